@@ -93,6 +93,11 @@
 #include "TH3D.h"
 #include "TRandom3.h"
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+
 
 ClassImp(AliCFUnfolding)
 
@@ -130,7 +135,11 @@ AliCFUnfolding::AliCFUnfolding() :
   fDeltaUnfoldedP(0x0),
   fDeltaUnfoldedN(0x0),
   fNCalcCorrErrors(0),
-  fRandomSeed(0)
+  fRandomSeed(0),
+  fUseCSREngine(kFALSE),
+  fNThreads(0),
+  fCSRNTrue(0),
+  fCSRNMeas(0)
 {
   //
   // default constructor
@@ -174,7 +183,11 @@ AliCFUnfolding::AliCFUnfolding(const Char_t* name, const Char_t* title, const In
   fDeltaUnfoldedP(0x0),
   fDeltaUnfoldedN(0x0),
   fNCalcCorrErrors(0),
-  fRandomSeed(randomSeed)
+  fRandomSeed(randomSeed),
+  fUseCSREngine(kFALSE),
+  fNThreads(0),
+  fCSRNTrue(0),
+  fCSRNMeas(0)
 {
   //
   // named constructor
@@ -353,40 +366,53 @@ void AliCFUnfolding::Unfold() {
   Int_t iIterBayes     = 0 ;
   Double_t convergence = 0.;
 
-  for (iIterBayes=0; iIterBayes<fMaxNumIterations; iIterBayes++) { // bayes iterations
+  if (fUseCSREngine && !fUseSmoothing) {
+    // same iterations on the flat representation, the THnSparse objects are updated at the end
+    BuildCSR();
+    CSRState state;
+    LoadCSRState(state);
+    RunCSRIterations(state,fNCalcCorrErrors==0,kTRUE);
+    convergence = state.fConvergence;
+    iIterBayes  = (state.fConverged ? state.fNIterations-1 : fMaxNumIterations);
+    if (state.fConverged) fNRandomIterations = iIterBayes;
+    StoreCSRState(state,state.fConverged);
+  }
+  else {
+    for (iIterBayes=0; iIterBayes<fMaxNumIterations; iIterBayes++) { // bayes iterations
 
-    CreateEstMeasured(); // create measured estimate from prior
-    CreateInvResponse(); // create inverse response  from prior
-    CreateUnfolded();    // create unfoled spectrum  from measured and inverse response
+      CreateEstMeasured(); // create measured estimate from prior
+      CreateInvResponse(); // create inverse response  from prior
+      CreateUnfolded();    // create unfoled spectrum  from measured and inverse response
 
-    convergence = GetConvergence();
-    AliDebug(0,Form("convergence at iteration %d is %e",iIterBayes,convergence));
+      convergence = GetConvergence();
+      AliDebug(0,Form("convergence at iteration %d is %e",iIterBayes,convergence));
 
-    if (fMaxConvergence>0. && convergence<fMaxConvergence && fNCalcCorrErrors == 0) {
-      fNRandomIterations = iIterBayes;
-      AliDebug(0,Form("convergence is met at iteration %d",iIterBayes));
-      break;
-    }
+      if (fMaxConvergence>0. && convergence<fMaxConvergence && fNCalcCorrErrors == 0) {
+        fNRandomIterations = iIterBayes;
+        AliDebug(0,Form("convergence is met at iteration %d",iIterBayes));
+        break;
+      }
 
-    if (fUseSmoothing) {
-      if (Smooth()) {
-	AliError("Couldn't smooth the unfolded spectrum!!");
-	if (fNCalcCorrErrors>0) {
-	  AliInfo(Form("=======================\nUnfold of randomized distribution finished at iteration %d with convergence %e \n",iIterBayes,convergence));
-	}
-	else {
-	  AliInfo(Form("\n\n=======================\nFinish at iteration %d : convergence is %e and you required it to be < %e\n=======================\n\n",iIterBayes,convergence,fMaxConvergence));
-	}
-	return;
+      if (fUseSmoothing) {
+        if (Smooth()) {
+          AliError("Couldn't smooth the unfolded spectrum!!");
+          if (fNCalcCorrErrors>0) {
+            AliInfo(Form("=======================\nUnfold of randomized distribution finished at iteration %d with convergence %e \n",iIterBayes,convergence));
+          }
+          else {
+            AliInfo(Form("\n\n=======================\nFinish at iteration %d : convergence is %e and you required it to be < %e\n=======================\n\n",iIterBayes,convergence,fMaxConvergence));
+          }
+          return;
+        }
       }
-    }
 
-    // update the prior distribution
-    if (fPrior) delete fPrior ;
-    fPrior = (THnSparse*)fUnfolded->Clone() ;
-    fPrior->SetTitle("Prior");
+      // update the prior distribution
+      if (fPrior) delete fPrior ;
+      fPrior = (THnSparse*)fUnfolded->Clone() ;
+      fPrior->SetTitle("Prior");
 
-  } // end bayes iteration
+    } // end bayes iteration
+  }
 
   if (fNCalcCorrErrors==0) fUnfoldedFinal = (THnSparse*) fUnfolded->Clone() ;
 
@@ -457,7 +483,8 @@ void AliCFUnfolding::CalculateCorrelatedErrors() {
 
 
   //Do fNRandomIterations = bayes iterations performed
-  for (int i=0; i<fNRandomIterations; i++) {
+  if (fUseCSREngine && !fUseSmoothing && fMaxNumIterations>0) RunCSRRandomIterations();
+  else for (int i=0; i<fNRandomIterations; i++) {
     
     // reset prior to original one
     if (fPrior) delete fPrior ;
@@ -512,22 +539,22 @@ void AliCFUnfolding::CreateRandomizedDist() {
   //
 
   for (Long_t iBin=0; iBin<fResponseOrig->GetNbins(); iBin++) {
-    Double_t val = fResponseOrig->GetBinContent(iBin,fCoordinatesN_M); //used as mean
-    Double_t err = fResponseOrig->GetBinError(fCoordinatesN_M);        //used as sigma
+    Double_t val = fResponseOrig->GetBinContent(iBin); //used as mean
+    Double_t err = fResponseOrig->GetBinError(iBin);   //used as sigma
     Double_t ran = fRandom3->Gaus(val,err);
     // random        = fRandom3->PoissonD(measuredValue); //doesn't work for normalized spectra, use Gaus (assuming raw counts in bin is large >10)
     fRandomResponse->SetBinContent(iBin,ran);
   }
   for (Long_t iBin=0; iBin<fEfficiencyOrig->GetNbins(); iBin++) {
-    Double_t val = fEfficiencyOrig->GetBinContent(iBin,fCoordinatesN_M); //used as mean
-    Double_t err = fEfficiencyOrig->GetBinError(fCoordinatesN_M);        //used as sigma
+    Double_t val = fEfficiencyOrig->GetBinContent(iBin); //used as mean
+    Double_t err = fEfficiencyOrig->GetBinError(iBin);   //used as sigma
     Double_t ran = fRandom3->Gaus(val,err);
     // random        = fRandom3->PoissonD(measuredValue); //doesn't work for normalized spectra, use Gaus (assuming raw counts in bin is large >10)
     fRandomEfficiency->SetBinContent(iBin,ran);
   }
   for (Long_t iBin=0; iBin<fMeasuredOrig->GetNbins(); iBin++) {
-    Double_t val = fMeasuredOrig->GetBinContent(iBin,fCoordinatesN_M); //used as mean
-    Double_t err = fMeasuredOrig->GetBinError(fCoordinatesN_M);        //used as sigma
+    Double_t val = fMeasuredOrig->GetBinContent(iBin); //used as mean
+    Double_t err = fMeasuredOrig->GetBinError(iBin);   //used as sigma
     Double_t ran = fRandom3->Gaus(val,err);
     // random        = fRandom3->PoissonD(measuredValue); //doesn't work for normalized spectra, use Gaus (assuming raw counts in bin is large >10)
     fRandomMeasured->SetBinContent(iBin,ran);
@@ -862,3 +889,468 @@ void AliCFUnfolding::CreateFlatPrior() {
   delete [] bin;
   delete [] bins;
 }
+
+//______________________________________________________________
+
+void AliCFUnfolding::BuildCSR() {
+  //
+  // Builds the flat representation of the conditional matrix, done only once (the conditional matrix does not change) :
+  // the true (T) and measured (M) bins are numbered, and the entries of the conditional matrix are stored
+  // by measured bin (CSR) and indexed by true bin (CSC).
+  // In each row and each column the entries keep the THnSparse bin order, so that all the sums
+  // are done in the same order as in CreateEstMeasured(), CreateInvResponse() and CreateUnfolded()
+  //
+
+  if (fCSRRowBegin.size()) return;
+
+  // keys of the bins : linearised coordinates, including under/overflows
+  fCSRKeyMult.assign(fNVariables,1);
+  for (Int_t iVar=0; iVar<fNVariables; iVar++) {
+    Int_t nBins = TMath::Max(fResponse->GetAxis(iVar)->GetNbins(),fResponse->GetAxis(iVar+fNVariables)->GetNbins());
+    nBins = TMath::Max(nBins,fPrior     ->GetAxis(iVar)->GetNbins());
+    nBins = TMath::Max(nBins,fPriorOrig ->GetAxis(iVar)->GetNbins());
+    nBins = TMath::Max(nBins,fEfficiency->GetAxis(iVar)->GetNbins());
+    nBins = TMath::Max(nBins,fMeasured  ->GetAxis(iVar)->GetNbins());
+    if (iVar+1<fNVariables) fCSRKeyMult[iVar+1] = fCSRKeyMult[iVar] * (nBins+2);
+  }
+
+  std::unordered_map<Long64_t,Int_t> trueIndex, measIndex;
+  fCSRTrueCoord.clear();
+  auto addTrue = [&](const Int_t* coord) {
+    auto found = trueIndex.insert(std::make_pair(CSRKey(coord),(Int_t)trueIndex.size()));
+    if (found.second) fCSRTrueCoord.insert(fCSRTrueCoord.end(),coord,coord+fNVariables);
+    return found.first->second;
+  };
+  auto addMeas = [&](const Int_t* coord) {
+    return measIndex.insert(std::make_pair(CSRKey(coord),(Int_t)measIndex.size())).first->second;
+  };
+
+  // entries of the conditional matrix
+  const Long64_t nEntries = fConditional->GetNbins();
+  std::vector<Int_t>    entryTrue(nEntries), entryMeas(nEntries);
+  std::vector<Double_t> entryCond(nEntries);
+  for (Long64_t iBin=0; iBin<nEntries; iBin++) {
+    entryCond[iBin] = fConditional->GetBinContent(iBin,fCoordinates2N);
+    GetCoordinates();
+    entryTrue[iBin] = addTrue(fCoordinatesN_T);
+    entryMeas[iBin] = addMeas(fCoordinatesN_M);
+  }
+  // the prior distributions may have bins outside of the response matrix
+  fCSRPriorTrue.resize(fPriorOrig->GetNbins());
+  for (Long64_t iBin=0; iBin<fPriorOrig->GetNbins(); iBin++) {
+    fPriorOrig->GetBinContent(iBin,fCoordinatesN_T);
+    fCSRPriorTrue[iBin] = addTrue(fCoordinatesN_T);
+  }
+  for (Long64_t iBin=0; iBin<fPrior->GetNbins(); iBin++) {
+    fPrior->GetBinContent(iBin,fCoordinatesN_T);
+    addTrue(fCoordinatesN_T);
+  }
+  fCSRNTrue = trueIndex.size();
+  fCSRNMeas = measIndex.size();
+
+  // efficiency and measured spectrum (the randomized ones have the same bins)
+  fCSREffTrue.resize(fEfficiencyOrig->GetNbins());
+  for (Long64_t iBin=0; iBin<fEfficiencyOrig->GetNbins(); iBin++) {
+    fEfficiencyOrig->GetBinContent(iBin,fCoordinatesN_T);
+    auto found = trueIndex.find(CSRKey(fCoordinatesN_T));
+    fCSREffTrue[iBin] = (found != trueIndex.end() ? found->second : -1);
+  }
+  fCSRMeasMeas.resize(fMeasuredOrig->GetNbins());
+  for (Long64_t iBin=0; iBin<fMeasuredOrig->GetNbins(); iBin++) {
+    fMeasuredOrig->GetBinContent(iBin,fCoordinatesN_M);
+    auto found = measIndex.find(CSRKey(fCoordinatesN_M));
+    fCSRMeasMeas[iBin] = (found != measIndex.end() ? found->second : -1);
+  }
+
+  // sorted keys of the true bins, to find the bins of other spectra
+  fCSRTrueKey.resize(fCSRNTrue);
+  fCSRTrueKeyBin.resize(fCSRNTrue);
+  std::vector<std::pair<Long64_t,Int_t> > keys(trueIndex.begin(),trueIndex.end());
+  std::sort(keys.begin(),keys.end());
+  for (Int_t iTrue=0; iTrue<fCSRNTrue; iTrue++) {
+    fCSRTrueKey[iTrue]    = keys[iTrue].first;
+    fCSRTrueKeyBin[iTrue] = keys[iTrue].second;
+  }
+
+  // rows (measured bins), stable in the response bin order
+  fCSRRowBegin.assign(fCSRNMeas+1,0);
+  for (Long64_t iBin=0; iBin<nEntries; iBin++) fCSRRowBegin[entryMeas[iBin]+1]++;
+  for (Int_t iMeas=0; iMeas<fCSRNMeas; iMeas++) fCSRRowBegin[iMeas+1] += fCSRRowBegin[iMeas];
+  fCSRTrue.resize(nEntries);
+  fCSRBin .resize(nEntries);
+  fCSRCond.resize(nEntries);
+  std::vector<Int_t> next(fCSRRowBegin.begin(),fCSRRowBegin.end()-1);
+  std::vector<Int_t> entryIndex(nEntries);
+  for (Long64_t iBin=0; iBin<nEntries; iBin++) {
+    Int_t iEntry = next[entryMeas[iBin]]++;
+    fCSRTrue[iEntry] = entryTrue[iBin];
+    fCSRBin [iEntry] = iBin;
+    fCSRCond[iEntry] = entryCond[iBin];
+    entryIndex[iBin] = iEntry;
+  }
+
+  // columns (true bins), stable in the response bin order
+  fCSCColBegin.assign(fCSRNTrue+1,0);
+  for (Long64_t iBin=0; iBin<nEntries; iBin++) fCSCColBegin[entryTrue[iBin]+1]++;
+  for (Int_t iTrue=0; iTrue<fCSRNTrue; iTrue++) fCSCColBegin[iTrue+1] += fCSCColBegin[iTrue];
+  fCSCEntry.resize(nEntries);
+  fCSCMeas .resize(nEntries);
+  next.assign(fCSCColBegin.begin(),fCSCColBegin.end()-1);
+  for (Long64_t iBin=0; iBin<nEntries; iBin++) {
+    Int_t k = next[entryTrue[iBin]]++;
+    fCSCEntry[k] = entryIndex[iBin];
+    fCSCMeas [k] = entryMeas[iBin];
+  }
+
+  AliInfo(Form("Flat representation : %d true bins, %d measured bins, %lld response entries",fCSRNTrue,fCSRNMeas,nEntries));
+}
+
+//______________________________________________________________
+
+Long64_t AliCFUnfolding::CSRKey(const Int_t* coord) const {
+  //
+  // key of the bin with N coordinates coord
+  //
+  Long64_t key = 0;
+  for (Int_t iVar=0; iVar<fNVariables; iVar++) key += coord[iVar] * fCSRKeyMult[iVar];
+  return key;
+}
+
+//______________________________________________________________
+
+Int_t AliCFUnfolding::FindCSRTrue(const Int_t* coord) const {
+  //
+  // true bin with N coordinates coord, -1 if it is not in the flat representation
+  //
+  Long64_t key = CSRKey(coord);
+  auto found = std::lower_bound(fCSRTrueKey.begin(),fCSRTrueKey.end(),key);
+  if (found == fCSRTrueKey.end() || *found != key) return -1;
+  return fCSRTrueKeyBin[found - fCSRTrueKey.begin()];
+}
+
+//______________________________________________________________
+
+void AliCFUnfolding::LoadCSRState(CSRState& state) const {
+  //
+  // fills the state from the current prior, efficiency, measured spectrum and inverse response
+  //
+
+  LoadCSRPrior(state,fPrior);
+
+  state.fEff.assign(fCSRNTrue,0.);
+  for (Long64_t iBin=0; iBin<fEfficiency->GetNbins(); iBin++) {
+    if (fCSREffTrue[iBin]>=0) state.fEff[fCSREffTrue[iBin]] = fEfficiency->GetBinContent(iBin);
+  }
+  state.fMeas.assign(fCSRNMeas,0.);
+  for (Long64_t iBin=0; iBin<fMeasured->GetNbins(); iBin++) {
+    if (fCSRMeasMeas[iBin]>=0) state.fMeas[fCSRMeasMeas[iBin]] = fMeasured->GetBinContent(iBin);
+  }
+
+  const Int_t nEntries = fCSRBin.size();
+  state.fInv.resize(nEntries);
+  for (Int_t iEntry=0; iEntry<nEntries; iEntry++) state.fInv[iEntry] = fInverseResponse->GetBinContent(fCSRBin[iEntry]);
+  state.fInvSet.assign(nEntries,0);
+
+  state.fPriorTimesEff.assign(fCSRNTrue,0.);
+  state.fEstMeas      .assign(fCSRNMeas,0.);
+  state.fUnfolded     .assign(fCSRNTrue,0.);
+  state.fFirstFill    .assign(fCSRNTrue,-1);
+  state.fUnfoldedOrder.clear();
+  state.fNIterations = 0;
+  state.fConverged   = kFALSE;
+  state.fConvergence = 0.;
+  state.fNBadPrior   = 0;
+}
+
+//______________________________________________________________
+
+void AliCFUnfolding::LoadCSRPrior(CSRState& state, const THnSparse* prior) const {
+  //
+  // puts the prior distribution in the state, keeping the THnSparse bin order
+  //
+
+  state.fPrior.assign(fCSRNTrue,0.);
+  state.fPriorOrder.clear();
+  std::vector<Int_t> coord(fNVariables);
+  for (Long64_t iBin=0; iBin<prior->GetNbins(); iBin++) {
+    Double_t priorValue = prior->GetBinContent(iBin,&coord[0]);
+    Int_t iTrue = (prior == fPriorOrig ? fCSRPriorTrue[iBin] : FindCSRTrue(&coord[0]));
+    if (iTrue<0) {
+      AliError(Form("Prior bin %lld is not in the flat representation",iBin));
+      continue;
+    }
+    state.fPrior[iTrue] = priorValue;
+    state.fPriorOrder.push_back(iTrue);
+  }
+}
+
+//______________________________________________________________
+
+void AliCFUnfolding::RunCSRIterations(CSRState& state, Bool_t allowBreak, Bool_t verbose) const {
+  //
+  // Bayes iterations on the flat representation :
+  // each step of the loop of Unfold() (CreateEstMeasured(), CreateInvResponse(), CreateUnfolded() and GetConvergence())
+  // is a product of the sparse conditional matrix with a dense vector, done in the same order as with THnSparse.
+  // Only the state is modified, so that several states can be iterated in parallel.
+  // If the convergence criterion is met and allowBreak is set, the loop stops and the prior of the last iteration is kept,
+  // otherwise the prior is the unfolded spectrum of the last iteration once swapped (see StoreCSRState())
+  //
+
+  state.fNIterations = 0;
+  state.fConverged   = kFALSE;
+  state.fConvergence = 0.;
+  state.fNBadPrior   = 0;
+
+  for (Int_t iIterBayes=0; iIterBayes<fMaxNumIterations; iIterBayes++) { // bayes iterations
+
+    // update the prior distribution
+    if (iIterBayes>0) {
+      state.fPrior.swap(state.fUnfolded);
+      state.fPriorOrder.swap(state.fUnfoldedOrder);
+    }
+
+    // prior times efficiency, defined only in the bins of the prior
+    std::fill(state.fPriorTimesEff.begin(),state.fPriorTimesEff.end(),0.);
+    for (Int_t iTrue : state.fPriorOrder) state.fPriorTimesEff[iTrue] = state.fPrior[iTrue] * state.fEff[iTrue];
+
+    // measured estimate and inverse response, row by row
+    for (Int_t iMeas=0; iMeas<fCSRNMeas; iMeas++) {
+      Double_t estMeasuredValue = 0.;
+      for (Int_t iEntry=fCSRRowBegin[iMeas]; iEntry<fCSRRowBegin[iMeas+1]; iEntry++) {
+        Double_t fill = fCSRCond[iEntry] * state.fPriorTimesEff[fCSRTrue[iEntry]];
+        if (fill>0.) estMeasuredValue += fill;
+      }
+      state.fEstMeas[iMeas] = estMeasuredValue;
+      for (Int_t iEntry=fCSRRowBegin[iMeas]; iEntry<fCSRRowBegin[iMeas+1]; iEntry++) {
+        Double_t fill = (estMeasuredValue>0. ? fCSRCond[iEntry] * state.fPriorTimesEff[fCSRTrue[iEntry]] / estMeasuredValue : 0.);
+        if (fill>0. || state.fInv[iEntry]>0.) {
+          state.fInv[iEntry]    = fill;
+          state.fInvSet[iEntry] = 1;
+        }
+      }
+    }
+
+    // unfolded spectrum, column by column
+    state.fUnfoldedOrder.clear();
+    for (Int_t iTrue=0; iTrue<fCSRNTrue; iTrue++) {
+      Double_t unfoldedValue = 0.;
+      Long64_t firstFill     = -1;
+      Double_t effValue      = state.fEff[iTrue];
+      if (effValue>0.) {
+        for (Int_t k=fCSCColBegin[iTrue]; k<fCSCColBegin[iTrue+1]; k++) {
+          Int_t iEntry = fCSCEntry[k];
+          Double_t fill = state.fInv[iEntry] * state.fMeas[fCSCMeas[k]] / effValue;
+          if (fill>0.) {
+            unfoldedValue += fill;
+            if (firstFill<0) firstFill = fCSRBin[iEntry];
+          }
+        }
+      }
+      state.fUnfolded [iTrue] = unfoldedValue;
+      state.fFirstFill[iTrue] = firstFill;
+      if (firstFill>=0) state.fUnfoldedOrder.push_back(iTrue);
+    }
+    // the bins of the unfolded THnSparse are created in the order of their first fill
+    const std::vector<Long64_t>& firstFill = state.fFirstFill;
+    std::sort(state.fUnfoldedOrder.begin(),state.fUnfoldedOrder.end(),
+              [&firstFill](Int_t a, Int_t b) { return firstFill[a] < firstFill[b]; });
+
+    // convergence
+    Double_t convergence = 0.;
+    for (Int_t iTrue : state.fPriorOrder) {
+      Double_t priorValue   = state.fPrior[iTrue];
+      Double_t currentValue = state.fUnfolded[iTrue];
+      if (priorValue > 0.)
+        convergence += ((priorValue-currentValue)/priorValue)*((priorValue-currentValue)/priorValue);
+      else {
+        state.fNBadPrior++;
+        if (verbose) AliWarning(Form("priorValue = %f. Adding 0 to convergence criterion.",priorValue));
+      }
+    }
+    state.fNIterations = iIterBayes+1;
+    state.fConvergence = convergence;
+    if (verbose) AliDebug(0,Form("convergence at iteration %d is %e",iIterBayes,convergence));
+
+    if (allowBreak && fMaxConvergence>0. && convergence<fMaxConvergence) {
+      state.fConverged = kTRUE;
+      if (verbose) AliDebug(0,Form("convergence is met at iteration %d",iIterBayes));
+      break;
+    }
+  } // end bayes iteration
+}
+
+//______________________________________________________________
+
+void AliCFUnfolding::StoreCSRState(const CSRState& state, Bool_t converged) {
+  //
+  // puts the result of the iterations in fPrior, fMeasuredEstimate, fInverseResponse and fUnfolded,
+  // with the same bins and contents as after the iterations of Unfold() with THnSparse
+  //
+
+  if (state.fNIterations==0) return;
+
+  if (state.fNIterations>1) {
+    // prior of the last iteration = unfolded spectrum of the one before
+    THnSparse* prior = (THnSparse*)fUnfolded->Clone();
+    prior->Reset();
+    for (Int_t iTrue : state.fPriorOrder) {
+      const Int_t* coord = &fCSRTrueCoord[iTrue*fNVariables];
+      prior->SetBinError  (coord,0.);
+      prior->AddBinContent(coord,state.fPrior[iTrue]);
+    }
+    prior->SetTitle("Prior");
+    if (fPrior) delete fPrior;
+    fPrior = prior;
+  }
+
+  CreateEstMeasured();
+  for (UInt_t iEntry=0; iEntry<state.fInvSet.size(); iEntry++) {
+    if (!state.fInvSet[iEntry]) continue;
+    fInverseResponse->SetBinContent(fCSRBin[iEntry],state.fInv[iEntry]);
+    fInverseResponse->SetBinError2 (fCSRBin[iEntry],0.);
+  }
+  CreateUnfolded();
+
+  if (!converged) {
+    // update the prior distribution
+    if (fPrior) delete fPrior ;
+    fPrior = (THnSparse*)fUnfolded->Clone() ;
+    fPrior->SetTitle("Prior");
+  }
+}
+
+//______________________________________________________________
+
+void AliCFUnfolding::RunCSRRandomIterations() {
+  //
+  // Random toys of CalculateCorrelatedErrors() on the flat representation.
+  // The randomized distributions are created in sequence (same random numbers as without the flat representation),
+  // then the toys are unfolded in parallel, by groups of fNThreads toys.
+  // The only state carried from one toy to the next is the inverse response : every toy of a group starts
+  // from the inverse response at the beginning of the group. This changes the result of the first iteration
+  // only if an entry was not set by the previous toys and is not positive in both; in this case the toy is
+  // unfolded again from the exact inverse response, so that the results are the same as in sequence.
+  //
+
+  BuildCSR();
+
+  Int_t nThreads = (fNThreads>0 ? fNThreads : (Int_t)std::thread::hardware_concurrency());
+  nThreads = TMath::Max(1,TMath::Min(nThreads,fNRandomIterations));
+
+  // bins of the final unfolded spectrum
+  fCSRFinalTrue.resize(fUnfoldedFinal->GetNbins());
+  for (Long64_t iBin=0; iBin<fUnfoldedFinal->GetNbins(); iBin++) {
+    fUnfoldedFinal->GetBinContent(iBin,fCoordinatesN_T);
+    fCSRFinalTrue[iBin] = FindCSRTrue(fCoordinatesN_T);
+  }
+
+  std::vector<CSRState> states(nThreads);
+  LoadCSRState(states[0]);
+  for (Int_t iThread=1; iThread<nThreads; iThread++) states[iThread] = states[0];
+  std::vector<Double_t> startInv(states[0].fInv);
+  std::vector<UChar_t>  invSet(startInv.size(),0);
+  const Int_t nEntries = startInv.size();
+
+  for (Int_t firstToy=0; firstToy<fNRandomIterations; firstToy+=nThreads) {
+    const Int_t nToys = TMath::Min(nThreads,fNRandomIterations-firstToy);
+
+    // create randomized distributions
+    for (Int_t iToy=0; iToy<nToys; iToy++) {
+      CSRState& state = states[iToy];
+      CreateRandomizedDist();
+      LoadCSRPrior(state,fPriorOrig);
+      std::fill(state.fEff.begin(),state.fEff.end(),0.);
+      for (Long64_t iBin=0; iBin<fRandomEfficiency->GetNbins(); iBin++) {
+        if (fCSREffTrue[iBin]>=0) state.fEff[fCSREffTrue[iBin]] = fRandomEfficiency->GetBinContent(iBin);
+      }
+      std::fill(state.fMeas.begin(),state.fMeas.end(),0.);
+      for (Long64_t iBin=0; iBin<fRandomMeasured->GetNbins(); iBin++) {
+        if (fCSRMeasMeas[iBin]>=0) state.fMeas[fCSRMeasMeas[iBin]] = fRandomMeasured->GetBinContent(iBin);
+      }
+      state.fInv = startInv;
+      std::fill(state.fInvSet.begin(),state.fInvSet.end(),0);
+    }
+
+    // unfold them with randomized distributions
+    std::atomic<Int_t> nextToy(0);
+    std::vector<std::thread> workers;
+    for (Int_t iThread=0; iThread<nToys; iThread++) {
+      workers.emplace_back([&]() {
+        for (Int_t iToy = nextToy++; iToy < nToys; iToy = nextToy++) RunCSRIterations(states[iToy],kFALSE,kFALSE);
+      });
+    }
+    for (auto &worker : workers) worker.join();
+
+    // results in sequence
+    for (Int_t iToy=0; iToy<nToys; iToy++) {
+      CSRState& state = states[iToy];
+      if (iToy>0) {
+        const std::vector<Double_t>& exactInv = states[iToy-1].fInv;
+        Bool_t same = kTRUE;
+        for (Int_t iEntry=0; iEntry<nEntries && same; iEntry++) {
+          same = (startInv[iEntry]==exactInv[iEntry] || (startInv[iEntry]>0. && exactInv[iEntry]>0.));
+        }
+        if (!same) {
+          LoadCSRPrior(state,fPriorOrig);
+          state.fInv = exactInv;
+          std::fill(state.fInvSet.begin(),state.fInvSet.end(),0);
+          RunCSRIterations(state,kFALSE,kFALSE);
+        }
+      }
+      for (Int_t iEntry=0; iEntry<nEntries; iEntry++) invSet[iEntry] |= state.fInvSet[iEntry];
+      if (state.fNBadPrior>0) AliWarning(Form("%d prior values were not positive and added 0 to the convergence criterion",state.fNBadPrior));
+      AliInfo(Form("=======================\nUnfolding of randomized distribution finished at iteration %d with convergence %e \n",fMaxNumIterations,state.fConvergence));
+      FillDeltaUnfoldedProfile(state.fUnfolded);
+    }
+    startInv = states[nToys-1].fInv;
+  }
+
+  // the THnSparse objects are left as after the last toy
+  if (fNRandomIterations>0) {
+    if (fResponse) delete fResponse ;
+    fResponse = (THnSparse*) fRandomResponse->Clone();
+    fResponse->SetTitle("Response");
+
+    if (fEfficiency) delete fEfficiency ;
+    fEfficiency = (THnSparse*) fRandomEfficiency->Clone();
+    fEfficiency->SetTitle("Efficiency");
+
+    if (fMeasured)   delete fMeasured   ;
+    fMeasured = (THnSparse*) fRandomMeasured->Clone();
+    fMeasured->SetTitle("Measured");
+
+    if (fPrior) delete fPrior ;
+    fPrior = (THnSparse*) fPriorOrig->Clone();
+
+    CSRState& last = states[(fNRandomIterations-1)%nThreads];
+    last.fInvSet.swap(invSet);
+    StoreCSRState(last,kFALSE);
+  }
+}
+
+//______________________________________________________________
+void AliCFUnfolding::FillDeltaUnfoldedProfile(const std::vector<Double_t>& unfolded) {
+  //
+  // Same as FillDeltaUnfoldedProfile(), with the unfolded spectrum in the true bins of the flat representation
+  //
+
+  for (Long_t iBin=0; iBin<fUnfoldedFinal->GetNbins(); iBin++) {
+    Double_t unfoldedValue = (fCSRFinalTrue[iBin]>=0 ? unfolded[fCSRFinalTrue[iBin]] : 0.);
+    Double_t deltaInBin    = fUnfoldedFinal->GetBinContent(iBin,fCoordinatesN_M) - unfoldedValue;
+    Double_t entriesInBin  = fDeltaUnfoldedN->GetBinContent(fCoordinatesN_M);
+
+    Double_t mean_nplus1 = fDeltaUnfoldedP->GetBinContent(fCoordinatesN_M) ;
+    mean_nplus1 *= entriesInBin ;
+    mean_nplus1 += deltaInBin ;
+    mean_nplus1 /= (entriesInBin+1) ;
+
+    Double_t meanx2_nplus1 = fDeltaUnfoldedP->GetBinError(fCoordinatesN_M) ;
+    meanx2_nplus1 *= entriesInBin ;
+    meanx2_nplus1 += (deltaInBin*deltaInBin) ;
+    meanx2_nplus1 /= (entriesInBin+1) ;
+
+    fDeltaUnfoldedP->SetBinError(fCoordinatesN_M,meanx2_nplus1) ;
+    fDeltaUnfoldedP->SetBinContent(fCoordinatesN_M,mean_nplus1) ;
+    fDeltaUnfoldedN->SetBinContent(fCoordinatesN_M,entriesInBin+1);
+  }
+}
@@ -10,6 +10,8 @@
 // Author : renaud.vernet@cern.ch                                     //
 //--------------------------------------------------------------------//
 
+#include <vector>
+
 #include "TNamed.h"
 #include "THnSparse.h"
 #include "AliLog.h"
@@ -36,6 +38,10 @@ class AliCFUnfolding : public TNamed {
   }
 
   void SetNRandomIterations(Int_t n = 100) {fNRandomIterations = n;};
+  void SetUseCSREngine(Bool_t b = kTRUE, Int_t nThreads = 0) { // run the iterations on flat arrays instead of THnSparse lookups
+    fUseCSREngine=b;                                           // the random toys run on nThreads threads (0 = number of cores)
+    fNThreads=nThreads;                                        // not used together with smoothing
+  }
 
   void UseSmoothing(TF1* fcn=0x0, Option_t* opt="iremn") { // if fcn=0x0 then smooth using neighbouring bins 
     fUseSmoothing=kTRUE;                                   // this function must NOT be used if fNVariables > 3
@@ -112,6 +118,45 @@ class AliCFUnfolding : public TNamed {
   Short_t        fNCalcCorrErrors;   // Book-keeping to prevend infinite loop
   UInt_t         fRandomSeed;        // Random seed
 
+  /* flat (CSR) representation of the unfolding, see BuildCSR() */
+  Bool_t         fUseCSREngine;      // Use the flat representation for the iterations
+  Int_t          fNThreads;          // Number of threads for the random toys (0 = number of cores)
+  // state of one unfolding (nominal or random toy) on the flat representation
+  struct CSRState {
+    std::vector<Double_t> fPrior;         // prior in true bins
+    std::vector<Int_t>    fPriorOrder;    // true bins present in the prior, in THnSparse bin order
+    std::vector<Double_t> fPriorTimesEff; // prior times efficiency
+    std::vector<Double_t> fEff;           // efficiency in true bins
+    std::vector<Double_t> fMeas;          // measured spectrum in measured bins
+    std::vector<Double_t> fEstMeas;       // measured estimate in measured bins
+    std::vector<Double_t> fInv;           // inverse response, one per response entry
+    std::vector<UChar_t>  fInvSet;        // inverse response entry was set (its error is 0)
+    std::vector<Double_t> fUnfolded;      // unfolded spectrum in true bins
+    std::vector<Int_t>    fUnfoldedOrder; // true bins present in the unfolded spectrum, in THnSparse bin order
+    std::vector<Long64_t> fFirstFill;     // response bin of the first fill of each true bin (-1 if not filled)
+    Int_t                 fNIterations;   // number of iterations done
+    Bool_t                fConverged;     // the convergence criterion was met at the last iteration
+    Double_t              fConvergence;   // convergence of the last iteration
+    Int_t                 fNBadPrior;     // number of non-positive prior values seen by the convergence
+  };
+  Int_t                 fCSRNTrue;       //! number of true bins
+  Int_t                 fCSRNMeas;       //! number of measured bins
+  std::vector<Int_t>    fCSRRowBegin;    //! entries of measured bin m are [fCSRRowBegin[m],fCSRRowBegin[m+1]), in response bin order
+  std::vector<Int_t>    fCSRTrue;        //! true bin of each entry
+  std::vector<Long64_t> fCSRBin;         //! response bin of each entry
+  std::vector<Double_t> fCSRCond;        //! conditional probability of each entry
+  std::vector<Int_t>    fCSCColBegin;    //! entries of true bin t are fCSCEntry[fCSCColBegin[t]..fCSCColBegin[t+1]-1], in response bin order
+  std::vector<Int_t>    fCSCEntry;       //! entry index
+  std::vector<Int_t>    fCSCMeas;        //! measured bin of the entry
+  std::vector<Int_t>    fCSRTrueCoord;   //! coordinates of the true bins (fNVariables per bin)
+  std::vector<Long64_t> fCSRKeyMult;     //! multipliers of the coordinates in the key of a bin
+  std::vector<Long64_t> fCSRTrueKey;     //! sorted keys of the true bins
+  std::vector<Int_t>    fCSRTrueKeyBin;  //! true bin of each key
+  std::vector<Int_t>    fCSREffTrue;     //! true bin of each bin of the efficiency (-1 if not used)
+  std::vector<Int_t>    fCSRMeasMeas;    //! measured bin of each bin of the measured spectrum (-1 if not used)
+  std::vector<Int_t>    fCSRPriorTrue;   //! true bin of each bin of the original prior
+  std::vector<Int_t>    fCSRFinalTrue;   //! true bin of each bin of the final unfolded spectrum (-1 if none)
+
 
   // functions
   void     Init();                  // initialisation of the internal settings
@@ -132,7 +177,18 @@ class AliCFUnfolding : public TNamed {
   void     FillDeltaUnfoldedProfile();  // Fills the fDeltaUnfoldedP profile
   void     SetMaxConvergencePerDOF (Double_t val);
 
-  ClassDef(AliCFUnfolding,1);
+  /* flat representation */
+  void     BuildCSR();                                        // builds the flat representation from the conditional matrix
+  Long64_t CSRKey(const Int_t* coord) const;                  // key of the bin with the N coordinates coord
+  Int_t    FindCSRTrue(const Int_t* coord) const;             // true bin with the N coordinates coord (-1 if none)
+  void     LoadCSRState(CSRState& state) const;               // fills the state from the THnSparse objects
+  void     LoadCSRPrior(CSRState& state, const THnSparse* prior) const;
+  void     RunCSRIterations(CSRState& state, Bool_t allowBreak, Bool_t verbose) const; // bayes iterations on the flat representation
+  void     StoreCSRState(const CSRState& state, Bool_t converged); // puts the result of the iterations in the THnSparse objects
+  void     RunCSRRandomIterations();                          // random toys of CalculateCorrelatedErrors on the flat representation
+  void     FillDeltaUnfoldedProfile(const std::vector<Double_t>& unfolded); // as FillDeltaUnfoldedProfile() from a flat unfolded spectrum
+
+  ClassDef(AliCFUnfolding,2);
 };
 
 #endif
@@ -24,6 +24,7 @@
 #include "AliMixInfo.h"
 #include "AliMixEventPool.h"
 #include "AliMixEventCutObj.h"
+#include "AliMixSnapshotPool.h"
 
 
 ClassImp(AliAnalysisTaskMixInfo)
@@ -141,6 +142,17 @@ void AliAnalysisTaskMixInfo::UserExecMix(Option_t *)
 void AliAnalysisTaskMixInfo::FinishTaskOutput()
 {
    // FinishTaskOutput
+   if (fMixInfo && fInputEHMix) {
+      // fills per bin statistics of snapshot pool
+      AliMixSnapshotPool *snapshotPool = fInputEHMix->GetSnapshotPool();
+      if (snapshotPool) {
+         for (Int_t bin = 0; bin < snapshotPool->GetNumberOfBins(); bin++) {
+            if (snapshotPool->GetNumberOfStored(bin)) fMixInfo->FillHistogram(AliMixInfo::kStoredEvents, bin, snapshotPool->GetNumberOfStored(bin));
+            if (snapshotPool->GetNumberOfEvicted(bin)) fMixInfo->FillHistogram(AliMixInfo::kEvictedEvents, bin, snapshotPool->GetNumberOfEvicted(bin));
+         }
+         snapshotPool->Print();
+      }
+   }
    if (fMixInfo) fMixInfo->Print();
 }
 
@@ -210,11 +222,19 @@ void AliAnalysisTaskMixInfo::InitMixInfo()
          //             TList *list = new TList;
          if (fMixInfo) fMixInfo->CreateHistogram(AliMixInfo::kMainEvents, 1, 1, 2);
          if (fMixInfo) fMixInfo->CreateHistogram(AliMixInfo::kMixedEvents, 1, 1, 2);
+         if (fInputEHMix->GetSnapshotPool()) {
+            fMixInfo->CreateHistogram(AliMixInfo::kStoredEvents, 1, 1, 2);
+            fMixInfo->CreateHistogram(AliMixInfo::kEvictedEvents, 1, 1, 2);
+         }
       } else {
          if (evPool->NeedInit()) evPool->Init();
          Int_t num = evPool->GetListOfEntryLists()->GetEntriesFast();
          if (fMixInfo) fMixInfo->CreateHistogram(AliMixInfo::kMainEvents, num, 1, num + 1);
          if (fMixInfo) fMixInfo->CreateHistogram(AliMixInfo::kMixedEvents, num, 1, num + 1);
+         if (fInputEHMix->GetSnapshotPool()) {
+            fMixInfo->CreateHistogram(AliMixInfo::kStoredEvents, num, 1, num + 1);
+            fMixInfo->CreateHistogram(AliMixInfo::kEvictedEvents, num, 1, num + 1);
+         }
       }
    }
 }
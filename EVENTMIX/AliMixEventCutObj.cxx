@@ -147,6 +147,27 @@ Int_t AliMixEventCutObj::GetBinNumber(Float_t num) const
    return -1;
 }
 
+//_________________________________________________________________________________________________
+void AliMixEventCutObj::GetBinEdges(TArrayF &lower, TArrayF &upper) const
+{
+   //
+   // Fills bin intervals <lower,upper) exactly as they are used in GetBinNumber
+   // (bin number = index in array + 1)
+   //
+   Int_t nBins = 0;
+   if (fCutStep >= 1e-5) {
+      for (Float_t iCurrent = fCutMin; iCurrent < fCutMax; iCurrent += fCutStep) nBins++;
+   }
+   lower.Set(nBins);
+   upper.Set(nBins);
+   Int_t binNum = 0;
+   for (Float_t iCurrent = fCutMin; binNum < nBins; iCurrent += fCutStep) {
+      lower[binNum] = iCurrent;
+      upper[binNum] = iCurrent + fCutStep - fCutSmallVal;
+      binNum++;
+   }
+}
+
 //_________________________________________________________________________________________________
 Int_t AliMixEventCutObj::GetIndex(AliVEvent *ev)
 {
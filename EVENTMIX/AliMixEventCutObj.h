@@ -13,6 +13,7 @@
 
 #include <TObject.h>
 #include <TString.h>
+#include <TArrayF.h>
 
 class AliVEvent;
 class AliAODEvent;
@@ -43,6 +44,7 @@ public:
    Float_t     GetStep() const { return fCutStep; }
    Short_t     GetType() const { return fCutType; }
    Int_t       GetBinNumber(Float_t num) const;
+   void        GetBinEdges(TArrayF &lower, TArrayF &upper) const;
    Int_t       GetIndex(AliVEvent *ev);
    Double_t    GetValue(AliVEvent *ev);
    Double_t    GetValue(AliESDEvent *ev);
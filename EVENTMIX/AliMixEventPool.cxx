@@ -23,7 +23,17 @@ AliMixEventPool::AliMixEventPool(const char *name, const char *title) : TNamed(n
    fListOfEventCuts(),
    fBinNumber(0),
    fBufferSize(0),
-   fMixNumber(0)
+   fMixNumber(0),
+   fIndexCuts(),
+   fIndexNBins(),
+   fIndexStride(),
+   fIndexBegin(),
+   fIndexLower(),
+   fIndexUpper(),
+   fIndexMin(),
+   fIndexInvStep(),
+   fIndexEntryLists(),
+   fIndexValues()
 {
    //
    // Default constructor.
@@ -37,7 +47,17 @@ AliMixEventPool::AliMixEventPool(const AliMixEventPool &obj) : TNamed(obj),
    fListOfEventCuts(obj.fListOfEventCuts),
    fBinNumber(obj.fBinNumber),
    fBufferSize(obj.fBufferSize),
-   fMixNumber(obj.fMixNumber)
+   fMixNumber(obj.fMixNumber),
+   fIndexCuts(),
+   fIndexNBins(),
+   fIndexStride(),
+   fIndexBegin(),
+   fIndexLower(),
+   fIndexUpper(),
+   fIndexMin(),
+   fIndexInvStep(),
+   fIndexEntryLists(),
+   fIndexValues()
 {
    //
    // Copy constructor
@@ -59,6 +79,9 @@ AliMixEventPool &AliMixEventPool::operator=(const AliMixEventPool &obj)
       fBinNumber = obj.fBinNumber;
       fBufferSize = obj.fBufferSize;
       fMixNumber = obj.fMixNumber;
+      // index points to objects of obj, it is rebuilt at next lookup
+      fIndexEntryLists.clear();
+      fIndexCuts.clear();
    }
    return *this;
 }
@@ -111,6 +134,7 @@ Int_t AliMixEventPool::Init()
    fBinNumber++;
    AliDebug(AliLog::kDebug, Form("fBinnumber = %d", fBinNumber));
    AddEntryList();
+   BuildIndex();
    AliDebug(AliLog::kDebug + 5, "->");
    return 0;
 }
@@ -174,15 +198,24 @@ Bool_t AliMixEventPool::AddEntry(Long64_t entry, AliVEvent *ev)
       return kFALSE;
    }
    Int_t idEntryList = -1;
-   TEntryList *el =  FindEntryList(ev, idEntryList);
-   if (el) {
-      el->Enter(entry);
-      AliDebug(AliLog::kDebug, Form("Entry %lld was added with idEntryList %d !!!", entry, idEntryList));
-      return kTRUE;
-   }
-   AliDebug(AliLog::kDebug, Form("Entry %lld was NOT added !!!", entry));
+   FindEntryList(ev, idEntryList);
    AliDebug(AliLog::kDebug + 5, "->");
-   return kFALSE;
+   return AddEntry(entry, idEntryList);
+}
+
+//_________________________________________________________________________________________________
+Bool_t AliMixEventPool::AddEntry(Long64_t entry, Int_t idEntryList)
+{
+   //
+   // Adds entry to entry list with index idEntryList (as found by FindEntryList)
+   //
+   if (entry < 0 || idEntryList < 1 || idEntryList > (Int_t)fIndexEntryLists.size() || !fIndexEntryLists[idEntryList - 1]) {
+      AliDebug(AliLog::kDebug, Form("Entry %lld was NOT added !!!", entry));
+      return kFALSE;
+   }
+   fIndexEntryLists[idEntryList - 1]->Enter(entry);
+   AliDebug(AliLog::kDebug, Form("Entry %lld was added with idEntryList %d !!!", entry, idEntryList));
+   return kTRUE;
 }
 
 //_________________________________________________________________________________________________
@@ -192,33 +225,99 @@ TEntryList *AliMixEventPool::FindEntryList(AliVEvent *ev, Int_t &idEntryList)
    // Find entrlist in list of entrlist
    //
    AliDebug(AliLog::kDebug + 5, "<-");
+   Int_t index = FindBinIndex(ev);
+   AliDebug(AliLog::kDebug, Form("idEntryList %d", index - 1));
+   if (index < 0) return 0;
+   idEntryList = index;
+   AliDebug(AliLog::kDebug + 5, "->");
+   // index which start with 0 (idEntryList-1)
+   if (idEntryList > (Int_t)fIndexEntryLists.size()) return 0;
+   return fIndexEntryLists[idEntryList - 1];
+}
+
+//_________________________________________________________________________________________________
+void AliMixEventPool::BuildIndex()
+{
+   //
+   // Builds stride index of bins: bin edges of every cut (as in AliMixEventCutObj::GetBinNumber),
+   // strides (first cut changes fastest, as in SetCutValuesFromBinIndex) and direct array of entry lists
+   //
+   AliDebug(AliLog::kDebug + 5, "<-");
    Int_t num = fListOfEventCuts.GetEntriesFast();
-   if (num < 1) return 0;
-   Int_t *indexes = new Int_t[num] ;
-   Int_t *lenght = new Int_t[num];
-   Int_t i = 0;
-   TObjArrayIter next(&fListOfEventCuts);
-   AliMixEventCutObj *cut;
-   while ((cut = (AliMixEventCutObj *) next())) {
-      indexes[i] = cut->GetIndex(ev);
-      if (indexes[i] < 0) {
-         AliDebug(AliLog::kDebug, Form("idEntryList %d", -1));
-         delete [] indexes;
-         delete [] lenght;
-         return 0;
-      }
-      lenght[i] = cut->GetNumberOfBins();
-      AliDebug(AliLog::kDebug + 1, Form("indexes[%d] %d", i, indexes[i]));
-      i++;
+   fIndexCuts.resize(num);
+   fIndexNBins.resize(num);
+   fIndexStride.resize(num);
+   fIndexBegin.resize(num + 1);
+   fIndexMin.resize(num);
+   fIndexInvStep.resize(num);
+   fIndexValues.resize(num);
+   fIndexLower.clear();
+   fIndexUpper.clear();
+   Int_t stride = 1;
+   TArrayF lower, upper;
+   for (Int_t i = 0; i < num; i++) {
+      AliMixEventCutObj *cut = (AliMixEventCutObj *) fListOfEventCuts.At(i);
+      cut->GetBinEdges(lower, upper);
+      fIndexCuts[i] = cut;
+      fIndexNBins[i] = lower.GetSize();
+      fIndexStride[i] = stride;
+      fIndexBegin[i] = fIndexLower.size();
+      fIndexLower.insert(fIndexLower.end(), lower.GetArray(), lower.GetArray() + lower.GetSize());
+      fIndexUpper.insert(fIndexUpper.end(), upper.GetArray(), upper.GetArray() + upper.GetSize());
+      fIndexMin[i] = cut->GetMin();
+      fIndexInvStep[i] = (fIndexNBins[i] > 0) ? 1.0 / cut->GetStep() : 0.0;
+      stride *= fIndexNBins[i];
+      AliDebug(AliLog::kDebug + 1, Form("cut[%d] nBins=%d stride=%d", i, fIndexNBins[i], fIndexStride[i]));
    }
-   idEntryList = 0;
-   SearchIndexRecursive(fListOfEventCuts.GetEntries() - 1, &indexes[0], &lenght[0], idEntryList);
-   AliDebug(AliLog::kDebug, Form("idEntryList %d", idEntryList - 1));
-   // index which start with 0 (idEntryList-1)
-   delete [] indexes;
-   delete [] lenght;
+   fIndexBegin[num] = fIndexLower.size();
+   // also 1 in case of no cuts ,which has 1 entry list
+   if (stride != fListOfEntryList.GetEntriesFast())
+      AliDebug(AliLog::kDebug, Form("number of bins %d differs from number of entry lists %d", stride, fListOfEntryList.GetEntriesFast()));
+
+   fIndexEntryLists.resize(fListOfEntryList.GetEntriesFast());
+   for (Int_t i = 0; i < fListOfEntryList.GetEntriesFast(); i++) fIndexEntryLists[i] = (TEntryList *) fListOfEntryList.At(i);
    AliDebug(AliLog::kDebug + 5, "->");
-   return (TEntryList *) fListOfEntryList.At(idEntryList - 1);
+}
+
+//_________________________________________________________________________________________________
+Int_t AliMixEventPool::FindBinIndex(AliVEvent *ev)
+{
+   //
+   // Finds bin index (idEntryList) of event, -1 if it is out of range
+   //
+   if ((Int_t)fIndexCuts.size() != fListOfEventCuts.GetEntriesFast() || (Int_t)fIndexEntryLists.size() != fListOfEntryList.GetEntriesFast()) BuildIndex();
+   if (fIndexCuts.empty()) return -1;
+   for (UInt_t i = 0; i < fIndexCuts.size(); i++) fIndexValues[i] = fIndexCuts[i]->GetValue(ev);
+   return FindBinIndex(&fIndexValues[0]);
+}
+
+//_________________________________________________________________________________________________
+Int_t AliMixEventPool::FindBinIndex(const Double_t *values)
+{
+   //
+   // Finds bin index (idEntryList) of cut values (one per cut), -1 if one of them is out of range
+   // Bin of every cut is guessed from uniform steps and corrected on the bin edges,
+   // so it is the same bin as AliMixEventCutObj::GetBinNumber gives
+   //
+   if ((Int_t)fIndexCuts.size() != fListOfEventCuts.GetEntriesFast() || (Int_t)fIndexEntryLists.size() != fListOfEntryList.GetEntriesFast()) BuildIndex();
+   Int_t num = fIndexCuts.size();
+   if (!num) return -1;
+   Int_t index = 1;
+   for (Int_t i = 0; i < num; i++) {
+      // values are compared as Float_t as in AliMixEventCutObj::GetBinNumber
+      const Float_t value = values[i];
+      const Int_t nBins = fIndexNBins[i];
+      const Float_t *lower = &fIndexLower[0] + fIndexBegin[i];
+      const Float_t *upper = &fIndexUpper[0] + fIndexBegin[i];
+      if (!nBins || !(value >= lower[0])) return -1;
+      Double_t guess = (value - fIndexMin[i]) * fIndexInvStep[i];
+      Int_t bin = (guess < nBins) ? (Int_t) guess : nBins - 1;
+      while (bin > 0 && value < lower[bin]) bin--;
+      while (bin < nBins - 1 && value >= lower[bin + 1]) bin++;
+      if (!(value < upper[bin])) return -1;
+      index += bin * fIndexStride[i];
+   }
+   return index;
 }
 
 //_________________________________________________________________________________________________
@@ -11,6 +11,8 @@
 #ifndef ALIMIXEVENTPOOL_H
 #define ALIMIXEVENTPOOL_H
 
+#include <vector>
+
 #include <TObjArray.h>
 #include <TNamed.h>
 
@@ -35,8 +37,14 @@ public:
    TEntryList *AddEntryList();
 
    Bool_t      AddEntry(Long64_t entry, AliVEvent *ev);
+   Bool_t      AddEntry(Long64_t entry, Int_t idEntryList);
    TEntryList *FindEntryList(AliVEvent *ev, Int_t &idEntryList);
 
+   // bin index (idEntryList, starting from 1) of event or of cut values (one per cut), -1 if out of range
+   Int_t       FindBinIndex(AliVEvent *ev);
+   Int_t       FindBinIndex(const Double_t *values);
+   void        BuildIndex();
+
    void        AddCut(AliMixEventCutObj *cut);
 
    Bool_t      NeedInit() { return (fListOfEntryList.GetEntries() == 0); }
@@ -58,7 +66,19 @@ private:
    Int_t       fBufferSize;            // buffer size
    Int_t       fMixNumber;             // mixing number
 
-   ClassDef(AliMixEventPool, 1)
+   // stride index of the bins: bin = 1 + sum_i (bin_i - 1) * stride_i
+   std::vector<AliMixEventCutObj *> fIndexCuts;    //! cuts
+   std::vector<Int_t>       fIndexNBins;           //! number of bins per cut
+   std::vector<Int_t>       fIndexStride;          //! stride per cut
+   std::vector<Int_t>       fIndexBegin;           //! first edge of each cut in fIndexLower/fIndexUpper
+   std::vector<Float_t>     fIndexLower;           //! lower bin edges of all cuts
+   std::vector<Float_t>     fIndexUpper;           //! upper bin edges of all cuts
+   std::vector<Double_t>    fIndexMin;             //! minimum per cut (uniform guess)
+   std::vector<Double_t>    fIndexInvStep;         //! 1/step per cut (uniform guess)
+   std::vector<TEntryList *> fIndexEntryLists;     //! entry list of each bin
+   std::vector<Double_t>    fIndexValues;          //! cut values of current event
+
+   ClassDef(AliMixEventPool, 2)
 };
 
 #endif
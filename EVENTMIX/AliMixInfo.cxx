@@ -75,19 +75,19 @@ void AliMixInfo::CreateHistogram(AliMixInfo::EInfoHistorgramType type, Int_t nbi
 }
 
 //_________________________________________________________________________________________________
-void AliMixInfo::FillHistogram(AliMixInfo::EInfoHistorgramType type, Int_t value)
+void AliMixInfo::FillHistogram(AliMixInfo::EInfoHistorgramType type, Int_t value, Double_t weight)
 {
    //
    // Create mix info histograms
    //
-   if (type == kMixedEvents && value < 0) return;
+   if (type != kMainEvents && value < 0) return;
    if (!fHistogramList) {
       AliError("fHistogramList is null");
       return;
    }
    TH1I *hist = (TH1I *) fHistogramList->FindObject(GetNameHistogramByType(type));
    if (hist) {
-      hist->Fill(value);
+      hist->Fill(value, weight);
       AliDebug(AliLog::kDebug, Form("%s was filled with %d sum is %.0f", GetNameHistogramByType(type), value, hist->GetBinContent(value)));
    } else {
       AliError(Form("Problem filling histogram %s", GetNameHistogramByType(type)));
@@ -105,6 +105,10 @@ const char *AliMixInfo::GetNameHistogramByType(Int_t index) const
          return "hMainEvents";
       case kMixedEvents:
          return "hMixedEvents";
+      case kStoredEvents:
+         return "hStoredEvents";
+      case kEvictedEvents:
+         return "hEvictedEvents";
    }
    return "";
 }
@@ -120,6 +124,10 @@ const char *AliMixInfo::GetTitleHistogramByType(Int_t index) const
          return "Main Events";
       case kMixedEvents:
          return "Mixed Events";
+      case kStoredEvents:
+         return "Events stored in snapshot pool";
+      case kEvictedEvents:
+         return "Events evicted from snapshot pool";
    }
    return "";
 }
@@ -435,6 +443,11 @@ void AliMixInfo::Add(AliMixInfo *mi)
    }
    hMain->Add(mi->GetHistogramByType(kMainEvents));
    hMix->Add(mi->GetHistogramByType(kMixedEvents));
+   // snapshot pool statistics (optional)
+   TH1I *hStored = GetHistogramByType(kStoredEvents);
+   if (hStored && mi->GetHistogramByType(kStoredEvents)) hStored->Add(mi->GetHistogramByType(kStoredEvents));
+   TH1I *hEvicted = GetHistogramByType(kEvictedEvents);
+   if (hEvicted && mi->GetHistogramByType(kEvictedEvents)) hEvicted->Add(mi->GetHistogramByType(kEvictedEvents));
 }
 
 //_________________________________________________________________________________________________
@@ -20,7 +20,7 @@ class TList;
 class TCollection;
 class AliMixInfo : public TNamed {
 public:
-   enum EInfoHistorgramType { kMainEvents = 0, kMixedEvents = 1, kNumTypes };
+   enum EInfoHistorgramType { kMainEvents = 0, kMixedEvents = 1, kStoredEvents = 2, kEvictedEvents = 3, kNumTypes };
 
    AliMixInfo(const char *name = "mix", const char *title = "MixInfo");
    AliMixInfo(const AliMixInfo &obj);
@@ -35,7 +35,7 @@ public:
 
    void SetOutputList(TList *const list) { fHistogramList = list; }
    void CreateHistogram(EInfoHistorgramType type, Int_t nbins, Int_t min, Int_t max);
-   void FillHistogram(AliMixInfo::EInfoHistorgramType type, Int_t value);
+   void FillHistogram(AliMixInfo::EInfoHistorgramType type, Int_t value, Double_t weight = 1.0);
    const char *GetNameHistogramByType(Int_t index) const;
    const char *GetTitleHistogramByType(Int_t index) const;
    TH1I  *GetHistogramByType(Int_t index) const;
@@ -17,6 +17,7 @@
 #include "AliInputEventHandler.h"
 
 #include "AliMixEventPool.h"
+#include "AliMixSnapshotPool.h"
 #include "AliMixInputEventHandler.h"
 #include "AliMixInputHandlerInfo.h"
 
@@ -33,6 +34,7 @@ AliMixInputEventHandler::AliMixInputEventHandler(const Int_t size, const Int_t m
    fEventPool(0),
    fNumberMixed(0),
    fMixNumber(mixNum),
+   fSnapshotPool(0),
    fUseDefautProcess(kFALSE),
    fDoMixExtra(kTRUE),
    fDoMixIfNotEnoughEvents(kTRUE),
@@ -43,7 +45,8 @@ AliMixInputEventHandler::AliMixInputEventHandler(const Int_t size, const Int_t m
    fCurrentBinIndex(-1),
    fOfflineTriggerMask(0),
    fCurrentMixEntry(),
-   fCurrentEntryMainTree(0)
+   fCurrentEntryMainTree(0),
+   fCurrentSnapshot(-1)
 {
    //
    // Default constructor.
@@ -192,7 +195,10 @@ Bool_t AliMixInputEventHandler::GetEntry()
    //
    AliDebug(AliLog::kDebug + 5, Form("<-"));
 
-   if (!fEventPool) {
+   if (fSnapshotPool) {
+      MixSnapshots();
+   }
+   else if (!fEventPool) {
       MixStd();
    }
    // if buffer size is higher then 1
@@ -297,8 +303,6 @@ Bool_t AliMixInputEventHandler::MixBuffer()
    Long64_t zeroChainEntries = fMixIntupHandlerInfoTmp->GetChain()->GetEntries() - inEvHMain->GetTree()->GetTree()->GetEntries();
    // fill entry
    Long64_t currentMainEntry = inEvHMain->GetTree()->GetTree()->GetReadEntry() + zeroChainEntries;
-   // fills entry
-   if (fEventPool && inEvHMain) fEventPool->AddEntry(currentMainEntry, inEvHMain->GetEvent());
    // start of
    AliDebug(AliLog::kDebug + 3, Form("++++++++++++++ BEGIN SETUP EVENT %lld +++++++++++++++++++", fEntryCounter));
    // reset mix number
@@ -306,7 +310,10 @@ Bool_t AliMixInputEventHandler::MixBuffer()
    Long64_t elNum = 0;
    TEntryList *el = 0;
    Int_t idEntryList = -1;
+   // one bin lookup for both filling the entry and mixing
    if (fEventPool) el = fEventPool->FindEntryList(inEvHMain->GetEvent(), idEntryList);
+   // fills entry
+   if (el) fEventPool->AddEntry(currentMainEntry, idEntryList);
    // return in case of 0 entry in full chain
    if (!fEntryCounter) {
       AliDebug(AliLog::kDebug + 3, Form("-> fEntryCounter == 0"));
@@ -398,7 +405,6 @@ Bool_t AliMixInputEventHandler::MixEventsMoreTimesWithOneEvent()
    Long64_t zeroChainEntries = fMixIntupHandlerInfoTmp->GetChain()->GetEntries() - inEvHMain->GetTree()->GetTree()->GetEntries();
    // fill entry
    Long64_t currentMainEntry = inEvHMain->GetTree()->GetTree()->GetReadEntry() + zeroChainEntries;
-   if (fEventPool && inEvHMain) fEventPool->AddEntry(currentMainEntry, inEvHMain->GetEvent());
    // start of
    AliDebug(AliLog::kDebug + 3, Form("++++++++++++++ BEGIN SETUP EVENT %lld +++++++++++++++++++", fEntryCounter));
    // reset mix number
@@ -406,7 +412,9 @@ Bool_t AliMixInputEventHandler::MixEventsMoreTimesWithOneEvent()
    Long64_t elNum = 0;
    Int_t idEntryList = -1;
    TEntryList *el = 0;
+   // one bin lookup for both filling the entry and mixing
    if (fEventPool) el = fEventPool->FindEntryList(inEvHMain->GetEvent(), idEntryList);
+   if (el) fEventPool->AddEntry(currentMainEntry, idEntryList);
    // return in case of 0 entry in full chain
    if (!fEntryCounter) {
       // runs UserExecMix for all tasks, if needed
@@ -495,6 +503,99 @@ Bool_t AliMixInputEventHandler::MixEventsMoreTimesWithBuffer()
    return kFALSE;
 }
 
+//_____________________________________________________________________________
+Bool_t AliMixInputEventHandler::MixSnapshots()
+{
+   //
+   // Mix with track snapshots of previous events from the same bin kept in memory
+   // (no event is read from the input tree). Without event pool all events are in bin 1
+   //
+   AliDebug(AliLog::kDebug + 5, "<-");
+   AliDebug(AliLog::kDebug + 1, "Mix method");
+   // get correct handler
+   AliAnalysisManager *mgr = AliAnalysisManager::GetAnalysisManager();
+   AliMultiInputEventHandler *mh = dynamic_cast<AliMultiInputEventHandler *>(mgr->GetInputEventHandler());
+   AliInputEventHandler *inEvHMain = 0;
+   if (mh) inEvHMain = dynamic_cast<AliInputEventHandler *>(mh->GetFirstInputEventHandler());
+   else inEvHMain = dynamic_cast<AliInputEventHandler *>(mgr->GetInputEventHandler());
+   if (!inEvHMain) return kFALSE;
+
+   // check for PhysSelection
+   if (!IsEventCurrentSelected()) return kFALSE;
+
+   fCurrentMixEntry.Reset();
+   fCurrentSnapshot = -1;
+
+   // find out zero chain entries
+   Long64_t zeroChainEntries = fMixIntupHandlerInfoTmp->GetChain()->GetEntries() - inEvHMain->GetTree()->GetTree()->GetEntries();
+   // fill entry
+   Long64_t currentMainEntry = inEvHMain->GetTree()->GetTree()->GetReadEntry() + zeroChainEntries;
+   // start of
+   AliDebug(AliLog::kDebug + 3, Form("++++++++++++++ BEGIN SETUP EVENT %lld +++++++++++++++++++", fEntryCounter));
+   // reset mix number
+   fNumberMixed = 0;
+   Int_t idEntryList = 1;
+   if (fEventPool && !fEventPool->FindEntryList(inEvHMain->GetEvent(), idEntryList)) idEntryList = -1;
+   if (idEntryList < 0) {
+      AliDebug(AliLog::kDebug + 3, Form("++++++++++++++ END SETUP EVENT %lld SKIPPED (el null) +++++++++++++++++++", fEntryCounter));
+      UserExecMixAllTasks(fEntryCounter, -1, currentMainEntry, -1, 0);
+      return kTRUE;
+   }
+
+   Int_t nEvents = fSnapshotPool->GetNumberOfEvents(idEntryList);
+   if (!nEvents || (!fDoMixIfNotEnoughEvents && nEvents < fMixNumber)) {
+      // include main event in to counter only if requested (idEntryList>0)
+      if (!nEvents && !fDoMixIfNotEnoughEvents) UserExecMixAllTasks(fEntryCounter, -1, currentMainEntry, -1, 0);
+      else UserExecMixAllTasks(fEntryCounter, idEntryList, currentMainEntry, -1, 0);
+      AliDebug(AliLog::kDebug + 3, Form("++++++++++++++ END SETUP EVENT %lld SKIPPED (%d) NOT ENOUGH EVENTS TO MIX => NEED=%d +++++++++++++++++++", fEntryCounter, nEvents, fMixNumber));
+   } else {
+      // pre mix evetns
+      Int_t mixNum = fMixNumber;
+      if (fDoMixExtra) {
+         if (nEvents <= 2 * fMixNumber) mixNum = nEvents;
+      }
+      Long64_t entryMix = 0;
+      for (Int_t counter = 0; counter < mixNum && counter < nEvents; counter++) {
+         fCurrentMixEntry.Reset();
+         entryMix = fSnapshotPool->GetEntry(idEntryList, counter);
+         fCurrentMixEntry.Enter(entryMix);
+         fCurrentSnapshot = counter;
+         // runs UserExecMix for all tasks
+         fNumberMixed++;
+         UserExecMixAllTasks(fEntryCounter, idEntryList, currentMainEntry, entryMix, fNumberMixed);
+      }
+   }
+
+   // current event is stored after mixing, so it is not mixed with itself
+   fSnapshotPool->AddEvent(idEntryList, inEvHMain->GetEvent(), currentMainEntry);
+
+   AliDebug(AliLog::kDebug + 3, Form("fEntryCounter=%lld fMixEventNumber=%d", fEntryCounter, fNumberMixed));
+   AliDebug(AliLog::kDebug + 3, Form("++++++++++++++ END SETUP EVENT %lld +++++++++++++++++++", fEntryCounter));
+   AliDebug(AliLog::kDebug + 5, "->");
+   return kTRUE;
+}
+
+//_____________________________________________________________________________
+Int_t AliMixInputEventHandler::CurrentSnapshotNumberOfTracks() const
+{
+   //
+   // Number of tracks in snapshot of current mixed event
+   //
+   if (!fSnapshotPool || fCurrentSnapshot < 0) return 0;
+   return fSnapshotPool->GetNumberOfTracks(fCurrentBinIndex, fCurrentSnapshot);
+}
+
+//_____________________________________________________________________________
+const Float_t *AliMixInputEventHandler::CurrentSnapshotTracks() const
+{
+   //
+   // Tracks of current mixed event as flat array [iTrack*nColumns+iColumn]
+   // (see AliMixSnapshotPool::GetColumnIndex)
+   //
+   if (!fSnapshotPool || fCurrentSnapshot < 0) return 0;
+   return fSnapshotPool->GetTracks(fCurrentBinIndex, fCurrentSnapshot);
+}
+
 //_____________________________________________________________________________
 Bool_t AliMixInputEventHandler::FinishEvent()
 {
@@ -21,6 +21,7 @@
 class TChain;
 class TChainElement;
 class AliMixEventPool;
+class AliMixSnapshotPool;
 class AliMixInputHandlerInfo;
 class AliInputEventHandler;
 class AliMixInputEventHandler : public AliMultiInputEventHandler {
@@ -42,8 +43,11 @@ public:
 
    void                    SetInputHandlerForMixing(const AliInputEventHandler *const inHandler);
    void                    SetEventPool(AliMixEventPool *const evPool) { fEventPool = evPool; }
+   // mixing partners are taken from track snapshots in memory instead of the input tree
+   void                    SetSnapshotPool(AliMixSnapshotPool *const snapshotPool) { fSnapshotPool = snapshotPool; }
 
    AliMixEventPool        *GetEventPool() const { return fEventPool; }
+   AliMixSnapshotPool     *GetSnapshotPool() const { return fSnapshotPool; }
    Int_t                   BufferSize() const { return fBufferSize; }
    Int_t                   NumberMixedTimes() const { return fNumberMixed; }
    Int_t                   MixNumber() const { return fMixNumber; }
@@ -64,6 +68,9 @@ public:
    Long64_t                CurrentEntryMain() const { return fCurrentEntryMain; }
    Long64_t                CurrentEntryMix() const { return fCurrentEntryMix; }
    Int_t                   NumberMixed() const { return fNumberMixed; }
+   // snapshot of current mixed event (snapshot pool only, should be used in UserExecMix() only)
+   Int_t                   CurrentSnapshotNumberOfTracks() const;
+   const Float_t          *CurrentSnapshotTracks() const;
 
    void                    SelectCollisionCandidates(UInt_t offlineTriggerMask = AliVEvent::kMB) {fOfflineTriggerMask = offlineTriggerMask;}
    Bool_t                  IsEventCurrentSelected();
@@ -82,6 +89,7 @@ protected:
    AliMixEventPool        *fEventPool;             // event pool
    Int_t                   fNumberMixed;           // number of mixed events with current event
    Int_t                   fMixNumber;             // user's mix number request
+   AliMixSnapshotPool     *fSnapshotPool;          // in memory pool of track snapshots
 
 private:
 
@@ -99,18 +107,20 @@ private:
 
    TEntryList fCurrentMixEntry;    //! array of mix entries currently used (user should touch)
    Long64_t fCurrentEntryMainTree; //! current entry in current tree (main event)
+   Int_t    fCurrentSnapshot;      //! current mixed event in snapshot pool (0 = most recent)
 
    virtual Bool_t          MixStd();
    virtual Bool_t          MixBuffer();
    virtual Bool_t          MixEventsMoreTimesWithOneEvent();
    virtual Bool_t          MixEventsMoreTimesWithBuffer();
+   virtual Bool_t          MixSnapshots();
 
    void                    UserExecMixAllTasks(Long64_t entryCounter, Int_t idEntryList, Long64_t entryMainReal, Long64_t entryMixReal, Int_t numMixed);
 
    AliMixInputEventHandler(const AliMixInputEventHandler &handler);
    AliMixInputEventHandler &operator=(const AliMixInputEventHandler &handler);
 
-   ClassDef(AliMixInputEventHandler, 5)
+   ClassDef(AliMixInputEventHandler, 6)
 };
 
 #endif
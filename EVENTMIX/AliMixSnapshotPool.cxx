@@ -0,0 +1,402 @@
+//
+// Class AliMixSnapshotPool
+//
+// AliMixSnapshotPool keeps compact track snapshots of the last events
+// of every event pool bin in memory, so that the mixing partners
+// are taken from memory instead of being read again from the input tree
+//
+// Every bin is a ring buffer of events stored in one flat array of
+// Float_t (the selected columns of each track). New events are appended,
+// evicted events only move the head, the array is compacted when more
+// than half of it belongs to evicted events.
+//
+
+#include <TObjArray.h>
+#include <TMath.h>
+
+#include "AliLog.h"
+#include "AliVEvent.h"
+#include "AliVParticle.h"
+
+#include "AliMixSnapshotPool.h"
+
+ClassImp(AliMixSnapshotPool)
+
+//_________________________________________________________________________________________________
+AliMixSnapshotPool::AliMixSnapshotPool(const char *name, const char *title) : TNamed(name, title),
+   fColumns(),
+   fMaxEventsPerBin(10),
+   fMaxTracksPerBin(0),
+   fMaxMemory(0),
+   fPtMin(0),
+   fPtMax(-1),
+   fEtaMax(-1),
+   fData(),
+   fEventBegin(),
+   fEventEntry(),
+   fHead(),
+   fNStored(),
+   fNEvicted(),
+   fMemory(0)
+{
+   //
+   // Default constructor.
+   //
+   AliDebug(AliLog::kDebug + 5, "<-");
+   AliDebug(AliLog::kDebug + 5, "->");
+}
+//_________________________________________________________________________________________________
+AliMixSnapshotPool::AliMixSnapshotPool(const AliMixSnapshotPool &obj) : TNamed(obj),
+   fColumns(obj.fColumns),
+   fMaxEventsPerBin(obj.fMaxEventsPerBin),
+   fMaxTracksPerBin(obj.fMaxTracksPerBin),
+   fMaxMemory(obj.fMaxMemory),
+   fPtMin(obj.fPtMin),
+   fPtMax(obj.fPtMax),
+   fEtaMax(obj.fEtaMax),
+   fData(),
+   fEventBegin(),
+   fEventEntry(),
+   fHead(),
+   fNStored(),
+   fNEvicted(),
+   fMemory(0)
+{
+   //
+   // Copy constructor (copies the configuration only)
+   //
+   AliDebug(AliLog::kDebug + 5, "<-");
+   AliDebug(AliLog::kDebug + 5, "->");
+}
+
+//_________________________________________________________________________________________________
+AliMixSnapshotPool &AliMixSnapshotPool::operator=(const AliMixSnapshotPool &obj)
+{
+   //
+   // Assigned operator (copies the configuration only)
+   //
+   if (&obj != this) {
+      TNamed::operator=(obj);
+      fColumns = obj.fColumns;
+      fMaxEventsPerBin = obj.fMaxEventsPerBin;
+      fMaxTracksPerBin = obj.fMaxTracksPerBin;
+      fMaxMemory = obj.fMaxMemory;
+      fPtMin = obj.fPtMin;
+      fPtMax = obj.fPtMax;
+      fEtaMax = obj.fEtaMax;
+      Clear();
+   }
+   return *this;
+}
+
+//_________________________________________________________________________________________________
+AliMixSnapshotPool::~AliMixSnapshotPool()
+{
+   //
+   // Destructor
+   //
+   AliDebug(AliLog::kDebug + 5, "<-");
+   AliDebug(AliLog::kDebug + 5, "->");
+}
+
+//_________________________________________________________________________________________________
+void AliMixSnapshotPool::AddColumn(AliMixSnapshotPool::EColumn_t column)
+{
+   //
+   // Adds column to the track snapshot
+   //
+   if (column < 0 || column >= kNumColumns) {
+      AliError(Form("Column %d is not supported", column));
+      return;
+   }
+   if (fMemory > 0) {
+      AliError("Columns can not be changed when events are stored");
+      return;
+   }
+   if (GetColumnIndex(column) >= 0) return;
+   fColumns.Set(fColumns.GetSize() + 1);
+   fColumns[fColumns.GetSize() - 1] = column;
+}
+
+//_________________________________________________________________________________________________
+Int_t AliMixSnapshotPool::GetColumnIndex(AliMixSnapshotPool::EColumn_t column) const
+{
+   //
+   // Returns index of column in track snapshot (-1 if column is not stored)
+   //
+   for (Int_t i = 0; i < fColumns.GetSize(); i++) {
+      if (fColumns[i] == column) return i;
+   }
+   return -1;
+}
+
+//_________________________________________________________________________________________________
+void AliMixSnapshotPool::Print(const Option_t *option) const
+{
+   //
+   // Prints usefull information
+   //
+   AliInfo(Form("%s columns=%d maxEventsPerBin=%d maxTracksPerBin=%d maxMemory=%lld memory=%lld %s", GetName(), fColumns.GetSize(), fMaxEventsPerBin, fMaxTracksPerBin, fMaxMemory, fMemory, option));
+   for (Int_t bin = 0; bin < GetNumberOfBins(); bin++) {
+      if (!fNStored[bin]) continue;
+      AliInfo(Form("bin[%d] events=%d stored=%lld evicted=%lld memory=%lld", bin, GetNumberOfEvents(bin), fNStored[bin], fNEvicted[bin], BinMemory(bin)));
+   }
+}
+
+//_________________________________________________________________________________________________
+void AliMixSnapshotPool::Clear(Option_t *)
+{
+   //
+   // Removes all stored events
+   //
+   fData.clear();
+   fEventBegin.clear();
+   fEventEntry.clear();
+   fHead.clear();
+   fNStored.clear();
+   fNEvicted.clear();
+   fMemory = 0;
+}
+
+//_________________________________________________________________________________________________
+void AliMixSnapshotPool::PrepareBin(Int_t bin)
+{
+   //
+   // Creates bins up to bin and default columns
+   //
+   if (!fColumns.GetSize()) {
+      AddColumn(kPt);
+      AddColumn(kEta);
+      AddColumn(kPhi);
+      AddColumn(kCharge);
+   }
+   if (bin < GetNumberOfBins()) return;
+   fData.resize(bin + 1);
+   fEventBegin.resize(bin + 1);
+   fEventEntry.resize(bin + 1);
+   fHead.resize(bin + 1, 0);
+   fNStored.resize(bin + 1, 0);
+   fNEvicted.resize(bin + 1, 0);
+}
+
+//_________________________________________________________________________________________________
+Bool_t AliMixSnapshotPool::AcceptTrack(AliVParticle *track) const
+{
+   //
+   // Track cuts
+   //
+   if (!track) return kFALSE;
+   if (track->Pt() < fPtMin) return kFALSE;
+   if (fPtMax > 0 && track->Pt() > fPtMax) return kFALSE;
+   if (fEtaMax > 0 && TMath::Abs(track->Eta()) > fEtaMax) return kFALSE;
+   return kTRUE;
+}
+
+//_________________________________________________________________________________________________
+void AliMixSnapshotPool::AddTrack(Int_t bin, AliVParticle *track)
+{
+   //
+   // Appends selected columns of track to the bin
+   //
+   std::vector<Float_t> &data = fData[bin];
+   for (Int_t i = 0; i < fColumns.GetSize(); i++) {
+      Double_t value = 0;
+      switch (fColumns[i]) {
+         case kPt:
+            value = track->Pt();
+            break;
+         case kEta:
+            value = track->Eta();
+            break;
+         case kPhi:
+            value = track->Phi();
+            break;
+         case kCharge:
+            value = track->Charge();
+            break;
+         case kPx:
+            value = track->Px();
+            break;
+         case kPy:
+            value = track->Py();
+            break;
+         case kPz:
+            value = track->Pz();
+            break;
+         case kE:
+            value = track->E();
+            break;
+         case kM:
+            value = track->M();
+            break;
+         case kY:
+            value = track->Y();
+            break;
+         case kLabel:
+            value = track->GetLabel();
+            break;
+      }
+      data.push_back(value);
+   }
+}
+
+//_________________________________________________________________________________________________
+Int_t AliMixSnapshotPool::AddEvent(Int_t bin, AliVEvent *ev, Long64_t entry)
+{
+   //
+   // Stores snapshot of accepted tracks of event in bin
+   // Returns number of evicted events
+   //
+   if (bin < 0 || !ev) return 0;
+   PrepareBin(bin);
+   fEventBegin[bin].push_back(fData[bin].size() / fColumns.GetSize());
+   AliVParticle *track;
+   for (Int_t i = 0; i < ev->GetNumberOfTracks(); i++) {
+      track = ev->GetTrack(i);
+      if (AcceptTrack(track)) AddTrack(bin, track);
+   }
+   return FinishEvent(bin, entry);
+}
+
+//_________________________________________________________________________________________________
+Int_t AliMixSnapshotPool::AddEvent(Int_t bin, TObjArray *tracks, Long64_t entry)
+{
+   //
+   // Stores snapshot of accepted tracks (AliVParticle) in bin
+   // Returns number of evicted events
+   //
+   if (bin < 0 || !tracks) return 0;
+   PrepareBin(bin);
+   fEventBegin[bin].push_back(fData[bin].size() / fColumns.GetSize());
+   AliVParticle *track;
+   for (Int_t i = 0; i < tracks->GetEntriesFast(); i++) {
+      track = dynamic_cast<AliVParticle *>(tracks->UncheckedAt(i));
+      if (AcceptTrack(track)) AddTrack(bin, track);
+   }
+   return FinishEvent(bin, entry);
+}
+
+//_________________________________________________________________________________________________
+Int_t AliMixSnapshotPool::FinishEvent(Int_t bin, Long64_t entry)
+{
+   //
+   // Updates statistics of the new event in bin and applies the limits
+   // Returns number of evicted events
+   //
+   const Int_t nColumns = fColumns.GetSize();
+   fEventEntry[bin].push_back(entry);
+   fNStored[bin]++;
+   fMemory += (fData[bin].size() / nColumns - fEventBegin[bin].back()) * nColumns * sizeof(Float_t) + sizeof(Int_t) + sizeof(Long64_t);
+
+   Int_t nEvicted = 0;
+   // per bin limits, the new event is always kept
+   while (GetNumberOfEvents(bin) > 1) {
+      Int_t nTracks = fData[bin].size() / nColumns - fEventBegin[bin][fHead[bin]];
+      if (GetNumberOfEvents(bin) <= fMaxEventsPerBin && (fMaxTracksPerBin <= 0 || nTracks <= fMaxTracksPerBin)) break;
+      EvictOldest(bin);
+      nEvicted++;
+   }
+
+   // memory limit, oldest event of the largest bin is evicted
+   while (fMaxMemory > 0 && fMemory > fMaxMemory) {
+      Int_t largestBin = -1;
+      Long64_t largestMemory = 0;
+      for (Int_t i = 0; i < GetNumberOfBins(); i++) {
+         if (GetNumberOfEvents(i) < ((i == bin) ? 2 : 1)) continue;
+         Long64_t mem = BinMemory(i);
+         if (mem > largestMemory) {
+            largestMemory = mem;
+            largestBin = i;
+         }
+      }
+      if (largestBin < 0) break;
+      EvictOldest(largestBin);
+      if (largestBin == bin) nEvicted++;
+   }
+
+   AliDebug(AliLog::kDebug + 1, Form("bin=%d entry=%lld events=%d evicted=%d memory=%lld", bin, entry, GetNumberOfEvents(bin), nEvicted, fMemory));
+   return nEvicted;
+}
+
+//_________________________________________________________________________________________________
+void AliMixSnapshotPool::EvictOldest(Int_t bin)
+{
+   //
+   // Removes oldest event of bin
+   //
+   const Int_t nColumns = fColumns.GetSize();
+   std::vector<Float_t> &data = fData[bin];
+   std::vector<Int_t> &begin = fEventBegin[bin];
+   std::vector<Long64_t> &entries = fEventEntry[bin];
+   Int_t &head = fHead[bin];
+   Int_t end = (head + 1 < (Int_t)begin.size()) ? begin[head + 1] : data.size() / nColumns;
+   fMemory -= (end - begin[head]) * nColumns * sizeof(Float_t) + sizeof(Int_t) + sizeof(Long64_t);
+   fNEvicted[bin]++;
+   head++;
+
+   // compact when evicted events take more than half of the bin
+   if (2 * head < (Int_t)begin.size()) return;
+   Int_t offset = (head < (Int_t)begin.size()) ? begin[head] : data.size() / nColumns;
+   data.erase(data.begin(), data.begin() + offset * nColumns);
+   begin.erase(begin.begin(), begin.begin() + head);
+   entries.erase(entries.begin(), entries.begin() + head);
+   for (UInt_t i = 0; i < begin.size(); i++) begin[i] -= offset;
+   head = 0;
+}
+
+//_________________________________________________________________________________________________
+Long64_t AliMixSnapshotPool::BinMemory(Int_t bin) const
+{
+   //
+   // Returns bytes used by kept events of bin
+   //
+   Int_t nEvents = GetNumberOfEvents(bin);
+   if (!nEvents) return 0;
+   const Int_t nColumns = fColumns.GetSize();
+   Long64_t nTracks = fData[bin].size() / nColumns - fEventBegin[bin][fHead[bin]];
+   return nTracks * nColumns * sizeof(Float_t) + nEvents * (sizeof(Int_t) + sizeof(Long64_t));
+}
+
+//_________________________________________________________________________________________________
+Int_t AliMixSnapshotPool::GetNumberOfEvents(Int_t bin) const
+{
+   //
+   // Returns number of kept events in bin
+   //
+   if (bin < 0 || bin >= GetNumberOfBins()) return 0;
+   return fEventBegin[bin].size() - fHead[bin];
+}
+
+//_________________________________________________________________________________________________
+Int_t AliMixSnapshotPool::GetNumberOfTracks(Int_t bin, Int_t iEvent) const
+{
+   //
+   // Returns number of tracks of event iEvent (0 = most recent) in bin
+   //
+   if (iEvent < 0 || iEvent >= GetNumberOfEvents(bin)) return 0;
+   Int_t index = fEventBegin[bin].size() - 1 - iEvent;
+   Int_t end = (iEvent > 0) ? fEventBegin[bin][index + 1] : fData[bin].size() / fColumns.GetSize();
+   return end - fEventBegin[bin][index];
+}
+
+//_________________________________________________________________________________________________
+const Float_t *AliMixSnapshotPool::GetTracks(Int_t bin, Int_t iEvent) const
+{
+   //
+   // Returns tracks of event iEvent (0 = most recent) in bin
+   // as flat array [iTrack*GetNumberOfColumns()+iColumn] (0 for empty or not existing event)
+   //
+   if (GetNumberOfTracks(bin, iEvent) <= 0) return 0;
+   Int_t index = fEventBegin[bin].size() - 1 - iEvent;
+   return &fData[bin][fEventBegin[bin][index] * fColumns.GetSize()];
+}
+
+//_________________________________________________________________________________________________
+Long64_t AliMixSnapshotPool::GetEntry(Int_t bin, Int_t iEvent) const
+{
+   //
+   // Returns entry of event iEvent (0 = most recent) in bin (-1 for not existing event)
+   //
+   if (iEvent < 0 || iEvent >= GetNumberOfEvents(bin)) return -1;
+   return fEventEntry[bin][fEventEntry[bin].size() - 1 - iEvent];
+}
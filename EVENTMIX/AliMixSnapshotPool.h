@@ -0,0 +1,94 @@
+//
+// Class AliMixSnapshotPool
+//
+// AliMixSnapshotPool keeps compact track snapshots of the last events
+// of every event pool bin in memory, so that the mixing partners
+// are taken from memory instead of being read again from the input tree
+//
+
+#ifndef ALIMIXSNAPSHOTPOOL_H
+#define ALIMIXSNAPSHOTPOOL_H
+
+#include <vector>
+
+#include <TNamed.h>
+#include <TArrayI.h>
+
+class TObjArray;
+class AliVEvent;
+class AliVParticle;
+class AliMixSnapshotPool : public TNamed {
+public:
+   enum EColumn_t { kPt = 0, kEta = 1, kPhi = 2, kCharge = 3, kPx = 4, kPy = 5, kPz = 6, kE = 7, kM = 8, kY = 9,
+                    kLabel = 10, kNumColumns = 11
+                  };
+
+   AliMixSnapshotPool(const char *name = "mixSnapshotPool", const char *title = "Mix snapshot pool");
+   AliMixSnapshotPool(const AliMixSnapshotPool &obj);
+   AliMixSnapshotPool &operator= (const AliMixSnapshotPool &obj);
+   virtual ~AliMixSnapshotPool();
+
+   // prints object info
+   virtual void      Print(const Option_t *option = "") const;
+
+   // configuration (columns are stored per track in the order they were added, default pt, eta, phi, charge)
+   void        AddColumn(EColumn_t column);
+   void        SetMaxEventsPerBin(Int_t maxEvents) { fMaxEventsPerBin = maxEvents; }
+   void        SetMaxTracksPerBin(Int_t maxTracks) { fMaxTracksPerBin = maxTracks; }
+   void        SetMaxMemory(Long64_t maxBytes) { fMaxMemory = maxBytes; }
+   void        SetTrackCuts(Double_t ptMin, Double_t ptMax, Double_t etaMax) { fPtMin = ptMin; fPtMax = ptMax; fEtaMax = etaMax; }
+
+   Int_t       GetNumberOfColumns() const { return fColumns.GetSize(); }
+   Int_t       GetColumnIndex(EColumn_t column) const;
+   Int_t       GetMaxEventsPerBin() const { return fMaxEventsPerBin; }
+   Int_t       GetMaxTracksPerBin() const { return fMaxTracksPerBin; }
+   Long64_t    GetMaxMemory() const { return fMaxMemory; }
+
+   // filling, bin is the index of the event pool bin (idEntryList), returns number of evicted events
+   Int_t       AddEvent(Int_t bin, AliVEvent *ev, Long64_t entry);
+   Int_t       AddEvent(Int_t bin, TObjArray *tracks, Long64_t entry);
+   void        Clear(Option_t *option = "");
+
+   // access to stored events, iEvent = 0 is the most recent one
+   Int_t       GetNumberOfBins() const { return fData.size(); }
+   Int_t       GetNumberOfEvents(Int_t bin) const;
+   Int_t       GetNumberOfTracks(Int_t bin, Int_t iEvent) const;
+   // tracks of the event as flat array [iTrack*GetNumberOfColumns()+iColumn], valid until the next AddEvent
+   const Float_t *GetTracks(Int_t bin, Int_t iEvent) const;
+   Long64_t    GetEntry(Int_t bin, Int_t iEvent) const;
+
+   // statistics
+   Long64_t    GetMemory() const { return fMemory; }
+   Long64_t    GetNumberOfStored(Int_t bin) const { return (bin >= 0 && bin < (Int_t)fNStored.size()) ? fNStored[bin] : 0; }
+   Long64_t    GetNumberOfEvicted(Int_t bin) const { return (bin >= 0 && bin < (Int_t)fNEvicted.size()) ? fNEvicted[bin] : 0; }
+
+private:
+
+   void        PrepareBin(Int_t bin);
+   void        AddTrack(Int_t bin, AliVParticle *track);
+   Bool_t      AcceptTrack(AliVParticle *track) const;
+   Int_t       FinishEvent(Int_t bin, Long64_t entry);
+   void        EvictOldest(Int_t bin);
+   Long64_t    BinMemory(Int_t bin) const;
+
+   TArrayI     fColumns;               // stored columns (EColumn_t)
+   Int_t       fMaxEventsPerBin;       // maximum number of events kept per bin
+   Int_t       fMaxTracksPerBin;       // maximum number of tracks kept per bin (0 = no limit)
+   Long64_t    fMaxMemory;             // maximum memory of all bins in bytes (0 = no limit)
+   Double_t    fPtMin;                 // track cut pt min
+   Double_t    fPtMax;                 // track cut pt max (<=0 = no cut)
+   Double_t    fEtaMax;                // track cut |eta| max (<=0 = no cut)
+
+   // per bin ring buffer: the events are appended to a flat array, the oldest event is at fHead
+   std::vector<std::vector<Float_t> >  fData;        //! track columns of all events of the bin
+   std::vector<std::vector<Int_t> >    fEventBegin;  //! first track of each event in fData
+   std::vector<std::vector<Long64_t> > fEventEntry;  //! entry of each event
+   std::vector<Int_t>                  fHead;        //! index of the oldest kept event in fEventBegin
+   std::vector<Long64_t>               fNStored;     //! number of stored events per bin
+   std::vector<Long64_t>               fNEvicted;    //! number of evicted events per bin
+   Long64_t                            fMemory;      //! bytes used by the kept events
+
+   ClassDef(AliMixSnapshotPool, 1)
+};
+
+#endif
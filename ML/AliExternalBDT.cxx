@@ -13,10 +13,25 @@
 #include "AliExternalBDT.h"
 
 #include <cassert>
+#include <iomanip>
 #include <iostream>
+#include <limits>
+#include <sstream>
 #include <stdio.h>
 #include <stdlib.h>
 
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifndef TREELITE_ID
+#define TREELITE_ID "unknown"
+#endif
+#ifndef TREELITE_LIBDIR
+#define TREELITE_LIBDIR ""
+#endif
+
 namespace {
   inline bool checkFile (const std::string name) {
     FILE *file = fopen(name.c_str(), "r");
@@ -27,8 +42,68 @@ namespace {
       return false;
     }
   }
+
+  /// 64-bit FNV-1a, used to build the key of the compiled model cache
+  inline void hashBytes(const char *data, std::size_t size, unsigned long long &hash) {
+    for (std::size_t iByte = 0; iByte < size; ++iByte) {
+      hash ^= static_cast<unsigned char>(data[iByte]);
+      hash *= 1099511628211ull;
+    }
+  }
+
+  inline bool hashFile(const std::string &name, unsigned long long &hash) {
+    FILE *file = fopen(name.c_str(), "rb");
+    if (file == NULL)
+      return false;
+    char buffer[65536];
+    std::size_t nRead = 0;
+    while ((nRead = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+      hashBytes(buffer, nRead, hash);
+    }
+    fclose(file);
+    return true;
+  }
+
+  /// Files loaded from the cache must belong to the current user and must not be writable by anyone else,
+  /// otherwise another user could plant a library there
+  inline bool isPrivate(const std::string &name) {
+    struct stat info;
+    if (stat(name.c_str(), &info) != 0)
+      return false;
+    return info.st_uid == getuid() && (info.st_mode & (S_IWGRP | S_IWOTH)) == 0;
+  }
+
+  /// Identity of the Treelite runtime: the installation path does not change on an in-place upgrade,
+  /// so the size and modification time of its libraries are added
+  inline std::string treeliteIdentity() {
+    std::ostringstream id;
+    id << TREELITE_ID;
+    const std::string libDir{TREELITE_LIBDIR};
+    for (const char *lib : {"/libtreelite.so", "/libtreelite_runtime.so"}) {
+      struct stat info;
+      if (!libDir.empty() && stat((libDir + lib).c_str(), &info) == 0)
+        id << ";" << lib << ":" << info.st_size << ":" << info.st_mtime;
+    }
+    return id.str();
+  }
+
+  /// Identity of the compiler used for the model library, as reported by gcc --version
+  inline std::string compilerIdentity() {
+    std::string id;
+    FILE *pipe = popen("gcc --version 2>/dev/null", "r");
+    if (pipe == NULL)
+      return id;
+    char buffer[256];
+    while (fgets(buffer, sizeof(buffer), pipe) != NULL)
+      id += buffer;
+    pclose(pipe);
+    return id;
+  }
 }
 
+std::string AliExternalBDT::fgCacheDir{""};
+bool AliExternalBDT::fgCacheDirSet{false};
+
 AliExternalBDT::AliExternalBDT(std::string name) :
   fBDTname{name},
   fModel{},
@@ -37,7 +112,10 @@ AliExternalBDT::AliExternalBDT(std::string name) :
   fCompiler{},
   fPredictor{},
   fOutSize{0u},
-  fNumFeatures{0u}
+  fNumFeatures{0u},
+  fOptLevel{1},
+  fEntries{},
+  fOutput{}
 {
 }
 
@@ -48,14 +126,92 @@ bool AliExternalBDT::CompileAndLoadModelLibrary() {
     std::cout << "Library found: " << path.data() << "/main.so . Loading it!" << std::endl;
   } else {
     std::cout << "Starting the model compilation, depending on the model size it can take a while..." << std::endl;
-    system((std::string("gcc -c -O1 -fPIC ") + path + "/main.c -o " + path + "/main.o && gcc -shared " + path + \
-          "/main.o -o " + path + "/main.so").data());
+    system((std::string("gcc -c ") + GetCompilerFlags() + " " + path + "/main.c -o " + path + "/main.o && gcc -shared " + \
+          path + "/main.o -o " + path + "/main.so").data());
   }
   return LoadModelLibrary(path + "/main.so");
 }
 
-bool AliExternalBDT::CreateModelCode() {
-  std::string path = GetUniquePath();
+bool AliExternalBDT::CompileAndLoadCachedModelLibrary(const std::string &cacheDir, int type) {
+  unsigned long long hash = 14695981039346656037ull;
+  if (!hashFile(fModelPath, hash)) {
+    std::cerr << "Cannot read model file " << fModelPath << std::endl;
+    return false;
+  }
+  std::ostringstream keyInfo;
+  keyInfo << type << ";" << treeliteIdentity() << ";" << compilerIdentity() << ";" << GetCompilerFlags();
+  const std::string keyString = keyInfo.str();
+  hashBytes(keyString.data(), keyString.size(), hash);
+
+  std::ostringstream key;
+  key << std::hex << std::setw(16) << std::setfill('0') << hash;
+  const std::string base = cacheDir + "/" + key.str();
+  const std::string library = base + ".so";
+
+  /// the library is published with an atomic rename, so a visible file is always complete
+  if (checkFile(library)) {
+    if (!isPrivate(cacheDir) || !isPrivate(library)) {
+      std::cerr << "Compiled model " << library << " is not owned by the user or is writable by others, not loading it" << std::endl;
+      return false;
+    }
+    std::cout << "Compiled model found in cache: " << library << " . Loading it!" << std::endl;
+    return LoadModelLibrary(library);
+  }
+
+  mkdir(cacheDir.data(), 0700);
+  const int lockFile = isPrivate(cacheDir) ? open((base + ".lock").data(), O_CREAT | O_RDWR, 0600) : -1;
+  if (lockFile < 0) {
+    std::cerr << "Cannot create lock file in private directory " << cacheDir << ", compiling without cache" << std::endl;
+    if (!ParseModel(type) || !CreateModelCode(GetUniquePath())) return false;
+    return CompileAndLoadModelLibrary();
+  }
+  /// jobs on the same node wait here while the first one compiles the model
+  flock(lockFile, LOCK_EX);
+
+  bool compiled = checkFile(library);
+  if (!compiled) {
+    std::ostringstream workDir;
+    workDir << base << "_" << getpid() << "_" << (unsigned long)this;
+    mkdir(workDir.str().data(), 0700);
+    if (ParseModel(type) && CreateModelCode(workDir.str())) {
+      std::cout << "Starting the model compilation, depending on the model size it can take a while..." << std::endl;
+      const std::string tmpLibrary = workDir.str() + "/main.so";
+      system((std::string("gcc -c ") + GetCompilerFlags() + " " + workDir.str() + "/main.c -o " + workDir.str() + \
+            "/main.o && gcc -shared " + workDir.str() + "/main.o -o " + tmpLibrary).data());
+      compiled = checkFile(tmpLibrary) && rename(tmpLibrary.data(), library.data()) == 0;
+    }
+    system((std::string("rm -rf ") + workDir.str()).data());
+  }
+
+  flock(lockFile, LOCK_UN);
+  close(lockFile);
+
+  if (!compiled) {
+    std::cerr << "Model compilation failed" << std::endl;
+    return false;
+  }
+  if (!isPrivate(library)) {
+    std::cerr << "Compiled model " << library << " is not owned by the user or is writable by others, not loading it" << std::endl;
+    return false;
+  }
+  return LoadModelLibrary(library);
+}
+
+std::string AliExternalBDT::GetCacheDirectory() {
+  if (fgCacheDirSet)
+    return fgCacheDir;
+  const char *env = getenv("ALIEXTERNALBDT_CACHE");
+  if (env)
+    return std::string(env);
+  const char *tmp = getenv("TMPDIR");
+  return std::string((tmp && *tmp) ? tmp : "/tmp") + "/AliExternalBDT_cache_" + std::to_string(getuid());
+}
+
+std::string AliExternalBDT::GetCompilerFlags() const {
+  return std::string("-O") + std::to_string(fOptLevel) + " -fPIC";
+}
+
+bool AliExternalBDT::CreateModelCode(const std::string &path) {
   if (checkFile(path + "/main.c")) {
     std::cout << "Code found: " << path.data() << "/main.c . \
       Remove it or unset/change the AliExternalBDT name to force its regeneration." << std::endl;
@@ -96,6 +252,17 @@ bool AliExternalBDT::LoadModel(const std::string &path, int type) {
 
   fModelPath = path;
   fModelName = fModelPath.substr(fModelPath.find_last_of("\\/")+1,fModelPath.size());
+
+  const std::string cacheDir = GetCacheDirectory();
+  if (!cacheDir.empty()) return CompileAndLoadCachedModelLibrary(cacheDir, type);
+
+  if (!ParseModel(type)) return false;
+  if (!CreateModelCode(GetUniquePath())) return false;
+  if (!CompileAndLoadModelLibrary()) return false;
+  return true;
+}
+
+bool AliExternalBDT::ParseModel(int type) {
   int status = 0;
   switch (type) {
     case 0:
@@ -112,8 +279,6 @@ bool AliExternalBDT::LoadModel(const std::string &path, int type) {
     std::cerr << "Model loading failed" << std::endl;
     return false;
   }
-  if (!CreateModelCode()) return false;
-  if (!CompileAndLoadModelLibrary()) return false;
   return true;
 }
 
@@ -140,22 +305,41 @@ bool AliExternalBDT::LoadModelLibrary(std::string path) {
   return true;
 }
 
-bool AliExternalBDT::Predict(double *features, int size, std::vector<double> &outputScores, bool useRawScore) {
-  std::vector<TreelitePredictorEntry> entries(size);
-  for (std::size_t iEntry = 0; iEntry < entries.size(); ++iEntry) {
-    entries[iEntry].fvalue = static_cast<float>(features[iEntry]);
+bool AliExternalBDT::Predict(const double *features, int size, std::vector<double> &outputScores, bool useRawScore) {
+  fEntries.resize(size);
+  for (std::size_t iEntry = 0; iEntry < fEntries.size(); ++iEntry) {
+    fEntries[iEntry].fvalue = static_cast<float>(features[iEntry]);
   }
 
-  std::vector<float> output(fOutSize);
-  int predict = TreelitePredictorPredictInst(fPredictor, entries.data(),
-      static_cast<int>(useRawScore), &output[0],
-      &fOutSize);
+  fOutput.resize(fOutSize);
+  std::size_t outSize = fOutSize;
+  int predict = TreelitePredictorPredictInst(fPredictor, fEntries.data(),
+      static_cast<int>(useRawScore), &fOutput[0],
+      &outSize);
   if(predict<0)
     return false;
 
-  for (std::size_t iEntry = 0; iEntry < fOutSize; ++iEntry) {
-    outputScores.push_back(static_cast<double>(output[iEntry]));
+  for (std::size_t iEntry = 0; iEntry < outSize; ++iEntry) {
+    outputScores.push_back(static_cast<double>(fOutput[iEntry]));
   }
 
   return true;
 }
+
+bool AliExternalBDT::PredictBatch(const float *features, std::size_t nRows, float *outputScores, bool useRawScore) {
+  if (nRows == 0u)
+    return true;
+
+  DenseBatchHandle batch;
+  if (TreeliteAssembleDenseBatch(features, std::numeric_limits<float>::quiet_NaN(), nRows, fNumFeatures, &batch) != 0) {
+    std::cerr << "Batch assembly failed" << std::endl;
+    return false;
+  }
+
+  std::size_t outSize = nRows * fOutSize;
+  const int predict = TreelitePredictorPredictBatch(fPredictor, batch, 0, 0, static_cast<int>(useRawScore),
+      outputScores, &outSize);
+  TreeliteDeleteDenseBatch(batch);
+
+  return predict >= 0 && outSize == nRows * fOutSize;
+}
@@ -29,16 +29,34 @@ public:
   bool LoadModelLibrary(std::string path);
   bool LoadXGBoostModel(std::string path);
 
-  bool Predict(double *features, int size, std::vector<double> &outputScores, bool useRaw = false);
+  bool Predict(const double *features, int size, std::vector<double> &outputScores, bool useRaw = false);
+  /// Score nRows candidates stored row-major in features (nRows x GetNumberOfFeatures()) with a single
+  /// Treelite batch call. outputScores is owned by the caller and must hold nRows x GetOutputSize() values.
+  bool PredictBatch(const float *features, std::size_t nRows, float *outputScores, bool useRaw = false);
 
   std::size_t GetOutputSize() const {return fOutSize;}
   std::size_t GetNumberOfFeatures() const {return fNumFeatures;}
 
+  /// Optimisation level used to compile the model library (default -O1)
+  void SetOptimizationLevel(int level) {fOptLevel = level;}
+  int GetOptimizationLevel() const {return fOptLevel;}
+
+  /// Compiled libraries are shared through a content-addressed cache directory, keyed by the hash of the
+  /// model file, the Treelite installation, the compiler and its flags. The default directory is
+  /// $ALIEXTERNALBDT_CACHE or the per-user $TMPDIR/AliExternalBDT_cache_<uid> (created with mode 0700);
+  /// cached libraries not owned by the user or writable by others are never loaded. An empty string
+  /// disables the cache.
+  static void SetCacheDirectory(std::string dir) {fgCacheDir = dir; fgCacheDirSet = true;}
+  static std::string GetCacheDirectory();
+
 private:
   bool CompileAndLoadModelLibrary();
-  bool CreateModelCode();
+  bool CompileAndLoadCachedModelLibrary(const std::string &cacheDir, int type);
+  std::string GetCompilerFlags() const;
+  bool CreateModelCode(const std::string &path);
   std::string GetUniquePath();
   bool LoadModel(const std::string &path, int type);
+  bool ParseModel(int type);
 
   std::string fBDTname;       /// Unique name of this external BDT handler
   ModelHandle fModel;
@@ -48,6 +66,13 @@ private:
   PredictorHandle fPredictor;
   std::size_t fOutSize;
   std::size_t fNumFeatures;
+  int fOptLevel;                                /// optimisation level of the compiled model library
+
+  std::vector<TreelitePredictorEntry> fEntries; /// buffer reused by Predict to avoid per-call allocations
+  std::vector<float> fOutput;                   /// buffer reused by Predict to avoid per-call allocations
+
+  static std::string fgCacheDir;                /// cache directory for the compiled model libraries
+  static bool fgCacheDirSet;                    /// whether the cache directory was set by the user
 };
 
 #endif
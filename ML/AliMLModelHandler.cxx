@@ -27,7 +27,7 @@ ClassImp(AliMLModelHandler);
 /// \endcond
 
 //_______________________________________________________________________________
-AliMLModelHandler::AliMLModelHandler() : TNamed(), fModel{nullptr}, fPath{}, fLibrary{}, fScoreCut{}, fScoreCutOpt{} {
+AliMLModelHandler::AliMLModelHandler() : TNamed(), fModel{nullptr}, fPath{}, fLibrary{}, fLocalPath{}, fScoreCut{}, fScoreCutOpt{} {
   //
   // Default constructor
   //
@@ -36,7 +36,7 @@ AliMLModelHandler::AliMLModelHandler() : TNamed(), fModel{nullptr}, fPath{}, fLi
 //_______________________________________________________________________________
 AliMLModelHandler::AliMLModelHandler(const YAML::Node &node)
     : TNamed(), fModel{nullptr}, fPath{node["path"].as<std::string>()},
-      fLibrary{node["library"].as<std::string>()}, fScoreCut{}, fScoreCutOpt{} {
+      fLibrary{node["library"].as<std::string>()}, fLocalPath{}, fScoreCut{}, fScoreCutOpt{} {
   //
   // Standard constructor
   //
@@ -86,7 +86,7 @@ AliMLModelHandler::~AliMLModelHandler() {
 //_______________________________________________________________________________
 AliMLModelHandler::AliMLModelHandler(const AliMLModelHandler &source)
     : TNamed(source.GetName(), source.GetTitle()), fModel{nullptr}, fPath{source.fPath},
-      fLibrary{source.fLibrary}, fScoreCut{source.fScoreCut}, fScoreCutOpt{source.fScoreCutOpt} {
+      fLibrary{source.fLibrary}, fLocalPath{source.fLocalPath}, fScoreCut{source.fScoreCut}, fScoreCutOpt{source.fScoreCutOpt} {
   //
   // Copy constructor
   //
@@ -107,6 +107,7 @@ AliMLModelHandler &AliMLModelHandler::operator=(const AliMLModelHandler &source)
 
   fPath        = source.fPath;
   fLibrary     = source.fLibrary;
+  fLocalPath   = source.fLocalPath;
   fScoreCut    = source.fScoreCut;
   fScoreCutOpt = source.fScoreCutOpt;
 
@@ -115,12 +116,23 @@ AliMLModelHandler &AliMLModelHandler::operator=(const AliMLModelHandler &source)
 
 //_______________________________________________________________________________
 bool AliMLModelHandler::CompileModel() {
+  ImportModel();
+  return LoadModel();
+}
+
+//_______________________________________________________________________________
+void AliMLModelHandler::ImportModel() {
+  fLocalPath = ImportFile(fPath);
+}
+
+//_______________________________________________________________________________
+bool AliMLModelHandler::LoadModel() {
 
   std::map<std::string, int> libraryMap = {{"kXGBoost", AliMLModelHandler::kXGBoost}, 
                                            {"kLightGBM", AliMLModelHandler::kLightGBM},
                                            {"kModelLibrary", AliMLModelHandler::kModelLibrary}};
 
-  std::string localpath = ImportFile(fPath);
+  const std::string &localpath = fLocalPath;
 
   switch (libraryMap[GetLibrary()]) {
     case kXGBoost: {
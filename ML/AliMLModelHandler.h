@@ -42,6 +42,9 @@ public:
   std::vector<int> const &GetScoreCutOpt() const { return fScoreCutOpt; }
 
   bool CompileModel();
+  /// the two steps of CompileModel: import the model file (ROOT I/O, not thread safe) and compile/load it
+  void ImportModel();
+  bool LoadModel();
   static std::string ImportFile(std::string path);
 
 private:
@@ -49,6 +52,7 @@ private:
 
   std::string fPath;                 ///
   std::string fLibrary;              ///
+  std::string fLocalPath;            //!<! local path of the imported model file
 
   std::vector<double> fScoreCut;     /// vector of cuts to be applied on output scores
   std::vector<int> fScoreCutOpt;     /// vector of options on output scores ("upper" or "lower")
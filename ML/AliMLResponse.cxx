@@ -12,6 +12,10 @@
 
 #include "AliMLResponse.h"
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
 #include "yaml-cpp/yaml.h"
 
 #include "AliExternalBDT.h"
@@ -29,7 +33,7 @@ ClassImp(AliMLResponse);
 //_______________________________________________________________________________
 AliMLResponse::AliMLResponse()
     : TNamed(), fConfigFilePath{}, fModels{}, fCentClasses{}, fBins{}, fVariableNames{}, fNBins{}, fNVariables{},
-      fBinsBegin{}, fRaw{} {
+      fBinsBegin{}, fRaw{}, fVariableIndex{}, fFeatures{}, fScores{}, fBatchFeatures{}, fBatchIndices{}, fBatchScores{} {
   //
   // Default constructor
   //
@@ -38,7 +42,8 @@ AliMLResponse::AliMLResponse()
 //_______________________________________________________________________________
 AliMLResponse::AliMLResponse(const Char_t *name, const Char_t *title)
     : TNamed(name, title), fConfigFilePath{""}, fModels{}, fCentClasses{}, fBins{}, fVariableNames{}, fNBins{},
-      fNVariables{}, fBinsBegin{}, fRaw{} {
+      fNVariables{}, fBinsBegin{}, fRaw{}, fVariableIndex{}, fFeatures{}, fScores{}, fBatchFeatures{}, fBatchIndices{},
+      fBatchScores{} {
   //
   // Standard constructor
   //
@@ -55,7 +60,8 @@ AliMLResponse::~AliMLResponse() {
 AliMLResponse::AliMLResponse(const AliMLResponse &source)
     : TNamed(source.GetName(), source.GetTitle()), fConfigFilePath{source.fConfigFilePath}, fModels{source.fModels},
       fCentClasses{source.fCentClasses}, fBins{source.fBins}, fVariableNames{source.fVariableNames},
-      fNBins{source.fNBins}, fNVariables{source.fNVariables}, fBinsBegin{source.fBinsBegin}, fRaw{source.fRaw} {
+      fNBins{source.fNBins}, fNVariables{source.fNVariables}, fBinsBegin{source.fBinsBegin}, fRaw{source.fRaw},
+      fVariableIndex{source.fVariableIndex}, fFeatures{}, fScores{}, fBatchFeatures{}, fBatchIndices{}, fBatchScores{} {
   //
   // Copy constructor
   //
@@ -78,6 +84,7 @@ AliMLResponse &AliMLResponse::operator=(const AliMLResponse &source) {
   fNVariables     = source.fNVariables;
   fBinsBegin      = source.fBinsBegin;
   fRaw            = source.fRaw;
+  fVariableIndex  = source.fVariableIndex;
 
   return *this;
 }
@@ -120,13 +127,47 @@ void AliMLResponse::CompileModels(std::string configLocalPath) {
 
   fBinsBegin = fBins.begin();
 
+  /// resolve the name-to-column lookup once, the per-candidate methods only use indices afterwards
+  fVariableIndex.clear();
+  for (int iVar = 0; iVar < (int)fVariableNames.size(); ++iVar) {
+    fVariableIndex[fVariableNames[iVar]] = iVar;
+  }
+  fFeatures.resize(fNVariables);
+  fBatchFeatures.resize(fNBins);
+  fBatchIndices.resize(fNBins);
+
   for (const auto &model : nodeList["MODELS"]) {
     fModels.push_back(AliMLModelHandler{model});
   }
 
+  /// optional optimisation level of the compiled model libraries (default -O1)
+  const int optLevel = nodeList["COMPILER_OPT_LEVEL"] ? nodeList["COMPILER_OPT_LEVEL"].as<int>() : 1;
+
+  /// the files are imported serially (ROOT I/O), then the models are compiled in parallel
   for (auto &model : fModels) {
-    bool comp = model.CompileModel();
-    if (!comp) {
+    model.GetModel()->SetOptimizationLevel(optLevel);
+    model.ImportModel();
+  }
+
+  const std::size_t nModels = fModels.size();
+  const std::size_t nThreads = std::max(1u, std::min((unsigned int)nModels, std::thread::hardware_concurrency()));
+  std::vector<char> compiled(nModels, 0);
+  std::atomic<std::size_t> nextModel{0};
+  std::vector<std::thread> workers;
+  for (std::size_t iThread = 0; iThread < nThreads; ++iThread) {
+    workers.emplace_back([&]() {
+      for (std::size_t iModel = nextModel++; iModel < nModels; iModel = nextModel++) {
+        compiled[iModel] = fModels[iModel].LoadModel();
+      }
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+
+  for (std::size_t iModel = 0; iModel < nModels; ++iModel) {
+    auto &model = fModels[iModel];
+    if (!compiled[iModel]) {
       AliFatal("Error in model compilation! Exit");
     }
     if(model.GetModel()->GetOutputSize() != model.GetScoreCut().size()) {
@@ -157,33 +198,50 @@ int AliMLResponse::FindBin(double binvar) {
 }
 
 //_______________________________________________________________________________
-double AliMLResponse::Predict(double binvar, map<string, double> varmap) {
+int AliMLResponse::GetVariableIndex(const string &varname) const {
+  auto it = fVariableIndex.find(varname);
+  return it == fVariableIndex.end() ? -1 : it->second;
+}
+
+//_______________________________________________________________________________
+std::size_t AliMLResponse::GetOutputSize(int bin) {
+  return fModels.at(bin - 1).GetModel()->GetOutputSize();
+}
+
+//_______________________________________________________________________________
+void AliMLResponse::FillFeatures(const map<string, double> &varmap) {
+  fFeatures.resize(fNVariables);
+  for (const auto &var : fVariableIndex) {
+    auto it = varmap.find(var.first);
+    if (it == varmap.end()) {
+      AliFatal(Form("Variable |%s| not found in variable list provided in config! Exit", var.first.data()));
+    }
+    fFeatures[var.second] = it->second;
+  }
+}
+
+//_______________________________________________________________________________
+double AliMLResponse::Predict(double binvar, const map<string, double> &varmap) {
   if ((int)varmap.size() < fNVariables) {
     AliFatal("The variable map you provided to the predictor has a size smaller than the variable list size! Exit");
   }
 
-  vector<double> features;
-  for (const auto &varname : fVariableNames) {
-    if (varmap.find(varname) == varmap.end()) {
-      AliFatal(Form("Variable |%s| not found in variable list provided in config! Exit", varname.data()));
-    }
-    features.push_back(varmap[varname]);
-  }
+  FillFeatures(varmap);
 
   int bin = FindBin(binvar);
   if (bin < 0)
     return -999.;
 
-  vector<double> scores;
-  bool predict = fModels.at(bin - 1).GetModel()->Predict(&features[0], fNVariables, scores, fRaw);
+  fScores.clear();
+  bool predict = fModels.at(bin - 1).GetModel()->Predict(&fFeatures[0], fNVariables, fScores, fRaw);
   if(!predict)
     return -999.;
 
-  return scores[0];
+  return fScores[0];
 }
 
 //_______________________________________________________________________________
-double AliMLResponse::Predict(double binvar, vector<double> variables) {
+double AliMLResponse::Predict(double binvar, const vector<double> &variables) {
   if ((int)variables.size() != fNVariables) {
     AliFatal(Form("Number of variables passed (%d) different from the one used in the model (%d)! Exit",
                   (int)variables.size(), fNVariables));
@@ -193,37 +251,31 @@ double AliMLResponse::Predict(double binvar, vector<double> variables) {
   if (bin < 0)
     return -999.;
 
-  vector<double> scores;
-  bool predict = fModels.at(bin - 1).GetModel()->Predict(&variables[0], fNVariables, scores, fRaw);
+  fScores.clear();
+  bool predict = fModels.at(bin - 1).GetModel()->Predict(&variables[0], fNVariables, fScores, fRaw);
   if(!predict)
     return -999.;
 
-  return scores[0];
+  return fScores[0];
 }
 
 //_______________________________________________________________________________
-bool AliMLResponse::PredictMultiClass(double binvar, map<string, double> varmap, vector<double> &outScores) {
+bool AliMLResponse::PredictMultiClass(double binvar, const map<string, double> &varmap, vector<double> &outScores) {
   if ((int)varmap.size() < fNVariables) {
     AliFatal("The variable map you provided to the predictor has a size smaller than the variable list size! Exit");
   }
 
-  vector<double> features;
-  for (const auto &varname : fVariableNames) {
-    if (varmap.find(varname) == varmap.end()) {
-      AliFatal(Form("Variable |%s| not found in variable list provided in config! Exit", varname.data()));
-    }
-    features.push_back(varmap[varname]);
-  }
+  FillFeatures(varmap);
 
   int bin = FindBin(binvar);
   if (bin < 0)
     return false;
 
-  return fModels.at(bin - 1).GetModel()->Predict(&features[0], fNVariables, outScores, fRaw);
+  return fModels.at(bin - 1).GetModel()->Predict(&fFeatures[0], fNVariables, outScores, fRaw);
 }
 
 //_______________________________________________________________________________
-bool AliMLResponse::PredictMultiClass(double binvar, vector<double> variables, vector<double> &outScores) {
+bool AliMLResponse::PredictMultiClass(double binvar, const vector<double> &variables, vector<double> &outScores) {
   if ((int)variables.size() != fNVariables) {
     AliFatal(Form("Number of variables passed (%d) different from the one used in the model (%d)! Exit",
                   (int)variables.size(), fNVariables));
@@ -237,25 +289,90 @@ bool AliMLResponse::PredictMultiClass(double binvar, vector<double> variables, v
 }
 
 //_______________________________________________________________________________
-bool AliMLResponse::IsSelected(double binvar, map<std::string, double> varmap) {
+bool AliMLResponse::IsSelected(double binvar, const map<std::string, double> &varmap) {
   double score{0.};
   return IsSelected(binvar, varmap, score);
 }
 
 //_______________________________________________________________________________
-bool AliMLResponse::IsSelected(double binvar, vector<double> variables) {
+bool AliMLResponse::IsSelected(double binvar, const vector<double> &variables) {
   double score{0.};
   return IsSelected(binvar, variables, score);
 }
 
 //_______________________________________________________________________________
-bool AliMLResponse::IsSelectedMultiClass(double binvar, map<std::string, double> varmap) {
+bool AliMLResponse::IsSelectedMultiClass(double binvar, const map<std::string, double> &varmap) {
   vector<double> score;
   return IsSelectedMultiClass(binvar, varmap, score);
 }
 
 //_______________________________________________________________________________
-bool AliMLResponse::IsSelectedMultiClass(double binvar, vector<double> variables) {
+bool AliMLResponse::IsSelectedMultiClass(double binvar, const vector<double> &variables) {
   vector<double> score;
   return IsSelectedMultiClass(binvar, variables, score);
-}
\ No newline at end of file
+}
+
+//_______________________________________________________________________________
+bool AliMLResponse::PredictBinBatch(int bin, const float *features, std::size_t nCandidates, float *scores) {
+  if (bin <= 0 || bin >= fNBins) {
+    AliWarning("Bin outside range, no model available!");
+    return false;
+  }
+  return fModels.at(bin - 1).GetModel()->PredictBatch(features, nCandidates, scores, fRaw);
+}
+
+//_______________________________________________________________________________
+bool AliMLResponse::PredictBatch(const double *binvars, const float *features, std::size_t nCandidates, float *scores) {
+  if (fBatchFeatures.size() != (std::size_t)fNBins) {
+    fBatchFeatures.resize(fNBins);
+    fBatchIndices.resize(fNBins);
+  }
+  for (int iBin = 1; iBin < fNBins; ++iBin) {
+    fBatchFeatures[iBin].clear();
+    fBatchIndices[iBin].clear();
+  }
+
+  /// group the candidates per bin, the buffers keep their capacity between calls
+  for (std::size_t iCand = 0; iCand < nCandidates; ++iCand) {
+    scores[iCand] = -999.;
+    int bin = FindBin(binvars[iCand]);
+    if (bin < 0)
+      continue;
+    const float *row = features + iCand * fNVariables;
+    fBatchFeatures[bin].insert(fBatchFeatures[bin].end(), row, row + fNVariables);
+    fBatchIndices[bin].push_back(iCand);
+  }
+
+  bool allPredicted = true;
+  for (int iBin = 1; iBin < fNBins; ++iBin) {
+    const std::size_t nInBin = fBatchIndices[iBin].size();
+    if (nInBin == 0u)
+      continue;
+    const std::size_t outSize = GetOutputSize(iBin);
+    fBatchScores.resize(nInBin * outSize);
+    if (!PredictBinBatch(iBin, fBatchFeatures[iBin].data(), nInBin, fBatchScores.data())) {
+      allPredicted = false;
+      continue;
+    }
+    for (std::size_t iCand = 0; iCand < nInBin; ++iCand) {
+      scores[fBatchIndices[iBin][iCand]] = fBatchScores[iCand * outSize];
+    }
+  }
+
+  return allPredicted;
+}
+
+//_______________________________________________________________________________
+bool AliMLResponse::IsSelectedBatch(const double *binvars, const float *features, std::size_t nCandidates,
+                                    float *scores, bool *selected) {
+  bool predict = PredictBatch(binvars, features, nCandidates, scores);
+  for (std::size_t iCand = 0; iCand < nCandidates; ++iCand) {
+    selected[iCand] = false;
+    if (scores[iCand] == -999.)
+      continue;
+    /// bin is found again here instead of stored, FindBin is a binary search over a handful of edges
+    int bin = FindBin(binvars[iCand]);
+    selected[iCand] = scores[iCand] >= fModels.at(bin - 1).GetScoreCut()[0];
+  }
+  return predict;
+}
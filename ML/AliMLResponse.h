@@ -49,29 +49,46 @@ public:
   /// return the bin index
   int FindBin(double binvar);
   /// return the ML model predicted score (raw or proba, depending on useraw)
-  double Predict(double binvar, std::map<std::string, double> varmap);
+  double Predict(double binvar, const std::map<std::string, double> &varmap);
   /// overload to pass directly a vector of variables
-  double Predict(double binvar, std::vector<double> variables);
+  double Predict(double binvar, const std::vector<double> &variables);
   /// return true if predicted score for map is above the threshold given in the config
-  bool IsSelected(double binvar, std::map<std::string, double> varmap);
+  bool IsSelected(double binvar, const std::map<std::string, double> &varmap);
   /// overload for getting the model score too
-  template <typename F> bool IsSelected(double binvar, std::map<std::string, double> varmap, F &score);
+  template <typename F> bool IsSelected(double binvar, const std::map<std::string, double> &varmap, F &score);
   /// overload to pass directly a vector of variables
-  bool IsSelected(double binvar, std::vector<double> variables);
+  bool IsSelected(double binvar, const std::vector<double> &variables);
   /// overload for getting the model score too
-  template <typename F> bool IsSelected(double binvar, std::vector<double> variables, F &score);
+  template <typename F> bool IsSelected(double binvar, const std::vector<double> &variables, F &score);
   /// return the ML model predicted scores (raw or proba, depending on useraw)
-  bool PredictMultiClass(double binvar, std::map<std::string, double> varmap, std::vector<double> &outScores);
+  bool PredictMultiClass(double binvar, const std::map<std::string, double> &varmap, std::vector<double> &outScores);
   /// overload to pass directly a vector of variables
-  bool PredictMultiClass(double binvar, std::vector<double> variables, std::vector<double> &outScores);
+  bool PredictMultiClass(double binvar, const std::vector<double> &variables, std::vector<double> &outScores);
   /// return true if predicted score for map is above the threshold given in the config
-  bool IsSelectedMultiClass(double binvar, std::map<std::string, double> varmap);
+  bool IsSelectedMultiClass(double binvar, const std::map<std::string, double> &varmap);
   /// overload for getting the model score too
-  template <typename F> bool IsSelectedMultiClass(double binvar, std::map<std::string, double> varmap, std::vector<F> &outScores);
+  template <typename F> bool IsSelectedMultiClass(double binvar, const std::map<std::string, double> &varmap, std::vector<F> &outScores);
   /// overload to pass directly a vector of variables
-  bool IsSelectedMultiClass(double binvar, std::vector<double> variables);
+  bool IsSelectedMultiClass(double binvar, const std::vector<double> &variables);
   /// overload for getting the model score too
-  template <typename F> bool IsSelectedMultiClass(double binvar, std::vector<double> variables, std::vector<F> &outScores);
+  template <typename F> bool IsSelectedMultiClass(double binvar, const std::vector<double> &variables, std::vector<F> &outScores);
+
+  /// return the column of a variable in the feature matrix (resolved once in CompileModels), -1 if not used
+  int GetVariableIndex(const std::string &varname) const;
+  /// return the number of variables (columns of the feature matrix)
+  int GetNVariables() const { return fNVariables; }
+  /// return the number of output scores of the model of a given bin
+  std::size_t GetOutputSize(int bin);
+  /// score nCandidates rows of a row-major float feature matrix that all fall in the same bin with one
+  /// Treelite batch call. scores is caller-owned and must hold nCandidates x GetOutputSize(bin) values
+  bool PredictBinBatch(int bin, const float *features, std::size_t nCandidates, float *scores);
+  /// score nCandidates rows of a row-major float feature matrix, grouping them per bin of binvars so
+  /// that each bin is evaluated with one batch call. scores is caller-owned and holds the first output
+  /// score of each candidate (-999 for candidates outside the binning)
+  bool PredictBatch(const double *binvars, const float *features, std::size_t nCandidates, float *scores);
+  /// as PredictBatch, additionally filling the caller-owned selected array with the single-class decision
+  bool IsSelectedBatch(const double *binvars, const float *features, std::size_t nCandidates, float *scores,
+                       bool *selected);
 
 protected:
   std::string fConfigFilePath;    /// path of the config file
@@ -88,12 +105,22 @@ protected:
 
   bool fRaw;    /// set to true to use raw score instead of probability
 
+  std::map<std::string, int> fVariableIndex;            //!<! column of each variable in the feature matrix
+  std::vector<double> fFeatures;                        //!<! feature buffer reused by the map-based methods
+  std::vector<double> fScores;                          //!<! score buffer reused by the single-class methods
+  std::vector<std::vector<float> > fBatchFeatures;      //!<! per-bin feature matrices reused by PredictBatch
+  std::vector<std::vector<std::size_t> > fBatchIndices; //!<! per-bin candidate indices reused by PredictBatch
+  std::vector<float> fBatchScores;                      //!<! per-bin output buffer reused by PredictBatch
+
+  /// fill fFeatures from a variable map following the order of fVariableNames
+  void FillFeatures(const std::map<std::string, double> &varmap);
+
   /// \cond CLASSIMP
-  ClassDef(AliMLResponse, 2);    ///
+  ClassDef(AliMLResponse, 3);    ///
   /// \endcond
 };
 
-template <typename F> bool AliMLResponse::IsSelected(double binvar, std::map<std::string, double> varmap, F &score) {
+template <typename F> bool AliMLResponse::IsSelected(double binvar, const std::map<std::string, double> &varmap, F &score) {
   int bin = FindBin(binvar);
   if (bin < 0)
     return false;
@@ -101,7 +128,7 @@ template <typename F> bool AliMLResponse::IsSelected(double binvar, std::map<std
   return score >= fModels.at(bin - 1).GetScoreCut()[0];
 }
 
-template <typename F> bool AliMLResponse::IsSelected(double binvar, std::vector<double> variables, F &score) {
+template <typename F> bool AliMLResponse::IsSelected(double binvar, const std::vector<double> &variables, F &score) {
   int bin = FindBin(binvar);
   if (bin < 0)
     return false;
@@ -109,7 +136,7 @@ template <typename F> bool AliMLResponse::IsSelected(double binvar, std::vector<
   return score >= fModels.at(bin - 1).GetScoreCut()[0];
 }
 
-template <typename F> bool AliMLResponse::IsSelectedMultiClass(double binvar, std::map<std::string, double> varmap, std::vector<F> &outScores) {
+template <typename F> bool AliMLResponse::IsSelectedMultiClass(double binvar, const std::map<std::string, double> &varmap, std::vector<F> &outScores) {
   int bin = FindBin(binvar);
   if (bin < 0)
     return false;
@@ -128,7 +155,7 @@ template <typename F> bool AliMLResponse::IsSelectedMultiClass(double binvar, st
   return true;
 }
 
-template <typename F> bool AliMLResponse::IsSelectedMultiClass(double binvar, std::vector<double> variables, std::vector<F> &outScores) {
+template <typename F> bool AliMLResponse::IsSelectedMultiClass(double binvar, const std::vector<double> &variables, std::vector<F> &outScores) {
   int bin = FindBin(binvar);
   if (bin < 0)
     return false;
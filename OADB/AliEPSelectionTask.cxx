@@ -104,7 +104,12 @@ AliAnalysisTaskSE(),
   fHOutNTEPRes(0),
   fHOutPTPsi(0),
   fHOutDiff(0),
-  fHOutleadPTPsi(0)
+  fHOutleadPTPsi(0),
+  fTrackPhi(),
+  fTrackWeight(),
+  fTrackPhiWeight(),
+  fTrackSub(),
+  fTrackID()
 {
   // Default constructor
   AliInfo("Event Plane Selection enabled.");
@@ -114,6 +119,12 @@ AliAnalysisTaskSE(),
   for(Int_t i = 0; i < 2; ++i) {
      fQDist[i] = 0;
   }
+  for(Int_t i = 0; i < 3; ++i) {
+    for(Int_t n = 0; n < kNHarmonics; ++n) {
+      fQnX[i][n] = 0;
+      fQnY[i][n] = 0;
+    }
+  }
 }
 
 //________________________________________________________________________
@@ -155,7 +166,12 @@ AliEPSelectionTask::AliEPSelectionTask(const char *name):
   fHOutNTEPRes(0),
   fHOutPTPsi(0),
   fHOutDiff(0),
-  fHOutleadPTPsi(0)
+  fHOutleadPTPsi(0),
+  fTrackPhi(),
+  fTrackWeight(),
+  fTrackPhiWeight(),
+  fTrackSub(),
+  fTrackID()
 {
   // Default constructor
   AliInfo("Event Plane Selection enabled.");
@@ -166,6 +182,12 @@ AliEPSelectionTask::AliEPSelectionTask(const char *name):
   for(Int_t i = 0; i < 2; ++i) {
      fQDist[i] = 0;
   }
+  for(Int_t i = 0; i < 3; ++i) {
+    for(Int_t n = 0; n < kNHarmonics; ++n) {
+      fQnX[i][n] = 0;
+      fQnY[i][n] = 0;
+    }
+  }
 }
 
 //________________________________________________________________________
@@ -294,11 +316,11 @@ void AliEPSelectionTask::UserExec(Option_t */*option*/)
 
       if (nt>4){
 
-	// qvector full event
-	fQVector = new TVector2(GetQ(esdEP,tracklist));
+	// qvector full event and subevents in one pass over the tracks
+	TVector2 qq;
+	FillQvectors(tracklist, esdEP, &qq, &qq1, &qq2);
+	fQVector = new TVector2(qq);
 	fEventplaneQ = fQVector->Phi()/2;
-	// q vector subevents
-	GetQsub(qq1, qq2, tracklist, esdEP);
 	fQsub1 = new TVector2(qq1);
 	fQsub2 = new TVector2(qq2);
 	fQsubRes = (fQsub1->Phi()/2 - fQsub2->Phi()/2);
@@ -322,7 +344,7 @@ void AliEPSelectionTask::UserExec(Option_t */*option*/)
 	    while (delta > TMath::Pi()) delta -= TMath::Pi();
 	    fHOutPTPsi->Fill(track->Pt(),delta);
 	    fHOutPhi->Fill(track->Phi());
-	    fHOutPhiCorr->Fill(track->Phi(),GetPhiWeight(track));
+	    fHOutPhiCorr->Fill(track->Phi(),fTrackPhiWeight[iter]);
           }
 	}
 
@@ -388,11 +410,11 @@ void AliEPSelectionTask::UserExec(Option_t */*option*/)
 
       if (NT>4){
 
-	// qvector full event
-	fQVector = new TVector2(GetQ(esdEP,tracklist));
+	// qvector full event and subevents in one pass over the tracks
+	TVector2 qq;
+	FillQvectors(tracklist, esdEP, &qq, &qq1, &qq2);
+	fQVector = new TVector2(qq);
 	fEventplaneQ = fQVector->Phi()/2;
-	// q vector subevents
-	GetQsub(qq1, qq2, tracklist, esdEP);
 	fQsub1 = new TVector2(qq1);
 	fQsub2 = new TVector2(qq2);
 	fQsubRes = (fQsub1->Phi()/2 - fQsub2->Phi()/2);
@@ -416,7 +438,7 @@ void AliEPSelectionTask::UserExec(Option_t */*option*/)
 	    while (delta > TMath::Pi()) delta -= TMath::Pi();
 	    fHOutPTPsi->Fill(track->Pt(),delta);
 	    fHOutPhi->Fill(track->Phi());
-	    fHOutPhiCorr->Fill(track->Phi(),GetPhiWeight(track));
+	    fHOutPhiCorr->Fill(track->Phi(),fTrackPhiWeight[iter]);
 	  }
 	}
 
@@ -454,33 +476,7 @@ TVector2 AliEPSelectionTask::GetQ(AliEventplane* EP, TObjArray* tracklist)
 {
   // Get the Q vector
   TVector2 mQ;
-  float mQx=0, mQy=0;
-  AliVTrack* track;
-  Double_t weight;
-  Int_t idtemp = -1;
-  // get recentering values
-  Double_t mean[2], rms[2];
-  Recenter(0, mean);
-  Recenter(1, rms);
-
-  int nt = tracklist->GetEntries();
-
-  for (int i=0; i<nt; i++){
-    weight = 1;
-    track = dynamic_cast<AliVTrack*> (tracklist->At(i));
-    if (track) {
-      weight = GetWeight(track);
-    if (fSaveTrackContribution){
-      idtemp = track->GetID();
-      if ((fAnalysisInput.CompareTo("AOD")==0) && (fAODfilterbit == 128)) idtemp = idtemp*(-1) - 1;
-      EP->GetQContributionXArray()->AddAt(weight*cos(2*track->Phi())/rms[0],idtemp);
-      EP->GetQContributionYArray()->AddAt(weight*sin(2*track->Phi())/rms[1],idtemp);
-     }
-     mQx += (weight*cos(2*track->Phi())/rms[0]);
-     mQy += (weight*sin(2*track->Phi())/rms[1]);
-    }
-  }
-  mQ.Set(mQx-(mean[0]/rms[0]), mQy-(mean[1]/rms[1]));
+  FillQvectors(tracklist, EP, &mQ, 0, 0);
   return mQ;
 }
 
@@ -488,135 +484,166 @@ TVector2 AliEPSelectionTask::GetQ(AliEventplane* EP, TObjArray* tracklist)
 void AliEPSelectionTask::GetQsub(TVector2 &Q1, TVector2 &Q2, TObjArray* tracklist,AliEventplane* EP)
 {
   // Get Qsub
-  TVector2 mQ[2];
-  float mQx1=0, mQy1=0, mQx2=0, mQy2=0;
-  Double_t weight;
+  FillQvectors(tracklist, EP, 0, &Q1, &Q2);
+}
+
+//__________________________________________________________________________
+Bool_t AliEPSelectionTask::FillQvectors(TObjArray* tracklist, AliEventplane* EP, TVector2* Q, TVector2* Qsub1, TVector2* Qsub2)
+{
+  // Q vectors of the full event (Q) and of the subevents (Qsub1, Qsub2), those which are not 0 are filled.
+  // The tracks are read once into flat arrays (phi, weight, subevent), then the harmonics 1..kNHarmonics
+  // of the full event and of both subevents are summed in one loop without branches.
+  // The second harmonic is recentered and returned, all harmonics are kept for GetQn().
+  // Returns kFALSE if the subevents were requested with an unknown split method (Qsub1, Qsub2 not set).
+
   // get recentering values
   Double_t mean[2], rms[2];
   Recenter(0, mean);
   Recenter(1, rms);
 
-  AliVTrack* track;
-  TRandom2 rn = 0;
-
-  int nt = tracklist->GetEntries();
-  int trackcounter1=0, trackcounter2=0;
-  int idtemp = 0;
+  const Bool_t subevents = (Qsub1 && Qsub2);
+  if (subevents && fSplitMethod != AliEPSelectionTask::kRandom && fSplitMethod != AliEPSelectionTask::kEta && fSplitMethod != AliEPSelectionTask::kCharge) {
+    printf("plane resolution determination method not available!\n\n ");
+    if (!Q) return kFALSE;
+  }
 
-  if (fSplitMethod == AliEPSelectionTask::kRandom){
+  const Int_t nt = tracklist->GetEntries();
+  fTrackPhi.resize(nt);
+  fTrackWeight.resize(nt);
+  fTrackPhiWeight.resize(nt);
+  fTrackSub.resize(nt);
+  fTrackID.resize(nt);
 
-    for (Int_t i = 0; i < nt; i++) {
-      weight = 1;
-      track = dynamic_cast<AliVTrack*> (tracklist->At(i));
-      if (!track) continue;
-      weight = GetWeight(track);
-      idtemp = track->GetID();
-      if ((fAnalysisInput.CompareTo("AOD")==0) && (fAODfilterbit == 128)) idtemp = idtemp*(-1) - 1;
-
-      // This loop splits the track set into 2 random subsets
-      if( trackcounter1 < int(nt/2.) && trackcounter2 < int(nt/2.)){
-        float random = rn.Rndm();
-        if(random < .5){
-          mQx1 += (weight*cos(2*track->Phi())/rms[0]);
-          mQy1 += (weight*sin(2*track->Phi())/rms[1]);
-          if (fSaveTrackContribution){
-            EP->GetQContributionXArraysub1()->AddAt(weight*cos(2*track->Phi())/rms[0],idtemp);
-            EP->GetQContributionYArraysub1()->AddAt(weight*sin(2*track->Phi())/rms[1],idtemp);
-          }
-          trackcounter1++;
-        }
-        else {
-          mQx2 += (weight*cos(2*track->Phi())/rms[0]);
-          mQy2 += (weight*sin(2*track->Phi())/rms[1]);
-          if (fSaveTrackContribution){
-            EP->GetQContributionXArraysub2()->AddAt(weight*cos(2*track->Phi())/rms[0],idtemp);
-            EP->GetQContributionYArraysub2()->AddAt(weight*sin(2*track->Phi())/rms[1],idtemp);
-          }
-          trackcounter2++;
-        }
-      }
-      else if( trackcounter1 >= int(nt/2.)){
-        mQx2 += (weight*cos(2*track->Phi())/rms[0]);
-        mQy2 += (weight*sin(2*track->Phi())/rms[1]);
-        if (fSaveTrackContribution){
-          EP->GetQContributionXArraysub2()->AddAt(weight*cos(2*track->Phi())/rms[0],idtemp);
-          EP->GetQContributionYArraysub2()->AddAt(weight*sin(2*track->Phi())/rms[1],idtemp);
-        }
-        trackcounter2++;
+  // gather the tracks, the random split decides track by track as the tracks come
+  const Int_t mode = GetPhiDistMode();
+  const Bool_t aodTPC = (fAnalysisInput.CompareTo("AOD")==0) && (fAODfilterbit == 128);
+  TRandom2 rn = 0;
+  int trackcounter1=0, trackcounter2=0;
+  for (Int_t i = 0; i < nt; i++) {
+    fTrackPhi[i] = 0;
+    fTrackWeight[i] = 0;
+    fTrackPhiWeight[i] = 1;
+    fTrackSub[i] = -1;
+    fTrackID[i] = -1;
+    AliVTrack* track = dynamic_cast<AliVTrack*> (tracklist->At(i));
+    if (!track) continue;
+    const Double_t phi = track->Phi();
+    Double_t ptweight = 1;
+    if (fUsePtWeight) {
+      if (track->Pt()<2) ptweight=track->Pt();
+      else ptweight=2;
+    }
+    Double_t phiweight = 1;
+    if (fUsePhiWeight) {
+      Int_t dist = SelectPhiDistIndex(track, mode);
+      if (dist >= 0 && !fPhiWeightTable[dist].empty()) {
+        const Int_t nPhibins = fPhiWeightTable[dist].size() - 2;
+        Int_t bin = 1+TMath::FloorNint(phi*nPhibins/TMath::TwoPi());
+        // as TH1::GetBinContent, out of range bins give under/overflow
+        if (bin < 0) bin = 0;
+        if (bin > nPhibins+1) bin = nPhibins+1;
+        phiweight = fPhiWeightTable[dist][bin];
       }
-      else {
-        mQx1 += (weight*cos(2*track->Phi())/rms[0]);
-        mQy1 += (weight*sin(2*track->Phi())/rms[1]);
-        if (fSaveTrackContribution){
-          EP->GetQContributionXArraysub1()->AddAt(weight*cos(2*track->Phi())/rms[0],idtemp);
-          EP->GetQContributionYArraysub1()->AddAt(weight*sin(2*track->Phi())/rms[1],idtemp);
+    }
+    fTrackPhi[i] = phi;
+    fTrackPhiWeight[i] = phiweight;
+    fTrackWeight[i] = ptweight*phiweight;
+    fTrackID[i] = aodTPC ? track->GetID()*(-1) - 1 : track->GetID();
+
+    Int_t sub = 0;
+    if (subevents) {
+      if (fSplitMethod == AliEPSelectionTask::kRandom){
+        // This splits the track set into 2 random subsets
+        if( trackcounter1 < int(nt/2.) && trackcounter2 < int(nt/2.)){
+          float random = rn.Rndm();
+          sub = (random < .5) ? 1 : 2;
         }
-        trackcounter1++;
+        else if( trackcounter1 >= int(nt/2.)) sub = 2;
+        else sub = 1;
+        if (sub == 1) trackcounter1++;
+        else trackcounter2++;
+      } else if (fSplitMethod == AliEPSelectionTask::kEta) {
+        Double_t eta = track->Eta();
+        if (eta > fEtaGap/2.) sub = 1;
+        else if (eta < -1.*fEtaGap/2.) sub = 2;
+      } else if (fSplitMethod == AliEPSelectionTask::kCharge) {
+        Short_t cha = track->Charge();
+        if (cha > 0) sub = 1;
+        else if (cha < 0) sub = 2;
       }
     }
-  } else if (fSplitMethod == AliEPSelectionTask::kEta) {
+    fTrackSub[i] = sub;
+  }
 
-    for (Int_t i = 0; i < nt; i++) {
-      weight = 1;
-      track = dynamic_cast<AliVTrack*> (tracklist->At(i));
-      if (!track) continue;
-      weight = GetWeight(track);
-      Double_t eta = track->Eta();
-      idtemp = track->GetID();
-      if ((fAnalysisInput.CompareTo("AOD")==0) && (fAODfilterbit == 128)) idtemp = idtemp*(-1) - 1;
-
-      if (eta > fEtaGap/2.) {
-        mQx1 += (weight*cos(2*track->Phi())/rms[0]);
-        mQy1 += (weight*sin(2*track->Phi())/rms[1]);
-        if (fSaveTrackContribution){
-          EP->GetQContributionXArraysub1()->AddAt(weight*cos(2*track->Phi())/rms[0],idtemp);
-          EP->GetQContributionYArraysub1()->AddAt(weight*sin(2*track->Phi())/rms[1],idtemp);
-        }
-      } else if (eta < -1.*fEtaGap/2.) {
-        mQx2 += (weight*cos(2*track->Phi())/rms[0]);
-        mQy2 += (weight*sin(2*track->Phi())/rms[1]);
-        if (fSaveTrackContribution){
-          EP->GetQContributionXArraysub2()->AddAt(weight*cos(2*track->Phi())/rms[0],idtemp);
-          EP->GetQContributionYArraysub2()->AddAt(weight*sin(2*track->Phi())/rms[1],idtemp);
-        }
-      }
+  // harmonics 1..kNHarmonics of full event and subevents, cos(n*phi) and sin(n*phi) by recursion
+  Double_t qx[3][kNHarmonics], qy[3][kNHarmonics];
+  for (Int_t s = 0; s < 3; s++) {
+    for (Int_t n = 0; n < kNHarmonics; n++) {
+      qx[s][n] = 0;
+      qy[s][n] = 0;
+    }
+  }
+  for (Int_t i = 0; i < nt; i++) {
+    const Double_t w = fTrackWeight[i];
+    const Double_t w1 = (fTrackSub[i] == 1) ? w : 0.;
+    const Double_t w2 = (fTrackSub[i] == 2) ? w : 0.;
+    const Double_t c1 = TMath::Cos(fTrackPhi[i]);
+    const Double_t s1 = TMath::Sin(fTrackPhi[i]);
+    Double_t cn = c1, sn = s1;
+    for (Int_t n = 0; n < kNHarmonics; n++) {
+      qx[0][n] += w*cn;
+      qy[0][n] += w*sn;
+      qx[1][n] += w1*cn;
+      qy[1][n] += w1*sn;
+      qx[2][n] += w2*cn;
+      qy[2][n] += w2*sn;
+      const Double_t cnext = cn*c1 - sn*s1;
+      sn = sn*c1 + cn*s1;
+      cn = cnext;
     }
-  } else if (fSplitMethod == AliEPSelectionTask::kCharge) {
+  }
+  for (Int_t s = 0; s < 3; s++) {
+    if (s > 0 && !subevents) continue;
+    for (Int_t n = 0; n < kNHarmonics; n++) {
+      fQnX[s][n] = qx[s][n];
+      fQnY[s][n] = qy[s][n];
+    }
+  }
 
+  if (fSaveTrackContribution) {
     for (Int_t i = 0; i < nt; i++) {
-      weight = 1;
-      track = dynamic_cast<AliVTrack*> (tracklist->At(i));
-      if (!track) continue;
-      weight = GetWeight(track);
-      Short_t cha = track->Charge();
-      idtemp = track->GetID();
-      if ((fAnalysisInput.CompareTo("AOD")==0) && (fAODfilterbit == 128)) idtemp = idtemp*(-1) - 1;
-
-      if (cha > 0) {
-        mQx1 += (weight*cos(2*track->Phi())/rms[0]);
-        mQy1 += (weight*sin(2*track->Phi())/rms[1]);
-        if (fSaveTrackContribution){
-          EP->GetQContributionXArraysub1()->AddAt(weight*cos(2*track->Phi())/rms[0],idtemp);
-          EP->GetQContributionYArraysub1()->AddAt(weight*sin(2*track->Phi())/rms[1],idtemp);
-        }
-      } else if (cha < 0) {
-        mQx2 += (weight*cos(2*track->Phi())/rms[0]);
-        mQy2 += (weight*sin(2*track->Phi())/rms[1]);
-        if (fSaveTrackContribution){
-          EP->GetQContributionXArraysub2()->AddAt(weight*cos(2*track->Phi())/rms[0],idtemp);
-          EP->GetQContributionYArraysub2()->AddAt(weight*sin(2*track->Phi())/rms[1],idtemp);
-        }
+      if (fTrackSub[i] < 0) continue;
+      const Double_t cx = fTrackWeight[i]*cos(2*fTrackPhi[i])/rms[0];
+      const Double_t cy = fTrackWeight[i]*sin(2*fTrackPhi[i])/rms[1];
+      if (Q) {
+        EP->GetQContributionXArray()->AddAt(cx,fTrackID[i]);
+        EP->GetQContributionYArray()->AddAt(cy,fTrackID[i]);
+      }
+      if (subevents && fTrackSub[i] == 1) {
+        EP->GetQContributionXArraysub1()->AddAt(cx,fTrackID[i]);
+        EP->GetQContributionYArraysub1()->AddAt(cy,fTrackID[i]);
+      } else if (subevents && fTrackSub[i] == 2) {
+        EP->GetQContributionXArraysub2()->AddAt(cx,fTrackID[i]);
+        EP->GetQContributionYArraysub2()->AddAt(cy,fTrackID[i]);
       }
     }
-  } else {
-    printf("plane resolution determination method not available!\n\n ");
-    return;
   }
-  // apply recenetering
-  mQ[0].Set(mQx1-(mean[0]/rms[0]), mQy1-(mean[1]/rms[1]));
-  mQ[1].Set(mQx2-(mean[0]/rms[0]), mQy2-(mean[1]/rms[1]));
-  Q1 = mQ[0];
-  Q2 = mQ[1];
+
+  // apply recentering to the second harmonic
+  if (Q) Q->Set(qx[0][1]/rms[0]-(mean[0]/rms[0]), qy[0][1]/rms[1]-(mean[1]/rms[1]));
+  if (!subevents) return kTRUE;
+  if (fSplitMethod != AliEPSelectionTask::kRandom && fSplitMethod != AliEPSelectionTask::kEta && fSplitMethod != AliEPSelectionTask::kCharge) return kFALSE;
+  Qsub1->Set(qx[1][1]/rms[0]-(mean[0]/rms[0]), qy[1][1]/rms[1]-(mean[1]/rms[1]));
+  Qsub2->Set(qx[2][1]/rms[0]-(mean[0]/rms[0]), qy[2][1]/rms[1]-(mean[1]/rms[1]));
+  return kTRUE;
+}
+
+//__________________________________________________________________________
+TVector2 AliEPSelectionTask::GetQn(Int_t harmonic, Int_t sub) const
+{
+  // weighted Q_n of the last event (full event: sub = 0, subevents: sub = 1,2)
+  if (harmonic < 1 || harmonic > kNHarmonics || sub < 0 || sub > 2) return TVector2();
+  return TVector2(fQnX[sub][harmonic-1], fQnY[sub][harmonic-1]);
 }
 
 //________________________________________________________________________
@@ -693,42 +720,53 @@ Double_t AliEPSelectionTask::GetPhiWeight(TObject* track1)
   Double_t phiweight=1;
   AliVTrack* track = dynamic_cast<AliVTrack*>(track1);
 
-  TH1F *phiDist = 0x0;
-  if(track) phiDist = SelectPhiDist(track);
-
-  if (fUsePhiWeight && phiDist && track) {
-    Double_t nParticles = phiDist->Integral();
-    Double_t nPhibins = phiDist->GetNbinsX();
-
-    Double_t Phi = track->Phi();
+  Int_t dist = -1;
+  if(track) dist = SelectPhiDistIndex(track, GetPhiDistMode());
 
-    while (Phi<0) Phi += TMath::TwoPi();
-    while (Phi>TMath::TwoPi()) Phi -= TMath::TwoPi();
-
-    Double_t PhiDistValue = phiDist->GetBinContent(1+TMath::FloorNint((track->Phi())*nPhibins/TMath::TwoPi()));
-
-    if (PhiDistValue > 0) phiweight = nParticles/nPhibins/PhiDistValue;
+  if (fUsePhiWeight && dist >= 0 && !fPhiWeightTable[dist].empty()) {
+    // nParticles/nPhibins/PhiDistValue is tabulated per bin in FillPhiWeightTable()
+    const Int_t nPhibins = fPhiWeightTable[dist].size() - 2;
+    Int_t bin = 1+TMath::FloorNint((track->Phi())*nPhibins/TMath::TwoPi());
+    if (bin < 0) bin = 0;
+    if (bin > nPhibins+1) bin = nPhibins+1;
+    phiweight = fPhiWeightTable[dist][bin];
   }
   return phiweight;
 }
 
+//________________________________________________________________________
+void AliEPSelectionTask::FillPhiWeightTable()
+{
+  // tabulate the phi weight nParticles/nPhibins/PhiDistValue of each bin of the phi distributions,
+  // bins with no entries (and under/overflow) get weight 1
+  for (Int_t i = 0; i < 4; i++) {
+    fPhiWeightTable[i].clear();
+    if (!fPhiDist[i]) continue;
+    const Int_t nPhibins = fPhiDist[i]->GetNbinsX();
+    const Double_t nParticles = fPhiDist[i]->Integral();
+    fPhiWeightTable[i].resize(nPhibins+2, 1.);
+    for (Int_t bin = 0; bin <= nPhibins+1; bin++) {
+      Double_t PhiDistValue = fPhiDist[i]->GetBinContent(bin);
+      if (PhiDistValue > 0) fPhiWeightTable[i][bin] = nParticles/nPhibins/PhiDistValue;
+    }
+  }
+}
+
 //________________________________________________________________________
 void AliEPSelectionTask::Recenter(Int_t var, Double_t * values)
 {
 
   if (fUseRecentering && fQDist[0] && fQDist[1] && fCentrality!=-1.) {
     Int_t centbin = fQDist[0]->FindBin(fCentrality);
+    if ((Int_t)fQMean[0].size() != fQDist[0]->GetNbinsX()+2) FillRecenteringTable();
 
     if(var==0) { // fill mean
-      values[0] = fQDist[0]->GetBinContent(centbin);
-      values[1] = fQDist[1]->GetBinContent(centbin);
+      values[0] = fQMean[0][centbin];
+      values[1] = fQMean[1][centbin];
     }
     else if(var==1) { // fill rms
-      values[0] = fQDist[0]->GetBinError(centbin);
-      values[1] = fQDist[1]->GetBinError(centbin);
-      // protection against division by zero
-      if(values[0]==0.0) values[0]=1.0;
-      if(values[1]==0.0) values[1]=1.0;
+      values[0] = fQRMS[0][centbin];
+      values[1] = fQRMS[1][centbin];
     }
   }
   else { //default (no recentering)
@@ -738,6 +776,28 @@ void AliEPSelectionTask::Recenter(Int_t var, Double_t * values)
   return;
 }
 
+//________________________________________________________________________
+void AliEPSelectionTask::FillRecenteringTable()
+{
+  // cache mean and rms of Qx, Qy of the run for each centrality bin (with under/overflow)
+  for (Int_t i = 0; i < 2; i++) {
+    fQMean[i].clear();
+    fQRMS[i].clear();
+  }
+  if (!fQDist[0] || !fQDist[1]) return;
+  const Int_t ncells = fQDist[0]->GetNbinsX()+2;
+  for (Int_t i = 0; i < 2; i++) {
+    fQMean[i].resize(ncells);
+    fQRMS[i].resize(ncells);
+    for (Int_t centbin = 0; centbin < ncells; centbin++) {
+      fQMean[i][centbin] = fQDist[i]->GetBinContent(centbin);
+      fQRMS[i][centbin] = fQDist[i]->GetBinError(centbin);
+      // protection against division by zero
+      if(fQRMS[i][centbin]==0.0) fQRMS[i][centbin]=1.0;
+    }
+  }
+}
+
 //__________________________________________________________________________
 void AliEPSelectionTask::SetPhiDist()
 {
@@ -814,6 +874,7 @@ void AliEPSelectionTask::SetPhiDist()
   AliInfo("No Phi-weights available. All Phi weights set to 1");
   SetUsePhiWeight(kFALSE);
   }
+  FillPhiWeightTable();
 }
 
 //__________________________________________________________________________
@@ -826,6 +887,7 @@ void AliEPSelectionTask::SetQvectorDist()
 
   if (!fQDist[0] || !fQDist[1]) {
     AliError(Form("Cannot find OADB q-vector distributions for run %d. Using default values (mean=0,rms=1).", fRunNumber));
+    FillRecenteringTable();
     return;
   }
 
@@ -852,6 +914,7 @@ void AliEPSelectionTask::SetQvectorDist()
   if (emptybins) {
     AliError("After Maximum of rebinning still empty Qxy-bins!!!");
   }
+  FillRecenteringTable();
 }
 
 //__________________________________________________________________________
@@ -864,6 +927,7 @@ void AliEPSelectionTask::SetPersonalPhiDistribution(const char* infilename, char
   TObject* list = f.Get(listname);
   fPhiDist[0] = (TH1F*)list->FindObject("fHOutPhi");
   if (!fPhiDist[0]) AliFatal("Phi Distribution not found!!!");
+  FillPhiWeightTable();
 
   f.Close();
 }
@@ -965,22 +1029,40 @@ void AliEPSelectionTask::SetOADBandPeriod()
 //_________________________________________________________________________
 TH1F* AliEPSelectionTask::SelectPhiDist(AliVTrack *track)
 {
-  if (fPeriod.CompareTo("LHC10h")==0  || fUserphidist) return fPhiDist[0];
-  else if(fPeriod.CompareTo("LHC11h")==0)
+  Int_t dist = SelectPhiDistIndex(track, GetPhiDistMode());
+  if (dist < 0) return 0;
+  return fPhiDist[dist];
+}
+
+//_________________________________________________________________________
+Int_t AliEPSelectionTask::GetPhiDistMode() const
+{
+  // 0: one phi distribution, 1: phi distributions in charge and eta (LHC11h), -1: none
+  if (fPeriod.CompareTo("LHC10h")==0  || fUserphidist) return 0;
+  else if(fPeriod.CompareTo("LHC11h")==0) return 1;
+  return -1;
+}
+
+//_________________________________________________________________________
+Int_t AliEPSelectionTask::SelectPhiDistIndex(AliVTrack *track, Int_t mode) const
+{
+  // index of the phi distribution of the track, -1 if there is none
+  if (mode == 0) return 0;
+  else if(mode == 1)
     {
      if (track->Charge() < 0)
        {
-        if(track->Eta() < 0.)       return fPhiDist[0];
-        else if (track->Eta() > 0.) return fPhiDist[2];
+        if(track->Eta() < 0.)       return 0;
+        else if (track->Eta() > 0.) return 2;
        }
       else if (track->Charge() > 0)
        {
-        if(track->Eta() < 0.)       return fPhiDist[1];
-        else if (track->Eta() > 0.) return fPhiDist[3];
+        if(track->Eta() < 0.)       return 1;
+        else if (track->Eta() > 0.) return 3;
        }
 
     }
-  return 0;
+  return -1;
 }
 
 TObjArray* AliEPSelectionTask::GetTracksForLHC11h(AliESDEvent* esd)
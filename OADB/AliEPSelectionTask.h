@@ -9,6 +9,8 @@
 //   author: Alberica Toia, Johanna Gramling
 //*****************************************************
 
+#include <vector>
+
 #include "AliAnalysisTaskSE.h"
 
 class TFile;
@@ -32,6 +34,7 @@ class AliEPSelectionTask : public AliAnalysisTaskSE {
  public:
   
   enum ResoMethod{kRandom,kEta,kCharge};
+  enum {kNHarmonics = 6};               // harmonics of the Q-vectors built per event
 
   AliEPSelectionTask();
   AliEPSelectionTask(const char *name);
@@ -47,6 +50,8 @@ class AliEPSelectionTask : public AliAnalysisTaskSE {
   Double_t GetWeight(TObject* track1);
   Double_t GetPhiWeight(TObject* track1);
   void Recenter(Int_t var, Double_t * values);
+  // weighted Q_n = sum w*exp(i*n*phi) (not recentered) of the last event, n = 1..kNHarmonics, sub 0 = full event, 1,2 = subevents
+  TVector2 GetQn(Int_t harmonic, Int_t sub = 0) const;
 
   virtual void  SetDebugLevel(Int_t level)   {fDebug = level;}
   void SetInput(const char* input)           {fAnalysisInput = input;}
@@ -72,6 +77,11 @@ class AliEPSelectionTask : public AliAnalysisTaskSE {
   TObjArray* GetAODTracksAndMaxID(AliAODEvent* aod, Int_t& maxid);
   void SetOADBandPeriod();
   TH1F* SelectPhiDist(AliVTrack *track);
+  Int_t SelectPhiDistIndex(AliVTrack *track, Int_t mode) const;
+  Int_t GetPhiDistMode() const;
+  void FillPhiWeightTable();
+  void FillRecenteringTable();
+  Bool_t FillQvectors(TObjArray* tracklist, AliEventplane* EP, TVector2* Q, TVector2* Qsub1, TVector2* Qsub2);
   TObjArray* GetTracksForLHC11h(AliESDEvent* esd);
 
   TString  fAnalysisInput; 		// "ESD", "AOD"
@@ -119,7 +129,18 @@ class AliEPSelectionTask : public AliAnalysisTaskSE {
   TH2F*	 fHOutDiff;			//! control histogram: Difference of MC RP and EP - only filled if fUseMCRP is true!
   TH2F*  fHOutleadPTPsi;		//! control histogram: emission angle of leading pT track vs EP angle
 
-  ClassDef(AliEPSelectionTask,4); 
+  std::vector<Double_t> fPhiWeightTable[4];	//! phi weight of each bin (with under/overflow) of fPhiDist[i]
+  std::vector<Double_t> fQMean[2];	//! recentering mean of Qx, Qy of each centrality bin of fQDist
+  std::vector<Double_t> fQRMS[2];	//! recentering rms of Qx, Qy of each centrality bin of fQDist
+  std::vector<Double_t> fTrackPhi;	//! phi of the tracks of the event
+  std::vector<Double_t> fTrackWeight;	//! weight (pt and phi) of the tracks of the event
+  std::vector<Double_t> fTrackPhiWeight;	//! phi weight of the tracks of the event
+  std::vector<Int_t>    fTrackSub;	//! subevent of the tracks of the event (0 = none, -1 = no track)
+  std::vector<Int_t>    fTrackID;	//! ID of the tracks of the event (for the track contributions)
+  Double_t fQnX[3][kNHarmonics];	//! X component of Q_n of full event and subevents
+  Double_t fQnY[3][kNHarmonics];	//! Y component of Q_n of full event and subevents
+
+  ClassDef(AliEPSelectionTask,5); 
 };
 
 #endif
@@ -0,0 +1,208 @@
+/**************************************************************************
+ * Copyright(c) 1998-1999, ALICE Experiment at CERN, All rights reserved. *
+ *                                                                        *
+ * Author: The ALICE Off-line Project.                                    *
+ * Contributors are mentioned in the code where appropriate.              *
+ *                                                                        *
+ * Permission to use, copy, modify and distribute this software and its   *
+ * documentation strictly for non-commercial purposes is hereby granted   *
+ * without fee, provided that the above copyright notice appears in all   *
+ * copies and that both the copyright notice and this permission notice   *
+ * appear in the supporting documentation. The authors make no claims     *
+ * about the suitability of this software for any purpose. It is          *
+ * provided "as is" without express or implied warranty.                  *
+ **************************************************************************/
+
+// --- ROOT system ---
+#include <TObjArray.h>
+#include <TMath.h>
+
+// --- AliRoot system ---
+#include "AliVCluster.h"
+#include "AliVTrack.h"
+#include "AliMixedEvent.h"
+
+// --- CaloTrackCorrelations ---
+#include "AliCaloTrackParticle.h"
+#include "AliCaloTrackReader.h"
+
+#include "AliCaloTrackEtaPhiGrid.h"
+
+/// \cond CLASSIMP
+ClassImp(AliCaloTrackEtaPhiGrid) ;
+/// \endcond
+
+//____________________________________
+/// Default constructor.
+//____________________________________
+AliCaloTrackEtaPhiGrid::AliCaloTrackEtaPhiGrid() :
+TObject(),
+fCellSize(0.05),
+fList(0x0),          fNEntries(0),
+fPt(),               fEta(),          fPhi(),
+fNEtaCells(0),       fNPhiCells(0),   fEtaMin(0.),     fEtaCellSize(0.),
+fCellStart(),        fCellEntries(),
+fMomentum(),         fTrackVector()
+{
+}
+
+//_________________________________________________________________________________
+/// Calculate the kinematics of the entries of the list and sort them into the cells.
+/// Clusters are assumed to come from the vertex of their event in straight line,
+/// tracks take their momentum, mixed event particles (AliCaloTrackParticle) their
+/// stored kinematics, as in AliIsolationCut::CalculateCaloSignalInCone()
+/// and AliIsolationCut::CalculateTrackSignalInCone().
+/// Entries of other type are not put in any cell.
+///
+/// \param list: array of tracks or clusters of the reader.
+/// \param reader: pointer to AliCaloTrackReader. Needed to access the vertices.
+//_________________________________________________________________________________
+void AliCaloTrackEtaPhiGrid::Fill(TObjArray * list, AliCaloTrackReader * reader)
+{
+  fList     = list;
+  fNEntries = list->GetEntriesFast();
+
+  fPt .assign(fNEntries, -100.);
+  fEta.assign(fNEntries, -100.);
+  fPhi.assign(fNEntries, -100.);
+  std::vector<Bool_t> ok(fNEntries, kFALSE);
+
+  Float_t etaMin = 0., etaMax = 0.;
+  Int_t   nOk    = 0;
+
+  for(Int_t ipr = 0; ipr < fNEntries; ipr++)
+  {
+    TObject * obj = list->At(ipr);
+
+    if      ( AliVCluster * calo = dynamic_cast<AliVCluster*>(obj) )
+    {
+      // Get the index where the cluster comes, to retrieve the corresponding vertex
+      Int_t evtIndex = 0 ;
+      if ( reader->GetMixedEvent() )
+        evtIndex=reader->GetMixedEvent()->EventIndexForCaloCluster(calo->GetID()) ;
+
+      calo->GetMomentum(fMomentum,reader->GetVertex(evtIndex)) ;
+
+      fPt [ipr] = fMomentum.Pt()  ;
+      fEta[ipr] = fMomentum.Eta() ;
+      fPhi[ipr] = fMomentum.Phi() ;
+    }
+    else if ( AliVTrack * track = dynamic_cast<AliVTrack*>(obj) )
+    {
+      fTrackVector.SetXYZ(track->Px(),track->Py(),track->Pz());
+
+      fPt [ipr] = fTrackVector.Pt();
+      fEta[ipr] = fTrackVector.Eta();
+      fPhi[ipr] = fTrackVector.Phi() ;
+    }
+    else if ( AliCaloTrackParticle * part = dynamic_cast<AliCaloTrackParticle*>(obj) )
+    {
+      fPt [ipr] = part->Pt();
+      fEta[ipr] = part->Eta();
+      fPhi[ipr] = part->Phi() ;
+    }
+    else continue;
+
+    ok[ipr] = kTRUE;
+
+    if ( nOk == 0 || fEta[ipr] < etaMin ) etaMin = fEta[ipr];
+    if ( nOk == 0 || fEta[ipr] > etaMax ) etaMax = fEta[ipr];
+    nOk++;
+  }
+
+  // Grid limits, eta from the entries, phi from 0 to 2 pi
+  //
+  const Int_t kMaxEtaCells = 1000;
+
+  fEtaMin      = etaMin;
+  fEtaCellSize = TMath::Max(fCellSize, (etaMax-etaMin)/kMaxEtaCells);
+  fNEtaCells   = TMath::Min(Int_t((etaMax-etaMin)/fEtaCellSize)+1, kMaxEtaCells);
+  fNPhiCells   = TMath::Max(Int_t(TMath::Ceil(TMath::TwoPi()/fCellSize)), 1);
+
+  Float_t phiCellSize = TMath::TwoPi()/fNPhiCells;
+
+  // Count the entries per cell, running sum gives the first entry of each cell,
+  // then fill keeping the list order within each cell
+  //
+  Int_t nCells = fNEtaCells*fNPhiCells;
+  std::vector<Int_t> cellOfEntry(fNEntries, -1);
+  fCellStart.assign(nCells+1, 0);
+
+  for(Int_t ipr = 0; ipr < fNEntries; ipr++)
+  {
+    if ( !ok[ipr] ) continue;
+
+    Float_t phi = fPhi[ipr];
+    if ( phi < 0 ) phi+=TMath::TwoPi();
+
+    Int_t ieta = TMath::Min(Int_t((fEta[ipr]-fEtaMin)/fEtaCellSize), fNEtaCells-1);
+    Int_t iphi = TMath::Min(TMath::Max(Int_t(phi/phiCellSize), 0), fNPhiCells-1);
+
+    cellOfEntry[ipr] = ieta*fNPhiCells+iphi;
+    fCellStart[cellOfEntry[ipr]+1]++;
+  }
+
+  for(Int_t icell = 0; icell < nCells; icell++) fCellStart[icell+1] += fCellStart[icell];
+
+  fCellEntries.resize(nOk);
+  std::vector<Int_t> next(fCellStart.begin(), fCellStart.end()-1);
+  for(Int_t ipr = 0; ipr < fNEntries; ipr++)
+  {
+    if ( cellOfEntry[ipr] >= 0 ) fCellEntries[next[cellOfEntry[ipr]]++] = ipr;
+  }
+}
+
+//_________________________________________________________________________________
+/// \return kTRUE if the grid was filled with this list and the list did not change size since.
+//_________________________________________________________________________________
+Bool_t AliCaloTrackEtaPhiGrid::IsFilled(const TObjArray * list) const
+{
+  return ( fList && fList == list && fNEntries == list->GetEntriesFast() ) ;
+}
+
+//_________________________________________________________________________________
+/// Add to entries the list indices of the tracks or clusters in the cells overlapping
+/// the rectangle [etaMin,etaMax] x [phiMin,phiMax], cell by cell.
+/// The phi limits can be out of [0, 2 pi], the rectangle is wrapped around.
+/// Entries of the border cells can be out of the rectangle, the caller must apply
+/// its selection and sort the entries if several regions are requested.
+//_________________________________________________________________________________
+void AliCaloTrackEtaPhiGrid::GetEntriesInRegion(Float_t etaMin, Float_t etaMax,
+                                                Float_t phiMin, Float_t phiMax,
+                                                std::vector<Int_t> & entries) const
+{
+  if ( fCellEntries.empty() || etaMax < etaMin || phiMax < phiMin ) return;
+
+  // Margin for the rounding of the distances calculated by the caller
+  const Float_t kMargin = 1e-4;
+
+  Float_t phiCellSize = TMath::TwoPi()/fNPhiCells;
+
+  Float_t etaLow  = (etaMin-kMargin-fEtaMin)/fEtaCellSize;
+  Float_t etaHigh = (etaMax+kMargin-fEtaMin)/fEtaCellSize;
+  if ( etaHigh < 0 || etaLow >= fNEtaCells ) return;
+
+  Int_t ietaMin = ( etaLow  > 0          ? Int_t(etaLow)  : 0            );
+  Int_t ietaMax = ( etaHigh < fNEtaCells ? Int_t(etaHigh) : fNEtaCells-1 );
+
+  Int_t iphiMin = 0;
+  Int_t iphiMax = fNPhiCells-1;
+  if ( phiMax-phiMin+2*kMargin < TMath::TwoPi() - phiCellSize )
+  {
+    iphiMin = Int_t(TMath::Floor((phiMin-kMargin)/phiCellSize));
+    iphiMax = Int_t(TMath::Floor((phiMax+kMargin)/phiCellSize));
+  }
+
+  for(Int_t ieta = ietaMin; ieta <= ietaMax; ieta++)
+  {
+    for(Int_t jphi = iphiMin; jphi <= iphiMax; jphi++)
+    {
+      Int_t iphi  = ((jphi % fNPhiCells) + fNPhiCells) % fNPhiCells;
+      Int_t icell = ieta*fNPhiCells+iphi;
+
+      entries.insert(entries.end(),
+                     fCellEntries.begin()+fCellStart[icell],
+                     fCellEntries.begin()+fCellStart[icell+1]);
+    }
+  }
+}
@@ -0,0 +1,94 @@
+#ifndef ALICALOTRACKETAPHIGRID_H
+#define ALICALOTRACKETAPHIGRID_H
+/* Copyright(c) 1998-1999, ALICE Experiment at CERN, All rights reserved. *
+ * See cxx source for full Copyright notice     */
+
+//_________________________________________________________________________
+/// \class AliCaloTrackEtaPhiGrid
+/// \ingroup CaloTrackCorrelationsBase
+/// \brief Eta-phi grid of the tracks or clusters selected by the reader in the event
+///
+/// The kinematics (pt, eta, phi) of each entry of one of the reader lists
+/// (AliCaloTrackReader::GetCTSTracks(), GetEMCALClusters(), GetPHOSClusters())
+/// is calculated once per event, as done in the isolation cone loops of AliIsolationCut,
+/// and the entries are sorted into cells of fCellSize x fCellSize in eta-phi.
+/// The grid gives the entries in any eta-phi rectangle, in the order of the list,
+/// so that cone and band sums done on them are the same as looping the full list.
+///
+/// The grids are filled on request by AliCaloTrackReader::GetEtaPhiGrid()
+/// and shared by all the analyses using the same reader.
+//_________________________________________________________________________
+
+#include <vector>
+
+// --- ROOT system ---
+#include <TObject.h>
+#include <TLorentzVector.h>
+#include <TVector3.h>
+class TObjArray ;
+
+// --- ANALYSIS system ---
+class AliCaloTrackReader ;
+
+class AliCaloTrackEtaPhiGrid : public TObject {
+
+ public:
+
+  AliCaloTrackEtaPhiGrid() ;
+
+  /// Virtual destructor.
+  virtual ~AliCaloTrackEtaPhiGrid() { ; }
+
+  void       Fill(TObjArray * list, AliCaloTrackReader * reader) ;
+
+  /// Forget the list of the event, to be refilled.
+  void       Reset()                                       { fList = 0x0 ; fNEntries = 0 ; }
+
+  Bool_t     IsFilled(const TObjArray * list) const ;
+
+  void       GetEntriesInRegion(Float_t etaMin, Float_t etaMax,
+                                Float_t phiMin, Float_t phiMax,
+                                std::vector<Int_t> & entries) const ;
+
+  Float_t    GetPt (Int_t i)                         const { return fPt [i]            ; }
+  Float_t    GetEta(Int_t i)                         const { return fEta[i]            ; }
+  Float_t    GetPhi(Int_t i)                         const { return fPhi[i]            ; }
+
+  Float_t    GetCellSize()                           const { return fCellSize          ; }
+  void       SetCellSize(Float_t size)                     { fCellSize = size          ; }
+
+ private:
+
+  Float_t    fCellSize ;                        ///<  Size of the cells in eta and phi, phi rounded to divide 2 pi.
+
+  TObjArray * fList ;                           //!<! List of the reader the grid was filled with.
+  Int_t      fNEntries ;                        //!<! Number of entries of fList when filled.
+
+  std::vector<Float_t> fPt  ;                   //!<! Pt of each entry of the list.
+  std::vector<Float_t> fEta ;                   //!<! Eta of each entry of the list.
+  std::vector<Float_t> fPhi ;                   //!<! Phi of each entry of the list, as given by the track/cluster.
+
+  Int_t      fNEtaCells ;                       //!<! Number of cells in eta.
+  Int_t      fNPhiCells ;                       //!<! Number of cells in phi, from 0 to 2 pi.
+  Float_t    fEtaMin ;                          //!<! Lower eta edge of the grid.
+  Float_t    fEtaCellSize ;                     //!<! Size of the cells in eta, larger than fCellSize for very wide lists.
+
+  std::vector<Int_t> fCellStart  ;              //!<! First entry in fCellEntries of each cell, running sum of the cell contents.
+  std::vector<Int_t> fCellEntries ;             //!<! List entries ordered by cell, by index within a cell.
+
+  TLorentzVector fMomentum;                     //!<! Momentum of cluster, temporal object.
+  TVector3   fTrackVector;                      //!<! Track moment, temporal object.
+
+  /// Copy constructor not implemented.
+  AliCaloTrackEtaPhiGrid(              const AliCaloTrackEtaPhiGrid & g) ;
+
+  /// Assignment operator not implemented.
+  AliCaloTrackEtaPhiGrid & operator = (const AliCaloTrackEtaPhiGrid & g) ;
+
+  /// \cond CLASSIMP
+  ClassDef(AliCaloTrackEtaPhiGrid,1) ;
+  /// \endcond
+
+} ;
+
+#endif //ALICALOTRACKETAPHIGRID_H
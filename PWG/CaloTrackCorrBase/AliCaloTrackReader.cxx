@@ -83,6 +83,7 @@ fUseTrackDCACut(0),
 fAODBranchList(0x0),
 fCTSTracks(0x0),             fEMCALClusters(0x0),
 fDCALClusters(0x0),          fPHOSClusters(0x0),
+fEtaPhiGrid(),               fUseEtaPhiGrid(kTRUE),
 fEMCALCells(0x0),            fPHOSCells(0x0),
 fInputEvent(0x0),            fOutputEvent(0x0),               fMC(0x0),
 fSelectEmbeddedClusters(kFALSE),
@@ -2429,6 +2430,30 @@ Double_t AliCaloTrackReader::GetEventPlaneAngle() const
   return ep;
 }
 
+//_________________________________________________________________________________
+/// \return Eta-phi grid of the selected tracks (detector AliFiducialCut::kCTS)
+/// or EMCal/PHOS clusters (AliFiducialCut::kEMCAL/kPHOS) of the current event.
+/// It is filled the first time it is requested in the event and then shared by
+/// all the analyses of this reader. Null if switched off or no list.
+//_________________________________________________________________________________
+AliCaloTrackEtaPhiGrid * AliCaloTrackReader::GetEtaPhiGrid(Int_t detector)
+{
+  if ( !fUseEtaPhiGrid ) return 0x0;
+  
+  TObjArray * list = 0x0;
+  if      ( detector == AliFiducialCut::kCTS   ) list = fCTSTracks;
+  else if ( detector == AliFiducialCut::kEMCAL ) list = fEMCALClusters;
+  else if ( detector == AliFiducialCut::kPHOS  ) list = fPHOSClusters;
+  
+  if ( !list ) return 0x0;
+  
+  AliCaloTrackEtaPhiGrid * grid = &fEtaPhiGrid[detector];
+  
+  if ( !grid->IsFilled(list) ) grid->Fill(list, this);
+  
+  return grid;
+}
+
 //__________________________________________________________
 /// \return Vertex position to be used for single event analysis.
 //__________________________________________________________
@@ -4545,6 +4570,8 @@ void AliCaloTrackReader::ResetLists()
   if(fEMCALClusters)   fEMCALClusters -> Clear("C");
   if(fPHOSClusters)    fPHOSClusters  -> Clear("C");
   
+  for(Int_t igrid = 0; igrid < 3; igrid++) fEtaPhiGrid[igrid].Reset();
+  
   fV0ADC[0] = 0;   fV0ADC[1] = 0;
   fV0Mul[0] = 0;   fV0Mul[1] = 0;
   
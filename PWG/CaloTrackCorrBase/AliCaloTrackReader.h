@@ -57,6 +57,7 @@ class AliVCluster;
 class AliCalorimeterUtils;
 #include "AliAnaWeights.h"
 #include "AliMCAnalysisUtils.h"
+#include "AliCaloTrackEtaPhiGrid.h"
 
 class AliCaloTrackReader : public TObject {
 
@@ -350,6 +351,12 @@ public:
   virtual TObjArray*     GetPHOSClusters()           const { return fPHOSClusters           ; }
   virtual AliVCaloCells* GetEMCALCells()             const { return fEMCALCells             ; }
   virtual AliVCaloCells* GetPHOSCells()              const { return fPHOSCells              ; }
+
+  AliCaloTrackEtaPhiGrid * GetEtaPhiGrid(Int_t detector) ;
+
+  Bool_t           IsEtaPhiGridOn()                  const { return fUseEtaPhiGrid          ; }
+  void             SwitchOnEtaPhiGrid()                    { fUseEtaPhiGrid = kTRUE         ; }
+  void             SwitchOffEtaPhiGrid()                   { fUseEtaPhiGrid = kFALSE        ; }
   
   //-------------------------------------
   // Event/track selection methods
@@ -972,6 +979,11 @@ public:
   /// Temporal array with PHOS  CaloClusters.
   TObjArray      * fPHOSClusters ;                 //-> 
   
+  /// Eta-phi grids of fCTSTracks, fEMCALClusters and fPHOSClusters, filled on request, see GetEtaPhiGrid().
+  AliCaloTrackEtaPhiGrid fEtaPhiGrid[3] ;          //!<!
+
+  Bool_t           fUseEtaPhiGrid ;                ///<  Give the eta-phi grids of the lists to the analysis, for the isolation cone sums.
+
   AliVCaloCells  * fEMCALCells ;                   //!<! Temporal array with EMCAL AliVCaloCells.
   AliVCaloCells  * fPHOSCells ;                    //!<! Temporal array with PHOS  AliVCaloCells.
 
@@ -1251,7 +1263,7 @@ public:
   AliCaloTrackReader & operator = (const AliCaloTrackReader & r) ; 
   
   /// \cond CLASSIMP
-  ClassDef(AliCaloTrackReader,95) ;
+  ClassDef(AliCaloTrackReader,96) ;
   /// \endcond
 
 } ;
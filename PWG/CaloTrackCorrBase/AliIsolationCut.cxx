@@ -13,6 +13,8 @@
  * provided "as is" without express or implied warranty.                  *
  **************************************************************************/
 
+#include <algorithm>
+
 // --- ROOT system ---
 #include <TObjArray.h>
 #include <TH3F.h>
@@ -34,6 +36,7 @@
 #include "AliFiducialCut.h"
 #include "AliHistogramRanges.h"
 
+#include "AliCaloTrackEtaPhiGrid.h"
 #include "AliIsolationCut.h"
 
 /// \cond CLASSIMP
@@ -54,6 +57,7 @@ fSumPtThreshold(0.), fSumPtThresholdMax(10000.),    fSumPtThresholdGap(0.),
 fPtFraction(0.),     fICMethod(0),                  fPartInCone(0),
 fFracIsThresh(1),    fIsTMClusterInConeRejected(1), fDistMinToTrigger(-1.),
 fDebug(0),           fMomentum(),                   fTrackVector(),
+fGridEntries(),
 fEMCEtaSize(-1),     fEMCPhiMin(-1),                fEMCPhiMax(-1),
 fTPCEtaSize(-1),     fTPCPhiSize(-1),
 // Histograms
@@ -215,20 +219,23 @@ void AliIsolationCut::CalculateCaloSignalInCone
   TObjArray * refclusters  = 0x0;
   Int_t       nclusterrefs = 0;
   
+  // Clusters of the reader list: only those that can be in the cone or UE regions,
+  // from the eta-phi grid shared by all the analyses of the reader
+  AliCaloTrackEtaPhiGrid * grid = 0x0;
+  if ( !bgCls && !useRefs ) grid = reader->GetEtaPhiGrid(calorimeter);
+  if ( !SelectGridEntriesInCone(grid, etaC, phiC, ptC, kFALSE) ) grid = 0x0;
+  Int_t nEntries = ( grid ? (Int_t) fGridEntries.size() : plNe->GetEntries() );
+  
   // Get the clusters
   //
   //printf("Loop calo\n");
-  for(Int_t ipr = 0;ipr < plNe->GetEntries() ; ipr ++ )
+  for(Int_t ient = 0;ient < nEntries ; ient ++ )
   {
+    Int_t ipr = ( grid ? fGridEntries[ient] : ient );
     AliVCluster * calo = dynamic_cast<AliVCluster *>(plNe->At(ipr)) ;
     
     if ( calo )
     {
-      // Get the index where the cluster comes, to retrieve the corresponding vertex
-      Int_t evtIndex = 0 ;
-      if ( reader->GetMixedEvent() )
-        evtIndex=reader->GetMixedEvent()->EventIndexForCaloCluster(calo->GetID()) ;
-      
       // Do not count the candidate (photon or pi0) or the daughters of the candidate
       if ( calo->GetID() == pCandidate->GetCaloLabel(0) ||
            calo->GetID() == pCandidate->GetCaloLabel(1)   ) continue ;
@@ -243,12 +250,27 @@ void AliIsolationCut::CalculateCaloSignalInCone
         if ( fPartInCone == kNeutralAndCharged && matched ) continue ;
       }
       
-      // Assume that come from vertex in straight line
-      calo->GetMomentum(fMomentum,reader->GetVertex(evtIndex)) ;
-      
-      pt  = fMomentum.Pt()  ;
-      eta = fMomentum.Eta() ;
-      phi = fMomentum.Phi() ;
+      if ( grid )
+      {
+        // Same as below, calculated once per event
+        pt  = grid->GetPt (ipr) ;
+        eta = grid->GetEta(ipr) ;
+        phi = grid->GetPhi(ipr) ;
+      }
+      else
+      {
+        // Get the index where the cluster comes, to retrieve the corresponding vertex
+        Int_t evtIndex = 0 ;
+        if ( reader->GetMixedEvent() )
+          evtIndex=reader->GetMixedEvent()->EventIndexForCaloCluster(calo->GetID()) ;
+        
+        // Assume that come from vertex in straight line
+        calo->GetMomentum(fMomentum,reader->GetVertex(evtIndex)) ;
+        
+        pt  = fMomentum.Pt()  ;
+        eta = fMomentum.Eta() ;
+        phi = fMomentum.Phi() ;
+      }
     }
     else
     {// Mixed event stored in AliCaloTrackParticles
@@ -613,12 +635,20 @@ void AliIsolationCut::CalculateTrackSignalInCone
   TObjArray * reftracks  = 0x0;
   Int_t       ntrackrefs = 0;
     
+  // Tracks of the reader list: only those that can be in the cone or UE regions,
+  // from the eta-phi grid shared by all the analyses of the reader
+  AliCaloTrackEtaPhiGrid * grid = 0x0;
+  if ( !bgTrk && !useRefs ) grid = reader->GetEtaPhiGrid(AliFiducialCut::kCTS);
+  if ( !SelectGridEntriesInCone(grid, etaTrig, phiTrig, ptTrig, kTRUE) ) grid = 0x0;
+  Int_t nEntries = ( grid ? (Int_t) fGridEntries.size() : plCTS->GetEntries() );
+  
   //-----------------------------------------------------------
   // Get the tracks in cone
   //
   //-----------------------------------------------------------
-  for(Int_t ipr = 0;ipr < plCTS->GetEntries() ; ipr ++ )
+  for(Int_t ient = 0;ient < nEntries ; ient ++ )
   {
+    Int_t ipr = ( grid ? fGridEntries[ient] : ient );
     AliVTrack* track = dynamic_cast<AliVTrack*>(plCTS->At(ipr)) ;
     
     if(track)
@@ -639,10 +669,20 @@ void AliIsolationCut::CalculateTrackSignalInCone
         if ( contained ) continue ;
       }
       
-      fTrackVector.SetXYZ(track->Px(),track->Py(),track->Pz());
-      ptTrack  = fTrackVector.Pt();
-      etaTrack = fTrackVector.Eta();
-      phiTrack = fTrackVector.Phi() ;
+      if ( grid )
+      {
+        // Same as below, calculated once per event
+        ptTrack  = grid->GetPt (ipr);
+        etaTrack = grid->GetEta(ipr);
+        phiTrack = grid->GetPhi(ipr) ;
+      }
+      else
+      {
+        fTrackVector.SetXYZ(track->Px(),track->Py(),track->Pz());
+        ptTrack  = fTrackVector.Pt();
+        etaTrack = fTrackVector.Eta();
+        phiTrack = fTrackVector.Phi() ;
+      }
     }
     else
     {// Mixed event stored in AliCaloTrackParticles
@@ -943,6 +983,59 @@ void AliIsolationCut::CalculateTrackSignalInCone
   if ( bFillAOD && reftracks ) pCandidate->AddObjArray(reftracks);  
 }
 
+//_________________________________________________________________________________________________________________________________
+/// Select in fGridEntries the tracks or clusters of the reader list that can be in the cone of the
+/// candidate or in the UE regions of the isolation method (eta and phi bands, perpendicular cones).
+/// The entries are taken from the cells of the reader eta-phi grid overlapping these regions
+/// and sorted in the order of the list, so the cone loops give the same sums as on the full list.
+///
+/// \param grid: eta-phi grid of the reader list, see AliCaloTrackReader::GetEtaPhiGrid().
+/// \param etaC: pseudorapidity of candidate particle.
+/// \param phiC: azimuthal angle of candidate particle, in [0, 2 pi].
+/// \param ptC: transverse momentum of candidate particle.
+/// \param perpCones: add the perpendicular cones of kSumBkgSubIC, only filled for tracks.
+/// \return kFALSE if no grid or if the full list is needed, eta-phi histograms of all particles.
+//_________________________________________________________________________________________________________________________________
+Bool_t AliIsolationCut::SelectGridEntriesInCone(AliCaloTrackEtaPhiGrid * grid,
+                                                Float_t etaC, Float_t phiC, Float_t ptC,
+                                                Bool_t perpCones)
+{
+  fGridEntries.clear();
+  
+  if ( !grid ) return kFALSE;
+  
+  if ( fFillHistograms && fFillEtaPhiHistograms && ptC > fEtaPhiHistogramsMinPt ) return kFALSE;
+  
+  // Isolation cone
+  grid->GetEntriesInRegion(etaC-fConeSize, etaC+fConeSize,
+                           phiC-fConeSize, phiC+fConeSize, fGridEntries);
+  
+  if ( fICMethod > kSumBkgSubIC )
+  {
+    Float_t bandSize = fConeSize+fConeSizeBandGap;
+    
+    // Phi band, 90 degrees around the candidate
+    grid->GetEntriesInRegion(etaC-bandSize, etaC+bandSize,
+                             phiC-TMath::PiOver2(), phiC+TMath::PiOver2(), fGridEntries);
+    
+    // Eta band
+    grid->GetEntriesInRegion(-1e6, 1e6, phiC-bandSize, phiC+bandSize, fGridEntries);
+  }
+  
+  if ( perpCones && fICMethod == kSumBkgSubIC )
+  {
+    grid->GetEntriesInRegion(etaC-fConeSize, etaC+fConeSize,
+                             phiC+TMath::PiOver2()-fConeSize, phiC+TMath::PiOver2()+fConeSize, fGridEntries);
+    grid->GetEntriesInRegion(etaC-fConeSize, etaC+fConeSize,
+                             phiC-TMath::PiOver2()-fConeSize, phiC-TMath::PiOver2()+fConeSize, fGridEntries);
+  }
+  
+  std::sort(fGridEntries.begin(), fGridEntries.end());
+  fGridEntries.erase(std::unique(fGridEntries.begin(), fGridEntries.end()), fGridEntries.end());
+  
+  return kTRUE;
+}
+
 //_________________________________________________________________________________________________________________________________
 /// Get normalization of cluster background band.
 //_________________________________________________________________________________________________________________________________
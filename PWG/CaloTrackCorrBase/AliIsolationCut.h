@@ -18,6 +18,8 @@
 /// \author Gustavo Conesa Balbastre <Gustavo.Conesa.Balbastre@cern.ch>, LPSC-IN2P3-CNRS
 //_________________________________________________________________________
 
+#include <vector>
+
 // --- ROOT system ---
 #include <TObject.h>
 class TObjArray ;
@@ -28,6 +30,7 @@ class TH3F ;
 // --- ANALYSIS system ---
 class AliCaloTrackParticleCorrelation ;
 class AliCaloTrackReader ;
+class AliCaloTrackEtaPhiGrid ;
 class AliCaloPID ;
 class AliHistogramRanges ;
 
@@ -103,6 +106,10 @@ class AliIsolationCut : public TObject {
                                         Double_t  histoWeight=1,
                                         Float_t centrality = -1, Int_t cenBin = -1) ;
   
+  Bool_t     SelectGridEntriesInCone   (AliCaloTrackEtaPhiGrid * grid, 
+                                        Float_t etaC, Float_t phiC, Float_t ptC,
+                                        Bool_t perpCones) ;
+  
   // Cone background studies medthods
 
   void       GetDetectorAngleLimits( AliCaloTrackReader * reader, Int_t calorimeter );
@@ -253,6 +260,8 @@ class AliIsolationCut : public TObject {
   TLorentzVector fMomentum;                            //!<! Momentum of cluster, temporal object.
 
   TVector3   fTrackVector;                             //!<! Track moment, temporal object.
+
+  std::vector<Int_t> fGridEntries;                     //!<! Entries of the reader list in the cone and UE regions of the candidate, temporal object.
   
   Float_t    fEMCEtaSize;                              ///< Eta size of Calo
   Float_t    fEMCPhiMin;                               ///< Minimim Phi limit of Calo
@@ -427,7 +436,7 @@ class AliIsolationCut : public TObject {
   AliIsolationCut & operator = (const AliIsolationCut & g) ; 
 
   /// \cond CLASSIMP
-  ClassDef(AliIsolationCut,20) ;
+  ClassDef(AliIsolationCut,21) ;
   /// \endcond
 
 } ;
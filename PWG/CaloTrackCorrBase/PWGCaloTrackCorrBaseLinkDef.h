@@ -12,6 +12,7 @@
 #pragma link C++ class AliIsolationCut+;
 #pragma link C++ class AliCaloTrackParticle+;
 #pragma link C++ class AliCaloTrackParticleCorrelation+;
+#pragma link C++ class AliCaloTrackEtaPhiGrid+;
 #pragma link C++ class AliCaloTrackReader+;
 #pragma link C++ class AliCaloTrackESDReader+;
 #pragma link C++ class AliCaloTrackAODReader+;
@@ -0,0 +1,140 @@
+#include "AliNanoAODTrackColumns.h"
+#include "AliNanoAODTrackMapping.h"
+#include "AliNanoAODTrack.h"
+#include "AliAnalysisManager.h"
+#include "AliVEvent.h"
+#include "AliLog.h"
+#include <iostream>
+
+
+ClassImp(AliNanoAODTrackColumns)
+
+AliNanoAODTrackColumns::AliNanoAODTrackColumns() :
+  TObject(),
+  fVarNames(),
+  fVarNamesInt(),
+  fVarIndex(),
+  fVarIndexInt(),
+  fEvent(0),
+  fEntry(-1),
+  fNTracks(0),
+  fColumns(),
+  fColumnsInt(),
+  fNanoFlags(),
+  fLabels()
+{
+  /// default ctor
+}
+
+Int_t AliNanoAODTrackColumns::AddColumn(const char * varName) {
+  /// Add a column for the float variable varName of the mapping.
+  /// Returns the handle of the column, to be used with GetColumn()
+
+  fVarNames.push_back(varName);
+  fVarIndex.clear();
+  return fVarNames.size()-1;
+}
+
+Int_t AliNanoAODTrackColumns::AddColumnInt(const char * varName) {
+  /// Add a column for the int variable varName of the mapping.
+  /// Returns the handle of the column, to be used with GetColumnInt()
+
+  fVarNamesInt.push_back(varName);
+  fVarIndexInt.clear();
+  return fVarNamesInt.size()-1;
+}
+
+void AliNanoAODTrackColumns::ResolveColumns() {
+  /// Find the mapping index of the variables of all columns
+
+  AliNanoAODTrackMapping * mapping = AliNanoAODTrackMapping::GetInstance();
+
+  fVarIndex.resize(fVarNames.size());
+  for (UInt_t icol = 0; icol < fVarNames.size(); icol++) {
+    if (mapping->IsIntVar(fVarNames[icol]))
+      AliFatal(Form("Variable %s is an int variable, use AddColumnInt", fVarNames[icol].Data()));
+    fVarIndex[icol] = mapping->GetVarIndex(fVarNames[icol]);
+    if (fVarIndex[icol] < 0 || fVarIndex[icol] >= mapping->GetSize())
+      AliFatal(Form("Variable %s not in the NanoAOD tracks", fVarNames[icol].Data()));
+  }
+
+  fVarIndexInt.resize(fVarNamesInt.size());
+  for (UInt_t icol = 0; icol < fVarNamesInt.size(); icol++) {
+    if (!mapping->IsIntVar(fVarNamesInt[icol]))
+      AliFatal(Form("Variable %s is not an int variable, use AddColumn", fVarNamesInt[icol].Data()));
+    // Status is two ints (high and low word), it does not fit in one column
+    if (fVarNamesInt[icol] == "Status")
+      AliFatal("Status cannot be a column, use AliNanoAODTrack::GetStatus()");
+    fVarIndexInt[icol] = mapping->GetVarIndex(fVarNamesInt[icol]);
+    if (fVarIndexInt[icol] < 0 || fVarIndexInt[icol] >= mapping->GetSizeInt())
+      AliFatal(Form("Int variable %s not in the NanoAOD tracks", fVarNamesInt[icol].Data()));
+  }
+}
+
+Bool_t AliNanoAODTrackColumns::Fill(AliVEvent * event) {
+  /// Copy the variables of the columns of all tracks of the event.
+  /// Nothing is done if the columns were already filled with this event
+  /// at the current entry of the analysis manager.
+  /// Returns kFALSE if the tracks of the event are not NanoAOD tracks.
+
+  AliAnalysisManager *mgr = AliAnalysisManager::GetAnalysisManager();
+  Long64_t entry = (mgr ? mgr->GetCurrentEntry() : -1);
+  if (entry >= 0 && entry == fEntry && event == fEvent) return kTRUE;
+
+  Reset();
+  if (!event) return kFALSE;
+
+  if (fVarIndex.size() != fVarNames.size() || fVarIndexInt.size() != fVarNamesInt.size())
+    ResolveColumns();
+
+  const Int_t nTracks = event->GetNumberOfTracks();
+  const Int_t nCols = fVarIndex.size();
+  const Int_t nColsInt = fVarIndexInt.size();
+
+  fColumns.resize(nCols*nTracks);
+  fColumnsInt.resize(nColsInt*nTracks);
+  fNanoFlags.resize(nTracks);
+  fLabels.resize(nTracks);
+
+  for (Int_t itrack = 0; itrack < nTracks; itrack++) {
+    const AliNanoAODTrack * track = dynamic_cast<const AliNanoAODTrack*>(event->GetTrack(itrack));
+    if (!track) {
+      AliError(Form("Track %d is not a NanoAOD track", itrack));
+      Reset();
+      return kFALSE;
+    }
+    for (Int_t icol = 0; icol < nCols; icol++)
+      fColumns[icol*nTracks+itrack] = track->GetVar(fVarIndex[icol]);
+    for (Int_t icol = 0; icol < nColsInt; icol++)
+      fColumnsInt[icol*nTracks+itrack] = track->GetVarInt(fVarIndexInt[icol]);
+    fNanoFlags[itrack] = track->GetNanoFlags();
+    fLabels[itrack] = track->GetLabel();
+  }
+
+  fNTracks = nTracks;
+  fEvent = event;
+  fEntry = entry;
+
+  return kTRUE;
+}
+
+void AliNanoAODTrackColumns::Reset() {
+  /// Empty the columns, the next Fill() reads the event again
+
+  fEvent = 0;
+  fEntry = -1;
+  fNTracks = 0;
+  fColumns.clear();
+  fColumnsInt.clear();
+  fNanoFlags.clear();
+  fLabels.clear();
+}
+
+void  AliNanoAODTrackColumns::Print(const Option_t* /*opt*/) const {
+  std::cout << "Printing AliNanoAODTrackColumns (" << fNTracks << " tracks)" << std::endl;
+
+  for (UInt_t icol = 0; icol<fVarNames.size(); icol++)
+    std::cout << " " << icol << " " << fVarNames[icol] << std::endl;
+  for (UInt_t icol = 0; icol<fVarNamesInt.size(); icol++)
+    std::cout << " " << icol << " " << fVarNamesInt[icol] << " (int)" << std::endl;
+}
@@ -0,0 +1,89 @@
+/// \class AliNanoAODTrackColumns
+/// \brief Columnar view of the NanoAOD tracks of an event
+///
+/// The variables of the AliNanoAODTrack objects are stored per track,
+/// and each getter of the AliVTrack interface resolves the index of its
+/// variable in the AliNanoAODTrackMapping. Analyses reading the same
+/// variables for every track in nested loops can instead copy them once
+/// per event into one contiguous array per variable (column):
+///
+///     // at configuration, keep the handles
+///     fPtCol    = fColumns.AddColumn("pt");
+///     fNclsCol  = fColumns.AddColumnInt("TPCncls");
+///     // per event
+///     fColumns.Fill(fInputEvent);
+///     const Double_t * pt   = fColumns.GetColumn(fPtCol);
+///     const Int_t    * ncls = fColumns.GetColumnInt(fNclsCol);
+///     for (Int_t i = 0; i < fColumns.GetNTracks(); i++) ... pt[i] ... ncls[i]
+///
+/// Column i of track j holds the same value as the corresponding getter
+/// of track j of the event. The variable names are the ones of the
+/// mapping (AliNanoAODTrackMapping::GetVarIndex), including custom
+/// variables. The names are resolved into mapping indices once, in the
+/// first Fill(), when the mapping of the input is available; a float
+/// variable added with AddColumnInt, or an int one with AddColumn, is a
+/// fatal error. Status (two ints) cannot be a column. The tracks
+/// themselves are not modified and stay usable through AliVTrack.
+
+#ifndef _ALINANOAODTRACKCOLUMNS_H_
+#define _ALINANOAODTRACKCOLUMNS_H_
+
+#include <vector>
+#include "TObject.h"
+#include "TString.h"
+#include "AliNanoAODTrack.h"
+
+class AliVEvent;
+
+class AliNanoAODTrackColumns : public TObject
+{
+public:
+  AliNanoAODTrackColumns();
+  virtual ~AliNanoAODTrackColumns(){;}
+
+  void Print(const Option_t * opt = "") const;
+
+  Int_t AddColumn(const char * varName);
+  Int_t AddColumnInt(const char * varName);
+
+  Bool_t Fill(AliVEvent * event);
+  void   Reset();
+
+  Int_t GetNTracks()     const { return fNTracks;            }
+  Int_t GetNColumns()    const { return fVarNames.size();    }
+  Int_t GetNColumnsInt() const { return fVarNamesInt.size(); }
+
+  /// Values of the float variable of the column for all tracks of the event
+  const Double_t * GetColumn(Int_t column)    const { return fColumns.data()    + column*fNTracks; }
+  /// Values of the int variable of the column for all tracks of the event
+  const Int_t    * GetColumnInt(Int_t column) const { return fColumnsInt.data() + column*fNTracks; }
+  /// NanoAOD flags (AliNanoAODTrack::ENanoFlags) of all tracks of the event
+  const UInt_t   * GetNanoFlags()             const { return fNanoFlags.data(); }
+  /// MC labels of all tracks of the event
+  const Int_t    * GetLabels()                const { return fLabels.data();    }
+
+  Short_t GetCharge(Int_t track) const { return TESTBIT(fNanoFlags[track], AliNanoAODTrack::kNanoCharge) ? 1 : -1; }
+
+private:
+
+  void ResolveColumns();
+
+  std::vector<TString> fVarNames;    ///< Names of the float variables of the columns
+  std::vector<TString> fVarNamesInt; ///< Names of the int variables of the columns
+  std::vector<Int_t> fVarIndex;      //!<! Mapping index of the float variables
+  std::vector<Int_t> fVarIndexInt;   //!<! Mapping index of the int variables
+
+  const AliVEvent * fEvent;          //!<! Event the columns were filled with
+  Long64_t fEntry;                   //!<! Entry of the analysis manager the columns were filled at
+  Int_t fNTracks;                    //!<! Number of tracks of the event
+
+  std::vector<Double_t> fColumns;    //!<! Float columns, one after the other
+  std::vector<Int_t> fColumnsInt;    //!<! Int columns, one after the other
+  std::vector<UInt_t> fNanoFlags;    //!<! NanoAOD flags of the tracks
+  std::vector<Int_t> fLabels;        //!<! MC labels of the tracks
+
+  ClassDef(AliNanoAODTrackColumns, 1)
+
+};
+
+#endif /* _ALINANOAODTRACKCOLUMNS_H_ */
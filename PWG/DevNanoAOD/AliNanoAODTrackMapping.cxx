@@ -271,6 +271,22 @@ Int_t AliNanoAODTrackMapping::GetVarIndex(TString varName){
   
 }
 
+Bool_t AliNanoAODTrackMapping::IsIntVar(TString varName) const {
+  /// Whether the variable is stored in the int array, i.e. its index
+  /// from GetVarIndex is to be used with GetVarInt.
+  /// Status takes two ints (high and low word), starting at its index.
+
+  return (varName == "TPCncls"          ||
+          varName == "TPCnclsF"         ||
+          varName == "TPCNCrossedRows"  ||
+          varName == "TPCsignalN"       ||
+          varName == "TRDntrackletsPID" ||
+          varName == "TRDnClusters"     ||
+          varName == "TPCnclsS"         ||
+          varName == "FilterMap"        ||
+          varName == "Status"           );
+}
+
 const char * AliNanoAODTrackMapping::GetVarName(Int_t index) const {
   /// Get Variable name from index
 
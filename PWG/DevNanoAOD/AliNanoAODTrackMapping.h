@@ -32,6 +32,7 @@ public:
   const char * GetVarName(Int_t index) const;
   const char * GetVarNameInt(Int_t index) const;
   Int_t GetVarIndex(TString varName); // cannot be const (uses stl map)
+  Bool_t IsIntVar(TString varName) const; // variable stored in the int array (GetVarInt)
 
   //TODO: implement custom variables
 
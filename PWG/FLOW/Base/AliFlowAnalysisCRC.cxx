@@ -45,6 +45,7 @@
 #include "AliFlowVector.h"
 #include "AliFlowTrackSimple.h"
 #include "AliFlowAnalysisCRC.h"
+#include "AliFlowQVectorBuilder.h"
 #include "AliLog.h"
 #include "TRandom.h"
 #include "TF1.h"
@@ -148,6 +149,7 @@ fUseQvectorTerms(kFALSE),
 fReQ(NULL),
 fImQ(NULL),
 fSpk(NULL),
+fQVectorBuilder(NULL),
 fReQGF(NULL),
 fImQGF(NULL),
 fIntFlowCorrelationsEBE(NULL),
@@ -421,6 +423,7 @@ AliFlowAnalysisCRC::~AliFlowAnalysisCRC()
   // destructor
   delete fHistList;
   delete fTempList;
+  delete fQVectorBuilder;
   if(fCRCQVecWeightsList) delete fCRCQVecWeightsList;
   if(fCRCZDCCalibList)    delete fCRCZDCCalibList;
   if(fCRCZDC2DCutList)    delete fCRCZDC2DCutList;
@@ -778,6 +781,10 @@ void AliFlowAnalysisCRC::Make(AliFlowEventSimple* anEvent)
     }
   }
 
+  if(!fQVectorBuilder) fQVectorBuilder = new AliFlowQVectorBuilder(12,8);
+  fQVectorBuilder->SetHarmonic(n);
+  fQVectorBuilder->Reset();
+
   // loop over particles **********************************************************************************************
 
   for(Int_t i=0;i<nPrim;i++) {
@@ -853,23 +860,9 @@ void AliFlowAnalysisCRC::Make(AliFlowEventSimple* anEvent)
           if(fPhiExclZoneHist->GetBinContent(fPhiExclZoneHist->FindBin(dEta,dPhi))<0.5) continue;
         }
 
-        // Calculate Re[Q_{m*n,k}] and Im[Q_{m*n,k}] for this event (m = 1,2,...,12, k = 0,1,...,8):
-        for(Int_t m=0;m<12;m++) // to be improved - hardwired 6
-        {
-          for(Int_t k=0;k<9;k++) // to be improved - hardwired 9
-          {
-            (*fReQ)(m,k)+=pow(wPhiEta*wPhi*wPt*wEta*wTrack,k)*TMath::Cos((m+1)*n*dPhi);
-            (*fImQ)(m,k)+=pow(wPhiEta*wPhi*wPt*wEta*wTrack,k)*TMath::Sin((m+1)*n*dPhi);
-          }
-        }
-        // Calculate S_{p,k} for this event (Remark: final calculation of S_{p,k} follows after the loop over data bellow):
-        for(Int_t p=0;p<8;p++)
-        {
-          for(Int_t k=0;k<9;k++)
-          {
-            (*fSpk)(p,k)+=pow(wPhiEta*wPhi*wPt*wEta*wTrack,k);
-          }
-        }
+        // Buffer the RP for Re[Q_{m*n,k}], Im[Q_{m*n,k}] (m = 1,2,...,12, k = 0,1,...,8) and S_{p,k},
+        // which are accumulated for all RPs at once after the loop over data:
+        fQVectorBuilder->AddTrack(dPhi,wPhiEta*wPhi*wPt*wEta*wTrack);
         // Differential flow:
         if(fCalculateDiffFlow || fCalculate2DDiffFlow)
         {
@@ -1301,6 +1294,11 @@ void AliFlowAnalysisCRC::Make(AliFlowEventSimple* anEvent)
     }
   } // end of for(Int_t i=0;i<nPrim;i++)
 
+  // Accumulate Q_{m*n,k} and S_{p,k} (Remark: final calculation of S_{p,k} follows bellow):
+  fQVectorBuilder->Build();
+  fQVectorBuilder->AddTo(*fReQ,*fImQ);
+  fQVectorBuilder->AddSumOfWeightsTo(*fSpk);
+
   // ************************************************************************************************************
 
   // e) Calculate the final expressions for S_{p,k} and s_{p,k} (important !!!!):
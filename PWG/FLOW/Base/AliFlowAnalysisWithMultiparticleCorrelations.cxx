@@ -24,6 +24,8 @@
 #define AliFlowAnalysisWithMultiparticleCorrelations_cxx
 
 #include "AliFlowAnalysisWithMultiparticleCorrelations.h"
+#include "AliFlowQVectorBuilder.h"
+#include "AliFlowCorrelatorEngine.h"
 
 using std::endl;
 using std::cout;
@@ -63,6 +65,8 @@ AliFlowAnalysisWithMultiparticleCorrelations::AliFlowAnalysisWithMultiparticleCo
  fQvectorList(NULL),       
  fQvectorFlagsPro(NULL),
  fCalculateQvector(kFALSE),
+ fQVectorBuilder(NULL),
+ fCorrelatorEngine(NULL),
  fCalculateDiffQvectors(kFALSE),
  // 3.) Correlations:
  fCorrelationsList(NULL),
@@ -170,6 +174,8 @@ AliFlowAnalysisWithMultiparticleCorrelations::~AliFlowAnalysisWithMultiparticleC
  // Destructor.
  
  delete fHistList;
+ delete fQVectorBuilder;
+ delete fCorrelatorEngine;
 
 } // end of AliFlowAnalysisWithMultiparticleCorrelations::~AliFlowAnalysisWithMultiparticleCorrelations()
 
@@ -343,7 +349,8 @@ void AliFlowAnalysisWithMultiparticleCorrelations::Finish()
 
  // a) Cross-check pointers used in this method;
  // b) Calculate 'standard candles';
- // c) Calculate Q-cumulants.
+ // c) Calculate Q-cumulants;
+ // d) Report the savings of the memoized correlators.
  
  // a) Cross-check pointers used in this method:
  this->CrossCheckPointersUsedInFinish();
@@ -354,6 +361,9 @@ void AliFlowAnalysisWithMultiparticleCorrelations::Finish()
  // c) Calculate Q-cumulants:
  if(fCalculateQcumulants){this->CalculateQcumulants();this->CalculateReferenceFlow();}
 
+ // d) Report the savings of the memoized correlators:
+ if(fCorrelatorEngine){fCorrelatorEngine->Print();}
+
  // ...
 
  printf("\n  ... Closing the curtains ... \n\n");
@@ -2001,6 +2011,8 @@ void AliFlowAnalysisWithMultiparticleCorrelations::FillQvector(AliFlowEventSimpl
  Double_t dEta = 0., wEta = 1.; // pseudorapidity and corresponding eta weight
  Double_t wToPowerP = 1.; // weight raised to power p
  Int_t nCounterRPs = 0;
+ if(!fQVectorBuilder){fQVectorBuilder = new AliFlowQVectorBuilder(fMaxHarmonic*fMaxCorrelator,fMaxCorrelator);}
+ fQVectorBuilder->Reset();
  for(Int_t t=0;t<nTracks;t++) // loop over all tracks
  {
   AliFlowTrackSimple *pTrack = NULL;
@@ -2036,15 +2048,8 @@ void AliFlowAnalysisWithMultiparticleCorrelations::FillQvector(AliFlowEventSimpl
    dEta = pTrack->Eta();
    if(fUseWeights[0][2]){wEta = Weight(dEta,"RP","eta");} // corresponding eta weight
 
-   // Calculate Q-vector components:
-   for(Int_t h=0;h<fMaxHarmonic*fMaxCorrelator+1;h++)
-   {
-    for(Int_t wp=0;wp<fMaxCorrelator+1;wp++) // weight power
-    {
-     if(fUseWeights[0][0]||fUseWeights[0][1]||fUseWeights[0][2]){wToPowerP = pow(wPhi*wPt*wEta,wp);} 
-     fQvector[h][wp] += TComplex(wToPowerP*TMath::Cos(h*dPhi),wToPowerP*TMath::Sin(h*dPhi));
-    } // for(Int_t wp=0;wp<fMaxCorrelator+1;wp++)
-   } // for(Int_t h=0;h<fMaxHarmonic*fMaxCorrelator+1;h++)
+   // Buffer the RP for the Q-vector components, which are accumulated for all RPs at once after the loop over tracks:
+   fQVectorBuilder->AddTrack(dPhi,wPhi*wPt*wEta);
   } // if(pTrack->InRPSelection()) // fill Q-vector components only with reference particles
 
   // Differential Q-vectors (a.k.a. p-vector and q-vector):
@@ -2105,6 +2110,14 @@ void AliFlowAnalysisWithMultiparticleCorrelations::FillQvector(AliFlowEventSimpl
 
  } // for(Int_t t=0;t<nTracks;t++) // loop over all tracks
 
+ // Calculate Q-vector components:
+ fQVectorBuilder->Build();
+ fQVectorBuilder->AddTo(fQvector,fMaxHarmonic*fMaxCorrelator+1,fMaxCorrelator+1);
+
+ // Hand them over to the memoized correlators evaluated in Recursion(...):
+ if(!fCorrelatorEngine){fCorrelatorEngine = new AliFlowCorrelatorEngine();}
+ fCorrelatorEngine->SetQvector(fQvector,fMaxHarmonic*fMaxCorrelator+1,fMaxCorrelator+1);
+
 } // void AliFlowAnalysisWithMultiparticleCorrelations::FillQvector(AliFlowEventSimple *anEvent)
 
 //=======================================================================================================================
@@ -3876,6 +3889,7 @@ void AliFlowAnalysisWithMultiparticleCorrelations::ResetQvector()
    }
   } 
  } 
+ if(fCorrelatorEngine){fCorrelatorEngine->SetQvector(fQvector,fMaxHarmonic*fMaxCorrelator+1,fMaxCorrelator+1);}
 
 } // void AliFlowAnalysisWithMultiparticleCorrelations::ResetQvector()
 
@@ -5023,6 +5037,7 @@ TComplex AliFlowAnalysisWithMultiparticleCorrelations::Recursion(Int_t n, Int_t*
 
 //=======================================================================================================================
 
+/*
 TComplex AliFlowAnalysisWithMultiparticleCorrelations::Recursion(Int_t n, Int_t* harmonic, Int_t mult, Int_t skip) 
 {
  // Calculate multi-particle correlators by using recursion (an improved faster version) originally developed by 
@@ -5059,6 +5074,26 @@ TComplex AliFlowAnalysisWithMultiparticleCorrelations::Recursion(Int_t n, Int_t*
   return c-Double_t(mult)*c2;
 
 } // TComplex AliFlowAnalysisWithMultiparticleCorrelations::Recursion(Int_t n, Int_t* harmonic, Int_t mult, Int_t skip) 
+*/
+
+//=======================================================================================================================
+
+TComplex AliFlowAnalysisWithMultiparticleCorrelations::Recursion(Int_t n, Int_t* harmonic)
+{
+ // Calculate multi-particle correlators by using recursion. All intermediate correlators (keyed by their
+ // sorted harmonics and weight powers) are memoized for the current event by AliFlowCorrelatorEngine,
+ // so that they are shared between the numerators and denominators of all correlators requested in the event.
+ // Supersedes the recursion originally developed by Kristjan Gulbrandsen (gulbrand@nbi.dk), kept above.
+
+ if(!fCorrelatorEngine)
+ {
+  fCorrelatorEngine = new AliFlowCorrelatorEngine();
+  fCorrelatorEngine->SetQvector(fQvector,fMaxHarmonic*fMaxCorrelator+1,fMaxCorrelator+1);
+ }
+
+ return fCorrelatorEngine->Correlator(n,harmonic);
+
+} // TComplex AliFlowAnalysisWithMultiparticleCorrelations::Recursion(Int_t n, Int_t* harmonic)
 
 //=======================================================================================================================
 
@@ -5635,10 +5670,24 @@ Double_t AliFlowAnalysisWithMultiparticleCorrelations::CorrelationPsi2nPsi1n(Int
    Fatal(sMethodName.Data(),"switch(k)"); // TBI
  } // switch(k)
 
- // Calculate weight and correlators:
- Double_t dWeight = Recursion(order,harmonics0.GetArray()).Re(); // weight is 'number of combinations' by default
- TComplex cNum1 = Recursion(order,harmonics1.GetArray())/dWeight;
- TComplex cNum2 = Recursion(order,harmonics2.GetArray())/dWeight;
+ // Calculate weight and correlators (in one batch, they share most of the intermediate correlators):
+ TArrayI harmonics(3*order);
+ for(Int_t h=0;h<order;h++)
+ {
+  harmonics[h] = harmonics0[h];
+  harmonics[order+h] = harmonics1[h];
+  harmonics[2*order+h] = harmonics2[h];
+ }
+ TComplex correlators[3];
+ if(!fCorrelatorEngine)
+ {
+  fCorrelatorEngine = new AliFlowCorrelatorEngine();
+  fCorrelatorEngine->SetQvector(fQvector,fMaxHarmonic*fMaxCorrelator+1,fMaxCorrelator+1);
+ }
+ fCorrelatorEngine->Evaluate(3,order,harmonics.GetArray(),correlators);
+ Double_t dWeight = correlators[0].Re(); // weight is 'number of combinations' by default
+ TComplex cNum1 = correlators[1]/dWeight;
+ TComplex cNum2 = correlators[2]/dWeight;
  ratio = cNum1.Re()/cNum2.Re();
 
  return ratio;
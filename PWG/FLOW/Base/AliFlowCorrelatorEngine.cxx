@@ -0,0 +1,291 @@
+/*************************************************************************
+* Copyright(c) 1998-2008, ALICE Experiment at CERN, All rights reserved. *
+*                                                                        *
+* Author: The ALICE Off-line Project.                                    *
+* Contributors are mentioned in the code where appropriate.              *
+*                                                                        *
+* Permission to use, copy, modify and distribute this software and its   *
+* documentation strictly for non-commercial purposes is hereby granted   *
+* without fee, provided that the above copyright notice appears in all   *
+* copies and that both the copyright notice and this permission notice   *
+* appear in the supporting documentation. The authors make no claims     *
+* about the suitability of this software for any purpose. It is          *
+* provided "as is" without express or implied warranty.                  *
+**************************************************************************/
+
+#include <algorithm>
+#include "AliFlowCorrelatorEngine.h"
+#include "TComplex.h"
+#include "TMath.h"
+
+//********************************************************************
+// AliFlowCorrelatorEngine:                                          *
+// Memoized evaluation of the generic multi-particle correlators     *
+// from the Q-vectors of an event.                                   *
+//********************************************************************
+
+ClassImp(AliFlowCorrelatorEngine)
+
+//________________________________________________________________________
+
+AliFlowCorrelatorEngine::AliFlowCorrelatorEngine():
+  TObject(),
+  fNHarmonics(0),
+  fNPowers(0),
+  fQ(),
+  fCodes(),
+  fBegin(),
+  fOrder(),
+  fValue(),
+  fCalls(),
+  fDeps(),
+  fDepBegin(),
+  fTable(1024,-1),
+  fRequested(),
+  fNRequested(0),
+  fNMemoHits(0),
+  fNEvaluated(0),
+  fNNaiveCalls(0.)
+{
+  // constructor
+}
+
+//________________________________________________________________________
+
+void AliFlowCorrelatorEngine::SetQvector(const TComplex (*q)[9], Int_t nHarmonics, Int_t nPowers)
+{
+  // Copy the Q-vector components of the new event and forget the correlators of the previous one.
+
+  fNHarmonics = nHarmonics;
+  fNPowers = TMath::Min(nPowers,9);
+  fQ.resize(fNHarmonics*fNPowers);
+  for(Int_t h=0;h<fNHarmonics;h++)
+  {
+   for(Int_t p=0;p<fNPowers;p++)
+   {
+    fQ[h*fNPowers+p] = std::complex<double>(q[h][p].Re(),q[h][p].Im());
+   }
+  }
+  Reset();
+}
+
+//________________________________________________________________________
+
+void AliFlowCorrelatorEngine::Reset()
+{
+  // Forget the memoized correlators, the buffers keep their capacity.
+
+  fCodes.clear();
+  fBegin.clear();
+  fOrder.clear();
+  fValue.clear();
+  fCalls.clear();
+  fDeps.clear();
+  fDepBegin.clear();
+  std::fill(fTable.begin(),fTable.end(),-1);
+}
+
+//________________________________________________________________________
+
+std::complex<double> AliFlowCorrelatorEngine::Q(Int_t h, Int_t p) const
+{
+  // Q_{-h,p} = Q_{h,p}^*, components which are not stored are zero
+
+  const Int_t absh = h<0 ? -h : h;
+  if(absh>=fNHarmonics || p>=fNPowers){return std::complex<double>(0.,0.);}
+  const std::complex<double>& q = fQ[absh*fNPowers+p];
+  return h<0 ? std::conj(q) : q;
+}
+
+//________________________________________________________________________
+
+UInt_t AliFlowCorrelatorEngine::Hash(const UShort_t* codes, Int_t n) const
+{
+  // FNV-1a over the slot codes
+
+  UInt_t hash = 2166136261u;
+  for(Int_t i=0;i<n;i++)
+  {
+   hash = (hash^codes[i])*16777619u;
+  }
+  return hash^(hash>>15);
+}
+
+//________________________________________________________________________
+
+void AliFlowCorrelatorEngine::Rehash(Int_t capacity)
+{
+  // Rebuild the hash table with the given capacity (a power of two).
+
+  fTable.assign(capacity,-1);
+  const UInt_t mask = capacity-1;
+  for(Int_t node=0;node<(Int_t)fOrder.size();node++)
+  {
+   UInt_t slot = Hash(&fCodes[fBegin[node]],fOrder[node])&mask;
+   while(fTable[slot]>=0){slot = (slot+1)&mask;}
+   fTable[slot] = node;
+  }
+}
+
+//________________________________________________________________________
+
+Int_t AliFlowCorrelatorEngine::FindOrInsert(const UShort_t* codes, Int_t n)
+{
+  // Return the node of the sorted slot codes; a new node is queued for evaluation in fLevel[n].
+
+  if(2*(fOrder.size()+1)>fTable.size()){Rehash(2*fTable.size());}
+  const UInt_t mask = fTable.size()-1;
+  UInt_t slot = Hash(codes,n)&mask;
+  for(;fTable[slot]>=0;slot=(slot+1)&mask)
+  {
+   const Int_t node = fTable[slot];
+   if(fOrder[node]!=n){continue;}
+   const UShort_t *other = &fCodes[fBegin[node]];
+   Int_t i = 0;
+   while(i<n && other[i]==codes[i]){i++;}
+   if(i==n){return node;}
+  }
+
+  const Int_t node = fOrder.size();
+  fTable[slot] = node;
+  fBegin.push_back(fCodes.size());
+  fCodes.insert(fCodes.end(),codes,codes+n);
+  fOrder.push_back(n);
+  fValue.push_back(std::complex<double>(0.,0.));
+  fCalls.push_back(0.);
+  fDepBegin.push_back(-1);
+  fLevel[n].push_back(node);
+  return node;
+}
+
+//________________________________________________________________________
+
+void AliFlowCorrelatorEngine::Expand(Int_t node)
+{
+  // Queue the subproblems of node: the last slot s_n is either a new particle or merged into one of s_1..s_{n-1}.
+
+  const Int_t n = fOrder[node];
+  fDepBegin[node] = fDeps.size();
+  if(n==1){return;}
+
+  UShort_t slots[kMaxOrder];
+  std::copy(fCodes.begin()+fBegin[node],fCodes.begin()+fBegin[node]+n,slots);
+  const Int_t hLast = Harmonic(slots[n-1]);
+  const Int_t pLast = Power(slots[n-1]);
+
+  fDeps.push_back(FindOrInsert(slots,n-1));
+  UShort_t merged[kMaxOrder];
+  for(Int_t j=0;j<n-1;j++)
+  {
+   std::copy(slots,slots+n-1,merged);
+   const UShort_t code = Encode(Harmonic(slots[j])+hLast,Power(slots[j])+pLast);
+   // keep the codes sorted: move the merged slot to its place
+   Int_t k = j;
+   while(k>0 && merged[k-1]>code){merged[k] = merged[k-1]; k--;}
+   while(k<n-2 && merged[k+1]<code){merged[k] = merged[k+1]; k++;}
+   merged[k] = code;
+   fDeps.push_back(FindOrInsert(merged,n-1));
+  }
+}
+
+//________________________________________________________________________
+
+void AliFlowCorrelatorEngine::Compute(Int_t node)
+{
+  // N<s_1..s_n> = Q_{s_n} N<s_1..s_{n-1}> - sum_{j<n} N<s_1..(s_j+s_n)..s_{n-1}>
+
+  const Int_t n = fOrder[node];
+  const UShort_t last = fCodes[fBegin[node]+n-1];
+  std::complex<double> value = Q(Harmonic(last),Power(last));
+  Double_t calls = 1.;
+  if(n>1)
+  {
+   const Int_t *deps = &fDeps[fDepBegin[node]];
+   value *= fValue[deps[0]];
+   calls += fCalls[deps[0]];
+   for(Int_t j=1;j<n;j++)
+   {
+    value -= fValue[deps[j]];
+    calls += fCalls[deps[j]];
+   }
+  }
+  fValue[node] = value;
+  fCalls[node] = calls;
+  fNEvaluated++;
+}
+
+//________________________________________________________________________
+
+void AliFlowCorrelatorEngine::Evaluate(Int_t nCorrelators, Int_t n, const Int_t* harmonics, TComplex* result)
+{
+  // Evaluate a batch of n-particle correlators: look them up in the memo, expand the missing ones into
+  // the graph of their subproblems (from n slots down to one) and compute the new nodes from one slot up.
+
+  if(n<1 || n>kMaxOrder)
+  {
+   Fatal("Evaluate","correlators of order %d are not supported (1 <= n <= %d)",n,(Int_t)kMaxOrder);
+  }
+
+  fRequested.resize(nCorrelators);
+  UShort_t codes[kMaxOrder];
+  for(Int_t c=0;c<nCorrelators;c++)
+  {
+   const Int_t *h = harmonics+c*n;
+   Int_t sumAbs = 0;
+   for(Int_t i=0;i<n;i++)
+   {
+    sumAbs += TMath::Abs(h[i]);
+    // insertion sort, n is small
+    const UShort_t code = Encode(h[i],1);
+    Int_t k = i;
+    while(k>0 && codes[k-1]>code){codes[k] = codes[k-1]; k--;}
+    codes[k] = code;
+   }
+   if(sumAbs>127){Fatal("Evaluate","sum of |harmonics| %d above 127",sumAbs);}
+   const Int_t nNodes = fOrder.size();
+   fRequested[c] = FindOrInsert(codes,n);
+   if(fRequested[c]<nNodes){fNMemoHits++;}
+  }
+  fNRequested += nCorrelators;
+
+  // expansions of nodes with m slots only queue nodes with m-1 slots
+  for(Int_t m=n;m>=1;m--)
+  {
+   for(size_t i=0;i<fLevel[m].size();i++){Expand(fLevel[m][i]);}
+  }
+  for(Int_t m=1;m<=n;m++)
+  {
+   for(size_t i=0;i<fLevel[m].size();i++){Compute(fLevel[m][i]);}
+   fLevel[m].clear();
+  }
+
+  for(Int_t c=0;c<nCorrelators;c++)
+  {
+   const std::complex<double>& v = fValue[fRequested[c]];
+   result[c] = TComplex(v.real(),v.imag());
+   fNNaiveCalls += fCalls[fRequested[c]];
+  }
+}
+
+//________________________________________________________________________
+
+TComplex AliFlowCorrelatorEngine::Correlator(Int_t n, const Int_t* harmonic)
+{
+  // Single n-particle correlator.
+
+  TComplex result;
+  Evaluate(1,n,harmonic,&result);
+  return result;
+}
+
+//________________________________________________________________________
+
+void AliFlowCorrelatorEngine::Print(Option_t* /*option*/) const
+{
+  // Print the statistics of the memoization.
+
+  printf("\n AliFlowCorrelatorEngine: %lld correlators requested (%lld found in the memo),\n",fNRequested,fNMemoHits);
+  printf("   %lld subproblems evaluated instead of %.0f recursive calls",fNEvaluated,fNNaiveCalls);
+  if(fNEvaluated>0){printf(" (%.1fx fewer)",fNNaiveCalls/fNEvaluated);}
+  printf("\n");
+}
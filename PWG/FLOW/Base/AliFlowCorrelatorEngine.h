@@ -0,0 +1,89 @@
+/* Copyright(c) 1998-1999, ALICE Experiment at CERN, All rights reserved. *
+* See cxx source for full Copyright notice */
+/* $Id$ */
+
+#ifndef ALIFLOWCORRELATORENGINE_H
+#define ALIFLOWCORRELATORENGINE_H
+
+#include <complex>
+#include <vector>
+#include "TObject.h"
+
+class TComplex;
+
+//********************************************************************
+// AliFlowCorrelatorEngine:                                          *
+// Memoized evaluation of the generic multi-particle correlators     *
+//   N<h_1,p_1;...;h_n,p_n> = sum_{i_1!=...!=i_n} prod_k             *
+//                            w_{i_k}^{p_k} exp(i*h_k*phi_{i_k})     *
+// from the Q-vectors Q_{h,p} of an event, with the recursion        *
+//   N<s_1..s_n> = Q_{s_n} N<s_1..s_{n-1}>                           *
+//               - sum_{j<n} N<s_1..(s_j+s_n)..s_{n-1}>              *
+// Every N is symmetric in its (h,p) slots, so the subproblems are   *
+// keyed by the sorted list of slots and each one is computed once   *
+// per event, whichever correlator (numerator or denominator)        *
+// requests it. A batch of correlators is expanded into the graph of *
+// the subproblems it needs, which is then evaluated level by level  *
+// (in increasing number of slots), i.e. in topological order.       *
+//********************************************************************
+
+class AliFlowCorrelatorEngine: public TObject {
+ public:
+  enum {kMaxOrder = 16};
+
+  AliFlowCorrelatorEngine();
+  virtual ~AliFlowCorrelatorEngine() {}
+
+  // copy Q_{h,p} = q[h][p] for 0 <= h < nHarmonics and 0 <= p < nPowers, and forget the memoized correlators
+  void SetQvector(const TComplex (*q)[9], Int_t nHarmonics, Int_t nPowers);
+  void Reset();                                     // forget the memoized correlators (the Q-vectors are kept)
+
+  // n-particle correlator <exp[i(h_1*phi_1+...+h_n*phi_n)]> (numerator, unit weight powers)
+  TComplex Correlator(Int_t n, const Int_t* harmonic);
+  // nCorrelators n-particle correlators, harmonics stored row-major (nCorrelators x n), result owned by the caller
+  void Evaluate(Int_t nCorrelators, Int_t n, const Int_t* harmonics, TComplex* result);
+
+  // statistics accumulated over all events
+  Long64_t GetNRequested() const {return fNRequested;}   // correlators requested
+  Long64_t GetNMemoHits() const {return fNMemoHits;}     // requested correlators found in the memo
+  Long64_t GetNEvaluated() const {return fNEvaluated;}   // subproblems actually computed
+  Double_t GetNNaiveCalls() const {return fNNaiveCalls;} // calls the same recursion would have made without memo
+  virtual void Print(Option_t* option="") const;
+
+ private:
+  AliFlowCorrelatorEngine(const AliFlowCorrelatorEngine& other);
+  AliFlowCorrelatorEngine& operator=(const AliFlowCorrelatorEngine& other);
+
+  std::complex<double> Q(Int_t h, Int_t p) const;
+  Int_t FindOrInsert(const UShort_t* codes, Int_t n);  // node of the sorted slot codes, -1 if new nodes were queued
+  UInt_t Hash(const UShort_t* codes, Int_t n) const;
+  void Rehash(Int_t capacity);
+  void Expand(Int_t node);                           // queue the dependencies of node
+  void Compute(Int_t node);                          // value of node from its dependencies
+
+  static UShort_t Encode(Int_t h, Int_t p) {return (UShort_t)(((h+128)<<5)|p);}
+  static Int_t Harmonic(UShort_t code) {return (code>>5)-128;}
+  static Int_t Power(UShort_t code) {return code&31;}
+
+  Int_t fNHarmonics;                          // number of stored harmonics h
+  Int_t fNPowers;                             // number of stored weight powers p
+  std::vector<std::complex<double> > fQ;      //! Q_{h,p}, index h*fNPowers+p
+  std::vector<UShort_t> fCodes;               //! sorted slot codes of all nodes, concatenated
+  std::vector<Int_t> fBegin;                  //! first code of each node in fCodes
+  std::vector<UChar_t> fOrder;                //! number of slots of each node
+  std::vector<std::complex<double> > fValue;  //! value of each node
+  std::vector<Double_t> fCalls;               //! calls of the unmemoized recursion for each node
+  std::vector<Int_t> fDeps;                   //! dependencies of each node, concatenated
+  std::vector<Int_t> fDepBegin;               //! first dependency of each node in fDeps
+  std::vector<Int_t> fTable;                  //! open addressing hash table of the nodes (-1 = empty)
+  std::vector<Int_t> fLevel[kMaxOrder+1];     //! nodes to be computed, by number of slots
+  std::vector<Int_t> fRequested;              //! nodes of the current batch
+  Long64_t fNRequested;                       // correlators requested
+  Long64_t fNMemoHits;                        // requested correlators found in the memo
+  Long64_t fNEvaluated;                       // subproblems computed
+  Double_t fNNaiveCalls;                      // recursion calls needed without memoization
+
+  ClassDef(AliFlowCorrelatorEngine,1)
+};
+
+#endif
@@ -0,0 +1,179 @@
+/*************************************************************************
+* Copyright(c) 1998-2008, ALICE Experiment at CERN, All rights reserved. *
+*                                                                        *
+* Author: The ALICE Off-line Project.                                    *
+* Contributors are mentioned in the code where appropriate.              *
+*                                                                        *
+* Permission to use, copy, modify and distribute this software and its   *
+* documentation strictly for non-commercial purposes is hereby granted   *
+* without fee, provided that the above copyright notice appears in all   *
+* copies and that both the copyright notice and this permission notice   *
+* appear in the supporting documentation. The authors make no claims     *
+* about the suitability of this software for any purpose. It is          *
+* provided "as is" without express or implied warranty.                  *
+**************************************************************************/
+
+#include "AliFlowQVectorBuilder.h"
+#include "TComplex.h"
+#include "TMath.h"
+#include "TMatrixD.h"
+
+//********************************************************************
+// AliFlowQVectorBuilder:                                            *
+// Event-by-event accumulator of the weighted Q-vectors Q_{m*n,k}.   *
+//********************************************************************
+
+ClassImp(AliFlowQVectorBuilder)
+
+//________________________________________________________________________
+
+AliFlowQVectorBuilder::AliFlowQVectorBuilder(Int_t maxMultiple, Int_t maxPower):
+  TObject(),
+  fHarmonic(1),
+  fMaxMultiple(maxMultiple),
+  fMaxPower(maxPower),
+  fPhi(),
+  fWeight(),
+  fCos1(),
+  fSin1(),
+  fCosM(),
+  fSinM(),
+  fWPow(),
+  fReQ((maxMultiple+1)*(maxPower+1),0.),
+  fImQ((maxMultiple+1)*(maxPower+1),0.)
+{
+  // constructor
+}
+
+//________________________________________________________________________
+
+void AliFlowQVectorBuilder::Reset()
+{
+  // Clear the buffered tracks and the accumulated Q-vectors, the buffers keep their capacity.
+
+  fPhi.clear();
+  fWeight.clear();
+  for(size_t i=0;i<fReQ.size();i++)
+  {
+   fReQ[i] = 0.;
+   fImQ[i] = 0.;
+  }
+}
+
+//________________________________________________________________________
+
+void AliFlowQVectorBuilder::Build()
+{
+  // Accumulate the buffered tracks into Q_{m*n,k} and clear the track buffers.
+  // The loops run over tracks in the innermost position on contiguous arrays.
+
+  const Int_t nTracks = (Int_t)fPhi.size();
+  if(nTracks==0){return;}
+  fCos1.resize(nTracks);
+  fSin1.resize(nTracks);
+  fCosM.resize(nTracks);
+  fSinM.resize(nTracks);
+  fWPow.resize(nTracks);
+
+  const Double_t *phi = &fPhi[0];
+  const Double_t *w = &fWeight[0];
+  Double_t *c1 = &fCos1[0];
+  Double_t *s1 = &fSin1[0];
+  Double_t *cm = &fCosM[0];
+  Double_t *sm = &fSinM[0];
+  Double_t *wk = &fWPow[0];
+
+  // the only transcendental calls: one sin/cos pair per track
+  for(Int_t t=0;t<nTracks;t++)
+  {
+   c1[t] = TMath::Cos(fHarmonic*phi[t]);
+   s1[t] = TMath::Sin(fHarmonic*phi[t]);
+   cm[t] = 1.; // m = 0
+   sm[t] = 0.;
+  }
+
+  const Int_t nPowers = fMaxPower+1;
+  for(Int_t m=0;m<=fMaxMultiple;m++)
+  {
+   if(m>0)
+   {
+    // exp(i*m*n*phi) = exp(i*(m-1)*n*phi)*exp(i*n*phi)
+    for(Int_t t=0;t<nTracks;t++)
+    {
+     const Double_t c = cm[t]*c1[t]-sm[t]*s1[t];
+     const Double_t s = cm[t]*s1[t]+sm[t]*c1[t];
+     cm[t] = c;
+     sm[t] = s;
+    }
+   }
+   for(Int_t t=0;t<nTracks;t++){wk[t] = 1.;}
+   Double_t *reQ = &fReQ[m*nPowers];
+   Double_t *imQ = &fImQ[m*nPowers];
+   for(Int_t k=0;k<nPowers;k++)
+   {
+    Double_t sumRe = 0., sumIm = 0.;
+    for(Int_t t=0;t<nTracks;t++)
+    {
+     sumRe += wk[t]*cm[t];
+     sumIm += wk[t]*sm[t];
+     wk[t] *= w[t];
+    }
+    reQ[k] += sumRe;
+    imQ[k] += sumIm;
+   }
+  }
+
+  fPhi.clear();
+  fWeight.clear();
+}
+
+//________________________________________________________________________
+
+void AliFlowQVectorBuilder::AddTo(TMatrixD& reQ, TMatrixD& imQ) const
+{
+  // reQ(m,k) += Re[Q_{(m+1)*n,k}] and imQ(m,k) += Im[Q_{(m+1)*n,k}]
+
+  const Int_t nM = TMath::Min(reQ.GetNrows(),fMaxMultiple);
+  const Int_t nK = TMath::Min(reQ.GetNcols(),fMaxPower+1);
+  for(Int_t m=0;m<nM;m++)
+  {
+   for(Int_t k=0;k<nK;k++)
+   {
+    reQ(m,k) += ReQ(m+1,k);
+    imQ(m,k) += ImQ(m+1,k);
+   }
+  }
+}
+
+//________________________________________________________________________
+
+void AliFlowQVectorBuilder::AddSumOfWeightsTo(TMatrixD& spk) const
+{
+  // spk(p,k) += sum_i w_i^k for all p
+
+  const Int_t nK = TMath::Min(spk.GetNcols(),fMaxPower+1);
+  for(Int_t p=0;p<spk.GetNrows();p++)
+  {
+   for(Int_t k=0;k<nK;k++)
+   {
+    spk(p,k) += S(k);
+   }
+  }
+}
+
+//________________________________________________________________________
+
+void AliFlowQVectorBuilder::AddTo(TComplex (*q)[9], Int_t nHarmonics, Int_t nPowers) const
+{
+  // q[h][k] += Q_{h*n,k} for h < nHarmonics and k < nPowers
+
+  const Int_t nH = TMath::Min(nHarmonics,fMaxMultiple+1);
+  const Int_t nK = TMath::Min(TMath::Min(nPowers,fMaxPower+1),9);
+  for(Int_t h=0;h<nH;h++)
+  {
+   for(Int_t k=0;k<nK;k++)
+   {
+    q[h][k] += TComplex(ReQ(h,k),ImQ(h,k));
+   }
+  }
+}
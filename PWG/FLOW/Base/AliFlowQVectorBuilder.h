@@ -0,0 +1,72 @@
+/* Copyright(c) 1998-1999, ALICE Experiment at CERN, All rights reserved. *
+* See cxx source for full Copyright notice */
+/* $Id$ */
+
+#ifndef ALIFLOWQVECTORBUILDER_H
+#define ALIFLOWQVECTORBUILDER_H
+
+#include <vector>
+#include "TObject.h"
+
+class TMatrixD;
+class TComplex;
+
+//********************************************************************
+// AliFlowQVectorBuilder:                                            *
+// Event-by-event accumulator of the weighted Q-vectors              *
+//   Q_{m*n,k} = sum_i w_i^k exp(i*m*n*phi_i)                        *
+// for m = 0,...,maxMultiple and k = 0,...,maxPower.                 *
+// Tracks are buffered in contiguous (phi, weight) arrays; the       *
+// harmonics are obtained from a single sin/cos per track with the   *
+// recurrence exp(i(m+1)x) = exp(imx)*exp(ix), and the weight powers *
+// incrementally, in loops over tracks which the compiler vectorizes.*
+// Shared by the QC, CRC and MultiparticleCorrelations analyses.     *
+//********************************************************************
+
+class AliFlowQVectorBuilder: public TObject {
+ public:
+  AliFlowQVectorBuilder(Int_t maxMultiple=12, Int_t maxPower=8);
+  virtual ~AliFlowQVectorBuilder() {}
+
+  void SetHarmonic(Int_t n) {fHarmonic = n;}
+  Int_t GetHarmonic() const {return fHarmonic;}
+  Int_t GetMaxMultiple() const {return fMaxMultiple;}
+  Int_t GetMaxPower() const {return fMaxPower;}
+
+  void Reset();                                     // clear buffered tracks and accumulated Q-vectors
+  void AddTrack(Double_t phi, Double_t weight=1.) {fPhi.push_back(phi); fWeight.push_back(weight);}
+  Int_t GetNumberOfTracks() const {return (Int_t)fPhi.size();}
+  void Build();                                     // accumulate the buffered tracks into the Q-vectors
+
+  Double_t ReQ(Int_t m, Int_t k) const {return fReQ[m*(fMaxPower+1)+k];} // Re[Q_{m*n,k}]
+  Double_t ImQ(Int_t m, Int_t k) const {return fImQ[m*(fMaxPower+1)+k];} // Im[Q_{m*n,k}]
+  Double_t S(Int_t k) const {return fReQ[k];}                           // sum_i w_i^k = Q_{0,k}
+
+  // add Q_{(m+1)*n,k} to reQ(m,k) and imQ(m,k), for the layout of the QC and CRC fReQ/fImQ
+  void AddTo(TMatrixD& reQ, TMatrixD& imQ) const;
+  // add (sum_i w_i^k) to spk(p,k) for all p, for the layout of the QC and CRC fSpk
+  void AddSumOfWeightsTo(TMatrixD& spk) const;
+  // add Q_{h,k} to q[h][k] for h = 0,...,maxMultiple (with fHarmonic = 1), for the MPC fQvector
+  void AddTo(TComplex (*q)[9], Int_t nHarmonics, Int_t nPowers) const;
+
+ private:
+  AliFlowQVectorBuilder(const AliFlowQVectorBuilder& other);
+  AliFlowQVectorBuilder& operator=(const AliFlowQVectorBuilder& other);
+
+  Int_t fHarmonic;                 // base harmonic n
+  Int_t fMaxMultiple;              // highest multiple m of the base harmonic
+  Int_t fMaxPower;                 // highest weight power k
+  std::vector<Double_t> fPhi;      //! buffered azimuthal angles
+  std::vector<Double_t> fWeight;   //! buffered weights
+  std::vector<Double_t> fCos1;     //! cos(n*phi) per track
+  std::vector<Double_t> fSin1;     //! sin(n*phi) per track
+  std::vector<Double_t> fCosM;     //! cos(m*n*phi) per track for the current m
+  std::vector<Double_t> fSinM;     //! sin(m*n*phi) per track for the current m
+  std::vector<Double_t> fWPow;     //! w^k per track for the current k
+  std::vector<Double_t> fReQ;      //! Re[Q_{m*n,k}], index m*(fMaxPower+1)+k
+  std::vector<Double_t> fImQ;      //! Im[Q_{m*n,k}], index m*(fMaxPower+1)+k
+
+  ClassDef(AliFlowQVectorBuilder,1)
+};
+
+#endif
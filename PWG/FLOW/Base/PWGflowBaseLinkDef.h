@@ -8,6 +8,8 @@
 #pragma link C++ namespace AliFlowLYZConstants;
 
 #pragma link C++ class AliFlowVector+;
+#pragma link C++ class AliFlowQVectorBuilder+;
+#pragma link C++ class AliFlowCorrelatorEngine+;
 #pragma link C++ class AliFlowTrackSimple+;
 #pragma link C++ class AliFlowEventSimple+;
 
@@ -28,9 +28,14 @@
 // the derivation from THnSparse is obviously against many OO rules. correct would be a common baseclass of THnSparse and THn.
 //
 // Templated version allows also the use of double as storage container
+//
+// FillBatch fills many entries at once: the bins are computed per axis over the whole batch (for equidistant
+// bins in a loop which the compiler vectorizes), the entries are then sorted by bin before being added.
+// With SetNumberOfThreads each thread fills its own shadow buffers, which are added by MergeThreads
 // 
 // Author: Jan Fiete Grosse-Oetringhaus
 
+#include <algorithm>
 #include "AliTHn.h"
 #include "TList.h"
 #include "TCollection.h"
@@ -53,7 +58,15 @@ AliTHnT<TemplateArray, TemplateType>::AliTHnT() :
   axisCache(0),
   fNbinsCache(0),
   fLastVars(0),
-  fLastBins(0)
+  fLastBins(0),
+  fAxisMinCache(0),
+  fAxisMaxCache(0),
+  fAxisEdgesCache(0),
+  fNThreads(0),
+  fShadowValues(),
+  fShadowSumw2(),
+  fBatchBins(),
+  fBatchOrder()
 {
   // Constructor
 }
@@ -69,7 +82,15 @@ AliTHnT<TemplateArray, TemplateType>::AliTHnT(const Char_t* name, const Char_t*
   axisCache(0),
   fNbinsCache(0),
   fLastVars(0),
-  fLastBins(0)
+  fLastBins(0),
+  fAxisMinCache(0),
+  fAxisMaxCache(0),
+  fAxisEdgesCache(0),
+  fNThreads(0),
+  fShadowValues(),
+  fShadowSumw2(),
+  fBatchBins(),
+  fBatchOrder()
 {
   // Constructor
 
@@ -106,7 +127,15 @@ AliTHnT<TemplateArray, TemplateType>::AliTHnT(const AliTHnT &c) :
   axisCache(0),
   fNbinsCache(0),
   fLastVars(0),
-  fLastBins(0)
+  fLastBins(0),
+  fAxisMinCache(0),
+  fAxisMaxCache(0),
+  fAxisEdgesCache(0),
+  fNThreads(0),
+  fShadowValues(),
+  fShadowSumw2(),
+  fBatchBins(),
+  fBatchOrder()
 {
   //
   // AliTHnT copy constructor
@@ -135,6 +164,11 @@ AliTHnT<TemplateArray, TemplateType>::~AliTHnT()
   delete[] fNbinsCache;
   delete[] fLastVars;
   delete[] fLastBins;
+  delete[] fAxisMinCache;
+  delete[] fAxisMaxCache;
+  delete[] fAxisEdgesCache;
+  
+  DeleteShadows();
 }
 
 template <class TemplateArray, typename TemplateType>
@@ -191,9 +225,21 @@ AliTHnT<TemplateArray, TemplateType> &AliTHnT<TemplateArray, TemplateType>::oper
       fValues = 0;
       fSumw2 = 0;
     }
+    // the caches point to the axes of <c>, they are rebuilt at the next Fill
     delete [] axisCache;
-    axisCache = new TAxis*[fNVars];
-    memcpy(axisCache, c.axisCache, fNVars*sizeof(TAxis*));
+    delete [] fNbinsCache;
+    delete [] fLastVars;
+    delete [] fLastBins;
+    delete [] fAxisMinCache;
+    delete [] fAxisMaxCache;
+    delete [] fAxisEdgesCache;
+    axisCache = 0;
+    fNbinsCache = 0;
+    fLastVars = 0;
+    fLastBins = 0;
+    fAxisMinCache = 0;
+    fAxisMaxCache = 0;
+    fAxisEdgesCache = 0;
   }
   return *this;
 }
@@ -288,25 +334,7 @@ void AliTHnT<TemplateArray, TemplateType>::Fill(const Double_t *var, Int_t istep
 
   // fill axis cache
   if (!axisCache)
-  {
-    axisCache = new TAxis*[fNVars];
-    fNbinsCache = new Int_t[fNVars];
-    for (Int_t i=0; i<fNVars; i++)
-    {
-      axisCache[i] = GetAxis(i, 0);
-      fNbinsCache[i] = axisCache[i]->GetNbins();
-    }
-    
-    fLastVars = new Double_t[fNVars];
-    fLastBins = new Int_t[fNVars];
-    
-    // initial values to prevent checking for 0 below
-    for (Int_t i=0; i<fNVars; i++)
-    {
-      fLastBins[i] = axisCache[i]->FindBin(var[i]);
-      fLastVars[i] = var[i];
-    }
-  }
+    FillAxisCache();
   
   // calculate global bin index
   Long64_t bin = 0;
@@ -360,6 +388,260 @@ void AliTHnT<TemplateArray, TemplateType>::Fill(const Double_t *var, Int_t istep
 //   AliCFContainer::Fill(var, istep, weight);
 }
 
+template <class TemplateArray, typename TemplateType>
+void AliTHnT<TemplateArray, TemplateType>::FillAxisCache()
+{
+  // caches the axis information used in Fill and FillBatch
+  
+  axisCache = new TAxis*[fNVars];
+  fNbinsCache = new Int_t[fNVars];
+  fAxisMinCache = new Double_t[fNVars];
+  fAxisMaxCache = new Double_t[fNVars];
+  fAxisEdgesCache = new const Double_t*[fNVars];
+  for (Int_t i=0; i<fNVars; i++)
+  {
+    axisCache[i] = GetAxis(i, 0);
+    fNbinsCache[i] = axisCache[i]->GetNbins();
+    fAxisMinCache[i] = axisCache[i]->GetXmin();
+    fAxisMaxCache[i] = axisCache[i]->GetXmax();
+    fAxisEdgesCache[i] = (axisCache[i]->GetXbins()->GetSize() > 0) ? axisCache[i]->GetXbins()->GetArray() : 0;
+  }
+  
+  fLastVars = new Double_t[fNVars];
+  fLastBins = new Int_t[fNVars];
+  
+  // NaN never equals a coordinate, i.e. the first Fill computes all bins
+  for (Int_t i=0; i<fNVars; i++)
+  {
+    fLastBins[i] = 0;
+    fLastVars[i] = TMath::QuietNaN();
+  }
+}
+
+template <class TemplateArray, typename TemplateType>
+Int_t AliTHnT<TemplateArray, TemplateType>::FindBatchBins(Int_t n, const Double_t* const* vars, Int_t slot)
+{
+  // computes the global bins of the n entries into fBatchBins[slot] and the list of entries inside the
+  // histogram sorted by bin into fBatchOrder[slot]. Returns the number of entries inside the histogram
+  // Only touches the scratch buffers of <slot>, i.e. can be called concurrently for different slots
+  
+  std::vector<Long64_t>& binVector = fBatchBins[slot];
+  binVector.assign(n, 0);
+  Long64_t* bins = &binVector[0];
+  
+  for (Int_t i=0; i<fNVars; i++)
+  {
+    const Double_t* x = vars[i];
+    const Int_t nBins = fNbinsCache[i];
+    const Double_t xMin = fAxisMinCache[i];
+    const Double_t xMax = fAxisMaxCache[i];
+    
+    if (!fAxisEdgesCache[i])
+    {
+      // equidistant bins, same arithmetic as TAxis::FindBin. Branch free, the loop is vectorized
+      for (Int_t j=0; j<n; j++)
+      {
+        const Bool_t inside = (x[j] >= xMin && x[j] < xMax);
+        const Int_t tmpBin = inside ? Int_t(nBins*(x[j]-xMin)/(xMax-xMin)) : nBins;
+        bins[j] = (bins[j] < 0 || tmpBin >= nBins) ? -1 : bins[j] * nBins + tmpBin;
+      }
+    }
+    else
+    {
+      // variable bins, binary search as in TAxis::FindBin (with the caching of the last coordinate as in Fill)
+      const Double_t* edges = fAxisEdgesCache[i];
+      Double_t lastVar = TMath::QuietNaN();
+      Int_t lastBin = -1;
+      for (Int_t j=0; j<n; j++)
+      {
+        if (bins[j] < 0)
+          continue;
+        if (x[j] != lastVar)
+        {
+          lastVar = x[j];
+          lastBin = (x[j] >= xMin && x[j] < xMax) ? TMath::BinarySearch((Long64_t) nBins+1, edges, x[j]) : -1;
+        }
+        bins[j] = (lastBin < 0 || lastBin >= nBins) ? -1 : bins[j] * nBins + lastBin;
+      }
+    }
+  }
+  
+  // group the entries by bin; sorting (bin, entry) keeps the order of the entries within a bin, i.e. the
+  // content is the same as with sequential Fill calls
+  std::vector<std::pair<Long64_t, Int_t> >& order = fBatchOrder[slot];
+  order.clear();
+  for (Int_t j=0; j<n; j++)
+    if (bins[j] >= 0)
+      order.push_back(std::make_pair(bins[j], j));
+  std::sort(order.begin(), order.end());
+  
+  return order.size();
+}
+
+template <class TemplateArray, typename TemplateType>
+void AliTHnT<TemplateArray, TemplateType>::FillBatch(Int_t n, const Double_t* const* vars, Int_t istep, const Double_t* weights, Int_t thread)
+{
+  // fills n entries with the coordinates vars[ivar][i] and the weights weights[i] (unit weights if weights == 0)
+  // thread < 0: fills the data containers directly (same result as n calls to Fill)
+  // thread >= 0: fills the shadow buffers of <thread>, concurrent calls with different threads are safe
+  //   after SetNumberOfThreads has been called. The buffers are added to the data containers by MergeThreads
+  
+  if (n <= 0)
+    return;
+  
+  if (thread >= fNThreads)
+    AliFatal(Form("Thread %d requested but only %d shadow buffers exist (see SetNumberOfThreads)", thread, fNThreads));
+  
+  Int_t slot = 0;
+  if (thread < 0)
+  {
+    if (!axisCache)
+      FillAxisCache();
+    if (fBatchBins.size() == 0)
+    {
+      fBatchBins.resize(1);
+      fBatchOrder.resize(1);
+    }
+  }
+  else
+    slot = thread + 1;
+
+  const Int_t nEntries = FindBatchBins(n, vars, slot);
+  if (nEntries == 0)
+    return;
+  const std::pair<Long64_t, Int_t>* order = &fBatchOrder[slot][0];
+  
+  TemplateType* values = 0;
+  TemplateType* sumw2 = 0;
+  if (thread < 0)
+  {
+    if (!fValues[istep])
+    {
+      fValues[istep] = new TemplateArray(fNBins);
+      AliInfo(Form("Created values container for step %d", istep));
+    }
+    values = fValues[istep]->GetArray();
+  }
+  else
+  {
+    TemplateType*& shadow = fShadowValues[thread*fNSteps+istep];
+    if (!shadow)
+    {
+      shadow = new TemplateType[fNBins];
+      std::fill(shadow, shadow + fNBins, 0);
+    }
+    values = shadow;
+  }
+  
+  // as in Fill, the sumw2 container is created with the first weight != 1 from the entries filled so far
+  Bool_t needSumw2 = kFALSE;
+  if (weights)
+    for (Int_t k=0; k<nEntries; k++)
+      if (weights[order[k].second] != 1)
+        needSumw2 = kTRUE;
+  
+  if (thread < 0)
+  {
+    if (needSumw2 && !fSumw2[istep])
+    {
+      fSumw2[istep] = new TemplateArray(*fValues[istep]);
+      AliInfo(Form("Created sumw2 container for step %d", istep));
+    }
+    if (fSumw2[istep])
+      sumw2 = fSumw2[istep]->GetArray();
+  }
+  else
+  {
+    TemplateType*& shadow = fShadowSumw2[thread*fNSteps+istep];
+    if (needSumw2 && !shadow)
+    {
+      shadow = new TemplateType[fNBins];
+      std::copy(values, values + fNBins, shadow);
+    }
+    sumw2 = shadow;
+  }
+  
+  for (Int_t k=0; k<nEntries; k++)
+  {
+    const Double_t weight = (weights) ? weights[order[k].second] : 1.;
+    values[order[k].first] += weight;
+    if (sumw2)
+      sumw2[order[k].first] += weight * weight;
+  }
+}
+
+template <class TemplateArray, typename TemplateType>
+void AliTHnT<TemplateArray, TemplateType>::SetNumberOfThreads(Int_t nThreads)
+{
+  // creates the shadow buffers of nThreads threads for FillBatch. Has to be called before the threads start
+  // filling. Buffers which have been filled already are merged first
+  
+  MergeThreads();
+  
+  if (!axisCache)
+    FillAxisCache();
+  
+  fNThreads = nThreads;
+  fShadowValues.assign(fNThreads*fNSteps, (TemplateType*) 0);
+  fShadowSumw2.assign(fNThreads*fNSteps, (TemplateType*) 0);
+  // slot 0 is used by the non-threaded FillBatch
+  fBatchBins.resize(fNThreads+1);
+  fBatchOrder.resize(fNThreads+1);
+}
+
+template <class TemplateArray, typename TemplateType>
+void AliTHnT<TemplateArray, TemplateType>::MergeThreads()
+{
+  // adds the shadow buffers of all threads to the data containers and deletes the buffers
+  // not thread safe: call it when the threads have finished filling
+  
+  for (Int_t t=0; t<fNThreads; t++)
+  {
+    for (Int_t i=0; i<fNSteps; i++)
+    {
+      const TemplateType* values = fShadowValues[t*fNSteps+i];
+      if (!values)
+        continue;
+      const TemplateType* sumw2 = fShadowSumw2[t*fNSteps+i];
+      
+      if (!fValues[i])
+        fValues[i] = new TemplateArray(fNBins);
+      // as in Fill, entries filled with weight == 1 so far give the initial sumw2
+      if (sumw2 && !fSumw2[i])
+        fSumw2[i] = new TemplateArray(*fValues[i]);
+
+      TemplateType* target = fValues[i]->GetArray();
+      for (Long64_t l = 0; l<fNBins; l++)
+        target[l] += values[l];
+      
+      if (fSumw2[i])
+      {
+        // without shadow sumw2 all entries of this thread had weight 1, i.e. sumw2 = values
+        const TemplateType* source = (sumw2) ? sumw2 : values;
+        target = fSumw2[i]->GetArray();
+        for (Long64_t l = 0; l<fNBins; l++)
+          target[l] += source[l];
+      }
+    }
+  }
+  
+  DeleteShadows();
+}
+
+template <class TemplateArray, typename TemplateType>
+void AliTHnT<TemplateArray, TemplateType>::DeleteShadows()
+{
+  // deletes the shadow buffers, they are created again by the next FillBatch of the thread
+  
+  for (UInt_t i=0; i<fShadowValues.size(); i++)
+  {
+    delete[] fShadowValues[i];
+    fShadowValues[i] = 0;
+    delete[] fShadowSumw2[i];
+    fShadowSumw2[i] = 0;
+  }
+}
+
 template <class TemplateArray, typename TemplateType>
 Long64_t AliTHnT<TemplateArray, TemplateType>::GetGlobalBinIndex(const Int_t* binIdx)
 {
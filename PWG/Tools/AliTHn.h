@@ -10,6 +10,8 @@
 // As AliTHn derives from AliCFContainer, you can just replace your current AliCFContainer object by AliTHn
 // Once you have the merged output, call FillParent() and you can use AliCFContainer as usual
 
+#include <vector>
+#include <utility>
 #include "TObject.h"
 #include "TString.h"
 #include "AliCFContainer.h"
@@ -26,6 +28,9 @@ public:
   AliTHnBase(const Char_t* name, const Char_t* title,const Int_t nSelStep, const Int_t nVarIn, const Int_t* nBinIn) : AliCFContainer(name, title, nSelStep, nVarIn, nBinIn) { }
   
   virtual void Fill(const Double_t *var, Int_t istep, Double_t weight=1.) = 0;
+  virtual void FillBatch(Int_t n, const Double_t* const* vars, Int_t istep, const Double_t* weights=0, Int_t thread=-1) = 0;
+  virtual void SetNumberOfThreads(Int_t nThreads) = 0;
+  virtual void MergeThreads() = 0;
   virtual void FillParent() = 0;
   virtual void FillContainer(AliCFContainer* cont) = 0;
 
@@ -49,6 +54,15 @@ class AliTHnT : public AliTHnBase
   
   virtual void Fill(const Double_t *var, Int_t istep, Double_t weight=1.) ;
   virtual void FillParent();
+
+  // batched filling: n entries with coordinates vars[ivar][i] (one column per variable) and weights[i] (0 = unit weights)
+  // thread >= 0 fills the shadow buffer of that thread, see SetNumberOfThreads
+  virtual void FillBatch(Int_t n, const Double_t* const* vars, Int_t istep, const Double_t* weights=0, Int_t thread=-1);
+  // creates nThreads shadow buffers; FillBatch can then be called concurrently with distinct thread indices
+  virtual void SetNumberOfThreads(Int_t nThreads);
+  // adds the shadow buffers to the data containers (call when the threads are done, before the output is written)
+  virtual void MergeThreads();
+  Int_t GetNumberOfThreads() const { return fNThreads; }
   virtual void FillContainer(AliCFContainer* cont);
   
   virtual TArray* GetValues(Int_t step) { return fValues[step]; }
@@ -66,6 +80,9 @@ class AliTHnT : public AliTHnBase
 protected:
   void Init();
   Long64_t GetGlobalBinIndex(const Int_t* binIdx);
+  void FillAxisCache();
+  Int_t FindBatchBins(Int_t n, const Double_t* const* vars, Int_t slot);
+  void DeleteShadows();
   
   Long64_t fNBins;   // number of total bins
   Int_t    fNVars;   // number of variables
@@ -77,8 +94,17 @@ protected:
   Int_t* fNbinsCache; //! cache Nbins per axis
   Double_t* fLastVars; //! caching of last used bins (in many loops some vars are the same for a while)
   Int_t* fLastBins; //! caching of last used bins (in many loops some vars are the same for a while)
+  Double_t* fAxisMinCache; //! cache lower edge per axis (batched filling)
+  Double_t* fAxisMaxCache; //! cache upper edge per axis (batched filling)
+  const Double_t** fAxisEdgesCache; //! cache bin edges per axis, 0 for equidistant bins (batched filling)
+  
+  Int_t fNThreads; //! number of shadow buffers
+  std::vector<TemplateType*> fShadowValues; //! [fNThreads*fNSteps] per-thread buffers of fValues
+  std::vector<TemplateType*> fShadowSumw2;  //! [fNThreads*fNSteps] per-thread buffers of fSumw2
+  std::vector<std::vector<Long64_t> > fBatchBins; //! scratch per thread: global bin of each entry of a batch (-1 = outside)
+  std::vector<std::vector<std::pair<Long64_t, Int_t> > > fBatchOrder; //! scratch per thread: (bin, entry) sorted by bin
   
-  ClassDef(AliTHnT, 5) // THn like container
+  ClassDef(AliTHnT, 6) // THn like container
 };
 
 typedef AliTHnT<TArrayF, Float_t> AliTHn;
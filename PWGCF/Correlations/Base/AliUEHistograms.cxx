@@ -25,6 +25,7 @@
 #include "AliUEHistograms.h"
 
 #include "AliCFContainer.h"
+#include "AliTHn.h"
 #include "AliBasicParticle.h"
 #include "AliVParticle.h"
 #include "AliAODTrack.h"
@@ -85,6 +86,12 @@ AliUEHistograms::AliUEHistograms(const char* name, const char* histograms, const
   fPtOrder(kTRUE),
   fTwoTrackCutMinRadius(0.8),
   fCheckEventNumberInCorrelation(kFALSE),
+  fUseFlatPairLoop(kFALSE),
+  fFlatEfficiency(),
+  fFlatMask(),
+  fFlatPairVars(),
+  fFlatPairWeights(),
+  fTwoTrackRadii(),
   fRunNumber(0),
   fMergeCount(1)
 {
@@ -266,6 +273,12 @@ AliUEHistograms::AliUEHistograms(const AliUEHistograms &c) :
   fPtOrder(kTRUE),
   fTwoTrackCutMinRadius(0.8),
   fCheckEventNumberInCorrelation(kFALSE),
+  fUseFlatPairLoop(kFALSE),
+  fFlatEfficiency(),
+  fFlatMask(),
+  fFlatPairVars(),
+  fFlatPairWeights(),
+  fTwoTrackRadii(),
   fRunNumber(0),
   fMergeCount(1)
 {
@@ -591,6 +604,24 @@ void AliUEHistograms::FillCorrelations(Double_t centrality, Float_t zVtx, AliUEH
     TH1::AddDirectory(oldStatus);
   }
 
+  // bending terms of dphi* of all particles for the two-track cut, once per particle list
+  const Bool_t twoTrackTable = (twoTrackCuts && twoTrackEfficiencyCutValue > 0 && particles);
+  if (twoTrackTable)
+  {
+    FillTwoTrackCutTable(0, particles, bSign);
+    if (mixed)
+      FillTwoTrackCutTable(1, mixed, bSign);
+  }
+  const Int_t nRadii = fTwoTrackRadii.size();
+  const Double_t* triggerBend = (twoTrackTable) ? fTwoTrackBend[0].data() : 0;
+  const Double_t* assocBend = (twoTrackTable) ? fTwoTrackBend[(mixed) ? 1 : 0].data() : 0;
+
+  if (fUseFlatPairLoop && particles)
+  {
+    FillCorrelationsFlat(centrality, zVtx, step, particles, mixed, weight, firstTime, twoTrackCuts, bSign, twoTrackEfficiencyCutValue, applyEfficiency);
+    return;
+  }
+
   // Eta() is extremely time consuming, therefore cache it for the inner loop here:
   TObjArray* input = (mixed) ? mixed : particles;
   TArrayF eta(input->GetEntriesFast());
@@ -604,35 +635,7 @@ void AliUEHistograms::FillCorrelations(Double_t centrality, Float_t zVtx, AliUEH
     if (mixed)
       jMax = mixed->GetEntriesFast();
     
-    TH1* triggerWeighting = 0;
-    if (fWeightPerEvent)
-    {
-      TAxis* axis = fNumberDensityPhi->GetTrackHist(AliUEHist::kToward)->GetGrid(0)->GetGrid()->GetAxis(2);
-      triggerWeighting = new TH1F("triggerWeighting", "", axis->GetNbins(), axis->GetXbins()->GetArray());
-    
-      for (Int_t i=0; i<particles->GetEntriesFast(); i++)
-      {
-	AliVParticle* triggerParticle = (AliVParticle*) particles->UncheckedAt(i);
-	
-	// some optimization
-	Float_t triggerEta = triggerParticle->Eta();
-
-	if (fTriggerRestrictEta > 0 && TMath::Abs(triggerEta) > fTriggerRestrictEta)
-	  continue;
-
-	if (fOnlyOneEtaSide != 0)
-	{
-	  if (fOnlyOneEtaSide * triggerEta < 0)
-	    continue;
-	}
-	
-	if (fTriggerSelectCharge != 0)
-	  if (triggerParticle->Charge() * fTriggerSelectCharge < 0)
-	    continue;
-	
-	triggerWeighting->Fill(triggerParticle->Pt());
-      }
-    }
+    TH1* triggerWeighting = CreateTriggerWeighting(particles);
     
     // identify K, Lambda candidates and flag those particles
     // a TObject bit is used for this
@@ -801,173 +804,8 @@ void AliUEHistograms::FillCorrelations(Double_t centrality, Float_t zVtx, AliUEH
 	    continue;
 	  }
 
-	// conversions
-	if (twoTrackCuts && fCutConversionsV > 0 && particle->Charge() * triggerParticle->Charge() < 0)
-	{
-	  Float_t mass = GetInvMassSquaredCheap(triggerParticle->Pt(), triggerEta, triggerParticle->Phi(), particle->Pt(), eta[j], particle->Phi(), 0.510e-3, 0.510e-3);
-	  
-	  if (mass < fCutConversionsV * 5)
-	  {
-	    mass = GetInvMassSquared(triggerParticle->Pt(), triggerEta, triggerParticle->Phi(), particle->Pt(), eta[j], particle->Phi(), 0.510e-3, 0.510e-3);
-	    
-	    fControlConvResoncances->Fill(0.0, mass);
-
-	    if (mass < fCutConversionsV*fCutConversionsV) 
-	      continue;
-	  }
-	}
-	
-	// K0s
-	if (twoTrackCuts && fCutK0sV > 0 && particle->Charge() * triggerParticle->Charge() < 0)
-	{
-	  Float_t mass = GetInvMassSquaredCheap(triggerParticle->Pt(), triggerEta, triggerParticle->Phi(), particle->Pt(), eta[j], particle->Phi(), 0.1396, 0.1396);
-	  
-	  const Float_t kK0smass = 0.4976;
-	  
-	  if (TMath::Abs(mass - kK0smass*kK0smass) < fCutK0sV * 5)
-	  {
-	    mass = GetInvMassSquared(triggerParticle->Pt(), triggerEta, triggerParticle->Phi(), particle->Pt(), eta[j], particle->Phi(), 0.1396, 0.1396);
-	    
-	    fControlConvResoncances->Fill(1, mass - kK0smass*kK0smass);
-
-	    if (mass > (kK0smass-fCutK0sV)*(kK0smass-fCutK0sV) && mass < (kK0smass+fCutK0sV)*(kK0smass+fCutK0sV))
-	      continue;
-	  }
-	}
-
-	// Lambda
-	if (twoTrackCuts && fCutLambdaV > 0 && particle->Charge() * triggerParticle->Charge() < 0)
-	{
-	  Float_t mass1 = GetInvMassSquaredCheap(triggerParticle->Pt(), triggerEta, triggerParticle->Phi(), particle->Pt(), eta[j], particle->Phi(), 0.1396, 0.9383);
-	  Float_t mass2 = GetInvMassSquaredCheap(triggerParticle->Pt(), triggerEta, triggerParticle->Phi(), particle->Pt(), eta[j], particle->Phi(), 0.9383, 0.1396);
-	  
-	  const Float_t kLambdaMass = 1.115;
-
-	  if (TMath::Abs(mass1 - kLambdaMass*kLambdaMass) < fCutLambdaV * 5)
-	  {
-	    mass1 = GetInvMassSquared(triggerParticle->Pt(), triggerEta, triggerParticle->Phi(), particle->Pt(), eta[j], particle->Phi(), 0.1396, 0.9383);
-
-	    fControlConvResoncances->Fill(2, mass1 - kLambdaMass*kLambdaMass);
-	    
-	    if (mass1 > (kLambdaMass-fCutLambdaV)*(kLambdaMass-fCutLambdaV) && mass1 < (kLambdaMass+fCutLambdaV)*(kLambdaMass+fCutLambdaV))
-	      continue;
-	  }
-	  if (TMath::Abs(mass2 - kLambdaMass*kLambdaMass) < fCutLambdaV * 5)
-	  {
-	    mass2 = GetInvMassSquared(triggerParticle->Pt(), triggerEta, triggerParticle->Phi(), particle->Pt(), eta[j], particle->Phi(), 0.9383, 0.1396);
-
-	    fControlConvResoncances->Fill(2, mass2 - kLambdaMass*kLambdaMass);
-
-	    if (mass2 > (kLambdaMass-fCutLambdaV)*(kLambdaMass-fCutLambdaV) && mass2 < (kLambdaMass+fCutLambdaV)*(kLambdaMass+fCutLambdaV))
-	      continue;
-	  }
-	}
-
-        // Phi
-	if (twoTrackCuts && fCutPhiV > 0 && particle->Charge() * triggerParticle->Charge() < 0)
-	{
-	  Float_t mass = GetInvMassSquaredCheap(triggerParticle->Pt(), triggerEta, triggerParticle->Phi(), particle->Pt(), eta[j], particle->Phi(), 0.4937, 0.4937);
-	  
-	  const Float_t kPhimass = 1.019;
-	  
-	  if (TMath::Abs(mass - kPhimass*kPhimass) < fCutPhiV * 5)
-	  {
-	    mass = GetInvMassSquared(triggerParticle->Pt(), triggerEta, triggerParticle->Phi(), particle->Pt(), eta[j], particle->Phi(), 0.4937, 0.4937);
-	    
-	    fControlConvResoncances->Fill(3, mass - kPhimass*kPhimass);
-	    
-	    if (mass > (kPhimass-fCutPhiV)*(kPhimass-fCutPhiV) && mass < (kPhimass+fCutPhiV)*(kPhimass+fCutPhiV))
-	      continue;
-	  }
-	}	
-
-        // Rho
-	if (twoTrackCuts && fCutRhoV > 0 && particle->Charge() * triggerParticle->Charge() < 0)
-        {
-	  Float_t mass = GetInvMassSquaredCheap(triggerParticle->Pt(), triggerEta, triggerParticle->Phi(), particle->Pt(), eta[j], particle->Phi(), 0.1396, 0.1396);
-	  
-	  const Float_t kRhomass = 0.770;
-	  
-	  if (TMath::Abs(mass - kRhomass*kRhomass) < fCutRhoV * 5)
-          {
-	    mass = GetInvMassSquared(triggerParticle->Pt(), triggerEta, triggerParticle->Phi(), particle->Pt(), eta[j], particle->Phi(), 0.1396, 0.1396);
-	    
-	    fControlConvResoncances->Fill(4, mass - kRhomass*kRhomass);
-	    
-	    if (mass > (kRhomass-fCutRhoV)*(kRhomass-fCutRhoV) && mass < (kRhomass+fCutRhoV)*(kRhomass+fCutRhoV))
-	      continue;
-	  }
-	}
-
-        // User-defined cut
-	if (twoTrackCuts && fCutCustomMass > 0 && fCutCustomFirst > 0 && fCutCustomSecond > 0 && fCutCustomV > 0 && particle->Charge() * triggerParticle->Charge() < 0)
-        {
-	  Float_t mass = GetInvMassSquaredCheap(triggerParticle->Pt(), triggerEta, triggerParticle->Phi(), particle->Pt(), eta[j], particle->Phi(), fCutCustomFirst, fCutCustomSecond);
-	  
-	  if (TMath::Abs(mass - fCutCustomMass*fCutCustomMass) < fCutCustomV * 5)
-          {
-	    mass = GetInvMassSquared(triggerParticle->Pt(), triggerEta, triggerParticle->Phi(), particle->Pt(), eta[j], particle->Phi(), fCutCustomFirst, fCutCustomSecond);
-	    
-	    fControlConvResoncances->Fill(5, mass - fCutCustomMass*fCutCustomMass);
-	    
-	    if (mass > (fCutCustomMass-fCutCustomV)*(fCutCustomMass-fCutCustomV) && mass < (fCutCustomMass+fCutCustomV)*(fCutCustomMass+fCutCustomV))
-	      continue;
-	  }
-	}
-
-	if (twoTrackCuts && twoTrackEfficiencyCutValue > 0)
-	{
-	  // the variables & cuthave been developed by the HBT group 
-	  // see e.g. https://indico.cern.ch/materialDisplay.py?contribId=36&sessionId=6&materialId=slides&confId=142700
-
-	  Float_t phi1 = triggerParticle->Phi();
-	  Float_t pt1 = triggerParticle->Pt();
-	  Float_t charge1 = triggerParticle->Charge();
-	    
-	  Float_t phi2 = particle->Phi();
-	  Float_t pt2 = particle->Pt();
-	  Float_t charge2 = particle->Charge();
-	      
-	  Float_t deta = triggerEta - eta[j];
-	      
-	  // optimization
-	  if (TMath::Abs(deta) < twoTrackEfficiencyCutValue * 2.5 * 3)
-	  {
-	    // check first boundaries to see if is worth to loop and find the minimum
-	    Float_t dphistar1 = GetDPhiStar(phi1, pt1, charge1, phi2, pt2, charge2, fTwoTrackCutMinRadius, bSign);
-	    Float_t dphistar2 = GetDPhiStar(phi1, pt1, charge1, phi2, pt2, charge2, 2.5, bSign);
-	    
-	    const Float_t kLimit = twoTrackEfficiencyCutValue * 3;
-
-	    Float_t dphistarminabs = 1e5;
-	    Float_t dphistarmin = 1e5;
-	    if (TMath::Abs(dphistar1) < kLimit || TMath::Abs(dphistar2) < kLimit || dphistar1 * dphistar2 < 0)
-	    {
-	      for (Double_t rad=fTwoTrackCutMinRadius; rad<2.51; rad+=0.01) 
-	      {
-		Float_t dphistar = GetDPhiStar(phi1, pt1, charge1, phi2, pt2, charge2, rad, bSign);
-
-		Float_t dphistarabs = TMath::Abs(dphistar);
-		
-		if (dphistarabs < dphistarminabs)
-		{
-		  dphistarmin = dphistar;
-		  dphistarminabs = dphistarabs;
-		}
-	      }
-	      
-	      fTwoTrackDistancePt[0]->Fill(deta, dphistarmin, TMath::Abs(pt1 - pt2));
-	      
-	      if (dphistarminabs < twoTrackEfficiencyCutValue && TMath::Abs(deta) < twoTrackEfficiencyCutValue)
-	      {
-// 		Printf("Removed track pair %d %d with %f %f %f %f %f %f %f %f %f", i, j, deta, dphistarminabs, phi1, pt1, charge1, phi2, pt2, charge2, bSign);
-		continue;
-	      }
-
-    	      fTwoTrackDistancePt[1]->Fill(deta, dphistarmin, TMath::Abs(pt1 - pt2));
-	    }
-	  }
-	}
+	if (twoTrackCuts && RejectPairTwoTrackCuts(triggerParticle->Pt(), triggerEta, triggerParticle->Phi(), triggerParticle->Charge(), particle->Pt(), eta[j], particle->Phi(), particle->Charge(), twoTrackEfficiencyCutValue, bSign, (triggerBend) ? triggerBend + i * nRadii : 0, (assocBend) ? assocBend + j * nRadii : 0))
+	  continue;
         
         Double_t vars[6];
         vars[0] = triggerEta - eta[j];
@@ -1026,49 +864,7 @@ void AliUEHistograms::FillCorrelations(Double_t centrality, Float_t zVtx, AliUEH
       }
  
       if (firstTime)
-      {
-        // once per trigger particle
-        Double_t vars[3];
-        vars[0] = triggerParticle->Pt();
-        vars[1] = centrality;
-	vars[2] = zVtx;
-
-	Double_t useWeight = 1;
-	if (fEfficiencyCorrectionTriggers && applyEfficiency)
-	{
-	  Int_t effVars[4];
-	  
-	  // trigger particle
-	  effVars[0] = fEfficiencyCorrectionTriggers->GetAxis(0)->FindBin(triggerEta);
-	  effVars[1] = fEfficiencyCorrectionTriggers->GetAxis(1)->FindBin(vars[0]); //pt
-	  effVars[2] = fEfficiencyCorrectionTriggers->GetAxis(2)->FindBin(vars[1]); //centrality
-	  effVars[3] = fEfficiencyCorrectionTriggers->GetAxis(3)->FindBin(vars[2]); //zVtx
-	  useWeight *= fEfficiencyCorrectionTriggers->GetBinContent(effVars);
-	}
-
-	if (TMath::Abs(triggerEta) < 0.8 && triggerParticle->Pt() > 0)
-	  fInvYield2->Fill(centrality, triggerParticle->Pt(), useWeight / triggerParticle->Pt());
-
-	if (fWeightPerEvent)
-	{
-	  // leads effectively to a filling of one entry per filled trigger particle pT bin
-	  Int_t weightBin = triggerWeighting->GetXaxis()->FindBin(vars[0]);
-// 	  Printf("Using weight %f", triggerWeighting->GetBinContent(weightBin));
-	  useWeight /= triggerWeighting->GetBinContent(weightBin);
-	}
-	
-        fNumberDensityPhi->GetEventHist()->Fill(vars, step, useWeight);
-
-	// QA
-        fCorrelationpT->Fill(centrality, triggerParticle->Pt());
-        fCorrelationEta->Fill(centrality, triggerEta);
-        fCorrelationPhi->Fill(centrality, triggerParticle->Phi());
-	fYields->Fill(centrality, triggerParticle->Pt(), triggerEta);
-	fYieldsEtaPhiPT->Fill(triggerParticle->Pt(), triggerEta, triggerParticle->Phi());
-	
-/*        if (dynamic_cast<AliAODTrack*>(triggerParticle))
-          fITSClusterMap->Fill(((AliAODTrack*) triggerParticle)->GetITSClusterMap(), centrality, triggerParticle->Pt());*/
-      }
+        FillTriggerParticle(triggerParticle, triggerEta, centrality, zVtx, step, applyEfficiency, triggerWeighting);
     }
     
     if (triggerWeighting)
@@ -1082,6 +878,632 @@ void AliUEHistograms::FillCorrelations(Double_t centrality, Float_t zVtx, AliUEH
   fCentralityCorrelation->Fill(centrality, particles->GetEntriesFast());
   FillEvent(centrality, step);
 }
+
+//____________________________________________________________________
+void AliUEHistograms::FillCorrelationsFlat(Double_t centrality, Float_t zVtx, AliUEHist::CFStep step, TObjArray* particles, TObjArray* mixed, Float_t weight, Bool_t firstTime, Bool_t twoTrackCuts, Float_t bSign, Float_t twoTrackEfficiencyCutValue, Bool_t applyEfficiency)
+{
+  // struct-of-arrays version of FillCorrelations (see SetUseFlatPairLoop), the filled histograms are identical
+  //
+  // pt, eta, phi, charge, resonance flag and event index of the trigger and associated particles are copied once
+  // into contiguous arrays. For each trigger particle the single-pair selections are evaluated as masks over all
+  // associated particles, the remaining pairs pass the two-track cuts and are filled together at the end
+
+  Bool_t fillpT = kFALSE;
+  if (weight < 0)
+    fillpT = kTRUE;
+
+  // snapshot: index 0 for the trigger particles, index 1 for the associated particles (only if mixed)
+  TObjArray* input[2] = { particles, mixed };
+  const Int_t nSets = (mixed) ? 2 : 1;
+  const Int_t kAssoc = nSets - 1;
+  for (Int_t s=0; s<nSets; s++)
+  {
+    const Int_t n = input[s]->GetEntriesFast();
+    fFlatPt[s].resize(n);
+    fFlatEta[s].resize(n);
+    fFlatPhi[s].resize(n);
+    fFlatCharge[s].resize(n);
+    fFlatFlags[s].assign(n, 0);
+    fFlatEventIndex[s].assign(n, 0);
+    for (Int_t i=0; i<n; i++)
+    {
+      AliVParticle* particle = (AliVParticle*) input[s]->UncheckedAt(i);
+      fFlatPt[s][i] = particle->Pt();
+      fFlatEta[s][i] = particle->Eta();
+      fFlatPhi[s][i] = particle->Phi();
+      fFlatCharge[s][i] = particle->Charge();
+      if (fCheckEventNumberInCorrelation)
+      {
+        AliBasicParticle* particleBasic = dynamic_cast<AliBasicParticle*>(particle);
+        if (!particleBasic)
+          AliFatal("If fCheckEventNumberInCorrelation is set, particle must be derived from AliBasicParticle");
+        fFlatEventIndex[s][i] = particleBasic->GetEventIndex();
+      }
+    }
+  }
+
+  const Int_t nTriggers = fFlatPt[0].size();
+  const Int_t nAssoc = fFlatPt[kAssoc].size();
+  const Double_t* triggerPt = fFlatPt[0].data();
+  const Float_t* triggerEta = fFlatEta[0].data();
+  const Double_t* triggerPhi = fFlatPhi[0].data();
+  const Short_t* triggerCharge = fFlatCharge[0].data();
+  const Long64_t* triggerEventIndex = fFlatEventIndex[0].data();
+  const Double_t* pt = fFlatPt[kAssoc].data();
+  const Float_t* eta = fFlatEta[kAssoc].data();
+  const Double_t* phi = fFlatPhi[kAssoc].data();
+  const Short_t* charge = fFlatCharge[kAssoc].data();
+  const Long64_t* eventIndex = fFlatEventIndex[kAssoc].data();
+
+  // bending terms of dphi* for the two-track cut, filled by FillCorrelations
+  const Int_t nRadii = fTwoTrackRadii.size();
+  const Double_t* triggerBend = (twoTrackCuts && twoTrackEfficiencyCutValue > 0) ? fTwoTrackBend[0].data() : 0;
+  const Double_t* assocBend = (twoTrackCuts && twoTrackEfficiencyCutValue > 0) ? fTwoTrackBend[kAssoc].data() : 0;
+
+  // identify K, Lambda candidates and flag those particles
+  // the TObject bit is set as in FillCorrelations and then copied to the snapshot
+  const UInt_t kResonanceDaughterFlag = 1 << 14;
+  if (fRejectResonanceDaughters > 0)
+  {
+    Double_t resonanceMass = -1;
+    Double_t massDaughter1 = -1;
+    Double_t massDaughter2 = -1;
+    const Double_t interval = 0.02;
+
+    switch (fRejectResonanceDaughters)
+    {
+      case 1: resonanceMass = 1.2; massDaughter1 = 0.1396; massDaughter2 = 0.9383; break; // method test
+      case 2: resonanceMass = 0.4976; massDaughter1 = 0.1396; massDaughter2 = massDaughter1; break; // k0
+      case 3: resonanceMass = 1.115; massDaughter1 = 0.1396; massDaughter2 = 0.9383; break; // lambda
+      default: AliFatal(Form("Invalid setting %d", fRejectResonanceDaughters));
+    }
+
+    for (Int_t s=0; s<nSets; s++)
+      for (Int_t i=0; i<input[s]->GetEntriesFast(); i++)
+        input[s]->UncheckedAt(i)->ResetBit(kResonanceDaughterFlag);
+
+    for (Int_t i=0; i<nTriggers; i++)
+    {
+      for (Int_t j=0; j<nAssoc; j++)
+      {
+        if (!mixed && i == j)
+          continue;
+
+        if (triggerCharge[i] * charge[j] > 0)
+          continue;
+
+        if (fCheckEventNumberInCorrelation && triggerEventIndex[i] == eventIndex[j])
+          continue;
+
+        Float_t mass = GetInvMassSquaredCheap(triggerPt[i], triggerEta[i], triggerPhi[i], pt[j], eta[j], phi[j], massDaughter1, massDaughter2);
+
+        if (TMath::Abs(mass - resonanceMass*resonanceMass) < interval*5)
+        {
+          mass = GetInvMassSquared(triggerPt[i], triggerEta[i], triggerPhi[i], pt[j], eta[j], phi[j], massDaughter1, massDaughter2);
+
+          if (mass > (resonanceMass-interval)*(resonanceMass-interval) && mass < (resonanceMass+interval)*(resonanceMass+interval))
+          {
+            TObject* triggerParticle = particles->UncheckedAt(i);
+            TObject* particle = input[kAssoc]->UncheckedAt(j);
+            if (mixed && !fCheckEventNumberInCorrelation && triggerParticle->IsEqual(particle))
+              continue;
+
+            triggerParticle->SetBit(kResonanceDaughterFlag);
+            particle->SetBit(kResonanceDaughterFlag);
+          }
+        }
+      }
+    }
+
+    for (Int_t s=0; s<nSets; s++)
+      for (Int_t i=0; i<input[s]->GetEntriesFast(); i++)
+        fFlatFlags[s][i] = input[s]->UncheckedAt(i)->TestBit(kResonanceDaughterFlag);
+  }
+  const UChar_t* triggerFlags = fFlatFlags[0].data();
+  const UChar_t* flags = fFlatFlags[kAssoc].data();
+
+  // efficiency correction of the associated particles, it does not depend on the trigger particle
+  const Bool_t assocEfficiency = (applyEfficiency && fEfficiencyCorrectionAssociated);
+  if (assocEfficiency)
+  {
+    fFlatEfficiency.resize(nAssoc);
+    for (Int_t j=0; j<nAssoc; j++)
+    {
+      Int_t effVars[4];
+      effVars[0] = fEfficiencyCorrectionAssociated->GetAxis(0)->FindBin(eta[j]);
+      effVars[1] = fEfficiencyCorrectionAssociated->GetAxis(1)->FindBin(pt[j]); //pt
+      effVars[2] = fEfficiencyCorrectionAssociated->GetAxis(2)->FindBin(centrality); //centrality
+      effVars[3] = fEfficiencyCorrectionAssociated->GetAxis(3)->FindBin((Double_t) zVtx); //zVtx
+      fFlatEfficiency[j] = fEfficiencyCorrectionAssociated->GetBinContent(effVars);
+    }
+  }
+
+  TH1* triggerWeighting = CreateTriggerWeighting(particles);
+  AliCFContainer* trackHist = fNumberDensityPhi->GetTrackHist(AliUEHist::kToward);
+  // AliTHn containers are filled per trigger particle in one batch
+  AliTHnBase* trackHistBatch = dynamic_cast<AliTHnBase*> (trackHist);
+
+  // one column of nAssoc entries per fill variable
+  fFlatPairVars.resize(6 * nAssoc);
+  Double_t* pairVars[6];
+  for (Int_t v=0; v<6; v++)
+    pairVars[v] = fFlatPairVars.data() + v * nAssoc;
+
+  fFlatMask.resize(nAssoc);
+  UChar_t* mask = fFlatMask.data();
+
+  for (Int_t i=0; i<nTriggers; i++)
+  {
+    const Float_t tEta = triggerEta[i];
+    const Double_t tPt = triggerPt[i];
+    const Short_t tCharge = triggerCharge[i];
+
+    if (fTriggerRestrictEta > 0 && TMath::Abs(tEta) > fTriggerRestrictEta)
+      continue;
+
+    if (fOnlyOneEtaSide != 0 && fOnlyOneEtaSide * tEta < 0)
+      continue;
+
+    if (fTriggerSelectCharge != 0 && tCharge * fTriggerSelectCharge < 0)
+      continue;
+
+    if (fRejectResonanceDaughters > 0 && triggerFlags[i])
+      continue;
+
+    // single-pair selections, evaluated as masks over all associated particles
+    for (Int_t j=0; j<nAssoc; j++)
+      mask[j] = 1;
+
+    if (fCheckEventNumberInCorrelation)
+    {
+      const Long64_t tEventIndex = triggerEventIndex[i];
+      for (Int_t j=0; j<nAssoc; j++)
+        mask[j] &= (eventIndex[j] != tEventIndex);
+    }
+
+    if (fPtOrder)
+      for (Int_t j=0; j<nAssoc; j++)
+        mask[j] &= !(pt[j] >= tPt);
+
+    if (fAssociatedSelectCharge != 0)
+      for (Int_t j=0; j<nAssoc; j++)
+        mask[j] &= !(charge[j] * fAssociatedSelectCharge < 0);
+
+    if (fSelectCharge == 1) // skip like sign
+      for (Int_t j=0; j<nAssoc; j++)
+        mask[j] &= !(charge[j] * tCharge > 0);
+    else if (fSelectCharge == 2) // skip unlike sign
+      for (Int_t j=0; j<nAssoc; j++)
+        mask[j] &= !(charge[j] * tCharge < 0);
+
+    if (fOnlyOneAssocEtaSide != 0)
+      for (Int_t j=0; j<nAssoc; j++)
+        mask[j] &= !(fOnlyOneAssocEtaSide * eta[j] < 0);
+
+    if (fEtaOrdering)
+    {
+      if (tEta < 0)
+        for (Int_t j=0; j<nAssoc; j++)
+          mask[j] &= !(eta[j] < tEta);
+      if (tEta > 0)
+        for (Int_t j=0; j<nAssoc; j++)
+          mask[j] &= !(eta[j] > tEta);
+    }
+
+    if (fRejectResonanceDaughters > 0)
+      for (Int_t j=0; j<nAssoc; j++)
+        mask[j] &= !flags[j];
+
+    if (!mixed)
+      mask[i] = 0;
+
+    // quantities which only depend on the trigger particle
+    Double_t triggerEfficiency = 1;
+    if (applyEfficiency && fEfficiencyCorrectionTriggers)
+    {
+      Int_t effVars[4];
+      effVars[0] = fEfficiencyCorrectionTriggers->GetAxis(0)->FindBin(tEta);
+      effVars[1] = fEfficiencyCorrectionTriggers->GetAxis(1)->FindBin(tPt); //pt
+      effVars[2] = fEfficiencyCorrectionTriggers->GetAxis(2)->FindBin(centrality); //centrality
+      effVars[3] = fEfficiencyCorrectionTriggers->GetAxis(3)->FindBin((Double_t) zVtx); //zVtx
+      triggerEfficiency = fEfficiencyCorrectionTriggers->GetBinContent(effVars);
+    }
+    Double_t triggerCount = 1;
+    if (fWeightPerEvent)
+      triggerCount = triggerWeighting->GetBinContent(triggerWeighting->GetXaxis()->FindBin(tPt));
+
+    // remaining pairs: two-track cuts and fill variables
+    fFlatPairWeights.clear();
+    for (Int_t j=0; j<nAssoc; j++)
+    {
+      if (!mask[j])
+        continue;
+
+      // check if both particles point to the same element (does not occur for mixed events, but if subsets are mixed within the same event)
+      if (mixed && !fCheckEventNumberInCorrelation && particles->UncheckedAt(i)->IsEqual(mixed->UncheckedAt(j)))
+        continue;
+
+      if (twoTrackCuts && RejectPairTwoTrackCuts(tPt, tEta, triggerPhi[i], tCharge, pt[j], eta[j], phi[j], charge[j], twoTrackEfficiencyCutValue, bSign, (triggerBend) ? triggerBend + i * nRadii : 0, (assocBend) ? assocBend + j * nRadii : 0))
+        continue;
+
+      const Int_t k = fFlatPairWeights.size();
+      pairVars[0][k] = tEta - eta[j];
+      pairVars[1][k] = pt[j];
+      pairVars[2][k] = tPt;
+      pairVars[3][k] = centrality;
+      Double_t deltaPhi = triggerPhi[i] - phi[j];
+      if (deltaPhi > 1.5 * TMath::Pi())
+        deltaPhi -= TMath::TwoPi();
+      if (deltaPhi < -0.5 * TMath::Pi())
+        deltaPhi += TMath::TwoPi();
+      pairVars[4][k] = deltaPhi;
+      pairVars[5][k] = zVtx;
+
+      if (fillpT)
+        weight = pt[j];
+
+      Double_t useWeight = weight;
+      if (applyEfficiency)
+      {
+        if (assocEfficiency)
+          useWeight *= fFlatEfficiency[j];
+        if (fEfficiencyCorrectionTriggers)
+          useWeight *= triggerEfficiency;
+      }
+      if (fWeightPerEvent)
+        useWeight /= triggerCount;
+      fFlatPairWeights.push_back(useWeight);
+    }
+
+    // fill all in toward region and do not use the other regions
+    const Int_t nPairs = fFlatPairWeights.size();
+    if (trackHistBatch)
+      trackHistBatch->FillBatch(nPairs, pairVars, step, fFlatPairWeights.data());
+    else
+    {
+      for (Int_t k=0; k<nPairs; k++)
+      {
+        Double_t vars[6];
+        for (Int_t v=0; v<6; v++)
+          vars[v] = pairVars[v][k];
+        trackHist->Fill(vars, step, fFlatPairWeights[k]);
+      }
+    }
+
+    if (firstTime)
+      FillTriggerParticle((AliVParticle*) particles->UncheckedAt(i), tEta, centrality, zVtx, step, applyEfficiency, triggerWeighting);
+  }
+
+  delete triggerWeighting;
+
+  fCentralityDistribution->Fill(centrality);
+  fCentralityCorrelation->Fill(centrality, particles->GetEntriesFast());
+  FillEvent(centrality, step);
+}
+
+//____________________________________________________________________
+TH1* AliUEHistograms::CreateTriggerWeighting(TObjArray* particles)
+{
+  // histogram of the trigger particle pT used for the weighting with the number of trigger particles per event (fWeightPerEvent)
+  // the caller owns the returned histogram
+
+  if (!fWeightPerEvent)
+    return 0;
+
+  TAxis* axis = fNumberDensityPhi->GetTrackHist(AliUEHist::kToward)->GetGrid(0)->GetGrid()->GetAxis(2);
+  TH1* triggerWeighting = new TH1F("triggerWeighting", "", axis->GetNbins(), axis->GetXbins()->GetArray());
+
+  for (Int_t i=0; i<particles->GetEntriesFast(); i++)
+  {
+    AliVParticle* triggerParticle = (AliVParticle*) particles->UncheckedAt(i);
+
+    // some optimization
+    Float_t triggerEta = triggerParticle->Eta();
+
+    if (fTriggerRestrictEta > 0 && TMath::Abs(triggerEta) > fTriggerRestrictEta)
+      continue;
+
+    if (fOnlyOneEtaSide != 0)
+    {
+      if (fOnlyOneEtaSide * triggerEta < 0)
+        continue;
+    }
+
+    if (fTriggerSelectCharge != 0)
+      if (triggerParticle->Charge() * fTriggerSelectCharge < 0)
+        continue;
+
+    triggerWeighting->Fill(triggerParticle->Pt());
+  }
+
+  return triggerWeighting;
+}
+
+//____________________________________________________________________
+void AliUEHistograms::FillTriggerParticle(AliVParticle* triggerParticle, Float_t triggerEta, Double_t centrality, Float_t zVtx, AliUEHist::CFStep step, Bool_t applyEfficiency, TH1* triggerWeighting)
+{
+  // fills the event histogram and the QA histograms once per trigger particle (called from FillCorrelations)
+
+  Double_t vars[3];
+  vars[0] = triggerParticle->Pt();
+  vars[1] = centrality;
+  vars[2] = zVtx;
+
+  Double_t useWeight = 1;
+  if (fEfficiencyCorrectionTriggers && applyEfficiency)
+  {
+    Int_t effVars[4];
+
+    // trigger particle
+    effVars[0] = fEfficiencyCorrectionTriggers->GetAxis(0)->FindBin(triggerEta);
+    effVars[1] = fEfficiencyCorrectionTriggers->GetAxis(1)->FindBin(vars[0]); //pt
+    effVars[2] = fEfficiencyCorrectionTriggers->GetAxis(2)->FindBin(vars[1]); //centrality
+    effVars[3] = fEfficiencyCorrectionTriggers->GetAxis(3)->FindBin(vars[2]); //zVtx
+    useWeight *= fEfficiencyCorrectionTriggers->GetBinContent(effVars);
+  }
+
+  if (TMath::Abs(triggerEta) < 0.8 && triggerParticle->Pt() > 0)
+    fInvYield2->Fill(centrality, triggerParticle->Pt(), useWeight / triggerParticle->Pt());
+
+  if (fWeightPerEvent)
+  {
+    // leads effectively to a filling of one entry per filled trigger particle pT bin
+    Int_t weightBin = triggerWeighting->GetXaxis()->FindBin(vars[0]);
+// 	  Printf("Using weight %f", triggerWeighting->GetBinContent(weightBin));
+    useWeight /= triggerWeighting->GetBinContent(weightBin);
+  }
+
+  fNumberDensityPhi->GetEventHist()->Fill(vars, step, useWeight);
+
+  // QA
+  fCorrelationpT->Fill(centrality, triggerParticle->Pt());
+  fCorrelationEta->Fill(centrality, triggerEta);
+  fCorrelationPhi->Fill(centrality, triggerParticle->Phi());
+  fYields->Fill(centrality, triggerParticle->Pt(), triggerEta);
+  fYieldsEtaPhiPT->Fill(triggerParticle->Pt(), triggerEta, triggerParticle->Phi());
+
+/*  if (dynamic_cast<AliAODTrack*>(triggerParticle))
+    fITSClusterMap->Fill(((AliAODTrack*) triggerParticle)->GetITSClusterMap(), centrality, triggerParticle->Pt());*/
+}
+
+//____________________________________________________________________
+void AliUEHistograms::FillTwoTrackCutTable(Int_t set, TObjArray* particles, Float_t bSign)
+{
+  // fills the bending terms of dphi* (GetDPhiStarBend) of the particles at the radii scanned by the two-track cut
+  // into fTwoTrackBend[set], one row of fTwoTrackRadii.size() entries per particle
+  // the radii are the ones of the loop in RejectPairTwoTrackCuts, followed by the outer radius (2.5 m)
+
+  fTwoTrackRadii.clear();
+  for (Double_t rad=fTwoTrackCutMinRadius; rad<2.51; rad+=0.01)
+    fTwoTrackRadii.push_back(rad);
+  fTwoTrackRadii.push_back(2.5);
+
+  const Int_t nRadii = fTwoTrackRadii.size();
+  const Int_t n = particles->GetEntriesFast();
+  fTwoTrackBend[set].resize(n * nRadii);
+  Double_t* bend = fTwoTrackBend[set].data();
+  for (Int_t i=0; i<n; i++, bend += nRadii)
+  {
+    AliVParticle* particle = (AliVParticle*) particles->UncheckedAt(i);
+    const Float_t pt = particle->Pt();
+    const Float_t charge = particle->Charge();
+    for (Int_t r=0; r<nRadii; r++)
+      bend[r] = GetDPhiStarBend(pt, charge, fTwoTrackRadii[r], bSign);
+  }
+}
+
+//____________________________________________________________________
+Bool_t AliUEHistograms::RejectPairTwoTrackCuts(Double_t triggerPt, Float_t triggerEta, Double_t triggerPhi, Short_t triggerCharge, Double_t pt, Float_t eta, Double_t phi, Short_t charge, Float_t twoTrackEfficiencyCutValue, Float_t bSign, const Double_t* triggerBend, const Double_t* bend)
+{
+  // applies the cuts on conversions, resonances and the two-track cut to a pair (trigger, associated)
+  // returns kTRUE if the pair has to be rejected. Control histograms are filled on the way
+  //
+  // if triggerBend and bend are given (rows of fTwoTrackBend, see FillTwoTrackCutTable) dphi* is computed from them
+  // instead of GetDPhiStar, with identical results
+
+  // conversions
+  if (fCutConversionsV > 0 && charge * triggerCharge < 0)
+  {
+    Float_t mass = GetInvMassSquaredCheap(triggerPt, triggerEta, triggerPhi, pt, eta, phi, 0.510e-3, 0.510e-3);
+
+    if (mass < fCutConversionsV * 5)
+    {
+      mass = GetInvMassSquared(triggerPt, triggerEta, triggerPhi, pt, eta, phi, 0.510e-3, 0.510e-3);
+
+      fControlConvResoncances->Fill(0.0, mass);
+
+      if (mass < fCutConversionsV*fCutConversionsV) 
+        return kTRUE;
+    }
+  }
+
+  // K0s
+  if (fCutK0sV > 0 && charge * triggerCharge < 0)
+  {
+    Float_t mass = GetInvMassSquaredCheap(triggerPt, triggerEta, triggerPhi, pt, eta, phi, 0.1396, 0.1396);
+
+    const Float_t kK0smass = 0.4976;
+
+    if (TMath::Abs(mass - kK0smass*kK0smass) < fCutK0sV * 5)
+    {
+      mass = GetInvMassSquared(triggerPt, triggerEta, triggerPhi, pt, eta, phi, 0.1396, 0.1396);
+
+      fControlConvResoncances->Fill(1, mass - kK0smass*kK0smass);
+
+      if (mass > (kK0smass-fCutK0sV)*(kK0smass-fCutK0sV) && mass < (kK0smass+fCutK0sV)*(kK0smass+fCutK0sV))
+        return kTRUE;
+    }
+  }
+
+  // Lambda
+  if (fCutLambdaV > 0 && charge * triggerCharge < 0)
+  {
+    Float_t mass1 = GetInvMassSquaredCheap(triggerPt, triggerEta, triggerPhi, pt, eta, phi, 0.1396, 0.9383);
+    Float_t mass2 = GetInvMassSquaredCheap(triggerPt, triggerEta, triggerPhi, pt, eta, phi, 0.9383, 0.1396);
+
+    const Float_t kLambdaMass = 1.115;
+
+    if (TMath::Abs(mass1 - kLambdaMass*kLambdaMass) < fCutLambdaV * 5)
+    {
+      mass1 = GetInvMassSquared(triggerPt, triggerEta, triggerPhi, pt, eta, phi, 0.1396, 0.9383);
+
+      fControlConvResoncances->Fill(2, mass1 - kLambdaMass*kLambdaMass);
+
+      if (mass1 > (kLambdaMass-fCutLambdaV)*(kLambdaMass-fCutLambdaV) && mass1 < (kLambdaMass+fCutLambdaV)*(kLambdaMass+fCutLambdaV))
+        return kTRUE;
+    }
+    if (TMath::Abs(mass2 - kLambdaMass*kLambdaMass) < fCutLambdaV * 5)
+    {
+      mass2 = GetInvMassSquared(triggerPt, triggerEta, triggerPhi, pt, eta, phi, 0.9383, 0.1396);
+
+      fControlConvResoncances->Fill(2, mass2 - kLambdaMass*kLambdaMass);
+
+      if (mass2 > (kLambdaMass-fCutLambdaV)*(kLambdaMass-fCutLambdaV) && mass2 < (kLambdaMass+fCutLambdaV)*(kLambdaMass+fCutLambdaV))
+        return kTRUE;
+    }
+  }
+
+  // Phi
+  if (fCutPhiV > 0 && charge * triggerCharge < 0)
+  {
+    Float_t mass = GetInvMassSquaredCheap(triggerPt, triggerEta, triggerPhi, pt, eta, phi, 0.4937, 0.4937);
+
+    const Float_t kPhimass = 1.019;
+
+    if (TMath::Abs(mass - kPhimass*kPhimass) < fCutPhiV * 5)
+    {
+      mass = GetInvMassSquared(triggerPt, triggerEta, triggerPhi, pt, eta, phi, 0.4937, 0.4937);
+
+      fControlConvResoncances->Fill(3, mass - kPhimass*kPhimass);
+
+      if (mass > (kPhimass-fCutPhiV)*(kPhimass-fCutPhiV) && mass < (kPhimass+fCutPhiV)*(kPhimass+fCutPhiV))
+        return kTRUE;
+    }
+  }	
+
+  // Rho
+  if (fCutRhoV > 0 && charge * triggerCharge < 0)
+  {
+    Float_t mass = GetInvMassSquaredCheap(triggerPt, triggerEta, triggerPhi, pt, eta, phi, 0.1396, 0.1396);
+
+    const Float_t kRhomass = 0.770;
+
+    if (TMath::Abs(mass - kRhomass*kRhomass) < fCutRhoV * 5)
+    {
+      mass = GetInvMassSquared(triggerPt, triggerEta, triggerPhi, pt, eta, phi, 0.1396, 0.1396);
+
+      fControlConvResoncances->Fill(4, mass - kRhomass*kRhomass);
+
+      if (mass > (kRhomass-fCutRhoV)*(kRhomass-fCutRhoV) && mass < (kRhomass+fCutRhoV)*(kRhomass+fCutRhoV))
+        return kTRUE;
+    }
+  }
+
+  // User-defined cut
+  if (fCutCustomMass > 0 && fCutCustomFirst > 0 && fCutCustomSecond > 0 && fCutCustomV > 0 && charge * triggerCharge < 0)
+  {
+    Float_t mass = GetInvMassSquaredCheap(triggerPt, triggerEta, triggerPhi, pt, eta, phi, fCutCustomFirst, fCutCustomSecond);
+
+    if (TMath::Abs(mass - fCutCustomMass*fCutCustomMass) < fCutCustomV * 5)
+    {
+      mass = GetInvMassSquared(triggerPt, triggerEta, triggerPhi, pt, eta, phi, fCutCustomFirst, fCutCustomSecond);
+
+      fControlConvResoncances->Fill(5, mass - fCutCustomMass*fCutCustomMass);
+
+      if (mass > (fCutCustomMass-fCutCustomV)*(fCutCustomMass-fCutCustomV) && mass < (fCutCustomMass+fCutCustomV)*(fCutCustomMass+fCutCustomV))
+        return kTRUE;
+    }
+  }
+
+  if (twoTrackEfficiencyCutValue > 0)
+  {
+    // the variables & cuthave been developed by the HBT group 
+    // see e.g. https://indico.cern.ch/materialDisplay.py?contribId=36&sessionId=6&materialId=slides&confId=142700
+
+    Float_t phi1 = triggerPhi;
+    Float_t pt1 = triggerPt;
+    Float_t charge1 = triggerCharge;
+
+    Float_t phi2 = phi;
+    Float_t pt2 = pt;
+    Float_t charge2 = charge;
+
+    Float_t deta = triggerEta - eta;
+
+    // optimization
+    if (TMath::Abs(deta) < twoTrackEfficiencyCutValue * 2.5 * 3)
+    {
+      // phi1 - phi2 as in GetDPhiStar
+      const Float_t dphi = phi1 - phi2;
+      const Int_t nRadii = fTwoTrackRadii.size();
+
+      // check first boundaries to see if is worth to loop and find the minimum
+      Float_t dphistar1 = 0;
+      Float_t dphistar2 = 0;
+      if (triggerBend && bend)
+      {
+        dphistar1 = WrapDPhiStar(dphi - triggerBend[0] + bend[0]);
+        dphistar2 = WrapDPhiStar(dphi - triggerBend[nRadii-1] + bend[nRadii-1]);
+      }
+      else
+      {
+        dphistar1 = GetDPhiStar(phi1, pt1, charge1, phi2, pt2, charge2, fTwoTrackCutMinRadius, bSign);
+        dphistar2 = GetDPhiStar(phi1, pt1, charge1, phi2, pt2, charge2, 2.5, bSign);
+      }
+
+      const Float_t kLimit = twoTrackEfficiencyCutValue * 3;
+
+      Float_t dphistarminabs = 1e5;
+      Float_t dphistarmin = 1e5;
+      if (TMath::Abs(dphistar1) < kLimit || TMath::Abs(dphistar2) < kLimit || dphistar1 * dphistar2 < 0)
+      {
+        if (triggerBend && bend)
+        {
+          // the scanned radii are the first nRadii-1 entries of the rows
+          for (Int_t r=0; r<nRadii-1; r++)
+          {
+            Float_t dphistar = WrapDPhiStar(dphi - triggerBend[r] + bend[r]);
+
+            Float_t dphistarabs = TMath::Abs(dphistar);
+
+            if (dphistarabs < dphistarminabs)
+            {
+              dphistarmin = dphistar;
+              dphistarminabs = dphistarabs;
+            }
+          }
+        }
+        else
+        {
+          for (Double_t rad=fTwoTrackCutMinRadius; rad<2.51; rad+=0.01) 
+          {
+            Float_t dphistar = GetDPhiStar(phi1, pt1, charge1, phi2, pt2, charge2, rad, bSign);
+
+            Float_t dphistarabs = TMath::Abs(dphistar);
+
+            if (dphistarabs < dphistarminabs)
+            {
+              dphistarmin = dphistar;
+              dphistarminabs = dphistarabs;
+            }
+          }
+        }
+
+        fTwoTrackDistancePt[0]->Fill(deta, dphistarmin, TMath::Abs(pt1 - pt2));
+
+        if (dphistarminabs < twoTrackEfficiencyCutValue && TMath::Abs(deta) < twoTrackEfficiencyCutValue)
+        {
+// 		Printf("Removed track pair %d %d with %f %f %f %f %f %f %f %f %f", i, j, deta, dphistarminabs, phi1, pt1, charge1, phi2, pt2, charge2, bSign);
+          return kTRUE;
+        }
+
+        fTwoTrackDistancePt[1]->Fill(deta, dphistarmin, TMath::Abs(pt1 - pt2));
+      }
+    }
+  }
+
+  return kFALSE;
+}
   
 //____________________________________________________________________
 void AliUEHistograms::FillTrackingEfficiency(TObjArray* mc, TObjArray* recoPrim, TObjArray* recoAll, TObjArray* recoPrimPID, TObjArray* recoAllPID, TObjArray* fake, Int_t particleType, Double_t centrality, Double_t zVtx)
@@ -1374,6 +1796,7 @@ void AliUEHistograms::Copy(TObject& c) const
   target.fPtOrder = fPtOrder;
   target.fTwoTrackCutMinRadius = fTwoTrackCutMinRadius;
   target.fCheckEventNumberInCorrelation = fCheckEventNumberInCorrelation;
+  target.fUseFlatPairLoop = fUseFlatPairLoop;
 }
 
 //____________________________________________________________________
@@ -8,6 +8,7 @@
 
 // encapsulates several AliUEHist objects for a full UE analysis plus additional control histograms
 
+#include <vector>
 #include "TNamed.h"
 #include "AliUEHist.h"
 #include "TMath.h"
@@ -18,6 +19,7 @@ class AliVParticle;
 class TList;
 class TSeqCollection;
 class TObjArray;
+class TH1;
 class TH1F;
 class TH2F;
 class TH3F;
@@ -106,6 +108,7 @@ class AliUEHistograms : public TNamed
   void SetTwoTrackCutMinRadius(Float_t min) { fTwoTrackCutMinRadius = min; }
 
   void SetCheckEventNumberInCorrelation(Bool_t val) { fCheckEventNumberInCorrelation = val; }
+  void SetUseFlatPairLoop(Bool_t flag) { fUseFlatPairLoop = flag; }
   void ExtendTrackingEfficiency(Bool_t verbose = kFALSE);
   void Reset();
 
@@ -117,12 +120,19 @@ class AliUEHistograms : public TNamed
   void Scale(Double_t factor);
   
 protected:
+  void FillCorrelationsFlat(Double_t centrality, Float_t zVtx, AliUEHist::CFStep step, TObjArray* particles, TObjArray* mixed, Float_t weight, Bool_t firstTime, Bool_t twoTrackCuts, Float_t bSign, Float_t twoTrackEfficiencyCutValue, Bool_t applyEfficiency);
+  TH1* CreateTriggerWeighting(TObjArray* particles);
+  void FillTriggerParticle(AliVParticle* triggerParticle, Float_t triggerEta, Double_t centrality, Float_t zVtx, AliUEHist::CFStep step, Bool_t applyEfficiency, TH1* triggerWeighting);
+  Bool_t RejectPairTwoTrackCuts(Double_t triggerPt, Float_t triggerEta, Double_t triggerPhi, Short_t triggerCharge, Double_t pt, Float_t eta, Double_t phi, Short_t charge, Float_t twoTrackEfficiencyCutValue, Float_t bSign, const Double_t* triggerBend = 0, const Double_t* bend = 0);
+  void FillTwoTrackCutTable(Int_t set, TObjArray* particles, Float_t bSign);
   void FillRegion(AliUEHist::Region region, Float_t zVtx, AliUEHist::CFStep step, AliVParticle* leading, TList* list, Int_t multiplicity);
   Int_t CountParticles(TList* list, Float_t ptMin);
   void DeleteContainers();
   inline Float_t GetInvMassSquared(Float_t pt1, Float_t eta1, Float_t phi1, Float_t pt2, Float_t eta2, Float_t phi2, Float_t m0_1, Float_t m0_2);
   inline Float_t GetInvMassSquaredCheap(Float_t pt1, Float_t eta1, Float_t phi1, Float_t pt2, Float_t eta2, Float_t phi2, Float_t m0_1, Float_t m0_2);
   inline Float_t GetDPhiStar(Float_t phi1, Float_t pt1, Float_t charge1, Float_t phi2, Float_t pt2, Float_t charge2, Float_t radius, Float_t bSign);
+  inline Double_t GetDPhiStarBend(Float_t pt, Float_t charge, Float_t radius, Float_t bSign);
+  inline Float_t WrapDPhiStar(Float_t dphistar);
   
   static const Int_t fgkUEHists; // number of histograms
 
@@ -177,12 +187,27 @@ protected:
   Float_t fTwoTrackCutMinRadius; // min radius for TTR cut
 
   Bool_t fCheckEventNumberInCorrelation; // do not correlate two particles from the same event (only works for AliBasicParticles)
+  Bool_t fUseFlatPairLoop;               // FillCorrelations copies the particles into the arrays below and selects the pairs with masks (same output)
+
+  std::vector<Double_t> fFlatPt[2];         //! pt of the trigger [0] and associated [1] particles (only [0] if not mixed)
+  std::vector<Float_t>  fFlatEta[2];        //! eta
+  std::vector<Double_t> fFlatPhi[2];        //! phi
+  std::vector<Short_t>  fFlatCharge[2];     //! charge
+  std::vector<UChar_t>  fFlatFlags[2];      //! resonance daughter flag
+  std::vector<Long64_t> fFlatEventIndex[2]; //! event index (with fCheckEventNumberInCorrelation)
+  std::vector<Double_t> fFlatEfficiency;    //! efficiency correction of the associated particles
+  std::vector<UChar_t>  fFlatMask;          //! pair selection for the current trigger particle
+  std::vector<Double_t> fFlatPairVars;      //! fill variables of the accepted pairs of the current trigger particle (6 columns of nAssoc entries)
+  std::vector<Double_t> fFlatPairWeights;   //! weights of the accepted pairs of the current trigger particle
+
+  std::vector<Float_t>  fTwoTrackRadii;     //! radii of the dphi* scan of the two-track cut, the last one is the outer radius (2.5 m)
+  std::vector<Double_t> fTwoTrackBend[2];   //! bending term of dphi* (GetDPhiStarBend) at fTwoTrackRadii of the trigger [0] and associated [1] particles (one row per particle)
 
   Long64_t fRunNumber;           // run number that has been processed
   
   Int_t fMergeCount;		// counts how many objects have been merged together
   
-  ClassDef(AliUEHistograms, 33)  // underlying event histogram container
+  ClassDef(AliUEHistograms, 35)  // underlying event histogram container
 };
 
 Float_t AliUEHistograms::GetDPhiStar(Float_t phi1, Float_t pt1, Float_t charge1, Float_t phi2, Float_t pt2, Float_t charge2, Float_t radius, Float_t bSign)
@@ -193,6 +218,24 @@ Float_t AliUEHistograms::GetDPhiStar(Float_t phi1, Float_t pt1, Float_t charge1,
   
   Float_t dphistar = phi1 - phi2 - charge1 * bSign * TMath::ASin(0.075 * radius / pt1) + charge2 * bSign * TMath::ASin(0.075 * radius / pt2);
   
+  return WrapDPhiStar(dphistar);
+}
+
+Double_t AliUEHistograms::GetDPhiStarBend(Float_t pt, Float_t charge, Float_t radius, Float_t bSign)
+{
+  //
+  // bending term of one particle in dphistar, with the same precision as in GetDPhiStar
+  //
+
+  return charge * bSign * TMath::ASin(0.075 * radius / pt);
+}
+
+Float_t AliUEHistograms::WrapDPhiStar(Float_t dphistar)
+{
+  //
+  // folds dphistar into [-pi, pi]
+  //
+
   static const Double_t kPi = TMath::Pi();
   
   // circularity
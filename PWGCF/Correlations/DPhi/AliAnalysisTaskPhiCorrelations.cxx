@@ -209,7 +209,8 @@ fCustomParticlesA(""),
 fCustomParticlesB(""),
 fEventPoolOutputList(),
 fUsePtBinnedEventPool(0),
-fCheckEventNumberInMixedEvent(kFALSE)
+fCheckEventNumberInMixedEvent(kFALSE),
+fUseFlatPairLoop(kFALSE)
 {
   // Default constructor
   // Define input and output slots here
@@ -383,6 +384,9 @@ void  AliAnalysisTaskPhiCorrelations::CreateOutputObjects()
   fHistos->SetTwoTrackCutMinRadius(fTwoTrackCutMinRadius);
   fHistosMixed->SetTwoTrackCutMinRadius(fTwoTrackCutMinRadius);
 
+  fHistos->SetUseFlatPairLoop(fUseFlatPairLoop);
+  fHistosMixed->SetUseFlatPairLoop(fUseFlatPairLoop);
+
   if (fEfficiencyCorrectionTriggers) {
     fHistos->SetEfficiencyCorrectionTriggers(fEfficiencyCorrectionTriggers);
     fHistosMixed->SetEfficiencyCorrectionTriggers((THnF*) fEfficiencyCorrectionTriggers->Clone());
@@ -622,6 +626,7 @@ void  AliAnalysisTaskPhiCorrelations::AddSettingsTree()
   settingsTree->Branch("fUseNewCentralityFramework", &fUseNewCentralityFramework,"fUseNewCentralityFramework/O");
   settingsTree->Branch("fTwoTrackEfficiencyCut", &fTwoTrackEfficiencyCut,"TwoTrackEfficiencyCut/D");
   settingsTree->Branch("fTwoTrackCutMinRadius", &fTwoTrackCutMinRadius,"TwoTrackCutMinRadius/D");
+  settingsTree->Branch("fUseFlatPairLoop", &fUseFlatPairLoop,"UseFlatPairLoop/O");
 
   //fCustomBinning
 
@@ -184,6 +184,7 @@ public:
   AliEventPoolManager* GetEventPoolManager() {return fPoolMgr;}
   void SetUsePtBinnedEventPool(Bool_t val) {fUsePtBinnedEventPool = val;}
   void SetCheckEventNumberInMixedEvent(Bool_t val) {fCheckEventNumberInMixedEvent = val;}
+  void SetUseFlatPairLoop(Bool_t val) {fUseFlatPairLoop = val;}
 
   // Set which pools will be saved
   void AddEventPoolsToOutput(Double_t minCent, Double_t maxCent,  Double_t minZvtx, Double_t maxZvtx, Double_t minPt, Double_t maxPt);
@@ -342,8 +343,9 @@ private:
   vector<vector<Double_t> > fEventPoolOutputList; // vector representing a list of pools (given by value range) that will be saved
   Bool_t fUsePtBinnedEventPool;                   // uses event pool in pt bins
   Bool_t fCheckEventNumberInMixedEvent;           // check event number before correlation in mixed event
+  Bool_t fUseFlatPairLoop;                        // use the struct-of-arrays pair loop of AliUEHistograms::FillCorrelations
 
-  ClassDef(AliAnalysisTaskPhiCorrelations, 64); // Analysis task for delta phi correlations
+  ClassDef(AliAnalysisTaskPhiCorrelations, 65); // Analysis task for delta phi correlations
 };
 
 #endif
@@ -8,24 +8,152 @@
 ///////////////////////////////////////////////////////////////////////////
 
 #include "AliFemtoManager.h"
+#include "AliFemtoSimpleAnalysis.h"
+#include "AliFemtoPair.h"
 //#include "AliFemtoParticleCollection.h"
 //#include "AliFemtoTrackCut.h"
 //#include "AliFemtoV0Cut.h"
 #include <cstdio>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #ifdef __ROOT__
+#include "TROOT.h"
   /// \cond CLASSIMP
   ClassImp(AliFemtoManager);
   /// \endcond
 #endif
 
+/// \class AliFemtoManagerWorkers
+/// \brief Threads processing the analyses of the events of an AliFemtoManager
+///
+/// The threads wait between events. For each event the calling thread and
+/// the workers take the next unprocessed analysis until all are done.
+///
+class AliFemtoManagerWorkers {
+public:
+  AliFemtoManagerWorkers(size_t nThreads);
+  ~AliFemtoManagerWorkers();
+
+  size_t NumberOfThreads() const { return fThreads.size() + 1; }
+
+  /// Process the event with all analyses, returns when they are all done
+  void Process(const std::vector<AliFemtoAnalysis*> &analyses, AliFemtoEvent *event);
+
+private:
+  AliFemtoManagerWorkers(const AliFemtoManagerWorkers&);
+  AliFemtoManagerWorkers& operator=(const AliFemtoManagerWorkers&);
+
+  void Run(unsigned int index);
+  void ProcessAnalyses();
+
+  std::vector<std::thread> fThreads;               ///< Worker threads, the calling thread is the last one
+  std::mutex fMutex;                               ///< Protects the members below
+  std::condition_variable fStart;                  ///< Signals a new event or the stop to the workers
+  std::condition_variable fDone;                   ///< Signals the calling thread that all workers are done
+  unsigned long fGeneration;                       ///< Number of events given to the workers
+  size_t fBusy;                                    ///< Number of workers still processing the event
+  bool fStop;                                      ///< Workers have to return
+  const std::vector<AliFemtoAnalysis*> *fAnalyses; ///< Analyses of the current event
+  AliFemtoEvent *fEvent;                           ///< Current event
+  std::atomic<size_t> fNextAnalysis;               ///< Next analysis to be processed
+};
+
+//____________________________
+AliFemtoManagerWorkers::AliFemtoManagerWorkers(size_t nThreads):
+  fThreads(),
+  fMutex(),
+  fStart(),
+  fDone(),
+  fGeneration(0),
+  fBusy(0),
+  fStop(false),
+  fAnalyses(nullptr),
+  fEvent(nullptr),
+  fNextAnalysis(0)
+{
+  for (size_t iThread = 0; iThread + 1 < nThreads; ++iThread) {
+    fThreads.emplace_back(&AliFemtoManagerWorkers::Run, this, (unsigned int) iThread);
+  }
+}
+//____________________________
+AliFemtoManagerWorkers::~AliFemtoManagerWorkers()
+{
+  {
+    std::lock_guard<std::mutex> lock(fMutex);
+    fStop = true;
+  }
+  fStart.notify_all();
+  for (auto &thread : fThreads) {
+    thread.join();
+  }
+}
+//____________________________
+void AliFemtoManagerWorkers::Process(const std::vector<AliFemtoAnalysis*> &analyses, AliFemtoEvent *event)
+{
+  {
+    std::lock_guard<std::mutex> lock(fMutex);
+    fAnalyses = &analyses;
+    fEvent = event;
+    fNextAnalysis = 0;
+    fBusy = fThreads.size();
+    ++fGeneration;
+  }
+  fStart.notify_all();
+
+  ProcessAnalyses();
+
+  std::unique_lock<std::mutex> lock(fMutex);
+  fDone.wait(lock, [this]() { return fBusy == 0; });
+}
+//____________________________
+void AliFemtoManagerWorkers::Run(unsigned int index)
+{
+  // the generator of the random pair ordering is per thread
+  AliFemtoPair::SetThreadRandomSeed(index + 1);
+
+  unsigned long generation = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(fMutex);
+      fStart.wait(lock, [&]() { return fStop || fGeneration != generation; });
+      if (fStop) {
+        return;
+      }
+      generation = fGeneration;
+    }
+
+    ProcessAnalyses();
+
+    std::lock_guard<std::mutex> lock(fMutex);
+    if (--fBusy == 0) {
+      fDone.notify_one();
+    }
+  }
+}
+//____________________________
+void AliFemtoManagerWorkers::ProcessAnalyses()
+{
+  // the analyses are independent: each one is taken by the next free thread
+  const size_t nAnalyses = fAnalyses->size();
+  for (size_t iAnalysis = fNextAnalysis++; iAnalysis < nAnalyses; iAnalysis = fNextAnalysis++) {
+    (*fAnalyses)[iAnalysis]->ProcessEvent(fEvent);
+  }
+}
+
 
 
 //____________________________
 AliFemtoManager::AliFemtoManager():
   fAnalysisCollection(nullptr),
   fEventReader(nullptr),
-  fEventWriterCollection(nullptr)
+  fEventWriterCollection(nullptr),
+  fNumberOfThreads(1),
+  fWorkers(nullptr)
 {
   // default constructor
   fAnalysisCollection = new AliFemtoAnalysisCollection;
@@ -35,7 +163,9 @@ AliFemtoManager::AliFemtoManager():
 AliFemtoManager::AliFemtoManager(const AliFemtoManager& aManager):
   fAnalysisCollection(new AliFemtoAnalysisCollection),
   fEventReader(aManager.fEventReader),
-  fEventWriterCollection(new AliFemtoEventWriterCollection)
+  fEventWriterCollection(new AliFemtoEventWriterCollection),
+  fNumberOfThreads(aManager.fNumberOfThreads),
+  fWorkers(nullptr)
 {
   // copy constructor
   for (auto *analysis : *aManager.fAnalysisCollection) {
@@ -50,6 +180,7 @@ AliFemtoManager::AliFemtoManager(const AliFemtoManager& aManager):
 AliFemtoManager::~AliFemtoManager()
 {
   // destructor
+  delete fWorkers;
   delete fEventReader;
   // now delete each Analysis in the Collection, and then the Collection itself
   for (auto *analysis : *fAnalysisCollection) {
@@ -71,6 +202,9 @@ AliFemtoManager& AliFemtoManager::operator=(const AliFemtoManager& aManager)
   }
 
   fEventReader = aManager.fEventReader;
+  fNumberOfThreads = aManager.fNumberOfThreads;
+  delete fWorkers;
+  fWorkers = nullptr;
 
 
   for (auto *analysis : *fAnalysisCollection) {
@@ -210,8 +344,28 @@ int AliFemtoManager::ProcessEvent()
   }
 
   // loop over all the Analysis
-  for (auto *analysis : *fAnalysisCollection) {
-    analysis->ProcessEvent(currentHbtEvent);
+  const size_t nAnalyses = fAnalysisCollection->size();
+  const size_t nThreads = std::min<size_t>(fNumberOfThreads, nAnalyses);
+  if (nThreads <= 1) {
+    for (auto *analysis : *fAnalysisCollection) {
+      analysis->ProcessEvent(currentHbtEvent);
+    }
+  } else {
+    if (!fWorkers || fWorkers->NumberOfThreads() != nThreads) {
+#ifdef __ROOT__
+      ROOT::EnableThreadSafety();
+#endif
+      delete fWorkers;
+      fWorkers = new AliFemtoManagerWorkers(nThreads);
+    }
+    const std::vector<AliFemtoAnalysis*> analyses(fAnalysisCollection->begin(), fAnalysisCollection->end());
+    // the printouts of the analyses would interleave
+    for (auto *analysis : analyses) {
+      if (auto *simpleAnalysis = dynamic_cast<AliFemtoSimpleAnalysis*>(analysis)) {
+        simpleAnalysis->SetVerboseMode(kFALSE);
+      }
+    }
+    fWorkers->Process(analyses, currentHbtEvent);
   }
 
   if (currentHbtEvent) {
@@ -19,6 +19,7 @@
 #include "AliFemtoEventReader.h"
 #include "AliFemtoEventWriter.h"
 
+class AliFemtoManagerWorkers;
 
 /// \class AliFemtoManager
 /// \brief Main class for managing femtoscopic analyses
@@ -49,6 +50,8 @@ private:
   AliFemtoAnalysisCollection* fAnalysisCollection;       ///< Collection of analyzes
   AliFemtoEventReader*        fEventReader;              ///< Event reader
   AliFemtoEventWriterCollection* fEventWriterCollection; ///< Event writer collection
+  int                         fNumberOfThreads;          ///< Number of threads processing the analyses of an event
+  AliFemtoManagerWorkers*     fWorkers;                  //!<! Worker threads, kept from one event to the next
 
   AliFemtoManager(const AliFemtoManager& aManager);
   AliFemtoManager& operator=(const AliFemtoManager& aManager);
@@ -70,6 +73,20 @@ public:
   AliFemtoEventReader* EventReader();
   void SetEventReader(AliFemtoEventReader* r);
 
+  /// Process the analyses of each event on `n` threads (default 1: one after
+  /// the other). Each analysis is processed by one thread at a time, so its
+  /// cuts, correlation functions and mixing buffer need no synchronization;
+  /// the analyses must however not share cut or correlation function objects
+  /// nor modify the event. The EventWriters are always called sequentially.
+  ///
+  /// The worker threads are started at the first event and reused for the
+  /// following ones, and ROOT thread safety is enabled. The verbose output
+  /// of AliFemtoSimpleAnalysis is switched off, as it would interleave. The
+  /// random particle ordering of the QYKP pair variables uses one generator
+  /// per thread, so these variables are not reproducible in threaded runs.
+  void SetNumberOfThreads(int n);
+  int NumberOfThreads() const;
+
   /// Calls `Init()` on all owned EventWriters
   ///
   /// Returns 0 for success, 1 for failure.
@@ -99,4 +116,7 @@ inline void AliFemtoManager::SetEventWriter(AliFemtoEventWriter* writer){fEventW
 inline AliFemtoEventReader* AliFemtoManager::EventReader(){return fEventReader;}
 inline void AliFemtoManager::SetEventReader(AliFemtoEventReader* reader){fEventReader = reader;}
 
+inline void AliFemtoManager::SetNumberOfThreads(int n){fNumberOfThreads = n > 1 ? n : 1;}
+inline int AliFemtoManager::NumberOfThreads() const {return fNumberOfThreads;}
+
 #endif
@@ -9,6 +9,22 @@
 ///////////////////////////////////////////////////////////////////////////
 #include <TMath.h>
 #include "AliFemtoPair.h"
+#include <cstdlib>
+#include <random>
+
+namespace {
+  thread_local bool gThreadRandom = false;
+  thread_local std::mt19937 gThreadRandomEngine;
+
+  /// Random ordering of the two particles of the pair
+  inline bool RandomOrder()
+  {
+    if (!gThreadRandom) {
+      return rand()/(double)RAND_MAX > 0.50;
+    }
+    return gThreadRandomEngine() > gThreadRandomEngine.max() / 2;
+  }
+}
 
 double AliFemtoPair::fgMaxDuInner = .8;
 double AliFemtoPair::fgMaxDzInner = 3.;
@@ -20,6 +36,12 @@ AliFemtoPair::AliFemtoPair():
   fTrack1(nullptr),
   fTrack2(nullptr),
   fPairAngleEP(0.0),
+  fKinParNotCalculated(1),
+  fQInvCalc(0.0),
+  fKTCalc(0.0),
+  fQOutCMSCalc(0.0),
+  fQSideCMSCalc(0.0),
+  fQLongCMSCalc(0.0),
   fNonIdParNotCalculated(0.0),
   fDKSide(0.0),
   fDKOut(0.0),
@@ -60,6 +82,12 @@ AliFemtoPair::AliFemtoPair(AliFemtoParticle* a, AliFemtoParticle* b):
   fTrack1(a),
   fTrack2(b),
   fPairAngleEP(0.0),
+  fKinParNotCalculated(1),
+  fQInvCalc(0.0),
+  fKTCalc(0.0),
+  fQOutCMSCalc(0.0),
+  fQSideCMSCalc(0.0),
+  fQLongCMSCalc(0.0),
   fNonIdParNotCalculated(0.0),
   fDKSide(0.0),
   fDKOut(0.0),
@@ -131,6 +159,12 @@ AliFemtoPair::AliFemtoPair(const AliFemtoPair &aPair):
   fTrack1(aPair.fTrack1),
   fTrack2(aPair.fTrack2),
   fPairAngleEP(aPair.fPairAngleEP),
+  fKinParNotCalculated(aPair.fKinParNotCalculated),
+  fQInvCalc(aPair.fQInvCalc),
+  fKTCalc(aPair.fKTCalc),
+  fQOutCMSCalc(aPair.fQOutCMSCalc),
+  fQSideCMSCalc(aPair.fQSideCMSCalc),
+  fQLongCMSCalc(aPair.fQLongCMSCalc),
   fNonIdParNotCalculated(aPair.fNonIdParNotCalculated),
   fDKSide(aPair.fDKSide),
   fDKOut(aPair.fDKOut),
@@ -177,6 +211,13 @@ AliFemtoPair& AliFemtoPair::operator=(const AliFemtoPair &aPair)
 
   fPairAngleEP = aPair.fPairAngleEP;
 
+  fKinParNotCalculated = aPair.fKinParNotCalculated;
+  fQInvCalc = aPair.fQInvCalc;
+  fKTCalc = aPair.fKTCalc;
+  fQOutCMSCalc = aPair.fQOutCMSCalc;
+  fQSideCMSCalc = aPair.fQSideCMSCalc;
+  fQLongCMSCalc = aPair.fQLongCMSCalc;
+
   fNonIdParNotCalculated = aPair.fNonIdParNotCalculated;
   fDKSide = aPair.fDKSide;
   fDKOut = aPair.fDKOut;
@@ -233,15 +274,6 @@ double AliFemtoPair::MInv() const
     return tInvariantMass;
 }
 //_________________
-double AliFemtoPair::KT() const
-{
-  // transverse momentum
-  double tmp = (fTrack1->FourMomentum() + fTrack2->FourMomentum()).Perp();
-  tmp *= .5;
-
-  return tmp;
-}
-//_________________
 double AliFemtoPair::Rap() const
 {
   // longitudinal pair rapidity : Y = 0.5 ::log( E1 + E2 + pz1 + pz2 / E1 + E2 - pz1 - pz2 )
@@ -280,6 +312,13 @@ AliFemtoLorentzVector AliFemtoPair::FourMomentumDiff() const
   return temp;
 }
 //__________________________________
+void AliFemtoPair::SetThreadRandomSeed(unsigned int seed)
+{
+  // use a generator of this thread for the random particle ordering
+  gThreadRandomEngine.seed(seed);
+  gThreadRandom = true;
+}
+//__________________________________
 void AliFemtoPair::QYKPCMS(double& qP, double& qT, double& q0) const
 {
   // Yano-Koonin-Podgoretskii Parametrisation in CMS
@@ -290,7 +329,7 @@ void AliFemtoPair::QYKPCMS(double& qP, double& qT, double& q0) const
   const AliFemtoLorentzVector &l2 = fTrack2->FourMomentum();
 
   // random ordering of the particles
-  AliFemtoLorentzVector l = (rand()/(double)RAND_MAX > 0.50)
+  AliFemtoLorentzVector l = RandomOrder()
                           ? l1 - l2
                           : l2 - l1;
 
@@ -333,7 +372,7 @@ void AliFemtoPair::QYKPLCMS(double& qP, double& qT, double& q0) const
   AliFemtoLorentzVector l2boosted = l2.boost(l);
 
   // caculate the momentum difference with random ordering of the particle
-  if ( rand()/(double)RAND_MAX >0.50) {
+  if (RandomOrder()) {
     l = l1boosted-l2boosted;
   } else {
     l = l2boosted-l1boosted;
@@ -364,7 +403,7 @@ void AliFemtoPair::QYKPPF(double& qP, double& qT, double& q0) const
   AliFemtoLorentzVector l2boosted = l2.boost(l);
 
   // caculate the momentum difference with random ordering of the particle
-  if ( rand()/(double)RAND_MAX > 0.50) {
+  if (RandomOrder()) {
     l = l1boosted-l2boosted;
   } else {
     l = l2boosted-l1boosted;
@@ -376,80 +415,28 @@ void AliFemtoPair::QYKPPF(double& qP, double& qT, double& q0) const
   q0 = l.e();
 }
 
-
-// optimized division - returns 0 if denominator zero
-#ifdef __GNUC__
-  #define CHECKED_DIVIDE_ELSE_ZERO(_num, _den) \
-    __builtin_expect(_den == 0.0, false) ? 0.0 : _num / _den
-#else
-  #define CHECKED_DIVIDE_ELSE_ZERO(_num, _den) \
-    _den == 0.0 ? 0.0 : _num / _den
-#endif
-
-
 //_________________
-double AliFemtoPair::QOutCMS() const
+void AliFemtoPair::CalcKinPar() const
 {
-  // relative momentum out component in lab frame
-  const AliFemtoThreeVector
-    &p1 = fTrack1->FourMomentum().vect(),
-    &p2 = fTrack2->FourMomentum().vect();
-
-  const double
-    dx = p1.x() - p2.x(),
-    px = p1.x() + p2.x(),
-
-    dy = p1.y() - p2.y(),
-    py = p1.y() + p2.y(),
-
-    k = dx*px + dy*py,
-    pt = ::sqrt(px*px + py*py);
-
-  return CHECKED_DIVIDE_ELSE_ZERO(k, pt);
-}
-
-//_________________
-double AliFemtoPair::QSideCMS() const
-{
-  // relative momentum side component in lab frame
-  const AliFemtoThreeVector
-    &p1 = fTrack1->FourMomentum().vect(),
-    &p2 = fTrack2->FourMomentum().vect();
-
-  const double
-    x1 = p1.x(),
-    y1 = p1.y(),
-
-    x2 = p2.x(),
-    y2 = p2.y(),
+  // Calculate and cache qinv, kT and the relative momentum components in LCMS
+  fKinParNotCalculated = 0;
 
-    xt = x1+x2,
-    yt = y1+y2,
-
-    k = 2.0 * (x2*y1 - x1*y2),
-    pt = ::sqrt(xt*xt + yt*yt);
-
-  return CHECKED_DIVIDE_ELSE_ZERO(k, pt);
-}
-
-//_________________________
-double AliFemtoPair::QLongCMS() const
-{
-  // relative momentum component in lab frame
   const AliFemtoLorentzVector
     &tmp1 = fTrack1->FourMomentum(),
     &tmp2 = fTrack2->FourMomentum();
 
-  double dz = tmp1.z() - tmp2.z();
-  double zz = tmp1.z() + tmp2.z();
-
-  double dt = tmp1.t() - tmp2.t();
-  double tt = tmp1.t() + tmp2.t();
+  const double
+    p1[4] = {tmp1.x(), tmp1.y(), tmp1.z(), tmp1.t()},
+    p2[4] = {tmp2.x(), tmp2.y(), tmp2.z(), tmp2.t()};
 
-  double beta = zz/tt;
-  double gamma = 1.0/TMath::Sqrt((1.-beta)*(1.+beta));
+  double values[AliFemtoPairKinematics::kNVariables];
+  AliFemtoPairKinematics::CalcRelativeMomentum(p1, p2, values);
 
-  return gamma * (dz - beta*dt);
+  fQInvCalc = values[AliFemtoPairKinematics::kQInv];
+  fKTCalc = values[AliFemtoPairKinematics::kKT];
+  fQOutCMSCalc = values[AliFemtoPairKinematics::kQOutCMS];
+  fQSideCMSCalc = values[AliFemtoPairKinematics::kQSideCMS];
+  fQLongCMSCalc = values[AliFemtoPairKinematics::kQLongCMS];
 }
 
 //________________________________
@@ -475,7 +462,6 @@ double AliFemtoPair::QOutPf() const
   return gammaOut * (QOutCMS() - bOut*dt);
 }
 
-#undef CHECKED_DIVIDE_ELSE_ZERO
 
 
 //___________________________________
@@ -760,78 +746,28 @@ double AliFemtoPair::QInvFlippedXY() const
 }
 
 void AliFemtoPair::CalcNonIdPar() const
-{ // fortran like function! faster?
-  // Calculate generalized relative mometum
-  // Use this instead of qXYZ() function when calculating
-  // anything for non-identical particles
+{
+  // Calculate and cache k* and its components, see AliFemtoPairKinematics::CalcNonIdentical()
   fNonIdParNotCalculated=0;
 
   const AliFemtoLorentzVector
-    &p1 = fTrack1->FourMomentum(),
-    &p2 = fTrack2->FourMomentum();
+    &tmp1 = fTrack1->FourMomentum(),
+    &tmp2 = fTrack2->FourMomentum();
 
   const double
-    px1 = p1.x(),
-    py1 = p1.y(),
-    pz1 = p1.z(),
-    pE1  = p1.e(),
-    mass1_sqrd = std::max({0.0, p1.m2()}),
-
-    px2 = p2.x(),
-    py2 = p2.y(),
-    pz2 = p2.z(),
-    pE2  = p2.e(),
-    mass2_sqrd = std::max({0.0, p2.m2()}),
-
-    tPx = px1 + px2,
-    tPy = py1 + py2,
-    tPz = pz1 + pz2,
-    tPE = pE1 + pE2;
-
-  double tPtrans = tPx*tPx + tPy*tPy;
-  double tMtrans = tPE*tPE - tPz*tPz;
-  double tPinv = ::sqrt(tMtrans - tPtrans);
-  tMtrans = ::sqrt(tMtrans);
-  tPtrans = ::sqrt(tPtrans);
-
-  double tQinvL = (pE1-pE2)*(pE1-pE2) - (px1-px2)*(px1-px2) -
-    (py1-py2)*(py1-py2) - (pz1-pz2)*(pz1-pz2);
-
-  double tQ = (mass1_sqrd - mass2_sqrd)/tPinv;
-  tQ = ::sqrt( tQ*tQ - tQinvL);
+    p1[4] = {tmp1.x(), tmp1.y(), tmp1.z(), tmp1.e()},
+    p2[4] = {tmp2.x(), tmp2.y(), tmp2.z(), tmp2.e()};
 
-  fKStarCalc = tQ/2;
+  double values[AliFemtoPairKinematics::kNVariables];
+  AliFemtoPairKinematics::CalcNonIdentical(p1, p2, values);
 
-  // ad 1) go to LCMS
-  double beta = tPz/tPE;
-  double gamma = tPE/tMtrans;
-
-  double pz1L = gamma * (pz1 - beta * pE1);
-  double pE1L = gamma * (pE1 - beta * pz1);
-
-  // fill histogram for beam projection ( z - axis )
-  fDKLong = pz1L;
-
-  // ad 2) rotation px -> tPt
-  double px1R = (px1*tPx + py1*tPy)/tPtrans;
-  double py1R = (-px1*tPy + py1*tPx)/tPtrans;
-
-  //fill histograms for side projection ( y - axis )
-  fDKSide = py1R;
-
-  // ad 3) go from LCMS to CMS
-  beta = tPtrans/tMtrans;
-  gamma = tMtrans/tPinv;
-
-  double px1C = gamma * (px1R - beta * pE1L);
-
-  // fill histogram for out projection ( x - axis )
-  fDKOut  = px1C;
-
-  fCVK = (fDKOut*tPtrans + fDKLong*tPz)/fKStarCalc/::sqrt(tPtrans*tPtrans+tPz*tPz);
+  fKStarCalc = values[AliFemtoPairKinematics::kKStar];
+  fDKOut = values[AliFemtoPairKinematics::kKStarOut];
+  fDKSide = values[AliFemtoPairKinematics::kKStarSide];
+  fDKLong = values[AliFemtoPairKinematics::kKStarLong];
+  fCVK = values[AliFemtoPairKinematics::kCVK];
 }
 
-
 static double _calc_avgsep_mean(double sep, int count)
 {
   return __builtin_expect(count != 0, 1)
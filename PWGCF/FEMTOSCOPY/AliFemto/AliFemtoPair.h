@@ -26,6 +26,7 @@ namespace std {
 
 #include "AliFemtoParticle.h"
 #include "AliFemtoTypes.h"
+#include "AliFemtoPairKinematics.h"
 
 class AliFemtoPair {
 public:
@@ -42,6 +43,11 @@ public:
   void SetTrack1(const AliFemtoParticle* trkPtr);
   void SetTrack2(const AliFemtoParticle* trkPtr);
 
+  /// Set the cached relative momentum variables of the current tracks
+  /// (array indexed by AliFemtoPairKinematics::EVariable), computed in a
+  /// batch by AliFemtoPairKinematics. Must be called after SetTrack1/SetTrack2.
+  void SetKinematics(const double *values);
+
   AliFemtoLorentzVector FourMomentumDiff() const;
   AliFemtoLorentzVector FourMomentumSum() const;
   double QInv() const;
@@ -85,6 +91,13 @@ public:
   void QYKPLCMS(double& qP, double& qT, double& q0) const;
   void QYKPPF(double& qP, double& qT, double& q0) const; /// Calculate the momentum diffference in the pair rest frame
 
+  /// Give the calling thread its own generator for the random particle
+  /// ordering of the QYKP* methods, instead of the global rand(). Used by
+  /// the worker threads of AliFemtoManager; which analysis runs on which
+  /// thread varies from event to event, so threaded runs are not
+  /// reproducible for these variables.
+  static void SetThreadRandomSeed(unsigned int seed);
+
 
   double Quality() const;
 
@@ -227,6 +240,14 @@ private:
 
   double fPairAngleEP;	//Pair emission angle wrt EP
 
+  mutable short fKinParNotCalculated; // Set to 1 when qinv, kT and the LCMS components have not been calculated for this pair
+  mutable double fQInvCalc;     // qinv
+  mutable double fKTCalc;       // kT
+  mutable double fQOutCMSCalc;  // q out component in LCMS
+  mutable double fQSideCMSCalc; // q side component in LCMS
+  mutable double fQLongCMSCalc; // q long component in LCMS
+  void CalcKinPar() const;
+
   mutable short fNonIdParNotCalculated; // Set to 1 when NonId variables (kstar) have been already calculated for this pair
   mutable double fDKSide; // momemntum of first particle in PRF - k* side component
   mutable double fDKOut;  // momemntum of first particle in PRF - k* out component
@@ -304,6 +325,7 @@ private:
 };
 
 inline void AliFemtoPair::ResetParCalculated(){
+  fKinParNotCalculated=1;
   fNonIdParNotCalculated=1;
   fNonIdParNotCalculatedGlobal=1;
   fMergingParNotCalculated=1;
@@ -328,6 +350,22 @@ inline void AliFemtoPair::SetTrack2(const AliFemtoParticle* trkPtr){
   ResetParCalculated();
 }
 
+inline void AliFemtoPair::SetKinematics(const double *values){
+  fQInvCalc = values[AliFemtoPairKinematics::kQInv];
+  fKTCalc = values[AliFemtoPairKinematics::kKT];
+  fQOutCMSCalc = values[AliFemtoPairKinematics::kQOutCMS];
+  fQSideCMSCalc = values[AliFemtoPairKinematics::kQSideCMS];
+  fQLongCMSCalc = values[AliFemtoPairKinematics::kQLongCMS];
+  fKinParNotCalculated = 0;
+
+  fKStarCalc = values[AliFemtoPairKinematics::kKStar];
+  fDKOut = values[AliFemtoPairKinematics::kKStarOut];
+  fDKSide = values[AliFemtoPairKinematics::kKStarSide];
+  fDKLong = values[AliFemtoPairKinematics::kKStarLong];
+  fCVK = values[AliFemtoPairKinematics::kCVK];
+  fNonIdParNotCalculated = 0;
+}
+
 inline AliFemtoParticle* AliFemtoPair::Track1() const {return fTrack1;}
 inline AliFemtoParticle* AliFemtoPair::Track2() const {return fTrack2;}
 
@@ -348,8 +386,24 @@ inline double AliFemtoPair::KStar() const{
   return fKStarCalc;
 }
 inline double AliFemtoPair::QInv() const {
-  AliFemtoLorentzVector tDiff = (fTrack1->FourMomentum()-fTrack2->FourMomentum());
-  return -tDiff.m();
+  if(fKinParNotCalculated) CalcKinPar();
+  return fQInvCalc;
+}
+inline double AliFemtoPair::KT() const {
+  if(fKinParNotCalculated) CalcKinPar();
+  return fKTCalc;
+}
+inline double AliFemtoPair::QOutCMS() const {
+  if(fKinParNotCalculated) CalcKinPar();
+  return fQOutCMSCalc;
+}
+inline double AliFemtoPair::QSideCMS() const {
+  if(fKinParNotCalculated) CalcKinPar();
+  return fQSideCMSCalc;
+}
+inline double AliFemtoPair::QLongCMS() const {
+  if(fKinParNotCalculated) CalcKinPar();
+  return fQLongCMSCalc;
 }
 
 // Fabrice private <<<
@@ -0,0 +1,71 @@
+///
+/// \file AliFemtoPairKinematics.cxx
+///
+
+#include "AliFemtoPairKinematics.h"
+#include "AliFemtoParticle.h"
+
+
+AliFemtoPairKinematics::AliFemtoPairKinematics():
+  fPx(),
+  fPy(),
+  fPz(),
+  fE(),
+  fRow(),
+  fRowBegin(0)
+{
+}
+
+void AliFemtoPairKinematics::Fill(const std::list<AliFemtoParticle*> &particles)
+{
+  fPx.clear();
+  fPy.clear();
+  fPz.clear();
+  fE.clear();
+
+  for (const AliFemtoParticle *particle : particles) {
+    const AliFemtoLorentzVector &p = particle->FourMomentum();
+    fPx.push_back(p.x());
+    fPy.push_back(p.y());
+    fPz.push_back(p.z());
+    fE.push_back(p.e());
+  }
+}
+
+void AliFemtoPairKinematics::ComputeRow(size_t i,
+                                        const AliFemtoPairKinematics &other,
+                                        size_t begin,
+                                        size_t end,
+                                        bool swapFirst,
+                                        bool alternate)
+{
+  fRowBegin = begin;
+  if (end <= begin) {
+    return;
+  }
+  fRow.resize((end - begin) * kNVariables);
+
+  const double pi[4] = {fPx[i], fPy[i], fPz[i], fE[i]};
+
+  const double *px = other.fPx.data(),
+               *py = other.fPy.data(),
+               *pz = other.fPz.data(),
+               *pe = other.fE.data();
+
+  double *values = fRow.data();
+  bool swap = swapFirst;
+
+  for (size_t j = begin; j < end; ++j, values += kNVariables) {
+    const double pj[4] = {px[j], py[j], pz[j], pe[j]};
+
+    const double *p1 = swap ? pj : pi,
+                 *p2 = swap ? pi : pj;
+
+    CalcRelativeMomentum(p1, p2, values);
+    CalcNonIdentical(p1, p2, values);
+
+    if (alternate) {
+      swap = !swap;
+    }
+  }
+}
@@ -0,0 +1,204 @@
+///
+/// \file AliFemtoPairKinematics.h
+///
+
+#ifndef ALIFEMTOPAIRKINEMATICS_H
+#define ALIFEMTOPAIRKINEMATICS_H
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <list>
+
+class AliFemtoParticle;
+
+/// \class AliFemtoPairKinematics
+/// \brief Columnar snapshot of a particle collection and batched computation
+///        of the relative momentum variables of pairs
+///
+/// The four-momenta of the particles of a collection are copied once into
+/// contiguous arrays. For one particle of the outer loop over pairs, the
+/// relative momentum variables (EVariable) are then computed for a whole range
+/// of partners in a single loop, and passed to the AliFemtoPair with
+/// AliFemtoPair::SetKinematics(). The pair cut and all the correlation
+/// functions then read the cached values instead of recomputing them from the
+/// AliFemtoLorentzVectors.
+///
+/// The same functions (CalcRelativeMomentum, CalcNonIdentical) are used by
+/// AliFemtoPair when a variable is not cached, so that both give identical
+/// results.
+///
+class AliFemtoPairKinematics {
+public:
+
+  /// Relative momentum variables computed for each pair
+  enum EVariable {
+    kQInv = 0,   ///< qinv
+    kKT,         ///< kT = |pT1 + pT2| / 2
+    kQOutCMS,    ///< Bertsch-Pratt q out in LCMS
+    kQSideCMS,   ///< Bertsch-Pratt q side in LCMS
+    kQLongCMS,   ///< Bertsch-Pratt q long in LCMS
+    kKStar,      ///< k*
+    kKStarOut,   ///< out component of k* in the pair rest frame
+    kKStarSide,  ///< side component of k* in the pair rest frame
+    kKStarLong,  ///< long component of k* in the pair rest frame
+    kCVK,        ///< cos between velocity and k*
+    kNVariables
+  };
+
+  AliFemtoPairKinematics();
+
+  /// Copy the four-momenta of the particles into the columns
+  void Fill(const std::list<AliFemtoParticle*> &particles);
+
+  /// Number of particles in the columns
+  size_t Size() const { return fE.size(); }
+
+  /// Compute the variables of the pairs made of particle `i` of this snapshot
+  /// and the particles [begin, end) of `other`.
+  ///
+  /// If `alternate` is set, the order of the two particles is reversed every
+  /// other pair, starting with the reversed order if `swapFirst` is set (this
+  /// is the order used by AliFemtoSimpleAnalysis::MakePairs for identical
+  /// particles). Otherwise the order is reversed for all pairs if `swapFirst`
+  /// is set.
+  void ComputeRow(size_t i, const AliFemtoPairKinematics &other,
+                  size_t begin, size_t end,
+                  bool swapFirst = false, bool alternate = false);
+
+  /// Variables of the pair with particle `j` of the last ComputeRow, indexed
+  /// by EVariable
+  const double* Values(size_t j) const
+    { return &fRow[(j - fRowBegin) * kNVariables]; }
+
+  /// Compute qinv, kT and the relative momentum components in LCMS from the
+  /// four-momenta {px, py, pz, E} of the two particles
+  static void CalcRelativeMomentum(const double *p1, const double *p2, double *values);
+
+  /// Compute k*, its components in the pair rest frame and CVK from the
+  /// four-momenta {px, py, pz, E} of the two particles
+  static void CalcNonIdentical(const double *p1, const double *p2, double *values);
+
+private:
+  std::vector<double> fPx;    ///< px of the particles
+  std::vector<double> fPy;    ///< py of the particles
+  std::vector<double> fPz;    ///< pz of the particles
+  std::vector<double> fE;     ///< energy of the particles
+
+  std::vector<double> fRow;   ///< variables of the pairs of the last ComputeRow
+  size_t fRowBegin;           ///< index of the first partner of the last ComputeRow
+};
+
+inline void AliFemtoPairKinematics::CalcRelativeMomentum(const double *p1, const double *p2, double *values)
+{
+  const double
+    x1 = p1[0],
+    y1 = p1[1],
+    z1 = p1[2],
+    t1 = p1[3],
+
+    x2 = p2[0],
+    y2 = p2[1],
+    z2 = p2[2],
+    t2 = p2[3],
+
+    dx = x1 - x2,
+    dy = y1 - y2,
+    dz = z1 - z2,
+    dt = t1 - t2,
+
+    xt = x1 + x2,
+    yt = y1 + y2,
+    zz = z1 + z2,
+    tt = t1 + t2,
+
+    pt = ::sqrt(xt*xt + yt*yt);
+
+  // qinv = -m(p1 - p2)
+  const double tDiffMass2 = dt*dt - (dx*dx + dy*dy + dz*dz);
+  values[kQInv] = (tDiffMass2 < 0) ? ::sqrt(-tDiffMass2) : -::sqrt(tDiffMass2);
+
+  // transverse momentum
+  values[kKT] = pt * .5;
+
+  // relative momentum out component in lab frame
+  const double kOut = dx*xt + dy*yt;
+  values[kQOutCMS] = (pt == 0.0) ? 0.0 : kOut / pt;
+
+  // relative momentum side component in lab frame
+  const double kSide = 2.0 * (x2*y1 - x1*y2);
+  values[kQSideCMS] = (pt == 0.0) ? 0.0 : kSide / pt;
+
+  // relative momentum long component in lab frame
+  const double
+    beta = zz/tt,
+    gamma = 1.0/::sqrt((1.-beta)*(1.+beta));
+  values[kQLongCMS] = gamma * (dz - beta*dt);
+}
+
+inline void AliFemtoPairKinematics::CalcNonIdentical(const double *p1, const double *p2, double *values)
+{ // fortran like function! faster?
+  // Calculate generalized relative mometum
+  // Use this instead of qXYZ() function when calculating
+  // anything for non-identical particles
+
+  const double
+    px1 = p1[0],
+    py1 = p1[1],
+    pz1 = p1[2],
+    pE1  = p1[3],
+    mass1_sqrd = std::max(0.0, pE1*pE1 - (px1*px1 + py1*py1 + pz1*pz1)),
+
+    px2 = p2[0],
+    py2 = p2[1],
+    pz2 = p2[2],
+    pE2  = p2[3],
+    mass2_sqrd = std::max(0.0, pE2*pE2 - (px2*px2 + py2*py2 + pz2*pz2)),
+
+    tPx = px1 + px2,
+    tPy = py1 + py2,
+    tPz = pz1 + pz2,
+    tPE = pE1 + pE2;
+
+  double tPtrans = tPx*tPx + tPy*tPy;
+  double tMtrans = tPE*tPE - tPz*tPz;
+  double tPinv = ::sqrt(tMtrans - tPtrans);
+  tMtrans = ::sqrt(tMtrans);
+  tPtrans = ::sqrt(tPtrans);
+
+  double tQinvL = (pE1-pE2)*(pE1-pE2) - (px1-px2)*(px1-px2) -
+    (py1-py2)*(py1-py2) - (pz1-pz2)*(pz1-pz2);
+
+  double tQ = (mass1_sqrd - mass2_sqrd)/tPinv;
+  tQ = ::sqrt( tQ*tQ - tQinvL);
+
+  const double tKStar = tQ/2;
+
+  // ad 1) go to LCMS
+  double beta = tPz/tPE;
+  double gamma = tPE/tMtrans;
+
+  // beam projection ( z - axis )
+  const double pz1L = gamma * (pz1 - beta * pE1);
+  const double pE1L = gamma * (pE1 - beta * pz1);
+
+  // ad 2) rotation px -> tPt
+  const double px1R = (px1*tPx + py1*tPy)/tPtrans;
+  // side projection ( y - axis )
+  const double py1R = (-px1*tPy + py1*tPx)/tPtrans;
+
+  // ad 3) go from LCMS to CMS
+  beta = tPtrans/tMtrans;
+  gamma = tMtrans/tPinv;
+
+  // out projection ( x - axis )
+  const double px1C = gamma * (px1R - beta * pE1L);
+
+  values[kKStar] = tKStar;
+  values[kKStarOut] = px1C;
+  values[kKStarSide] = py1R;
+  values[kKStarLong] = pz1L;
+  values[kCVK] = (px1C*tPtrans + pz1L*tPz)/tKStar/::sqrt(tPtrans*tPtrans+tPz*tPz);
+}
+
+#endif
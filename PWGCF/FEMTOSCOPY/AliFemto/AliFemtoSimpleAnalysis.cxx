@@ -9,6 +9,7 @@
 #include "AliFemtoXiCut.h"
 #include "AliFemtoXiTrackCut.h"
 #include "AliFemtoPicoEvent.h"
+#include "AliFemtoPairKinematics.h"
 
 #include <string>
 #include <iostream>
@@ -183,7 +184,10 @@ AliFemtoSimpleAnalysis::AliFemtoSimpleAnalysis():
   fMinSizePartCollection(0),
   fVerbose(kTRUE),
   fPerformSharedDaughterCut(kFALSE),
-  fEnablePairMonitors(kFALSE)
+  fEnablePairMonitors(kFALSE),
+  fBatchPairKinematics(kFALSE),
+  fPairKinematics1(nullptr),
+  fPairKinematics2(nullptr)
 {
   // Default constructor
   fCorrFctnCollection = new AliFemtoCorrFctnCollection;
@@ -205,7 +209,10 @@ AliFemtoSimpleAnalysis::AliFemtoSimpleAnalysis(const AliFemtoSimpleAnalysis& a):
   fMinSizePartCollection(a.fMinSizePartCollection),
   fVerbose(a.fVerbose),
   fPerformSharedDaughterCut(a.fPerformSharedDaughterCut),
-  fEnablePairMonitors(a.fEnablePairMonitors)
+  fEnablePairMonitors(a.fEnablePairMonitors),
+  fBatchPairKinematics(a.fBatchPairKinematics),
+  fPairKinematics1(nullptr),
+  fPairKinematics2(nullptr)
 {
   /// Copy constructor
 
@@ -317,6 +324,9 @@ AliFemtoSimpleAnalysis::~AliFemtoSimpleAnalysis()
     }
     delete fMixingBuffer;
   }
+
+  delete fPairKinematics1;
+  delete fPairKinematics2;
 }
 //______________________
 AliFemtoSimpleAnalysis& AliFemtoSimpleAnalysis::operator=(const AliFemtoSimpleAnalysis& aAna)
@@ -402,6 +412,7 @@ AliFemtoSimpleAnalysis& AliFemtoSimpleAnalysis::operator=(const AliFemtoSimpleAn
   fVerbose = aAna.fVerbose;
   fPerformSharedDaughterCut = aAna.fPerformSharedDaughterCut;
   fEnablePairMonitors = aAna.fEnablePairMonitors;
+  fBatchPairKinematics = aAna.fBatchPairKinematics;
 
   return *this;
 }
@@ -623,10 +634,30 @@ void AliFemtoSimpleAnalysis::MakePairs(const char* typeIn,
   // Create the pair outside the loop - only allocate once
   AliFemtoPair* tPair = new AliFemtoPair;
 
+  // Columnar copies of the collections for the batched pair variables
+  AliFemtoPairKinematics *tKinematics1 = nullptr,
+                         *tKinematics2 = nullptr;
+  if (fBatchPairKinematics) {
+    if (!fPairKinematics1) {
+      fPairKinematics1 = new AliFemtoPairKinematics;
+    }
+    fPairKinematics1->Fill(*partCollection1);
+    tKinematics1 = tKinematics2 = fPairKinematics1;
+
+    if (partCollection2) {
+      if (!fPairKinematics2) {
+        fPairKinematics2 = new AliFemtoPairKinematics;
+      }
+      fPairKinematics2->Fill(*partCollection2);
+      tKinematics2 = fPairKinematics2;
+    }
+  }
+
   // Begin the outer loop
+  size_t tIndex1 = 0;
   for (AliFemtoParticleConstIterator tPartIter1 = tStartOuterLoop;
                                      tPartIter1 != tEndOuterLoop;
-                                     ++tPartIter1) {
+                                     ++tPartIter1, ++tIndex1) {
 
     // If analyzing identical particles, start inner loop at the particle
     // after the current outer loop position, (loops until end)
@@ -635,6 +666,14 @@ void AliFemtoSimpleAnalysis::MakePairs(const char* typeIn,
       tStartInnerLoop++;
     }
 
+    // Variables of all the pairs of this particle, in the same particle
+    // order as below
+    size_t tIndex2 = partCollection2 ? 0 : tIndex1 + 1;
+    if (tKinematics1) {
+      tKinematics1->ComputeRow(tIndex1, *tKinematics2, tIndex2, tKinematics2->Size(),
+                               !partCollection2 && swpart, !partCollection2);
+    }
+
     // If we have two collections - set the first track
     if (partCollection2 != nullptr) {
       tPair->SetTrack1(*tPartIter1);
@@ -643,7 +682,7 @@ void AliFemtoSimpleAnalysis::MakePairs(const char* typeIn,
     // Begin the inner loop
     for (AliFemtoParticleConstIterator tPartIter2 = tStartInnerLoop;
                                        tPartIter2 != tEndInnerLoop;
-                                     ++tPartIter2) {
+                                     ++tPartIter2, ++tIndex2) {
       // If we have two collections - only set the second track
       if (partCollection2 != nullptr) {
         tPair->SetTrack2(*tPartIter2);
@@ -655,6 +694,10 @@ void AliFemtoSimpleAnalysis::MakePairs(const char* typeIn,
         swpart = !swpart;
       }
 
+      if (tKinematics1) {
+        tPair->SetKinematics(tKinematics1->Values(tIndex2));
+      }
+
       // check if the pair passes the cut
       bool tmpPassPair = fPairCut->Pass(tPair);
 
@@ -18,6 +18,7 @@
 
 class AliFemtoPicoEventCollectionVectorHideAway;
 class AliFemtoPicoEvent;
+class AliFemtoPairKinematics;
 
 ///
 /// \class AliFemtoSimpleAnalysis
@@ -99,6 +100,14 @@ public:
   void SetEnablePairMonitors(Bool_t aEnable);
   Bool_t EnablePairMonitors();
 
+  /// Compute the relative momentum variables of the pairs (qinv, kT, LCMS
+  /// components, k*) in a batch for each particle of the outer pair loop,
+  /// from columnar copies of the particle collections (see
+  /// AliFemtoPairKinematics). The pair cut and the correlation functions get
+  /// the same values as without batch, without recomputing them per call.
+  void SetBatchPairKinematics(Bool_t aBatch);
+  Bool_t BatchPairKinematics() const;
+
   unsigned int NumEventsToMix() const;
   void SetNumEventsToMix(const unsigned int& NumberOfEventsToMix);
   AliFemtoPicoEvent* CurrentPicoEvent();
@@ -177,6 +186,10 @@ protected:
   Bool_t fVerbose;
   Bool_t fPerformSharedDaughterCut;
   Bool_t fEnablePairMonitors;
+  Bool_t fBatchPairKinematics;                       ///< Compute the pair variables in a batch per particle (AliFemtoPairKinematics)
+
+  AliFemtoPairKinematics* fPairKinematics1;          //!<! Columnar copy of the first particle collection in MakePairs
+  AliFemtoPairKinematics* fPairKinematics2;          //!<! Columnar copy of the second particle collection in MakePairs
 
 #ifdef __ROOT__
   /// \cond CLASSIMP
@@ -242,6 +255,11 @@ inline bool AliFemtoSimpleAnalysis::EnablePairMonitors()
   return fEnablePairMonitors;
 }
 
+inline Bool_t AliFemtoSimpleAnalysis::BatchPairKinematics() const
+{
+  return fBatchPairKinematics;
+}
+
 // Sets
 inline void AliFemtoSimpleAnalysis::SetPairCut(AliFemtoPairCut* x)
 {
@@ -305,4 +323,9 @@ inline void AliFemtoSimpleAnalysis::SetEnablePairMonitors(Bool_t aEnable)
   fEnablePairMonitors = aEnable;
 }
 
+inline void AliFemtoSimpleAnalysis::SetBatchPairKinematics(Bool_t aBatch)
+{
+  fBatchPairKinematics = aBatch;
+}
+
 #endif
@@ -5,6 +5,7 @@
  *      Author: bernhardhohlweger
  */
 
+#include <algorithm>
 #include <iostream>
 #include "AliFemtoDreamPairCleaner.h"
 ClassImp(AliFemtoDreamPairCleaner)
@@ -12,7 +13,11 @@ AliFemtoDreamPairCleaner::AliFemtoDreamPairCleaner()
     : fMinimalBooking(false),
       fCounter(0),
       fParticles(),
-      fHists(0) {
+      fHists(0),
+      fIDIndex(),
+      fDaughterIDs(),
+      fDaughterBegin(),
+      fSharing() {
 }
 
 AliFemtoDreamPairCleaner::AliFemtoDreamPairCleaner(
@@ -20,7 +25,11 @@ AliFemtoDreamPairCleaner::AliFemtoDreamPairCleaner(
     : fMinimalBooking(cleaner.fMinimalBooking),
       fCounter(0),
       fParticles(),
-      fHists(cleaner.fHists) {
+      fHists(cleaner.fHists),
+      fIDIndex(),
+      fDaughterIDs(),
+      fDaughterBegin(),
+      fSharing() {
 }
 
 AliFemtoDreamPairCleaner::AliFemtoDreamPairCleaner(int nTrackDecayChecks,
@@ -29,7 +38,11 @@ AliFemtoDreamPairCleaner::AliFemtoDreamPairCleaner(int nTrackDecayChecks,
     : fMinimalBooking(MinimalBooking),
       fCounter(0),
       fParticles(),
-      fHists(nullptr) {
+      fHists(nullptr),
+      fIDIndex(),
+      fDaughterIDs(),
+      fDaughterBegin(),
+      fSharing() {
   if (!fMinimalBooking) {
     fHists = new AliFemtoDreamPairCleanerHists(nTrackDecayChecks,
                                                nDecayDecayChecks);
@@ -57,26 +70,40 @@ AliFemtoDreamPairCleaner& AliFemtoDreamPairCleaner::operator=(
 void AliFemtoDreamPairCleaner::CleanTrackAndDecay(
     std::vector<AliFemtoDreamBasePart> *Tracks,
     std::vector<AliFemtoDreamBasePart> *Decay, int histnumber) {
+  // A decay sharing a daughter with a track is removed. The counter is
+  // increased by the number of daughters matching the first track (in track
+  // order) the decay shares a daughter with.
   int counter = 0;
-  for (auto itTrack = Tracks->begin(); itTrack != Tracks->end(); ++itTrack) {
-    //std::cout  << "New Track" << std::endl;
-    for (auto itDecay = Decay->begin(); itDecay != Decay->end(); ++itDecay) {
-      if (itDecay->UseParticle()) {
-        //std::cout  << "New v0" << std::endl;
-        std::vector<int> IDTrack = itTrack->GetIDTracks();
-        std::vector<int> IDDaug = itDecay->GetIDTracks();
-        for (auto itIDs = IDDaug.begin(); itIDs != IDDaug.end(); ++itIDs) {
-          //std::cout <<"ID of Track: "<<IDTrack.at(0)<<" IDs of Daughter: "
-          //              <<*itIDs<<'\n';
-          if (*itIDs == IDTrack.at(0)) {
-            itDecay->SetUse(false);
-            counter++;
-          }
-        }
-      } else {
-        continue;
+  fIDIndex.clear();
+  for (int iTrack = 0; iTrack < (int) Tracks->size(); ++iTrack) {
+    std::vector<int> IDTrack = Tracks->at(iTrack).GetIDTracks();
+    if (!IDTrack.empty()) {
+      fIDIndex.push_back(std::make_pair(IDTrack.at(0), iTrack));
+    }
+  }
+  std::sort(fIDIndex.begin(), fIDIndex.end());
+
+  for (auto itDecay = Decay->begin(); itDecay != Decay->end(); ++itDecay) {
+    if (!itDecay->UseParticle()) {
+      continue;
+    }
+    std::vector<int> IDDaug = itDecay->GetIDTracks();
+    int firstTrack = -1;
+    int sharedID = 0;
+    for (auto itIDs = IDDaug.begin(); itIDs != IDDaug.end(); ++itIDs) {
+      auto itIndex = std::lower_bound(fIDIndex.begin(), fIDIndex.end(),
+                                      std::make_pair(*itIDs, -1));
+      if (itIndex != fIDIndex.end() && itIndex->first == *itIDs
+          && (firstTrack < 0 || itIndex->second < firstTrack)) {
+        firstTrack = itIndex->second;
+        sharedID = *itIDs;
       }
     }
+    if (firstTrack < 0) {
+      continue;
+    }
+    itDecay->SetUse(false);
+    counter += std::count(IDDaug.begin(), IDDaug.end(), sharedID);
   }
   if (!fMinimalBooking)
     fHists->FillDaughtersSharedTrack(histnumber, counter);
@@ -84,36 +111,34 @@ void AliFemtoDreamPairCleaner::CleanTrackAndDecay(
 void AliFemtoDreamPairCleaner::CleanDecayAndDecay(
     std::vector<AliFemtoDreamBasePart> *Decay1,
     std::vector<AliFemtoDreamBasePart> *Decay2, int histnumber) {
+  // For each pair of decays sharing daughters, the one with the lower CPA
+  // is removed, and the counter is increased by the number of shared
+  // daughters. The pairs are resolved in the order of Decay1 and Decay2.
   int counter = 0;
+  IndexDaughters(Decay2);
   for (auto itDecay1 = Decay1->begin(); itDecay1 != Decay1->end(); ++itDecay1) {
-    for (auto itDecay2 = Decay2->begin(); itDecay2 != Decay2->end();
-          ++itDecay2) {
-      if (itDecay1->UseParticle()) {
-        if (itDecay2->UseParticle()) {
-          std::vector<int> IDDaug1 = itDecay1->GetIDTracks();
-          std::vector<int> IDDaug2 = itDecay2->GetIDTracks();
-          for (auto itID1s = IDDaug1.begin(); itID1s != IDDaug1.end();
-              ++itID1s) {
-            for (auto itID2s = IDDaug2.begin(); itID2s != IDDaug2.end();
-                ++itID2s) {
-              if (*itID1s == *itID2s) {
-                if (itDecay1->GetCPA() < itDecay2->GetCPA()) {
-                  itDecay1->SetUse(false);
-                  counter++;
-                } else {
-                  itDecay2->SetUse(false);
-                  counter++;
-                }
-              }
-            }
-          }
-        } else {
-          continue;
-        }
-      } else {
+    if (!itDecay1->UseParticle()) {
+      continue;
+    }
+    std::vector<int> IDDaug1 = itDecay1->GetIDTracks();
+    FindSharing(IDDaug1, -1);
+    for (auto itSharing = fSharing.begin(); itSharing != fSharing.end();
+        ++itSharing) {
+      if (!itDecay1->UseParticle()) {
         break;
       }
-    } 
+      AliFemtoDreamBasePart &Decay2Part = Decay2->at(*itSharing);
+      if (!Decay2Part.UseParticle()) {
+        continue;
+      }
+      const int nShared = NSharedIDs(IDDaug1, *itSharing);
+      if (itDecay1->GetCPA() < Decay2Part.GetCPA()) {
+        itDecay1->SetUse(false);
+      } else {
+        Decay2Part.SetUse(false);
+      }
+      counter += nShared;
+    }
   }
   if (!fMinimalBooking)
     fHists->FillDaughtersSharedDaughter(histnumber, counter);
@@ -121,82 +146,69 @@ void AliFemtoDreamPairCleaner::CleanDecayAndDecay(
 
 void AliFemtoDreamPairCleaner::CleanDecay(
     std::vector<AliFemtoDreamBasePart> *Decay, int histnumber) {
+  // As CleanDecayAndDecay, for the pairs of decays of the same vector
   int counter = 0;
-  for (std::vector<AliFemtoDreamBasePart>::iterator itDecay1 = Decay->begin();
-      itDecay1 != Decay->end(); ++itDecay1) {
-      //std::cout  << "New Particle 1" << std::endl;
-    for (auto itDecay2 = itDecay1 + 1; itDecay2 != Decay->end(); ++itDecay2) {
-      if (itDecay1->UseParticle()) {
-        if (itDecay2->UseParticle()) {
-          //std::cout  << "New Particle 2" << std::endl;
-          std::vector<int> IDDaug1 = itDecay1->GetIDTracks();
-          std::vector<int> IDDaug2 = itDecay2->GetIDTracks();
-          for (auto itID1s = IDDaug1.begin(); itID1s != IDDaug1.end();
-              ++itID1s) {
-            for (auto itID2s = IDDaug2.begin(); itID2s != IDDaug2.end();
-                ++itID2s) {
-              //std::cout <<"ID of Daug v01: "<<*itID1s<<" ID of Daug v02: "
-              //                  <<*itID2s<<'\n';
-              if (*itID1s == *itID2s) {
-                if (itDecay1->GetCPA() < itDecay2->GetCPA()) {
-                  itDecay1->SetUse(false);
-                  counter++;
-                } else {
-                  itDecay2->SetUse(false);
-                  counter++;
-                }
-              }
-            }
-          }
-        } else {
-          continue;
-        }
-      } else {
+  IndexDaughters(Decay);
+  for (int iDecay1 = 0; iDecay1 < (int) Decay->size(); ++iDecay1) {
+    AliFemtoDreamBasePart &Decay1Part = Decay->at(iDecay1);
+    if (!Decay1Part.UseParticle()) {
+      continue;
+    }
+    std::vector<int> IDDaug1 = Decay1Part.GetIDTracks();
+    FindSharing(IDDaug1, iDecay1);
+    for (auto itSharing = fSharing.begin(); itSharing != fSharing.end();
+        ++itSharing) {
+      if (!Decay1Part.UseParticle()) {
         break;
       }
-    } 
+      AliFemtoDreamBasePart &Decay2Part = Decay->at(*itSharing);
+      if (!Decay2Part.UseParticle()) {
+        continue;
+      }
+      const int nShared = NSharedIDs(IDDaug1, *itSharing);
+      if (Decay1Part.GetCPA() < Decay2Part.GetCPA()) {
+        Decay1Part.SetUse(false);
+      } else {
+        Decay2Part.SetUse(false);
+      }
+      counter += nShared;
+    }
   }
   if (!fMinimalBooking)
     fHists->FillDaughtersSharedDaughter(histnumber, counter);
 }
 
 void AliFemtoDreamPairCleaner::CleanDecayInvMass(std::vector<AliFemtoDreamBasePart> *Decay, int PDGCode, int histnumber) {
+  // As CleanDecay, keeping the decay with the invariant mass closer to the
+  // mass of PDGCode
   int counter = 0;
   double mass = TDatabasePDG::Instance()->GetParticle(PDGCode)->Mass();
-  for (std::vector<AliFemtoDreamBasePart>::iterator itDecay1 = Decay->begin();
-      itDecay1 != Decay->end(); ++itDecay1) {
-    //std::cout  << "New Particle 1" << std::endl;
-    for (auto itDecay2 = itDecay1 + 1; itDecay2 != Decay->end(); ++itDecay2) {
-      if (itDecay1->UseParticle()) {
-        if (itDecay2->UseParticle()) {
-          //std::cout  << "New Particle 2" << std::endl;
-          std::vector<int> IDDaug1 = itDecay1->GetIDTracks();
-          std::vector<int> IDDaug2 = itDecay2->GetIDTracks();
-          for (auto itID1s = IDDaug1.begin(); itID1s != IDDaug1.end();
-               ++itID1s) {
-            for (auto itID2s = IDDaug2.begin(); itID2s != IDDaug2.end();
-                 ++itID2s) {
-              //std::cout <<"ID of Daug v01: "<<*itID1s<<" ID of Daug v02: "
-              //                  <<*itID2s<<'\n';
-              if (*itID1s == *itID2s) {
-                float massDiff1 = TMath::Abs(itDecay1->GetInvMass() - mass);
-                float massDiff2 = TMath::Abs(itDecay2->GetInvMass() - mass);
-                if (massDiff2 < massDiff1) {
-                  itDecay1->SetUse(false);
-                  counter++;
-                } else {
-                  itDecay2->SetUse(false);
-                  counter++;
-                }
-              }
-            }
-          }
-        } else {
-          continue;
-        }
-      } else {
+  IndexDaughters(Decay);
+  for (int iDecay1 = 0; iDecay1 < (int) Decay->size(); ++iDecay1) {
+    AliFemtoDreamBasePart &Decay1Part = Decay->at(iDecay1);
+    if (!Decay1Part.UseParticle()) {
+      continue;
+    }
+    std::vector<int> IDDaug1 = Decay1Part.GetIDTracks();
+    FindSharing(IDDaug1, iDecay1);
+    for (auto itSharing = fSharing.begin(); itSharing != fSharing.end();
+        ++itSharing) {
+      if (!Decay1Part.UseParticle()) {
         break;
       }
+      AliFemtoDreamBasePart &Decay2Part = Decay->at(*itSharing);
+      if (!Decay2Part.UseParticle()) {
+        continue;
+      }
+      const int nShared = NSharedIDs(IDDaug1, *itSharing);
+      float massDiff1 = TMath::Abs(Decay1Part.GetInvMass() - mass);
+      float massDiff2 = TMath::Abs(Decay2Part.GetInvMass() - mass);
+      if (massDiff2 < massDiff1) {
+        Decay1Part.SetUse(false);
+      } else {
+        Decay2Part.SetUse(false);
+      }
+      counter += nShared;
     }
   }
   if (!fMinimalBooking)
@@ -204,41 +216,87 @@ void AliFemtoDreamPairCleaner::CleanDecayInvMass(std::vector<AliFemtoDreamBasePa
 }
 void AliFemtoDreamPairCleaner::CleanDecayAtRandom(std::vector<AliFemtoDreamBasePart> *Decay, int histnumber)
 {
+  // As CleanDecay, removing one of the two decays at random (one random
+  // number per pair of decays sharing daughters)
   int counter = 0;
-  for (std::vector<AliFemtoDreamBasePart>::iterator itDecay1 = Decay->begin();
-       itDecay1 != Decay->end(); ++itDecay1) {
-    for (auto itDecay2 = itDecay1 + 1; itDecay2 != Decay->end(); ++itDecay2) {
-      if (itDecay1->UseParticle()) {
-        if (itDecay2->UseParticle()) {
-          std::vector<int> IDDaug1 = itDecay1->GetIDTracks();
-          std::vector<int> IDDaug2 = itDecay2->GetIDTracks();
-          for (auto itID1s = IDDaug1.begin(); itID1s != IDDaug1.end(); ++itID1s) {
-            for (auto itID2s = IDDaug2.begin(); itID2s != IDDaug2.end(); ++itID2s) {
-              if(*itID1s == *itID2s){
-                if (itDecay1->UseParticle() && itDecay2->UseParticle()){
-                  if (gRandom->Uniform(0., 1.) > 0.5){
-                    itDecay1->SetUse(false);
-                    counter++;
-                  } else {
-                    itDecay2->SetUse(false);
-                    counter++;
-                  }
-                }
-              }
-            }
-          }
-        } else {
-          continue;
-        }
-      } else {
+  IndexDaughters(Decay);
+  for (int iDecay1 = 0; iDecay1 < (int) Decay->size(); ++iDecay1) {
+    AliFemtoDreamBasePart &Decay1Part = Decay->at(iDecay1);
+    if (!Decay1Part.UseParticle()) {
+      continue;
+    }
+    std::vector<int> IDDaug1 = Decay1Part.GetIDTracks();
+    FindSharing(IDDaug1, iDecay1);
+    for (auto itSharing = fSharing.begin(); itSharing != fSharing.end();
+        ++itSharing) {
+      if (!Decay1Part.UseParticle()) {
         break;
       }
-    } 
+      AliFemtoDreamBasePart &Decay2Part = Decay->at(*itSharing);
+      if (!Decay2Part.UseParticle()) {
+        continue;
+      }
+      if (gRandom->Uniform(0., 1.) > 0.5) {
+        Decay1Part.SetUse(false);
+      } else {
+        Decay2Part.SetUse(false);
+      }
+      counter++;
+    }
   }
   if (!fMinimalBooking)
     fHists->FillDaughtersSharedDaughter(histnumber, counter);
 }
 
+void AliFemtoDreamPairCleaner::IndexDaughters(
+    const std::vector<AliFemtoDreamBasePart> *Decay) {
+  fIDIndex.clear();
+  fDaughterIDs.clear();
+  fDaughterBegin.clear();
+  for (int iDecay = 0; iDecay < (int) Decay->size(); ++iDecay) {
+    fDaughterBegin.push_back(fDaughterIDs.size());
+    std::vector<int> IDDaug = Decay->at(iDecay).GetIDTracks();
+    for (auto itIDs = IDDaug.begin(); itIDs != IDDaug.end(); ++itIDs) {
+      fDaughterIDs.push_back(*itIDs);
+      fIDIndex.push_back(std::make_pair(*itIDs, iDecay));
+    }
+  }
+  fDaughterBegin.push_back(fDaughterIDs.size());
+  std::sort(fIDIndex.begin(), fIDIndex.end());
+}
+
+void AliFemtoDreamPairCleaner::FindSharing(const std::vector<int> &IDs,
+                                           int first) {
+  // indexed decays after first sharing at least one of the track IDs,
+  // in increasing order
+  fSharing.clear();
+  for (auto itIDs = IDs.begin(); itIDs != IDs.end(); ++itIDs) {
+    auto itIndex = std::upper_bound(fIDIndex.begin(), fIDIndex.end(),
+                                    std::make_pair(*itIDs, first));
+    for (; itIndex != fIDIndex.end() && itIndex->first == *itIDs; ++itIndex) {
+      fSharing.push_back(itIndex->second);
+    }
+  }
+  std::sort(fSharing.begin(), fSharing.end());
+  fSharing.erase(std::unique(fSharing.begin(), fSharing.end()),
+                 fSharing.end());
+}
+
+int AliFemtoDreamPairCleaner::NSharedIDs(const std::vector<int> &IDs,
+                                         int iDecay) const {
+  // number of pairs of equal track IDs between IDs and the daughters of
+  // the indexed decay
+  int nShared = 0;
+  for (auto itIDs = IDs.begin(); itIDs != IDs.end(); ++itIDs) {
+    for (int iDaug = fDaughterBegin[iDecay]; iDaug < fDaughterBegin[iDecay + 1];
+        ++iDaug) {
+      if (*itIDs == fDaughterIDs[iDaug]) {
+        nShared++;
+      }
+    }
+  }
+  return nShared;
+}
 
 void AliFemtoDreamPairCleaner::StoreParticle(
     std::vector<AliFemtoDreamBasePart> Particles) {
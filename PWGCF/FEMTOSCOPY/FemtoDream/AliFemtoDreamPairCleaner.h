@@ -8,6 +8,7 @@
 #ifndef ALIFEMTODREAMPAIRCLEANER_H_
 #define ALIFEMTODREAMPAIRCLEANER_H_
 #include <vector>
+#include <utility>
 #include "Rtypes.h"
 #include "AliFemtoDreamBasePart.h"
 #include "AliFemtoDreamPairCleanerHists.h"
@@ -50,10 +51,21 @@ class AliFemtoDreamPairCleaner {
  private:
   double InvMassPair(TVector3 Part1, int PDG1, TVector3 Part2, int PDG2);
   double E2(int pdgCode, double Ptot2);
+  // index of the track IDs of the daughters of the decays of an event,
+  // to find the decays sharing a daughter with a given one without
+  // comparing all the pairs
+  void IndexDaughters(const std::vector<AliFemtoDreamBasePart> *Decay);
+  void FindSharing(const std::vector<int> &IDs, int first);
+  int NSharedIDs(const std::vector<int> &IDs, int iDecay) const;
   bool fMinimalBooking;
   int fCounter;
   std::vector<std::vector<AliFemtoDreamBasePart>> fParticles;
-  AliFemtoDreamPairCleanerHists *fHists;ClassDef(AliFemtoDreamPairCleaner,3)
+  AliFemtoDreamPairCleanerHists *fHists;
+  std::vector<std::pair<int, int>> fIDIndex;  //! (track ID, candidate index) sorted by ID
+  std::vector<int> fDaughterIDs;              //! track IDs of the daughters of all the indexed decays
+  std::vector<int> fDaughterBegin;            //! first daughter of each indexed decay in fDaughterIDs
+  std::vector<int> fSharing;                  //! indexed candidates sharing a track ID with the current one
+ClassDef(AliFemtoDreamPairCleaner,4)
 };
 
 inline double AliFemtoDreamPairCleaner::E2(int pdgCode, double Ptot2) {
@@ -49,7 +49,17 @@ AliHistogramManager::AliHistogramManager() :
   fBinsAllocated(0),
   fVariableNames(),
   fVariableUnits(),
-  fNVars(0)
+  fNVars(0),
+  fPlanCompiled(kFALSE),
+  fNPlanClasses(0),
+  fPlanTypeBegin(),
+  fPlanHist(),
+  fPlanVarBegin(),
+  fPlanVars(),
+  fPlanWeight(),
+  fPlanClassHandles(),
+  fLastClassName(),
+  fLastClassHandle(-2)
 {
   //
   // Constructor
@@ -71,7 +81,17 @@ AliHistogramManager::AliHistogramManager(const Char_t* name, Int_t nvars) :
   fBinsAllocated(0),
   fVariableNames(),
   fVariableUnits(),
-  fNVars(nvars)
+  fNVars(nvars),
+  fPlanCompiled(kFALSE),
+  fNPlanClasses(0),
+  fPlanTypeBegin(),
+  fPlanHist(),
+  fPlanVarBegin(),
+  fPlanVars(),
+  fPlanWeight(),
+  fPlanClassHandles(),
+  fLastClassName(),
+  fLastClassHandle(-2)
 {
   //
   // Constructor
@@ -131,6 +151,7 @@ void AliHistogramManager::AddHistClass(const Char_t* histClass) {
   hList->SetOwner(kTRUE);
   hList->SetName(histClass);
   fMainList.Add(hList);
+  fPlanCompiled = kFALSE;
 }
 
 //_________________________________________________________________
@@ -154,6 +175,7 @@ void AliHistogramManager::AddHistogram(const Char_t* histClass,
     cout << "Warning in AliHistogramManager::AddHistogram(): Histogram " << name << " already exists" << endl;
     return;
   }
+  fPlanCompiled = kFALSE;
   TString hname = name;
   
   Int_t dimension = 1;
@@ -296,6 +318,7 @@ void AliHistogramManager::AddHistogram(const Char_t* histClass,
     cout << "Warning in AliHistogramManager::AddHistogram(): Histogram " << name << " already exists" << endl;
     return;
   }
+  fPlanCompiled = kFALSE;
   TString hname = name;
   
   Int_t dimension = 1;
@@ -441,6 +464,7 @@ void AliHistogramManager::AddHistogram(const Char_t* histClass,
     cout << "Warning in AliHistogramManager::AddHistogram(): Histogram " << name << " already exists" << endl;
     return;
   }
+  fPlanCompiled = kFALSE;
   TString hname = name;
   
   TString titleStr(title);
@@ -494,6 +518,7 @@ void AliHistogramManager::AddHistogram(const Char_t* histClass,
     cout << "Warning in AliHistogramManager::AddHistogram(): Histogram " << name << " already exists" << endl;
     return;
   }
+  fPlanCompiled = kFALSE;
   TString hname = name;
   
   TString titleStr(title);
@@ -624,147 +649,210 @@ void AliHistogramManager::FillHistClass(const Char_t* className, Float_t* values
   //
   //  fill a class of histograms
   //
-  THashList* hList = (THashList*)fMainList.FindObject(className);
-  if(!hList) {
-    /*cout << "Warning in AliHistogramManager::FillHistClass(): Histogram list " << className << " not found!" << endl;
-    cout << "         Histogram list not filled" << endl; */
-    return;
+  FillHistClass(GetHistClassHandle(className), values);
+}
+
+//__________________________________________________________________
+Int_t AliHistogramManager::GetHistClassHandle(const Char_t* className) {
+  //
+  // handle of a histogram class to be used with FillHistClass(Int_t, Float_t*), -1 if the class does not exist
+  // The handle of a class does not change when histograms or classes are added later
+  // The handles are taken from the name to handle map built by CompileFillPlans(), the last looked up
+  // class is checked first, so that consecutive fills of the same class do not search the map
+  //
+  if(!fPlanCompiled) CompileFillPlans();
+  if(fLastClassHandle>-2 && !fLastClassName.CompareTo(className)) return fLastClassHandle;
+  fLastClassName = className;
+  std::map<TString,Int_t>::const_iterator it = fPlanClassHandles.find(fLastClassName);
+  if(it!=fPlanClassHandles.end()) {
+    fLastClassHandle = it->second;
+    return fLastClassHandle;
   }
-  if(!hList) {
-    return;
+  /*cout << "Warning in AliHistogramManager::FillHistClass(): Histogram list " << className << " not found!" << endl;
+  cout << "         Histogram list not filled" << endl; */
+  fLastClassHandle = -1;
+  return fLastClassHandle;
+}
+
+//__________________________________________________________________
+Int_t AliHistogramManager::DecodeFillDescriptor(TObject* h, Int_t* vars, Int_t& nvars, Int_t& varW) const {
+  //
+  // decode the fill information encoded in the unique IDs of the histogram and of its axes
+  // returns the fill type, or -1 if the histogram cannot be filled (unused variables)
+  //
+  Int_t uid = h->GetUniqueID();
+  Bool_t isProfile = (uid%10==1 ? kTRUE : kFALSE);   // units digit encodes the isProfile
+  Bool_t isTHn = ((uid%100)>10 ? kTRUE : kFALSE);
+  Int_t thnDim = 0;
+  if(isTHn) thnDim = (uid%100)-10;        // the excess over 10 from the last 2 digits give the dimension of the THn
+  Int_t dimension = 0;
+  if(!isTHn) dimension = ((TH1*)h)->GetDimension();
+
+  uid = (uid-(uid%100))/100;
+  Int_t varT = -1;
+  varW = -1;
+  if(uid>0) {
+    varW = uid%(fNVars+1)-1;
+    if(varW==0) varW=AliReducedVarManager::kNothing;
+    uid = (uid-(uid%(fNVars+1)))/(fNVars+1);
+    if(uid>0) varT = uid - 1;
   }
-    
-  TIter next(hList);
-  TObject* h=0x0;
-  Bool_t isProfile;
-  Bool_t isTHn;
-  Int_t thnDim=0;
-  Bool_t isSparse=kFALSE;
-  Double_t fillValues[20]={0.0};
-  Int_t uid = 0;
-  Int_t varX=-1, varY=-1, varZ=-1, varT=-1, varW=-1;
-  Int_t dimension=0;
-  while((h=next())) {
-    Bool_t allVarsGood = kTRUE;
-    uid = h->GetUniqueID();
-    isProfile = (uid%10==1 ? kTRUE : kFALSE);   // units digit encodes the isProfile
-    isTHn = ((uid%100)>10 ? kTRUE : kFALSE);      
-    if(isTHn) thnDim = (uid%100)-10;        // the excess over 10 from the last 2 digits give the dimension of the THn
-    if(isTHn && ((TString)h->ClassName()).Contains("Sparse")) isSparse = kTRUE;
-    dimension = 0;
-    if(!isTHn) dimension = ((TH1*)h)->GetDimension();
-        
-    uid = (uid-(uid%100))/100;
-    varX = -1;
-    varY = -1;
-    varZ = -1;
-    varT = -1;
-    varW = -1;
-    if(uid>0) {
-      varW = uid%(fNVars+1)-1;
-      if(varW==0) varW=AliReducedVarManager::kNothing;
-      uid = (uid-(uid%(fNVars+1)))/(fNVars+1);
-      if(uid>0) varT = uid - 1;
-      //cout << "Filling " << h->GetName() << " with varT " << varT << endl;
-    }
-        
-    if(!isTHn) {
-      varX = ((TH1*)h)->GetXaxis()->GetUniqueID();
-      if(fUsedVars[varX]) {
-        switch(dimension) {
-          case 1:
-            if(isProfile) {
-              varY = ((TH1*)h)->GetYaxis()->GetUniqueID();
-              if(!fUsedVars[varY]) break;
-              if(varW>AliReducedVarManager::kNothing) { 
-                if(!fUsedVars[varW]) break;
-                ((TProfile*)h)->Fill(values[varX],values[varY],values[varW]);
-              }
-              else 
-                ((TProfile*)h)->Fill(values[varX],values[varY]);
-            }
-            else {
-              if(varW>AliReducedVarManager::kNothing) {
-                if(!fUsedVars[varW]) break;
-                ((TH1F*)h)->Fill(values[varX],values[varW]);
-              }
-              else
-                ((TH1F*)h)->Fill(values[varX]);
-            }
-          break;
-          case 2:
-            varY = ((TH1*)h)->GetYaxis()->GetUniqueID();
-            if(!fUsedVars[varY]) break;
-            if(isProfile) {
-              varZ = ((TH1*)h)->GetZaxis()->GetUniqueID();
-              if(!fUsedVars[varZ]) break;
-              if(varW>AliReducedVarManager::kNothing) {
-                if(!fUsedVars[varW]) break;
-                ((TProfile2D*)h)->Fill(values[varX],values[varY],values[varZ],values[varW]);
-              }
-              else
-                ((TProfile2D*)h)->Fill(values[varX],values[varY],values[varZ]);        
-            }
-            else {
-              if(varW>AliReducedVarManager::kNothing) {
-                if(!fUsedVars[varW]) break;
-                ((TH2F*)h)->Fill(values[varX],values[varY], values[varW]);
-              }
-              else
-                ((TH2F*)h)->Fill(values[varX],values[varY]);
-            }
-          break;
-          case 3:
-            varY = ((TH1*)h)->GetYaxis()->GetUniqueID();
-            if(!fUsedVars[varY]) break;
-            varZ = ((TH1*)h)->GetZaxis()->GetUniqueID();
-            if(!fUsedVars[varZ]) break;
-            if(isProfile) {
-              if(!fUsedVars[varT]) break;
-              if(varW>AliReducedVarManager::kNothing) {
-                if(!fUsedVars[varW]) break;
-                ((TProfile3D*)h)->Fill(values[varX],values[varY],values[varZ],values[varT],values[varW]);
-              }
-              else
-                ((TProfile3D*)h)->Fill(values[varX],values[varY],values[varZ],values[varT]);
-            }
-            else {
-              if(varW>AliReducedVarManager::kNothing) {
-                if(!fUsedVars[varW]) break;
-                ((TH3F*)h)->Fill(values[varX],values[varY],values[varZ],values[varW]);
-              }
-              else
-                ((TH3F*)h)->Fill(values[varX],values[varY],values[varZ]);
-            }
-          break;
-          default:
-          break;
-        }  // end switch
-      }
-    }  // end if(!isTHn)
-    else {
-      for(Int_t idim=0;idim<thnDim;++idim) {
-        if (isSparse) {
-          allVarsGood &= fUsedVars[((THnSparseF*)h)->GetAxis(idim)->GetUniqueID()];
-          fillValues[idim] = values[((THnSparseF*)h)->GetAxis(idim)->GetUniqueID()];
-        } else {
-          allVarsGood &= fUsedVars[((THnF*)h)->GetAxis(idim)->GetUniqueID()];
-          fillValues[idim] = values[((THnF*)h)->GetAxis(idim)->GetUniqueID()];
+  if(varW>AliReducedVarManager::kNothing && !fUsedVars[varW]) return -1;
+  if(varW<=AliReducedVarManager::kNothing) varW = -1;
+
+  Int_t type = -1;
+  nvars = 0;
+  if(!isTHn) {
+    vars[nvars++] = ((TH1*)h)->GetXaxis()->GetUniqueID();
+    switch(dimension) {
+      case 1:
+        if(isProfile) {
+          vars[nvars++] = ((TH1*)h)->GetYaxis()->GetUniqueID();
+          type = kFillProfile;
         }
-      }
-      if(allVarsGood) {
-        if(varW>AliReducedVarManager::kNothing) {
-          if(fUsedVars[varW]) {
-            if (isSparse) ((THnSparseF*)h)->Fill(fillValues,values[varW]);
-            else          ((THnF*)h)->Fill(fillValues,values[varW]);
-          }
+        else type = kFillTH1;
+      break;
+      case 2:
+        vars[nvars++] = ((TH1*)h)->GetYaxis()->GetUniqueID();
+        if(isProfile) {
+          vars[nvars++] = ((TH1*)h)->GetZaxis()->GetUniqueID();
+          type = kFillProfile2D;
         }
-        else {
-          if (isSparse) ((THnSparseF*)h)->Fill(fillValues);
-          else          ((THnF*)h)->Fill(fillValues);
+        else type = kFillTH2;
+      break;
+      case 3:
+        vars[nvars++] = ((TH1*)h)->GetYaxis()->GetUniqueID();
+        vars[nvars++] = ((TH1*)h)->GetZaxis()->GetUniqueID();
+        if(isProfile) {
+          vars[nvars++] = varT;
+          type = kFillProfile3D;
         }
+        else type = kFillTH3;
+      break;
+      default:
+      return -1;
+    }
+  }
+  else {
+    // THnF and THnSparseF are both filled through THnBase
+    for(Int_t idim=0;idim<thnDim;++idim)
+      vars[nvars++] = ((THnBase*)h)->GetAxis(idim)->GetUniqueID();
+    type = kFillTHn;
+  }
+  for(Int_t i=0;i<nvars;++i) {
+    if(vars[i]<0 || !fUsedVars[vars[i]]) return -1;
+  }
+  return type;
+}
+
+//__________________________________________________________________
+void AliHistogramManager::CompileFillPlans() {
+  //
+  // Compile the fill plans of all histogram classes: the histograms of each class are decoded once into
+  // descriptors (histogram, variables, weight) grouped by type of histogram, so that FillHistClass()
+  // runs one tight loop per type. Called automatically when histograms were booked after the last compilation.
+  //
+  fPlanHist.clear();
+  fPlanVarBegin.clear();
+  fPlanVars.clear();
+  fPlanWeight.clear();
+  fNPlanClasses = fMainList.GetEntries();
+  fPlanTypeBegin.assign(fNPlanClasses*kNFillTypes+1, 0);
+  // the name to handle map is rebuilt, classes may have been added since the last compilation
+  fPlanClassHandles.clear();
+  fLastClassName = "";
+  fLastClassHandle = -2;
+
+  std::vector<TObject*> hists;
+  std::vector<Int_t> types;
+  std::vector<Int_t> weights;
+  std::vector<Int_t> varBegin;
+  std::vector<Int_t> vars;
+  Int_t hvars[20];
+  Int_t nvars = 0;
+  Int_t varW = -1;
+  TIter nextClass(&fMainList);
+  THashList* hList = 0x0;
+  Int_t iclass = 0;
+  while((hList=(THashList*)nextClass())) {
+    fPlanClassHandles[hList->GetName()] = iclass;
+    hists.clear(); types.clear(); weights.clear(); varBegin.clear(); vars.clear();
+    TIter next(hList);
+    TObject* h=0x0;
+    while((h=next())) {
+      Int_t type = DecodeFillDescriptor(h, hvars, nvars, varW);
+      if(type<0) continue;
+      hists.push_back(h);
+      types.push_back(type);
+      weights.push_back(varW);
+      varBegin.push_back(vars.size());
+      vars.insert(vars.end(), hvars, hvars+nvars);
+    }
+    varBegin.push_back(vars.size());
+    // append the descriptors of the class grouped by type, in booking order within a type
+    for(Int_t type=0; type<kNFillTypes; ++type) {
+      fPlanTypeBegin[iclass*kNFillTypes+type] = fPlanHist.size();
+      for(UInt_t ih=0; ih<hists.size(); ++ih) {
+        if(types[ih]!=type) continue;
+        fPlanHist.push_back(hists[ih]);
+        fPlanWeight.push_back(weights[ih]);
+        fPlanVarBegin.push_back(fPlanVars.size());
+        fPlanVars.insert(fPlanVars.end(), vars.begin()+varBegin[ih], vars.begin()+varBegin[ih+1]);
       }
     }
+    ++iclass;
+  }
+  fPlanTypeBegin[fNPlanClasses*kNFillTypes] = fPlanHist.size();
+  fPlanVarBegin.push_back(fPlanVars.size());
+  fPlanCompiled = kTRUE;
+}
+
+//__________________________________________________________________
+void AliHistogramManager::FillHistClass(Int_t handle, Float_t* values) {
+  //
+  //  fill a class of histograms using its handle (see GetHistClassHandle())
+  //
+  if(!fPlanCompiled) CompileFillPlans();
+  if(handle<0 || handle>=fNPlanClasses) return;
+
+  const Int_t* begin = &fPlanTypeBegin[handle*kNFillTypes];
+  const Int_t end = fPlanTypeBegin[(handle+1)*kNFillTypes];
+  if(begin[0]==end) return;
+  TObject* const* hist = &fPlanHist[0];
+  const Int_t* weight = &fPlanWeight[0];
+  const Int_t* varBegin = &fPlanVarBegin[0];
+  const Int_t* allVars = (fPlanVars.empty() ? 0x0 : &fPlanVars[0]);
+  Int_t i = begin[kFillTH1];
+  for(; i<begin[kFillProfile]; ++i) {
+    const Int_t* v = allVars+varBegin[i];
+    ((TH1*)hist[i])->Fill(values[v[0]], (weight[i]<0 ? 1.0 : values[weight[i]]));
+  }
+  for(; i<begin[kFillTH2]; ++i) {
+    const Int_t* v = allVars+varBegin[i];
+    ((TProfile*)hist[i])->Fill(values[v[0]], values[v[1]], (weight[i]<0 ? 1.0 : values[weight[i]]));
+  }
+  for(; i<begin[kFillProfile2D]; ++i) {
+    const Int_t* v = allVars+varBegin[i];
+    ((TH2*)hist[i])->Fill(values[v[0]], values[v[1]], (weight[i]<0 ? 1.0 : values[weight[i]]));
+  }
+  for(; i<begin[kFillTH3]; ++i) {
+    const Int_t* v = allVars+varBegin[i];
+    ((TProfile2D*)hist[i])->Fill(values[v[0]], values[v[1]], values[v[2]], (weight[i]<0 ? 1.0 : values[weight[i]]));
+  }
+  for(; i<begin[kFillProfile3D]; ++i) {
+    const Int_t* v = allVars+varBegin[i];
+    ((TH3*)hist[i])->Fill(values[v[0]], values[v[1]], values[v[2]], (weight[i]<0 ? 1.0 : values[weight[i]]));
+  }
+  for(; i<begin[kFillTHn]; ++i) {
+    const Int_t* v = allVars+varBegin[i];
+    ((TProfile3D*)hist[i])->Fill(values[v[0]], values[v[1]], values[v[2]], values[v[3]], (weight[i]<0 ? 1.0 : values[weight[i]]));
+  }
+  Double_t fillValues[20]={0.0};
+  for(; i<end; ++i) {
+    const Int_t* v = allVars+varBegin[i];
+    const Int_t nDim = varBegin[i+1]-varBegin[i];
+    for(Int_t idim=0;idim<nDim;++idim) fillValues[idim] = values[v[idim]];
+    ((THnBase*)hist[i])->Fill(fillValues, (weight[i]<0 ? 1.0 : values[weight[i]]));
   }
 }
 
@@ -8,6 +8,9 @@
 #ifndef ALIHISTOGRAMMANAGER_H
 #define ALIHISTOGRAMMANAGER_H
 
+#include <vector>
+#include <map>
+
 #include <TString.h>
 #include <TObject.h>
 #include <THn.h>
@@ -69,6 +72,11 @@ class AliHistogramManager : public TObject {
                         TAxis* axis);
   
   void FillHistClass(const Char_t* className, Float_t* values);
+  // Fill plans: each histogram class is compiled once (after booking) into a flat list of fill descriptors
+  // and can be filled through an integer handle, without string lookups or decoding of the histograms
+  void CompileFillPlans();
+  Int_t GetHistClassHandle(const Char_t* className);     // -1 if the class does not exist
+  void FillHistClass(Int_t handle, Float_t* values);
   
   void SetUseDefaultVariableNames(Bool_t flag) {fUseDefaultVariableNames = flag;};
   void SetDefaultVarNames(TString* vars, TString* units);
@@ -106,9 +114,26 @@ class AliHistogramManager : public TObject {
   TString fVariableUnits[AliReducedVarManager::kNVars];               //! variable units
   Int_t fNVars;                          // maximum number of variables
   
+  // fill plans, descriptors are grouped by class and by type of histogram
+  enum FillTypes {
+    kFillTH1=0, kFillProfile, kFillTH2, kFillProfile2D, kFillTH3, kFillProfile3D, kFillTHn,
+    kNFillTypes
+  };
+  Bool_t fPlanCompiled;                  //! fill plans are up to date with the booked histograms
+  Int_t fNPlanClasses;                   //! number of compiled histogram classes
+  std::vector<Int_t> fPlanTypeBegin;     //! first descriptor of each (class,type), index class*kNFillTypes+type
+  std::vector<TObject*> fPlanHist;       //! histogram of each descriptor
+  std::vector<Int_t> fPlanVarBegin;      //! first variable of each descriptor in fPlanVars
+  std::vector<Int_t> fPlanVars;          //! variables (x,y,z,t or THn axes) of all descriptors
+  std::vector<Int_t> fPlanWeight;        //! weight variable of each descriptor (-1 = no weight)
+  std::map<TString,Int_t> fPlanClassHandles;  //! handle of each histogram class, by name
+  TString fLastClassName;                //! class name of the last handle lookup
+  Int_t fLastClassHandle;                //! handle of the last looked up class (-2 = none)
+  
   void MakeAxisLabels(TAxis* ax, const Char_t* labels);
+  Int_t DecodeFillDescriptor(TObject* h, Int_t* vars, Int_t& nvars, Int_t& varW) const;
   
-  ClassDef(AliHistogramManager, 4)
+  ClassDef(AliHistogramManager, 6)
 };
 
 #endif
@@ -15,6 +15,7 @@ using std::cout;
 using std::endl;
 using std::flush;
 
+#include <TClass.h>
 #include <TMath.h>
 #include <TTimeStamp.h>
 #include <TRandom.h>
@@ -47,7 +48,11 @@ AliMixingHandler::AliMixingHandler(Int_t mixingSetup /* = kMixResonanceLegs*/) :
   fHistos(0x0),
   fCrossPairsCuts(),
   fLikePairsLeg1Cuts(),
-  fLikePairsLeg2Cuts()
+  fLikePairsLeg2Cuts(),
+  fUseCompactPools(kFALSE),
+  fCompactPools(),
+  fHistClassHandles(),
+  fSelectedLegs()
 {
   // 
   // default constructor
@@ -58,6 +63,10 @@ AliMixingHandler::AliMixingHandler(Int_t mixingSetup /* = kMixResonanceLegs*/) :
      fVariables[iVar] = AliReducedVarManager::kNothing;
   }
   
+  for(Int_t i=0; i<2; ++i) {
+     fScratchLegs[i] = 0x0;
+     fScratchTrackLegs[i] = 0x0;
+  }
   fPoolSize.Set(1);
   fCrossPairsCuts.SetOwner(kTRUE);
   fLikePairsLeg1Cuts.SetOwner(kTRUE);
@@ -87,7 +96,11 @@ AliMixingHandler::AliMixingHandler(const Char_t* name, const Char_t* title, Int_
   fHistos(0x0),
   fCrossPairsCuts(),
   fLikePairsLeg1Cuts(),
-  fLikePairsLeg2Cuts()
+  fLikePairsLeg2Cuts(),
+  fUseCompactPools(kFALSE),
+  fCompactPools(),
+  fHistClassHandles(),
+  fSelectedLegs()
 {
   //
   // Named constructor
@@ -98,6 +111,10 @@ AliMixingHandler::AliMixingHandler(const Char_t* name, const Char_t* title, Int_
      fVariables[iVar] = AliReducedVarManager::kNothing;
   }
   
+  for(Int_t i=0; i<2; ++i) {
+     fScratchLegs[i] = 0x0;
+     fScratchTrackLegs[i] = 0x0;
+  }
   fPoolSize.Set(1);
   fCrossPairsCuts.SetOwner(kTRUE);
   fLikePairsLeg1Cuts.SetOwner(kTRUE);
@@ -113,6 +130,10 @@ AliMixingHandler::~AliMixingHandler() {
    fCrossPairsCuts.Clear("C");
    fLikePairsLeg1Cuts.Clear("C");
    fLikePairsLeg2Cuts.Clear("C");
+   for(Int_t i=0; i<2; ++i) {
+      if(fScratchLegs[i]) delete fScratchLegs[i];
+      if(fScratchTrackLegs[i]) delete fScratchTrackLegs[i];
+   }
 }
 
 
@@ -177,10 +198,19 @@ void AliMixingHandler::Init() {
     }
   }
 
+  delete histClassArr;
+
   Int_t size = 1;
   for(Int_t iVar = 0; iVar<fNMixingVariables; ++iVar) size *= (fVariableLimits[iVar].GetSize()-1);
-  fPoolsLeg1.Expand(size); fPoolsLeg1.SetOwner(kTRUE);
-  fPoolsLeg2.Expand(size); fPoolsLeg2.SetOwner(kTRUE);
+  if(fUseCompactPools && fMixingSetup!=kMixResonanceLegs) {
+    cout << "AliMixingHandler::Init(): WARNING Compact pools are available only for resonance legs mixing, the track pools will be used" << endl;
+    fUseCompactPools = kFALSE;
+  }
+  if(fUseCompactPools) fCompactPools.assign(size, CompactPool());
+  else {
+    fPoolsLeg1.Expand(size); fPoolsLeg1.SetOwner(kTRUE);
+    fPoolsLeg2.Expand(size); fPoolsLeg2.SetOwner(kTRUE);
+  }
   
   fPoolSize.Set(fNParallelCuts*size);
   for(Int_t i=0;i<fNParallelCuts*size;++i) fPoolSize[i] = 0;
@@ -221,6 +251,16 @@ void AliMixingHandler::FillEvent(TList* leg1List, TList* leg2List, Float_t* valu
   Int_t category = FindEventCategory(values);
   if(category<0) return;   // event characteristics outside the defined ranges
   
+  if(fUseCompactPools) {
+    FillCompactEvent(leg1List, leg2List, category, values);
+    ULong_t mixingMask = IncrementPoolSizes(leg1List,leg2List,category);
+    if(mixingMask) {
+      RunCompactEventMixing(category,mixingMask,type,values);
+      ResetPoolSizes(mixingMask,category);
+    }
+    return;
+  }
+  
   TClonesArray *leg1PoolP = static_cast<TClonesArray*>(fPoolsLeg1.At(category));
   if(!leg1PoolP) leg1PoolP = new(fPoolsLeg1[category]) TClonesArray("TList",1);
   leg1PoolP->SetOwner(kTRUE);
@@ -279,6 +319,57 @@ void AliMixingHandler::FillEvent(TList* leg1List, TList* leg2List, Float_t* valu
 }
 
 
+//_________________________________________________________________________
+void AliMixingHandler::FillCompactEvent(TList* leg1List, TList* leg2List, Int_t category, Float_t* values) {
+  //
+  // Append the legs of this event to the compact pool of the event category
+  // Only the information used by AliReducedVarManager::FillPairInfoME() is kept; the VZERO and TPC Q vectors
+  // are stored once per event instead of in the covariance matrix of each track
+  //
+  CompactPool& pool = fCompactPools[category];
+  TList* lists[2] = {leg1List, leg2List};
+  for(Int_t i=0; i<2; ++i) {
+    if(pool.fBegin[i].empty()) {
+      pool.fBegin[i].reserve(fPoolDepth+1);
+      pool.fBegin[i].push_back(0);
+    }
+    if(lists[i]) {
+      TIter nextTrack(lists[i]);
+      AliReducedBaseTrack* track = 0x0;
+      while((track=(AliReducedBaseTrack*)nextTrack())) {
+        CompactLeg leg;
+        if(track->IsCartesian()) {
+          leg.fP[0] = track->Px(); leg.fP[1] = track->Py(); leg.fP[2] = track->Pz();
+          leg.fInfo = 1;
+        }
+        else {
+          leg.fP[0] = track->Pt(); leg.fP[1] = track->Phi(); leg.fP[2] = track->Eta();
+          leg.fInfo = 0;
+        }
+        leg.fFlags = track->GetFlags();
+        leg.fCharge = track->Charge();
+        leg.fITSclusterMap = 0;
+        leg.fEMCalEnergy = 0.0;
+        if(track->IsA()==AliReducedTrackInfo::Class()) {
+          AliReducedTrackInfo* trackInfo = (AliReducedTrackInfo*)track;
+          leg.fITSclusterMap = trackInfo->ITSclusterMap();
+          leg.fEMCalEnergy = trackInfo->MatchedEMCalClusterEnergy();
+          leg.fInfo |= 2;
+        }
+        pool.fLegs[i].push_back(leg);
+      }
+    }
+    pool.fBegin[i].push_back(pool.fLegs[i].size());
+  }
+  pool.fQvec.push_back(values[AliReducedVarManager::kVZEROQvecX+0*6+1]);
+  pool.fQvec.push_back(values[AliReducedVarManager::kVZEROQvecY+0*6+1]);
+  pool.fQvec.push_back(values[AliReducedVarManager::kVZEROQvecX+1*6+1]);
+  pool.fQvec.push_back(values[AliReducedVarManager::kVZEROQvecY+1*6+1]);
+  pool.fQvec.push_back(values[AliReducedVarManager::kTPCQvecXtree+1]);
+  pool.fQvec.push_back(values[AliReducedVarManager::kTPCQvecYtree+1]);
+}
+
+
 //_________________________________________________________________________
 Int_t AliMixingHandler::FindEventCategory(Float_t* values) {
    //
@@ -347,6 +438,58 @@ Int_t AliMixingHandler::GetPoolSize(Int_t cutNumber, Int_t eventCategory) const
 }
 
 
+//_________________________________________________________________________
+Int_t AliMixingHandler::GetNPoolEvents(Int_t eventCategory) const {
+  //
+  // Number of events kept in the pools of an event category
+  //
+  if(eventCategory<0) return 0;
+  if(fUseCompactPools) {
+    if(eventCategory>=Int_t(fCompactPools.size())) return 0;
+    const std::vector<Int_t>& begin = fCompactPools[eventCategory].fBegin[0];
+    return (begin.empty() ? 0 : Int_t(begin.size())-1);
+  }
+  if(eventCategory>=fPoolsLeg1.GetSize()) return 0;
+  TClonesArray* pool = static_cast<TClonesArray*>(fPoolsLeg1.At(eventCategory));
+  return (pool ? pool->GetEntries() : 0);
+}
+
+
+//_________________________________________________________________________
+Long64_t AliMixingHandler::GetPoolMemory(Int_t eventCategory) const {
+  //
+  // Memory (bytes) used by the pools of an event category
+  // For the track pools it is estimated from the size of the track objects and of the lists holding them
+  //
+  if(eventCategory<0) return 0;
+  Long64_t memory = 0;
+  if(fUseCompactPools) {
+    if(eventCategory>=Int_t(fCompactPools.size())) return 0;
+    const CompactPool& pool = fCompactPools[eventCategory];
+    for(Int_t i=0; i<2; ++i) {
+      memory += pool.fLegs[i].capacity()*sizeof(CompactLeg);
+      memory += pool.fBegin[i].capacity()*sizeof(Int_t);
+    }
+    memory += pool.fQvec.capacity()*sizeof(Float_t);
+    return memory;
+  }
+  if(eventCategory>=fPoolsLeg1.GetSize()) return 0;
+  TClonesArray* pools[2] = {static_cast<TClonesArray*>(fPoolsLeg1.At(eventCategory)), static_cast<TClonesArray*>(fPoolsLeg2.At(eventCategory))};
+  for(Int_t i=0; i<2; ++i) {
+    if(!pools[i]) continue;
+    TIter nextList(pools[i]);
+    TList* list = 0x0;
+    while((list=(TList*)nextList())) {
+      memory += sizeof(TList);
+      TIter nextTrack(list);
+      TObject* track = 0x0;
+      while((track=nextTrack())) memory += track->IsA()->Size() + sizeof(TObjLink);
+    }
+  }
+  return memory;
+}
+
+
 //_________________________________________________________________________
 void AliMixingHandler::ResetPoolSizes(ULong_t mixingMask, Int_t category) {
   //
@@ -425,6 +568,19 @@ void AliMixingHandler::RunLeftoverMixing(Int_t type) {
   for(Int_t i=0; i<fNParallelCuts; ++i) mixingMask |= (ULong_t(1)<<i);
   Float_t values[AliReducedVarManager::kNVars];
   
+  if(fUseCompactPools) {
+    for(Int_t icateg=0; icateg<Int_t(fCompactPools.size()); ++icateg) {
+      if(!GetNPoolEvents(icateg)) continue;
+      for(Int_t iVar=0; iVar<fNMixingVariables; ++iVar) {
+        Int_t bin = GetBinFromCategory(iVar, icateg);
+        values[fVariables[iVar]] = 0.5*(fVariableLimits[iVar][bin] + fVariableLimits[iVar][bin+1]);
+      }
+      RunCompactEventMixing(icateg,mixingMask,type,values);
+      ResetPoolSizes(mixingMask,icateg);
+    }
+    return;
+  }
+  
   for(Int_t icateg=0; icateg<fPoolsLeg1.GetEntries(); ++icateg) {
     TClonesArray *leg1Pool = static_cast<TClonesArray*>(fPoolsLeg1.At(icateg));
     TClonesArray *leg2Pool = static_cast<TClonesArray*>(fPoolsLeg2.At(icateg));
@@ -453,7 +609,7 @@ void AliMixingHandler::RunEventMixing(TClonesArray* leg1Pool, TClonesArray* leg2
   Int_t entries = leg1Pool->GetEntries();
   if(entries<2) return;
   
-  TObjArray* histClassArr = fHistClassNames.Tokenize(";");
+  if(fHistClassHandles.empty()) InitHistClassHandles();
   
   TIter iterEv1Leg1Pool(leg1Pool);
   TIter iterEv1Leg2Pool(leg2Pool);
@@ -499,10 +655,10 @@ void AliMixingHandler::RunEventMixing(TClonesArray* leg1Pool, TClonesArray* leg2
                 if (fNParallelPairCuts>1) {
                   for (Int_t jbit=0; jbit<fNParallelPairCuts; jbit++) {
                     if (!((pairCutMask)&(ULong_t(1)<<jbit))) continue;
-                    fHistos->FillHistClass(histClassArr->At(ibit*3+jbit*3*fNParallelCuts+1)->GetName(), values);
+                    fHistos->FillHistClass(fHistClassHandles[ibit*3+jbit*3*fNParallelCuts+1], values);
                   }
                 } else {
-                  fHistos->FillHistClass(histClassArr->At(ibit*3+1)->GetName(), values);
+                  fHistos->FillHistClass(fHistClassHandles[ibit*3+1], values);
                 }
               }
               if(fMixingSetup==kMixCorrelation) {
@@ -511,12 +667,12 @@ void AliMixingHandler::RunEventMixing(TClonesArray* leg1Pool, TClonesArray* leg2
                   ULong_t pairCutMaskCorr = (reinterpret_cast<AliReducedPairInfo*>(ev1Leg1))->GetQualityFlags();
                   for (Int_t jbit=0; jbit<fNParallelPairCuts; jbit++) {
                     if (!((pairCutMaskCorr)&(ULong_t(1)<<jbit))) continue;
-                    if (fMixLikeSign) fHistos->FillHistClass(histClassArr->At(ibit*3+jbit*fNParallelCuts+pairType)->GetName(), values);
-                    else              fHistos->FillHistClass(histClassArr->At(ibit+jbit*fNParallelCuts)->GetName(), values);
+                    if (fMixLikeSign) fHistos->FillHistClass(fHistClassHandles[ibit*3+jbit*fNParallelCuts+pairType], values);
+                    else              fHistos->FillHistClass(fHistClassHandles[ibit+jbit*fNParallelCuts], values);
                   }
                 } else {
-                  if (fMixLikeSign) fHistos->FillHistClass(histClassArr->At(ibit*3+pairType)->GetName(), values);
-                  else              fHistos->FillHistClass(histClassArr->At(ibit)->GetName(), values);
+                  if (fMixLikeSign) fHistos->FillHistClass(fHistClassHandles[ibit*3+pairType], values);
+                  else              fHistos->FillHistClass(fHistClassHandles[ibit], values);
                 }
               }
             }
@@ -543,10 +699,10 @@ void AliMixingHandler::RunEventMixing(TClonesArray* leg1Pool, TClonesArray* leg2
             if (fNParallelPairCuts>1) {
                 for (Int_t jbit=0; jbit<fNParallelPairCuts; jbit++) {
                     if (!((pairCutMask)&(ULong_t(1)<<jbit))) continue;
-                    fHistos->FillHistClass(histClassArr->At(ibit*3+jbit*3*fNParallelCuts+0)->GetName(), values);
+                    fHistos->FillHistClass(fHistClassHandles[ibit*3+jbit*3*fNParallelCuts+0], values);
                 }
             } else {
-                fHistos->FillHistClass(histClassArr->At(ibit*3+0)->GetName(), values);
+                fHistos->FillHistClass(fHistClassHandles[ibit*3+0], values);
             }
         }
       }
@@ -581,10 +737,10 @@ void AliMixingHandler::RunEventMixing(TClonesArray* leg1Pool, TClonesArray* leg2
                     if (fNParallelPairCuts>1) {
                         for (Int_t jbit=0; jbit<fNParallelPairCuts; jbit++) {
                             if (!((pairCutMask)&(ULong_t(1)<<jbit))) continue;
-                            fHistos->FillHistClass(histClassArr->At(ibit*3+jbit*3*fNParallelCuts+2)->GetName(), values);
+                            fHistos->FillHistClass(fHistClassHandles[ibit*3+jbit*3*fNParallelCuts+2], values);
                         }
                     } else {
-                        fHistos->FillHistClass(histClassArr->At(ibit*3+2)->GetName(), values);
+                        fHistos->FillHistClass(fHistClassHandles[ibit*3+2], values);
                     }
                 }
             }
@@ -659,6 +815,169 @@ void AliMixingHandler::RunEventMixing(TClonesArray* leg1Pool, TClonesArray* leg2
 }
 
 
+//_________________________________________________________________________
+void AliMixingHandler::InitHistClassHandles() {
+  //
+  // Look up the histogram manager handles of the hist classes, in the order given in fHistClassNames
+  //
+  fHistClassHandles.clear();
+  TObjArray* histClassArr = fHistClassNames.Tokenize(";");
+  for(Int_t i=0; i<histClassArr->GetEntries(); ++i)
+    fHistClassHandles.push_back(fHistos->GetHistClassHandle(histClassArr->At(i)->GetName()));
+  delete histClassArr;
+}
+
+
+//_________________________________________________________________________
+void AliMixingHandler::RunCompactEventMixing(Int_t category, ULong_t mixingMask, Int_t type, Float_t* values) {
+  //
+  // Run event mixing over the compact pool of an event category
+  // NOTE: The pairs, the pair cuts and the order of the histogram fills are the same as in RunEventMixing()
+  //
+  Int_t entries = GetNPoolEvents(category);
+  if(entries<2) return;
+  if(fHistClassHandles.empty()) InitHistClassHandles();
+  
+  CompactPool& pool = fCompactPools[category];
+  for(Int_t iev1=0; iev1<entries; ++iev1) {                            // first event loop
+    const Float_t* qvec1 = &pool.fQvec[6*iev1];
+    for(Int_t iev2=0; iev2<entries; ++iev2) {                         // second event loop
+      if(iev1==iev2) continue;
+      
+      // ev1-leg1 with the ev2-leg2 (cross pairs) and the ev2-leg1 (like pairs) lists
+      for(Int_t ileg=pool.fBegin[0][iev1]; ileg<pool.fBegin[0][iev1+1]; ++ileg) {
+        const CompactLeg& leg = pool.fLegs[0][ileg];
+        ULong_t testFlags1 = mixingMask & leg.fFlags;
+        if(!testFlags1) continue;
+        MixCompactLegs(leg, qvec1, pool, 1, iev2, 1, testFlags1, type, values);
+        if(fMixLikeSign) MixCompactLegs(leg, qvec1, pool, 0, iev2, 0, testFlags1, type, values);
+      }
+      if(!fMixLikeSign) continue;
+      
+      // ev1-leg2 with the ev2-leg2 list (like pairs)
+      for(Int_t ileg=pool.fBegin[1][iev1]; ileg<pool.fBegin[1][iev1+1]; ++ileg) {
+        const CompactLeg& leg = pool.fLegs[1][ileg];
+        ULong_t testFlags1 = mixingMask & leg.fFlags;
+        if(!testFlags1) continue;
+        MixCompactLegs(leg, qvec1, pool, 1, iev2, 2, testFlags1, type, values);
+      }
+    }  // end second event loop
+  }  // end first event loop
+  
+  CleanCompactPool(pool, mixingMask);
+}
+
+
+//_________________________________________________________________________
+void AliMixingHandler::MixCompactLegs(const CompactLeg& leg1, const Float_t* qvec1, const CompactPool& pool, Int_t list2, Int_t iev2,
+                                      Int_t pairType, ULong_t testFlags1, Int_t type, Float_t* values) {
+  //
+  // Pair leg1 with the legs of the list list2 (0 - leg1, 1 - leg2) of event iev2 and fill the histograms
+  // pairType is 1 for cross pairs and 0 (2) for leg1 (leg2) like pairs, as in IsPairSelected(); 
+  //   it is also the position of the histogram class within the 3 classes of each cut
+  //
+  Int_t begin = pool.fBegin[list2][iev2];
+  Int_t end = pool.fBegin[list2][iev2+1];
+  if(begin==end) return;
+  
+  // select the partners having at least one common bit with leg1, without branching on the flags
+  if(Int_t(fSelectedLegs.size())<end-begin) fSelectedLegs.resize(end-begin);
+  const CompactLeg* legs = &pool.fLegs[list2][0];
+  Int_t* selected = &fSelectedLegs[0];
+  Int_t nSelected = 0;
+  for(Int_t i=begin; i<end; ++i) {
+    selected[nSelected] = i;
+    nSelected += ((legs[i].fFlags & testFlags1) ? 1 : 0);
+  }
+  if(!nSelected) return;
+  
+  AliReducedBaseTrack* t1 = LoadCompactLeg(leg1, qvec1, 0);
+  const Float_t* qvec2 = &pool.fQvec[6*iev2];
+  for(Int_t is=0; is<nSelected; ++is) {
+    const CompactLeg& leg2 = legs[selected[is]];
+    AliReducedBaseTrack* t2 = LoadCompactLeg(leg2, qvec2, 1);
+    AliReducedVarManager::FillPairInfoME(t1, t2, type, values);
+    ULong_t pairCutMask = IsPairSelected(values, pairType);
+    if(!pairCutMask) continue;   // fill histograms only if pair cuts are fulfilled
+    ULong_t testFlags2 = testFlags1 & leg2.fFlags;
+    for(Int_t ibit=0; ibit<fNParallelCuts; ++ibit) {
+      if(!(testFlags2&(ULong_t(1)<<ibit))) continue;
+      if(fNParallelPairCuts>1) {
+        for(Int_t jbit=0; jbit<fNParallelPairCuts; ++jbit) {
+          if(!(pairCutMask&(ULong_t(1)<<jbit))) continue;
+          fHistos->FillHistClass(fHistClassHandles[ibit*3+jbit*3*fNParallelCuts+pairType], values);
+        }
+      }
+      else fHistos->FillHistClass(fHistClassHandles[ibit*3+pairType], values);
+    }
+  }
+}
+
+
+//_________________________________________________________________________
+void AliMixingHandler::CleanCompactPool(CompactPool& pool, ULong_t mixingMask) {
+  //
+  // Unset the mixing flags, remove the legs without enabled flags and the events without legs.
+  // The arrays are compacted in place, so their capacity is kept for the next events
+  //
+  Int_t nEvents = Int_t(pool.fBegin[0].size())-1;
+  Int_t readBegin[2] = {0, 0};
+  Int_t nLegs[2] = {0, 0};
+  Int_t nKeptEvents = 0;
+  for(Int_t iev=0; iev<nEvents; ++iev) {
+    Int_t eventBegin[2] = {nLegs[0], nLegs[1]};
+    for(Int_t i=0; i<2; ++i) {
+      Int_t readEnd = pool.fBegin[i][iev+1];
+      for(Int_t ileg=readBegin[i]; ileg<readEnd; ++ileg) {
+        CompactLeg leg = pool.fLegs[i][ileg];
+        leg.fFlags &= ~mixingMask;
+        if(leg.fFlags) pool.fLegs[i][nLegs[i]++] = leg;
+      }
+      readBegin[i] = readEnd;
+    }
+    if(nLegs[0]==eventBegin[0] && nLegs[1]==eventBegin[1]) continue;
+    
+    pool.fBegin[0][nKeptEvents] = eventBegin[0];
+    pool.fBegin[1][nKeptEvents] = eventBegin[1];
+    for(Int_t iq=0; iq<6; ++iq) pool.fQvec[6*nKeptEvents+iq] = pool.fQvec[6*iev+iq];
+    ++nKeptEvents;
+  }
+  for(Int_t i=0; i<2; ++i) {
+    pool.fBegin[i][nKeptEvents] = nLegs[i];
+    pool.fBegin[i].resize(nKeptEvents+1);
+    pool.fLegs[i].resize(nLegs[i]);
+  }
+  pool.fQvec.resize(6*nKeptEvents);
+}
+
+
+//_________________________________________________________________________
+AliReducedBaseTrack* AliMixingHandler::LoadCompactLeg(const CompactLeg& leg, const Float_t* qvec, Int_t slot) {
+  //
+  // Copy a compact leg into the scratch track of the given slot (0 or 1), to be used with FillPairInfoME()
+  // For AliReducedTrackInfo legs the Q vectors are put in the covariance matrix, as done by FillEvent() for the track pools
+  //
+  AliReducedBaseTrack* track = 0x0;
+  if(leg.fInfo&2) {
+    if(!fScratchTrackLegs[slot]) fScratchTrackLegs[slot] = new AliReducedTrackInfo();
+    AliReducedTrackInfo* trackInfo = fScratchTrackLegs[slot];
+    trackInfo->SetITSclusterMap(leg.fITSclusterMap);
+    trackInfo->SetMatchedEMCalClusterEnergy(leg.fEMCalEnergy);
+    for(Int_t i=0; i<6; ++i) trackInfo->SetCovMatrix(i, qvec[i]);
+    track = trackInfo;
+  }
+  else {
+    if(!fScratchLegs[slot]) fScratchLegs[slot] = new AliReducedBaseTrack();
+    track = fScratchLegs[slot];
+  }
+  if(leg.fInfo&1) track->PxPyPz(leg.fP[0], leg.fP[1], leg.fP[2]);
+  else            track->PtPhiEta(leg.fP[0], leg.fP[1], leg.fP[2]);
+  track->Charge(leg.fCharge);
+  track->SetFlags(leg.fFlags);
+  return track;
+}
+
+
 //_________________________________________________________________________
 ULong_t AliMixingHandler::IsPairSelected(Float_t* values, Int_t pairType) {
    //
@@ -713,11 +1032,15 @@ void AliMixingHandler::PrintMixingLists(Int_t debugLevel) {
    cout << "Track downscale :: " << fDownscaleTracks << endl;
    cout << "No. parallel cuts :: " << fNParallelCuts << endl;
    cout << "Histogram class names :: " << fHistClassNames.Data() << endl;
-  
-   if(debugLevel<1) return;
+   cout << "Compact pools :: " << fUseCompactPools << endl;
   
    Int_t nCategories = 1;
    for(Int_t iVar=0; iVar<fNMixingVariables; ++iVar) nCategories *= (fVariableLimits[iVar].GetSize() - 1);
+   Long64_t totalMemory = 0;
+   for(Int_t iCateg=0; iCateg<nCategories; ++iCateg) totalMemory += GetPoolMemory(iCateg);
+   cout << "Pool memory (bytes) :: " << totalMemory << endl;
+   
+   if(debugLevel<1) return;
 
    AliReducedBaseTrack* track = 0x0;
    for(Int_t iCateg=0; iCateg<nCategories; ++iCateg) {
@@ -734,8 +1057,31 @@ void AliMixingHandler::PrintMixingLists(Int_t debugLevel) {
       for(Int_t icut=0;icut<fNParallelCuts;++icut) 
          cout << fPoolSize[icut*nCategories+iCateg] << (icut<fNParallelCuts-1 ? " -- " : "") << flush;
       cout << endl;
+      cout << "No. events :: " << GetNPoolEvents(iCateg) << ";  memory (bytes) :: " << GetPoolMemory(iCateg) << endl;
       if(debugLevel<2) continue;
       
+      if(fUseCompactPools) {
+         const CompactPool& pool = fCompactPools[iCateg];
+         for(Int_t iev=0; iev<GetNPoolEvents(iCateg); ++iev) {
+            cout << "	Event #" << iev << ";  No. of tracks (leg1/leg2) :: " 
+            << pool.fBegin[0][iev+1]-pool.fBegin[0][iev] << " / " << pool.fBegin[1][iev+1]-pool.fBegin[1][iev] << endl;
+            if(debugLevel<3) continue;
+            
+            for(Int_t i=0; i<2; ++i) {
+               cout << "		Leg" << i+1 << " list" << endl;
+               for(Int_t ileg=pool.fBegin[i][iev]; ileg<pool.fBegin[i][iev+1]; ++ileg) {
+                  track = LoadCompactLeg(pool.fLegs[i][ileg], &pool.fQvec[6*iev], 0);
+                  cout << "		track #" << ileg-pool.fBegin[i][iev] << " (p/px/py/pz/charge/flags) :: "
+                  << track->P() << " / " << track->Px() << " / " 
+                  << track->Py() << " / " << track->Pz() << "/" << track->Charge() << " / " << flush;
+                  AliReducedVarManager::PrintBits(track->GetFlags(), fNParallelCuts);	 
+                  cout << endl;
+               }  // end loop over legs
+            }  // end loop over leg lists
+         }  // end loop over events
+         continue;
+      }
+      
       TClonesArray *leg1PoolP = static_cast<TClonesArray*>(fPoolsLeg1.At(iCateg));
       if(!leg1PoolP) continue;
       TClonesArray &leg1Pool=*leg1PoolP;
@@ -14,10 +14,15 @@
 #include <TList.h>
 #include <TString.h>
 
+#include <vector>
+
 #include "AliHistogramManager.h"
 #include "AliReducedVarManager.h"
 #include "AliReducedInfoCut.h"
 
+class AliReducedBaseTrack;
+class AliReducedTrackInfo;
+
 class AliMixingHandler : public TNamed {
    
 public:
@@ -45,6 +50,7 @@ public:
   void SetNParallelPairCuts(Int_t n) {fNParallelPairCuts = n;}
   void SetHistogramManager(AliHistogramManager* histos) {fHistos = histos;}
   void SetHistClassNames(const Char_t* names) {fHistClassNames = names;}
+  void SetUseCompactPools(Bool_t flag) {fUseCompactPools = flag;}
   void AddCrossPairsCut(AliReducedInfoCut* cut) {fCrossPairsCuts.Add(cut);}
   void AddOppositeSignPairsCut(AliReducedInfoCut* cut) {fCrossPairsCuts.Add(cut);}    // synonim function to AddCrossPairsCut() used for charged legs
   void AddLikePairsLeg1Cut(AliReducedInfoCut* cut) {fLikePairsLeg1Cuts.Add(cut);}
@@ -69,6 +75,9 @@ public:
   TString GetHistClassNames() const {return fHistClassNames;};
   Int_t GetNMixingVariables() const {return fNMixingVariables;}
   Int_t GetMixingSetup() const {return fMixingSetup;}
+  Bool_t GetUseCompactPools() const {return fUseCompactPools;}
+  Int_t GetNPoolEvents(Int_t eventCategory) const;
+  Long64_t GetPoolMemory(Int_t eventCategory) const;
   
   void Init();
   Int_t FindEventCategory(Float_t* values);
@@ -111,11 +120,41 @@ private:
   TList fLikePairsLeg1Cuts;    // cut object for LEG1 like pairs
   TList fLikePairsLeg2Cuts;    // cut object for LEG2 like pairs
   
+  Bool_t fUseCompactPools;       // keep the pools as flat arrays of compact legs instead of cloned tracks (resonance mixing only)
+  
+  // compact leg kept in the pools if fUseCompactPools is set; holds what FillPairInfoME() needs from a track
+  struct CompactLeg {
+    Float_t fP[3];               // momentum as stored in the track, (px,py,pz) or (pt,phi,eta)
+    Float_t fEMCalEnergy;        // matched EMCal cluster energy
+    ULong_t fFlags;              // track flags (one bit per parallel cut)
+    Char_t  fCharge;             // charge
+    UChar_t fITSclusterMap;      // ITS cluster map
+    UChar_t fInfo;               // BIT0: cartesian momentum, BIT1: leg is an AliReducedTrackInfo
+  };
+  // compact pool of one event category: the legs of event iev are [fBegin[i][iev],fBegin[i][iev+1]) of fLegs[i]
+  struct CompactPool {
+    std::vector<CompactLeg> fLegs[2];    // leg1 and leg2 lists of all events
+    std::vector<Int_t> fBegin[2];        // first leg of each event, one more entry than events
+    std::vector<Float_t> fQvec;          // VZERO-A, VZERO-C and TPC 2nd harmonic Q vectors, 6 per event
+  };
+  std::vector<CompactPool> fCompactPools;    //! compact pools, one per event category
+  std::vector<Int_t> fHistClassHandles;      //! histogram manager handles of the hist classes
+  std::vector<Int_t> fSelectedLegs;          //! legs selected by the pair kernel
+  AliReducedBaseTrack* fScratchLegs[2];      //! legs handed to FillPairInfoME() for compact legs of base tracks
+  AliReducedTrackInfo* fScratchTrackLegs[2]; //! legs handed to FillPairInfoME() for compact legs of AliReducedTrackInfo
+  
   void RunEventMixing(TClonesArray* leg1Pool, TClonesArray* leg2Pool, ULong_t mixingMask, Int_t type, Float_t* values);
   ULong_t IncrementPoolSizes(TList* list1, TList* list2, Int_t eventCategory);
   void ResetPoolSizes(ULong_t mixingMask, Int_t category);  
+  void InitHistClassHandles();
+  void FillCompactEvent(TList* leg1List, TList* leg2List, Int_t category, Float_t* values);
+  void RunCompactEventMixing(Int_t category, ULong_t mixingMask, Int_t type, Float_t* values);
+  void MixCompactLegs(const CompactLeg& leg1, const Float_t* qvec1, const CompactPool& pool, Int_t list2, Int_t iev2,
+                      Int_t pairType, ULong_t testFlags1, Int_t type, Float_t* values);
+  void CleanCompactPool(CompactPool& pool, ULong_t mixingMask);
+  AliReducedBaseTrack* LoadCompactLeg(const CompactLeg& leg, const Float_t* qvec, Int_t slot);
   
-  ClassDef(AliMixingHandler,4);
+  ClassDef(AliMixingHandler,5);
 };
 
 #endif
@@ -116,6 +116,7 @@ class AliReducedTrackInfo : public AliReducedBaseTrack {
   
   // setters
   void SetMatchedEMCalClusterEnergy(Float_t energy) {fMatchedEMCalClusterEnergy=energy;}
+  void SetITSclusterMap(UChar_t map) {fITSclusterMap=map;}
 
  protected:
   ULong_t fStatus;              // tracking status
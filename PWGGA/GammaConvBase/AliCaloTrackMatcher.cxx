@@ -36,6 +36,7 @@
 #include "TH1F.h"
 #include "TF1.h"
 
+#include <algorithm>
 #include <vector>
 #include <map>
 #include <utility>
@@ -44,6 +45,12 @@ class iostream;
 
 using namespace std;
 
+namespace {
+  // orders the matches by their key only, see AliCaloTrackMatcher::SortMatches
+  struct CompareMatchKey {
+    template <class T> bool operator()(const T& a, const T& b) const { return a.first < b.first; }
+  };
+}
 
 ClassImp(AliCaloTrackMatcher)
 
@@ -61,11 +68,17 @@ AliCaloTrackMatcher::AliCaloTrackMatcher(const char *name, Int_t clusterType, In
   fGeomEMCAL(NULL),
   fGeomPHOS(NULL),
   fArrClusters(NULL),
-  fMapTrackToCluster(),
-  fMapClusterToTrack(),
+  fVecTrackToCluster(),
+  fVecClusterToTrack(),
   fNEntries(1),
   fVectorDeltaEtaDeltaPhi(0),
-  fMap_TrID_ClID_ToIndex(),
+  fVec_TrID_ClID_ToIndex(),
+  fGridClusters(),
+  fGridClusterPos(),
+  fGridCellStart(),
+  fGridCellClusters(),
+  fGridCandidates(),
+  fGridCellSize(1.),
   fSecMapTrackToCluster(),
   fSecMapClusterToTrack(),
   fSecNEntries(1),
@@ -88,10 +101,10 @@ AliCaloTrackMatcher::AliCaloTrackMatcher(const char *name, Int_t clusterType, In
 //________________________________________________________________________
 AliCaloTrackMatcher::~AliCaloTrackMatcher(){
     // default deconstructor
-    fMapTrackToCluster.clear();
-    fMapClusterToTrack.clear();
+    fVecTrackToCluster.clear();
+    fVecClusterToTrack.clear();
     fVectorDeltaEtaDeltaPhi.clear();
-    fMap_TrID_ClID_ToIndex.clear();
+    fVec_TrID_ClID_ToIndex.clear();
 
     fSecMapTrackToCluster.clear();
     fSecMapClusterToTrack.clear();
@@ -110,10 +123,10 @@ AliCaloTrackMatcher::~AliCaloTrackMatcher(){
 
 //________________________________________________________________________
 void AliCaloTrackMatcher::Terminate(Option_t *){
-  fMapTrackToCluster.clear();
-  fMapClusterToTrack.clear();
+  fVecTrackToCluster.clear();
+  fVecClusterToTrack.clear();
   fVectorDeltaEtaDeltaPhi.clear();
-  fMap_TrID_ClID_ToIndex.clear();
+  fVec_TrID_ClID_ToIndex.clear();
 
   fSecMapTrackToCluster.clear();
   fSecMapClusterToTrack.clear();
@@ -181,11 +194,11 @@ void AliCaloTrackMatcher::UserCreateOutputObjects(){
 //________________________________________________________________________
 void AliCaloTrackMatcher::Initialize(Int_t runNumber){
   // Initialize function to be called once before analysis
-  fMapTrackToCluster.clear();
-  fMapClusterToTrack.clear();
+  fVecTrackToCluster.clear();
+  fVecClusterToTrack.clear();
   fNEntries = 1;
   fVectorDeltaEtaDeltaPhi.clear();
-  fMap_TrID_ClID_ToIndex.clear();
+  fVec_TrID_ClID_ToIndex.clear();
 
   fSecMapTrackToCluster.clear();
   fSecMapClusterToTrack.clear();
@@ -301,6 +314,8 @@ void AliCaloTrackMatcher::ProcessEvent(AliVEvent *event){
     }
   }
 
+  FillClusterGrid(event,nClus);
+
   for (Int_t itr=0;itr<event->GetNumberOfTracks();itr++){
     AliExternalTrackParam *trackParam = 0;
     AliVTrack *inTrack = 0x0;
@@ -454,51 +469,28 @@ void AliCaloTrackMatcher::ProcessEvent(AliVEvent *event){
     // cout << "eta/phi: " << eta << ", " << phi << endl;
     // cout << "nClus: " << nClus << endl;
     Int_t nClusterMatchesToTrack = 0;
-    for(Int_t iclus=0;iclus < nClus;iclus++){
-      AliVCluster* cluster = NULL;
-      if(fArrClusters){
-        if(esdev){
-          if(fArrClusters)
-            cluster = new AliESDCaloCluster(*(AliESDCaloCluster*)fArrClusters->At(iclus));
-        } else if(aodev){
-          if(fArrClusters)
-            cluster = new AliAODCaloCluster(*(AliAODCaloCluster*)fArrClusters->At(iclus));
-        }
-      }
-      else
-        cluster = event->GetCaloCluster(iclus);
-      if (!cluster){
-        if(fArrClusters) delete cluster;
-        continue;
-      }
+    // only the clusters of the cells around the track can be within the matching window
+    GetClusterCandidates(exPos);
+    for(UInt_t icand=0;icand < fGridCandidates.size();icand++){
+      Int_t iclus = fGridCandidates[icand];
+      AliVCluster* cluster = fGridClusters[iclus];
       // cout << "-------------------------LOOPING: " << iclus << ", " << cluster->GetID() << endl;
-      cluster->GetPosition(clsPos);
+      clsPos[0] = fGridClusterPos[3*iclus];
+      clsPos[1] = fGridClusterPos[3*iclus+1];
+      clsPos[2] = fGridClusterPos[3*iclus+2];
       Double_t dR = TMath::Sqrt(TMath::Power(exPos[0]-clsPos[0],2)+TMath::Power(exPos[1]-clsPos[1],2)+TMath::Power(exPos[2]-clsPos[2],2));
       //cout << "dR: " << dR << endl;
-      if (dR > fMatchingWindow){
-        if(fArrClusters) delete cluster;
-        continue;
-      }
+      if (dR > fMatchingWindow) continue;
       Double_t clusterR = TMath::Sqrt( clsPos[0]*clsPos[0] + clsPos[1]*clsPos[1] );
       AliExternalTrackParam trackParamTmp(emcParam);//Retrieve the starting point every time before the extrapolation
       if(fClusterType == 1 || fClusterType == 3 || fClusterType == 4){
-        if (!cluster->IsEMCAL()){
-          if(fArrClusters) delete cluster;
-          continue;
-        }
         if(!AliEMCALRecoUtils::ExtrapolateTrackToCluster(&trackParamTmp, cluster, fMassHypothesis, 5., dEta, dPhi)){
           FillfHistControlMatches(4.,inTrack->Pt());
-          if(fArrClusters) delete cluster;
           continue;
         }
       }else if(fClusterType == 2){
-        if (!cluster->IsPHOS()){
-          if(fArrClusters) delete cluster;
-          continue;
-        }
         if(!AliTrackerBase::PropagateTrackToBxByBz(&trackParamTmp, clusterR, fMassHypothesis, 5., kTRUE, 0.8, -1)){
           FillfHistControlMatches(4.,inTrack->Pt());
-          if(fArrClusters) delete cluster;
           continue;
         }
         Double_t trkPos[3] = {0,0,0};
@@ -512,31 +504,138 @@ void AliCaloTrackMatcher::ProcessEvent(AliVEvent *event){
       Float_t dR2 = dPhi*dPhi + dEta*dEta;
 
       //cout << dEta << " - " << dPhi << " - " << dR2 << endl;
-      if(dR2 > fMatchingResidual){
-        if(fArrClusters) delete cluster;
-        continue;
-      }
+      if(dR2 > fMatchingResidual) continue;
       nClusterMatchesToTrack++;
       if(aodev){
-        fMapTrackToCluster.insert(make_pair(itr,cluster->GetID()));
-        fMapClusterToTrack.insert(make_pair(cluster->GetID(),itr));
+        fVecTrackToCluster.push_back(make_pair(itr,cluster->GetID()));
+        fVecClusterToTrack.push_back(make_pair(cluster->GetID(),itr));
       }else{
-        fMapTrackToCluster.insert(make_pair(inTrack->GetID(),cluster->GetID()));
-        fMapClusterToTrack.insert(make_pair(cluster->GetID(),inTrack->GetID()));
+        fVecTrackToCluster.push_back(make_pair(inTrack->GetID(),cluster->GetID()));
+        fVecClusterToTrack.push_back(make_pair(cluster->GetID(),inTrack->GetID()));
       }
       fVectorDeltaEtaDeltaPhi.push_back(make_pair(dEta,dPhi));
-      fMap_TrID_ClID_ToIndex[make_pair(inTrack->GetID(),cluster->GetID())] = fNEntries++;
+      fVec_TrID_ClID_ToIndex.push_back(make_pair(make_pair(inTrack->GetID(),cluster->GetID()),fNEntries++));
       if( (Int_t)fVectorDeltaEtaDeltaPhi.size() != (fNEntries-1)) AliFatal("Fatal error in AliCaloTrackMatcher, vector and map are not in sync!");
-      if(fArrClusters) delete cluster;
     }
     if(nClusterMatchesToTrack == 0) FillfHistControlMatches(5.,inTrack->Pt());
     else FillfHistControlMatches(6.,inTrack->Pt());
     delete trackParam;
   }
+  SortMatches();
 
   return;
 }
 
+//________________________________________________________________________
+void AliCaloTrackMatcher::FillClusterGrid(AliVEvent *event, Int_t nClus){
+  // sort the clusters of the calorimeter into cells in x, y, z of at least fMatchingWindow,
+  // all clusters within fMatchingWindow of a point are then in the 3x3x3 cells around it.
+  // The clusters are referenced, not copied, also if they come from the correction framework.
+  fGridClusters.assign(nClus,(AliVCluster*)NULL);
+  fGridClusterPos.assign(3*nClus,0.);
+  fGridCellClusters.clear();
+  fGridCandidates.clear();
+
+  Float_t posMin[3] = {0.,0.,0.};
+  Float_t posMax[3] = {0.,0.,0.};
+  Int_t nUsed = 0;
+  for(Int_t iclus=0;iclus < nClus;iclus++){
+    AliVCluster* cluster = NULL;
+    if(fArrClusters) cluster = (AliVCluster*)fArrClusters->At(iclus);
+    else cluster = event->GetCaloCluster(iclus);
+    if(!cluster) continue;
+    if((fClusterType == 1 || fClusterType == 3 || fClusterType == 4) && !cluster->IsEMCAL()) continue;
+    if(fClusterType == 2 && !cluster->IsPHOS()) continue;
+    fGridClusters[iclus] = cluster;
+    cluster->GetPosition(&fGridClusterPos[3*iclus]);
+    for(Int_t i=0;i<3;i++){
+      Float_t x = fGridClusterPos[3*iclus+i];
+      if(nUsed == 0 || x < posMin[i]) posMin[i] = x;
+      if(nUsed == 0 || x > posMax[i]) posMax[i] = x;
+    }
+    nUsed++;
+  }
+
+  // at most kMaxCells cells per axis
+  const Int_t kMaxCells = 32;
+  fGridCellSize = 1.01*fMatchingWindow; // margin for the rounding of the positions
+  for(Int_t i=0;i<3;i++){
+    if((posMax[i]-posMin[i])/kMaxCells > fGridCellSize) fGridCellSize = (posMax[i]-posMin[i])/kMaxCells;
+  }
+  if(!(fGridCellSize > 0.)) fGridCellSize = 1.;
+  for(Int_t i=0;i<3;i++){
+    fGridMin[i] = posMin[i];
+    fGridNCells[i] = TMath::Min((Int_t)((posMax[i]-posMin[i])/fGridCellSize)+1,kMaxCells);
+  }
+
+  // counting sort of the clusters by cell, keeping the index order within a cell
+  Int_t nCells = fGridNCells[0]*fGridNCells[1]*fGridNCells[2];
+  vector<Int_t> cellOfCluster(nClus,-1);
+  fGridCellStart.assign(nCells+1,0);
+  for(Int_t iclus=0;iclus < nClus;iclus++){
+    if(!fGridClusters[iclus]) continue;
+    Int_t cell[3];
+    for(Int_t i=0;i<3;i++) cell[i] = TMath::Min((Int_t)((fGridClusterPos[3*iclus+i]-fGridMin[i])/fGridCellSize),fGridNCells[i]-1);
+    cellOfCluster[iclus] = (cell[0]*fGridNCells[1]+cell[1])*fGridNCells[2]+cell[2];
+    fGridCellStart[cellOfCluster[iclus]+1]++;
+  }
+  for(Int_t icell=0;icell < nCells;icell++) fGridCellStart[icell+1] += fGridCellStart[icell];
+  fGridCellClusters.resize(nUsed);
+  vector<Int_t> fill(fGridCellStart.begin(),fGridCellStart.end()-1);
+  for(Int_t iclus=0;iclus < nClus;iclus++){
+    if(cellOfCluster[iclus] < 0) continue;
+    fGridCellClusters[fill[cellOfCluster[iclus]]++] = iclus;
+  }
+  return;
+}
+
+//________________________________________________________________________
+void AliCaloTrackMatcher::GetClusterCandidates(const Double_t* pos){
+  // clusters of the 3x3x3 cells around pos, in ascending index order as in a loop over all clusters
+  fGridCandidates.clear();
+  if(fGridCellClusters.empty()) return;
+  Int_t cellMin[3], cellMax[3];
+  for(Int_t i=0;i<3;i++){
+    Double_t x = (pos[i]-fGridMin[i])/fGridCellSize;
+    if(x < -1. || x >= fGridNCells[i]+1.) return; // no cluster within fMatchingWindow
+    Int_t cell = (Int_t)TMath::Floor(x);
+    cellMin[i] = TMath::Max(cell-1,0);
+    cellMax[i] = TMath::Min(cell+1,fGridNCells[i]-1);
+  }
+  for(Int_t ix=cellMin[0];ix<=cellMax[0];ix++){
+    for(Int_t iy=cellMin[1];iy<=cellMax[1];iy++){
+      Int_t cell = (ix*fGridNCells[1]+iy)*fGridNCells[2];
+      fGridCandidates.insert(fGridCandidates.end(),fGridCellClusters.begin()+fGridCellStart[cell+cellMin[2]],fGridCellClusters.begin()+fGridCellStart[cell+cellMax[2]+1]);
+    }
+  }
+  sort(fGridCandidates.begin(),fGridCandidates.end());
+  return;
+}
+
+//________________________________________________________________________
+void AliCaloTrackMatcher::SortMatches(){
+  // sort the matches of the event for the look-up in the getters: by track (cluster) ID, keeping
+  // the order of the matching for equal IDs. For a (trackID,clusterID) matched more than once,
+  // only the last residual is kept, as for the assignment to a map.
+  stable_sort(fVecTrackToCluster.begin(),fVecTrackToCluster.end(),CompareMatchKey());
+  stable_sort(fVecClusterToTrack.begin(),fVecClusterToTrack.end(),CompareMatchKey());
+
+  stable_sort(fVec_TrID_ClID_ToIndex.begin(),fVec_TrID_ClID_ToIndex.end(),CompareMatchKey());
+  vector<pair<pairInt,Int_t> >::iterator out = fVec_TrID_ClID_ToIndex.begin();
+  for(vector<pair<pairInt,Int_t> >::iterator it = fVec_TrID_ClID_ToIndex.begin(); it != fVec_TrID_ClID_ToIndex.end(); ++it){
+    if(out != fVec_TrID_ClID_ToIndex.begin() && (out-1)->first == it->first) *(out-1) = *it;
+    else *(out++) = *it;
+  }
+  fVec_TrID_ClID_ToIndex.erase(out,fVec_TrID_ClID_ToIndex.end());
+  return;
+}
+
+//________________________________________________________________________
+AliCaloTrackMatcher::matchRange AliCaloTrackMatcher::GetMatchRange(const vector<pairInt>& matches, Int_t key){
+  // entries of the sorted fVecTrackToCluster or fVecClusterToTrack with the given track or cluster ID
+  return equal_range(matches.begin(),matches.end(),make_pair(key,0),CompareMatchKey());
+}
+
 //________________________________________________________________________
 Bool_t AliCaloTrackMatcher::PropagateV0TrackToClusterAndGetMatchingResidual(AliVTrack* inSecTrack, AliVCluster* cluster, AliVEvent* event, Float_t &dEta, Float_t &dPhi){
 
@@ -766,8 +865,9 @@ Bool_t AliCaloTrackMatcher::PropagateV0TrackToClusterAndGetMatchingResidual(AliV
 //________________________________________________________________________
 //________________________________________________________________________
 Bool_t AliCaloTrackMatcher::GetTrackClusterMatchingResidual(Int_t trackID, Int_t clusterID, Float_t &dEta, Float_t &dPhi){
-  Int_t position = fMap_TrID_ClID_ToIndex[make_pair(trackID,clusterID)];
-  if(position == 0) return kFALSE;
+  vector<pair<pairInt,Int_t> >::const_iterator it = lower_bound(fVec_TrID_ClID_ToIndex.begin(),fVec_TrID_ClID_ToIndex.end(),make_pair(make_pair(trackID,clusterID),0),CompareMatchKey());
+  if(it == fVec_TrID_ClID_ToIndex.end() || it->first != make_pair(trackID,clusterID)) return kFALSE;
+  Int_t position = it->second;
 
   pairFloat tempEtaPhi = fVectorDeltaEtaDeltaPhi.at(position-1);
   dEta = tempEtaPhi.first;
@@ -777,18 +877,17 @@ Bool_t AliCaloTrackMatcher::GetTrackClusterMatchingResidual(Int_t trackID, Int_t
 //________________________________________________________________________
 Int_t AliCaloTrackMatcher::GetNMatchedTrackIDsForCluster(AliVEvent *event, Int_t clusterID, Float_t dEtaMax, Float_t dEtaMin, Float_t dPhiMax, Float_t dPhiMin){
   Int_t matched = 0;
-  multimap<Int_t,Int_t>::iterator it;
-  for (it=fMapClusterToTrack.begin(); it!=fMapClusterToTrack.end(); ++it){
-    if(it->first == clusterID){
-      Float_t tempDEta, tempDPhi;
-      AliVTrack* tempTrack  = dynamic_cast<AliVTrack*>(event->GetTrack(it->second));
-      if(!tempTrack) continue;
-      if(GetTrackClusterMatchingResidual(tempTrack->GetID(),it->first,tempDEta,tempDPhi)){
-        if(tempTrack->Charge()>0){
-          if( (dEtaMin < tempDEta) && (tempDEta < dEtaMax) && (dPhiMin < tempDPhi) && (tempDPhi < dPhiMax) ) matched++;
-        }else if(tempTrack->Charge()<0){
-          if( (dEtaMin < tempDEta) && (tempDEta < dEtaMax) && (-dPhiMin > tempDPhi) && (tempDPhi > -dPhiMax) ) matched++;
-        }
+  matchIter it;
+  matchRange range = GetMatchRange(fVecClusterToTrack,clusterID);
+  for (it=range.first; it!=range.second; ++it){
+    Float_t tempDEta, tempDPhi;
+    AliVTrack* tempTrack  = dynamic_cast<AliVTrack*>(event->GetTrack(it->second));
+    if(!tempTrack) continue;
+    if(GetTrackClusterMatchingResidual(tempTrack->GetID(),it->first,tempDEta,tempDPhi)){
+      if(tempTrack->Charge()>0){
+        if( (dEtaMin < tempDEta) && (tempDEta < dEtaMax) && (dPhiMin < tempDPhi) && (tempDPhi < dPhiMax) ) matched++;
+      }else if(tempTrack->Charge()<0){
+        if( (dEtaMin < tempDEta) && (tempDEta < dEtaMax) && (-dPhiMin > tempDPhi) && (tempDPhi > -dPhiMax) ) matched++;
       }
     }
   }
@@ -799,23 +898,22 @@ Int_t AliCaloTrackMatcher::GetNMatchedTrackIDsForCluster(AliVEvent *event, Int_t
 //________________________________________________________________________
 Int_t AliCaloTrackMatcher::GetNMatchedTrackIDsForCluster(AliVEvent *event, Int_t clusterID, TF1* fFuncPtDepEta, TF1* fFuncPtDepPhi){
   Int_t matched = 0;
-  multimap<Int_t,Int_t>::iterator it;
-  for (it=fMapClusterToTrack.begin(); it!=fMapClusterToTrack.end(); ++it){
-    if(it->first == clusterID){
-      Float_t tempDEta, tempDPhi;
-      AliVTrack* tempTrack  = dynamic_cast<AliVTrack*>(event->GetTrack(it->second));
-      if(!tempTrack) continue;
-      if(GetTrackClusterMatchingResidual(tempTrack->GetID(),it->first,tempDEta,tempDPhi)){
-        Bool_t match_dEta = kFALSE;
-        Bool_t match_dPhi = kFALSE;
-        if( TMath::Abs(tempDEta) < fFuncPtDepEta->Eval(tempTrack->Pt())) match_dEta = kTRUE;
-        else match_dEta = kFALSE;
-
-        if( TMath::Abs(tempDPhi) < fFuncPtDepPhi->Eval(tempTrack->Pt())) match_dPhi = kTRUE;
-        else match_dPhi = kFALSE;
-
-        if (match_dPhi && match_dEta )matched++;
-      }
+  matchIter it;
+  matchRange range = GetMatchRange(fVecClusterToTrack,clusterID);
+  for (it=range.first; it!=range.second; ++it){
+    Float_t tempDEta, tempDPhi;
+    AliVTrack* tempTrack  = dynamic_cast<AliVTrack*>(event->GetTrack(it->second));
+    if(!tempTrack) continue;
+    if(GetTrackClusterMatchingResidual(tempTrack->GetID(),it->first,tempDEta,tempDPhi)){
+      Bool_t match_dEta = kFALSE;
+      Bool_t match_dPhi = kFALSE;
+      if( TMath::Abs(tempDEta) < fFuncPtDepEta->Eval(tempTrack->Pt())) match_dEta = kTRUE;
+      else match_dEta = kFALSE;
+
+      if( TMath::Abs(tempDPhi) < fFuncPtDepPhi->Eval(tempTrack->Pt())) match_dPhi = kTRUE;
+      else match_dPhi = kFALSE;
+
+      if (match_dPhi && match_dEta )matched++;
     }
   }
   return matched;
@@ -824,15 +922,14 @@ Int_t AliCaloTrackMatcher::GetNMatchedTrackIDsForCluster(AliVEvent *event, Int_t
 //________________________________________________________________________
 Int_t AliCaloTrackMatcher::GetNMatchedTrackIDsForCluster(AliVEvent *event, Int_t clusterID, Float_t dR){
   Int_t matched = 0;
-  multimap<Int_t,Int_t>::iterator it;
-  for (it=fMapClusterToTrack.begin(); it!=fMapClusterToTrack.end(); ++it){
-    if(it->first == clusterID){
-      Float_t tempDEta, tempDPhi;
-      AliVTrack* tempTrack  = dynamic_cast<AliVTrack*>(event->GetTrack(it->second));
-      if(!tempTrack) continue;
-      if(GetTrackClusterMatchingResidual(tempTrack->GetID(),it->first,tempDEta,tempDPhi)){
-        if (TMath::Sqrt(tempDEta*tempDEta + tempDPhi*tempDPhi) < dR ) matched++;
-      }
+  matchIter it;
+  matchRange range = GetMatchRange(fVecClusterToTrack,clusterID);
+  for (it=range.first; it!=range.second; ++it){
+    Float_t tempDEta, tempDPhi;
+    AliVTrack* tempTrack  = dynamic_cast<AliVTrack*>(event->GetTrack(it->second));
+    if(!tempTrack) continue;
+    if(GetTrackClusterMatchingResidual(tempTrack->GetID(),it->first,tempDEta,tempDPhi)){
+      if (TMath::Sqrt(tempDEta*tempDEta + tempDPhi*tempDPhi) < dR ) matched++;
     }
   }
   return matched;
@@ -857,18 +954,17 @@ Int_t AliCaloTrackMatcher::GetNMatchedClusterIDsForTrack(AliVEvent *event, Int_t
   }else TrackPos = trackID; // for ESD just take trackID
 
   Int_t matched = 0;
-  multimap<Int_t,Int_t>::iterator it;
+  matchIter it;
   AliVTrack* tempTrack  = dynamic_cast<AliVTrack*>(event->GetTrack(TrackPos));
   if(!tempTrack) return matched;
-  for (it=fMapTrackToCluster.begin(); it!=fMapTrackToCluster.end(); ++it){
-    if(it->first == TrackPos){
-      Float_t tempDEta, tempDPhi;
-      if(GetTrackClusterMatchingResidual(tempTrack->GetID(),it->second,tempDEta,tempDPhi)){
-        if(tempTrack->Charge()>0){
-          if( (dEtaMin < tempDEta) && (tempDEta < dEtaMax) && (dPhiMin < tempDPhi) && (tempDPhi < dPhiMax) ) matched++;
-        }else if(tempTrack->Charge()<0){
-          if( (dEtaMin < tempDEta) && (tempDEta < dEtaMax) && (-dPhiMin > tempDPhi) && (tempDPhi > -dPhiMax) ) matched++;
-        }
+  matchRange range = GetMatchRange(fVecTrackToCluster,TrackPos);
+  for (it=range.first; it!=range.second; ++it){
+    Float_t tempDEta, tempDPhi;
+    if(GetTrackClusterMatchingResidual(tempTrack->GetID(),it->second,tempDEta,tempDPhi)){
+      if(tempTrack->Charge()>0){
+        if( (dEtaMin < tempDEta) && (tempDEta < dEtaMax) && (dPhiMin < tempDPhi) && (tempDPhi < dPhiMax) ) matched++;
+      }else if(tempTrack->Charge()<0){
+        if( (dEtaMin < tempDEta) && (tempDEta < dEtaMax) && (-dPhiMin > tempDPhi) && (tempDPhi > -dPhiMax) ) matched++;
       }
     }
   }
@@ -893,24 +989,23 @@ Int_t AliCaloTrackMatcher::GetNMatchedClusterIDsForTrack(AliVEvent *event, Int_t
   }else TrackPos = trackID; // for ESD just take trackID
 
   Int_t matched = 0;
-  multimap<Int_t,Int_t>::iterator it;
+  matchIter it;
   AliVTrack* tempTrack  = dynamic_cast<AliVTrack*>(event->GetTrack(TrackPos));
   if(!tempTrack) return matched;
-  for (it=fMapTrackToCluster.begin(); it!=fMapTrackToCluster.end(); ++it){
-    if(it->first == TrackPos){
-      Float_t tempDEta, tempDPhi;
-      if(GetTrackClusterMatchingResidual(tempTrack->GetID(),it->second,tempDEta,tempDPhi)){
-        Bool_t match_dEta = kFALSE;
-        Bool_t match_dPhi = kFALSE;
-        if( TMath::Abs(tempDEta) < fFuncPtDepEta->Eval(tempTrack->Pt())) match_dEta = kTRUE;
-        else match_dEta = kFALSE;
+  matchRange range = GetMatchRange(fVecTrackToCluster,TrackPos);
+  for (it=range.first; it!=range.second; ++it){
+    Float_t tempDEta, tempDPhi;
+    if(GetTrackClusterMatchingResidual(tempTrack->GetID(),it->second,tempDEta,tempDPhi)){
+      Bool_t match_dEta = kFALSE;
+      Bool_t match_dPhi = kFALSE;
+      if( TMath::Abs(tempDEta) < fFuncPtDepEta->Eval(tempTrack->Pt())) match_dEta = kTRUE;
+      else match_dEta = kFALSE;
 
-        if( TMath::Abs(tempDPhi) < fFuncPtDepPhi->Eval(tempTrack->Pt())) match_dPhi = kTRUE;
-        else match_dPhi = kFALSE;
+      if( TMath::Abs(tempDPhi) < fFuncPtDepPhi->Eval(tempTrack->Pt())) match_dPhi = kTRUE;
+      else match_dPhi = kFALSE;
 
-        if (match_dPhi && match_dEta )matched++;
+      if (match_dPhi && match_dEta )matched++;
 
-      }
     }
   }
   return matched;
@@ -934,15 +1029,14 @@ Int_t AliCaloTrackMatcher::GetNMatchedClusterIDsForTrack(AliVEvent *event, Int_t
   }else TrackPos = trackID; // for ESD just take trackID
 
   Int_t matched = 0;
-  multimap<Int_t,Int_t>::iterator it;
+  matchIter it;
   AliVTrack* tempTrack  = dynamic_cast<AliVTrack*>(event->GetTrack(TrackPos));
   if(!tempTrack) return matched;
-  for (it=fMapTrackToCluster.begin(); it!=fMapTrackToCluster.end(); ++it){
-    if(it->first == TrackPos){
-      Float_t tempDEta, tempDPhi;
-      if(GetTrackClusterMatchingResidual(tempTrack->GetID(),it->second,tempDEta,tempDPhi)){
-        if (TMath::Sqrt(tempDEta*tempDEta + tempDPhi*tempDPhi) < dR ) matched++;
-      }
+  matchRange range = GetMatchRange(fVecTrackToCluster,TrackPos);
+  for (it=range.first; it!=range.second; ++it){
+    Float_t tempDEta, tempDPhi;
+    if(GetTrackClusterMatchingResidual(tempTrack->GetID(),it->second,tempDEta,tempDPhi)){
+      if (TMath::Sqrt(tempDEta*tempDEta + tempDPhi*tempDPhi) < dR ) matched++;
     }
   }
   return matched;
@@ -951,18 +1045,17 @@ Int_t AliCaloTrackMatcher::GetNMatchedClusterIDsForTrack(AliVEvent *event, Int_t
 //________________________________________________________________________
 vector<Int_t> AliCaloTrackMatcher::GetMatchedTrackIDsForCluster(AliVEvent *event, Int_t clusterID, Float_t dEtaMax, Float_t dEtaMin, Float_t dPhiMax, Float_t dPhiMin){
   vector<Int_t> tempMatchedTracks;
-  multimap<Int_t,Int_t>::iterator it;
-  for (it=fMapClusterToTrack.begin(); it!=fMapClusterToTrack.end(); ++it){
-    if(it->first == clusterID){
-      Float_t tempDEta, tempDPhi;
-      AliVTrack* tempTrack  = dynamic_cast<AliVTrack*>(event->GetTrack(it->second));
-      if(!tempTrack) continue;
-      if(GetTrackClusterMatchingResidual(tempTrack->GetID(),it->first,tempDEta,tempDPhi)){ 
-        if(tempTrack->Charge()>0){
-          if( (dEtaMin < tempDEta) && (tempDEta < dEtaMax) && (dPhiMin < tempDPhi) && (tempDPhi < dPhiMax) ) tempMatchedTracks.push_back(it->second);
-        }else if(tempTrack->Charge()<0){
-          if( (dEtaMin < tempDEta) && (tempDEta < dEtaMax) && (-dPhiMin > tempDPhi) && (tempDPhi > -dPhiMax) ) tempMatchedTracks.push_back(it->second);
-        }
+  matchIter it;
+  matchRange range = GetMatchRange(fVecClusterToTrack,clusterID);
+  for (it=range.first; it!=range.second; ++it){
+    Float_t tempDEta, tempDPhi;
+    AliVTrack* tempTrack  = dynamic_cast<AliVTrack*>(event->GetTrack(it->second));
+    if(!tempTrack) continue;
+    if(GetTrackClusterMatchingResidual(tempTrack->GetID(),it->first,tempDEta,tempDPhi)){ 
+      if(tempTrack->Charge()>0){
+        if( (dEtaMin < tempDEta) && (tempDEta < dEtaMax) && (dPhiMin < tempDPhi) && (tempDPhi < dPhiMax) ) tempMatchedTracks.push_back(it->second);
+      }else if(tempTrack->Charge()<0){
+        if( (dEtaMin < tempDEta) && (tempDEta < dEtaMax) && (-dPhiMin > tempDPhi) && (tempDPhi > -dPhiMax) ) tempMatchedTracks.push_back(it->second);
       }
     }
   }
@@ -972,24 +1065,23 @@ vector<Int_t> AliCaloTrackMatcher::GetMatchedTrackIDsForCluster(AliVEvent *event
 //________________________________________________________________________
 vector<Int_t> AliCaloTrackMatcher::GetMatchedTrackIDsForCluster(AliVEvent *event, Int_t clusterID,  TF1* fFuncPtDepEta, TF1* fFuncPtDepPhi){
   vector<Int_t> tempMatchedTracks;
-  multimap<Int_t,Int_t>::iterator it;
-  for (it=fMapClusterToTrack.begin(); it!=fMapClusterToTrack.end(); ++it){
-    if(it->first == clusterID){
-      Float_t tempDEta, tempDPhi;
-      AliVTrack* tempTrack  = dynamic_cast<AliVTrack*>(event->GetTrack(it->second));
-      if(!tempTrack) continue;
-      if(GetTrackClusterMatchingResidual(tempTrack->GetID(),it->first,tempDEta,tempDPhi)){
-        Bool_t match_dEta = kFALSE;
-        Bool_t match_dPhi = kFALSE;
-        if( TMath::Abs(tempDEta) < fFuncPtDepEta->Eval(tempTrack->Pt())) match_dEta = kTRUE;
-        else match_dEta = kFALSE;
-
-        if( TMath::Abs(tempDPhi) < fFuncPtDepPhi->Eval(tempTrack->Pt())) match_dPhi = kTRUE;
-        else match_dPhi = kFALSE;
+  matchIter it;
+  matchRange range = GetMatchRange(fVecClusterToTrack,clusterID);
+  for (it=range.first; it!=range.second; ++it){
+    Float_t tempDEta, tempDPhi;
+    AliVTrack* tempTrack  = dynamic_cast<AliVTrack*>(event->GetTrack(it->second));
+    if(!tempTrack) continue;
+    if(GetTrackClusterMatchingResidual(tempTrack->GetID(),it->first,tempDEta,tempDPhi)){
+      Bool_t match_dEta = kFALSE;
+      Bool_t match_dPhi = kFALSE;
+      if( TMath::Abs(tempDEta) < fFuncPtDepEta->Eval(tempTrack->Pt())) match_dEta = kTRUE;
+      else match_dEta = kFALSE;
+
+      if( TMath::Abs(tempDPhi) < fFuncPtDepPhi->Eval(tempTrack->Pt())) match_dPhi = kTRUE;
+      else match_dPhi = kFALSE;
+
+      if (match_dPhi && match_dEta )tempMatchedTracks.push_back(it->second);
 
-        if (match_dPhi && match_dEta )tempMatchedTracks.push_back(it->second);
-
-      }
     }
   }
   return tempMatchedTracks;
@@ -998,15 +1090,14 @@ vector<Int_t> AliCaloTrackMatcher::GetMatchedTrackIDsForCluster(AliVEvent *event
 //________________________________________________________________________
 vector<Int_t> AliCaloTrackMatcher::GetMatchedTrackIDsForCluster(AliVEvent *event, Int_t clusterID,  Float_t dR){
   vector<Int_t> tempMatchedTracks;
-  multimap<Int_t,Int_t>::iterator it;
-  for (it=fMapClusterToTrack.begin(); it!=fMapClusterToTrack.end(); ++it){
-    if(it->first == clusterID){
-      Float_t tempDEta, tempDPhi;
-      AliVTrack* tempTrack  = dynamic_cast<AliVTrack*>(event->GetTrack(it->second));
-      if(!tempTrack) continue;
-      if(GetTrackClusterMatchingResidual(tempTrack->GetID(),it->first,tempDEta,tempDPhi)){
-        if (TMath::Sqrt(tempDEta*tempDEta + tempDPhi*tempDPhi) < dR ) tempMatchedTracks.push_back(it->second);
-      }
+  matchIter it;
+  matchRange range = GetMatchRange(fVecClusterToTrack,clusterID);
+  for (it=range.first; it!=range.second; ++it){
+    Float_t tempDEta, tempDPhi;
+    AliVTrack* tempTrack  = dynamic_cast<AliVTrack*>(event->GetTrack(it->second));
+    if(!tempTrack) continue;
+    if(GetTrackClusterMatchingResidual(tempTrack->GetID(),it->first,tempDEta,tempDPhi)){
+      if (TMath::Sqrt(tempDEta*tempDEta + tempDPhi*tempDPhi) < dR ) tempMatchedTracks.push_back(it->second);
     }
   }
   return tempMatchedTracks;
@@ -1030,18 +1121,17 @@ vector<Int_t> AliCaloTrackMatcher::GetMatchedClusterIDsForTrack(AliVEvent *event
   }else TrackPos = trackID; // for ESD just take trackID
 
   vector<Int_t> tempMatchedClusters;
-  multimap<Int_t,Int_t>::iterator it;
+  matchIter it;
   AliVTrack* tempTrack  = dynamic_cast<AliVTrack*>(event->GetTrack(TrackPos));
   if(!tempTrack) return tempMatchedClusters;
-  for (it=fMapTrackToCluster.begin(); it!=fMapTrackToCluster.end(); ++it){
-    if(it->first == TrackPos){
-      Float_t tempDEta, tempDPhi;
-      if(GetTrackClusterMatchingResidual(tempTrack->GetID(),it->second,tempDEta,tempDPhi)){
-        if(tempTrack->Charge()>0){
-          if( (dEtaMin < tempDEta) && (tempDEta < dEtaMax) && (dPhiMin < tempDPhi) && (tempDPhi < dPhiMax) ) tempMatchedClusters.push_back(it->second);
-        }else if(tempTrack->Charge()<0){
-          if( (dEtaMin < tempDEta) && (tempDEta < dEtaMax) && (-dPhiMin > tempDPhi) && (tempDPhi > -dPhiMax) ) tempMatchedClusters.push_back(it->second);
-        }
+  matchRange range = GetMatchRange(fVecTrackToCluster,TrackPos);
+  for (it=range.first; it!=range.second; ++it){
+    Float_t tempDEta, tempDPhi;
+    if(GetTrackClusterMatchingResidual(tempTrack->GetID(),it->second,tempDEta,tempDPhi)){
+      if(tempTrack->Charge()>0){
+        if( (dEtaMin < tempDEta) && (tempDEta < dEtaMax) && (dPhiMin < tempDPhi) && (tempDPhi < dPhiMax) ) tempMatchedClusters.push_back(it->second);
+      }else if(tempTrack->Charge()<0){
+        if( (dEtaMin < tempDEta) && (tempDEta < dEtaMax) && (-dPhiMin > tempDPhi) && (tempDPhi > -dPhiMax) ) tempMatchedClusters.push_back(it->second);
       }
     }
   }
@@ -1067,23 +1157,22 @@ vector<Int_t> AliCaloTrackMatcher::GetMatchedClusterIDsForTrack(AliVEvent *event
   }else TrackPos = trackID; // for ESD just take trackID
 
   vector<Int_t> tempMatchedClusters;
-  multimap<Int_t,Int_t>::iterator it;
+  matchIter it;
   AliVTrack* tempTrack  = dynamic_cast<AliVTrack*>(event->GetTrack(TrackPos));
   if(!tempTrack) return tempMatchedClusters;
-  for (it=fMapTrackToCluster.begin(); it!=fMapTrackToCluster.end(); ++it){
-    if(it->first == TrackPos){
-      Float_t tempDEta, tempDPhi;
-      if(GetTrackClusterMatchingResidual(tempTrack->GetID(),it->second,tempDEta,tempDPhi)){
-        Bool_t match_dEta = kFALSE;
-        Bool_t match_dPhi = kFALSE;
-        if( TMath::Abs(tempDEta) < fFuncPtDepEta->Eval(tempTrack->Pt())) match_dEta = kTRUE;
-        else match_dEta = kFALSE;
-
-        if( TMath::Abs(tempDPhi) < fFuncPtDepPhi->Eval(tempTrack->Pt())) match_dPhi = kTRUE;
-        else match_dPhi = kFALSE;
-
-        if (match_dPhi && match_dEta )tempMatchedClusters.push_back(it->second);
-      }
+  matchRange range = GetMatchRange(fVecTrackToCluster,TrackPos);
+  for (it=range.first; it!=range.second; ++it){
+    Float_t tempDEta, tempDPhi;
+    if(GetTrackClusterMatchingResidual(tempTrack->GetID(),it->second,tempDEta,tempDPhi)){
+      Bool_t match_dEta = kFALSE;
+      Bool_t match_dPhi = kFALSE;
+      if( TMath::Abs(tempDEta) < fFuncPtDepEta->Eval(tempTrack->Pt())) match_dEta = kTRUE;
+      else match_dEta = kFALSE;
+
+      if( TMath::Abs(tempDPhi) < fFuncPtDepPhi->Eval(tempTrack->Pt())) match_dPhi = kTRUE;
+      else match_dPhi = kFALSE;
+
+      if (match_dPhi && match_dEta )tempMatchedClusters.push_back(it->second);
     }
   }
   return tempMatchedClusters;
@@ -1106,15 +1195,14 @@ vector<Int_t> AliCaloTrackMatcher::GetMatchedClusterIDsForTrack(AliVEvent *event
     if(TrackPos == -1) AliFatal(Form("AliCaloTrackMatcher: GetNMatchedClusterIDsForTrack - track (ID: '%i') cannot be retrieved from event, should be impossible as it has been used in maim task before!",trackID));
   }else TrackPos = trackID; // for ESD just take trackID
   vector<Int_t> tempMatchedClusters;
-  multimap<Int_t,Int_t>::iterator it;
+  matchIter it;
   AliVTrack* tempTrack  = dynamic_cast<AliVTrack*>(event->GetTrack(TrackPos));
   if(!tempTrack) return tempMatchedClusters;
-  for (it=fMapTrackToCluster.begin(); it!=fMapTrackToCluster.end(); ++it){
-    if(it->first == TrackPos){
-      Float_t tempDEta, tempDPhi;
-      if(GetTrackClusterMatchingResidual(tempTrack->GetID(),it->second,tempDEta,tempDPhi)){
-        if (TMath::Sqrt(tempDEta*tempDEta + tempDPhi*tempDPhi) < dR ) tempMatchedClusters.push_back(it->second);
-      }
+  matchRange range = GetMatchRange(fVecTrackToCluster,TrackPos);
+  for (it=range.first; it!=range.second; ++it){
+    Float_t tempDEta, tempDPhi;
+    if(GetTrackClusterMatchingResidual(tempTrack->GetID(),it->second,tempDEta,tempDPhi)){
+      if (TMath::Sqrt(tempDEta*tempDEta + tempDPhi*tempDPhi) < dR ) tempMatchedClusters.push_back(it->second);
     }
   }
   return tempMatchedClusters;
@@ -1557,8 +1645,8 @@ void AliCaloTrackMatcher::DebugMatching(){
     cout << "vector etaphi:" << endl;
     cout << fVectorDeltaEtaDeltaPhi.size() << endl;
     cout << "multimap" << endl;
-    mapT::iterator iter = fMap_TrID_ClID_ToIndex.begin();
-    for (iter = fMap_TrID_ClID_ToIndex.begin(); iter != fMap_TrID_ClID_ToIndex.end(); ++iter){
+    vector<pair<pairInt,Int_t> >::const_iterator iter;
+    for (iter = fVec_TrID_ClID_ToIndex.begin(); iter != fVec_TrID_ClID_ToIndex.end(); ++iter){
       Float_t dEta, dPhi = 0;
       if(!GetTrackClusterMatchingResidual(iter->first.first,iter->first.second,dEta,dPhi)) continue;
       cout << "  [" << iter->first.first << "/" << iter->first.second << ", " << iter->second << "] - (" << dEta << "/" << dPhi << ")" << endl;
@@ -1574,11 +1662,11 @@ void AliCaloTrackMatcher::DebugMatching(){
       cout << itr << " (" << tCharge << ") - " << GetNMatchedClusterIDsForTrack(fInputEvent,inTrack->GetID(),5,-5,0.2,-0.4) << "\t\t";
     }
     cout << endl;
-    multimap<Int_t,Int_t>::iterator it;
-    for (it=fMapTrackToCluster.begin(); it!=fMapTrackToCluster.end(); ++it) cout << it->first << " => " << it->second << '\n';
+    matchIter it;
+    for (it=fVecTrackToCluster.begin(); it!=fVecTrackToCluster.end(); ++it) cout << it->first << " => " << it->second << '\n';
     cout << "mapClusterToTrack" << endl;
-    Int_t tempClus = it->second;
-    for (it=fMapClusterToTrack.begin(); it!=fMapClusterToTrack.end(); ++it) cout << it->first << " => " << it->second << '\n';
+    Int_t tempClus = (it-1)->second;
+    for (it=fVecClusterToTrack.begin(); it!=fVecClusterToTrack.end(); ++it) cout << it->first << " => " << it->second << '\n';
     vector<Int_t> tempTracks = GetMatchedTrackIDsForCluster(fInputEvent,tempClus, 5, -5, 0.2, -0.4);
     for(UInt_t iJ=0; iJ<tempTracks.size();iJ++){
       cout << tempClus << " - " << tempTracks.at(iJ) << endl;
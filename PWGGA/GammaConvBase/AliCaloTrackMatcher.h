@@ -84,6 +84,8 @@ class AliCaloTrackMatcher : public AliAnalysisTaskSE {
     typedef pair<Int_t, Int_t> pairInt;
     typedef pair<Float_t, Float_t> pairFloat;
     typedef map<pairInt, Int_t> mapT;
+    typedef vector<pairInt>::const_iterator matchIter;
+    typedef pair<matchIter, matchIter> matchRange;
 
     AliCaloTrackMatcher (const AliCaloTrackMatcher&); // not implemented
     AliCaloTrackMatcher & operator=(const AliCaloTrackMatcher&); // not implemented
@@ -91,6 +93,10 @@ class AliCaloTrackMatcher : public AliAnalysisTaskSE {
     // private methods
     void Initialize(Int_t runNumber);
     void ProcessEvent(AliVEvent *event);
+    void FillClusterGrid(AliVEvent *event, Int_t nClus);
+    void GetClusterCandidates(const Double_t* pos);
+    void SortMatches();
+    static matchRange GetMatchRange(const vector<pairInt>& matches, Int_t key);
     void SetLogBinningYTH2(TH2* histoRebin);
 
     // debug methods
@@ -120,12 +126,22 @@ class AliCaloTrackMatcher : public AliAnalysisTaskSE {
 
     TClonesArray*         fArrClusters;            //! array with clusters
 
-    multimap<Int_t,Int_t> fMapTrackToCluster;      //! connects a given track ID with all associated cluster IDs
-    multimap<Int_t,Int_t> fMapClusterToTrack;      //! connects a given cluster ID with all associated track IDs
+    vector<pairInt>       fVecTrackToCluster;      //! (track ID, cluster ID) of all matches, sorted by track ID (clusters in matching order), see GetMatchRange
+    vector<pairInt>       fVecClusterToTrack;      //! (cluster ID, track ID) of all matches, sorted by cluster ID (tracks in matching order)
 
     Int_t                 fNEntries;               //! number of current TrackID/ClusterID -> Eta/Phi connections
     vector<pairFloat>     fVectorDeltaEtaDeltaPhi; //! vector of all matching residuals for a specific TrackID/ClusterID
-    mapT                  fMap_TrID_ClID_ToIndex;  //! map tuple of (trackID,clusterID) to index in vector fVectorDeltaEtaDeltaPhi
+    vector<pair<pairInt,Int_t> > fVec_TrID_ClID_ToIndex; //! (trackID,clusterID) and index in vector fVectorDeltaEtaDeltaPhi, sorted by (trackID,clusterID), last match kept
+
+    // clusters of the event for the matching, in a grid of cells in x, y, z
+    vector<AliVCluster*>  fGridClusters;           //! clusters of the calorimeter, not copied (0 for the other clusters)
+    vector<Float_t>       fGridClusterPos;         //! x, y, z of the clusters
+    vector<Int_t>         fGridCellStart;          //! first entry in fGridCellClusters of each cell (one more entry than cells)
+    vector<Int_t>         fGridCellClusters;       //! cluster indices ordered by cell
+    vector<Int_t>         fGridCandidates;         //! clusters of the cells around the current track, in index order
+    Int_t                 fGridNCells[3];          //! number of cells in x, y, z
+    Float_t               fGridMin[3];             //! lower edge of the grid in x, y, z
+    Float_t               fGridCellSize;           //! size of the cells, at least fMatchingWindow
 
     // for cluster <-> V0-track matching (running with different mass hypthesis)
     multimap<Int_t,Int_t> fSecMapTrackToCluster;      //! connects a given secondary track ID with all associated cluster IDs
@@ -144,7 +160,7 @@ class AliCaloTrackMatcher : public AliAnalysisTaskSE {
     Bool_t                fDoLightOutput;          // switch for running light output, kFALSE -> normal mode, kTRUE -> light mode
 
     Double_t              fMassHypothesis;          // mass used for track propagation to calorimeter surface
-    ClassDef(AliCaloTrackMatcher,10)
+    ClassDef(AliCaloTrackMatcher,11)
 };
 
 #endif
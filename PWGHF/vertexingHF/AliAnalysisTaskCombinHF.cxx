@@ -45,6 +45,7 @@
 #include "AliGenPythiaEventHeader.h"
 #include "AliAnalysisUtils.h"
 #include "AliAnalysisVertexingHF.h"
+#include "AliHFRecoCandCache.h"
 #include "AliAnalysisTaskCombinHF.h"
 
 /// \cond CLASSIMP
@@ -2342,6 +2343,7 @@ void AliAnalysisTaskCombinHF::DoMixingWithPools(Int_t poolIndex){
 void AliAnalysisTaskCombinHF::FinishTaskOutput()
 {
   /// perform mixed event analysis
+  AliHFRecoCandCache::Instance().PrintSummary();
   if(fDoEventMixing==0) return;
   printf("AliAnalysisTaskCombinHF: FinishTaskOutput\n");
 
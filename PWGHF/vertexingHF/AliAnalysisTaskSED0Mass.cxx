@@ -52,6 +52,7 @@
 #include "AliAODRecoDecayHF2Prong.h"
 #include "AliAODRecoCascadeHF.h"
 #include "AliAnalysisVertexingHF.h"
+#include "AliHFRecoCandCache.h"
 #include "AliAnalysisTaskSE.h"
 #include "AliAnalysisTaskSED0Mass.h"
 #include "AliNormalizationCounter.h"
@@ -2764,6 +2765,14 @@ AliAODVertex* AliAnalysisTaskSED0Mass::GetPrimaryVtxSkipped(AliAODEvent *aodev){
 }
 
 
+//________________________________________________________________________
+void AliAnalysisTaskSED0Mass::FinishTaskOutput()
+{
+  /// Print the counters of the on-the-fly candidate reconstruction
+  /// (called on each worker, where the candidates are refilled)
+  AliHFRecoCandCache::Instance().PrintSummary();
+}
+
 //________________________________________________________________________
 void AliAnalysisTaskSED0Mass::Terminate(Option_t */*option*/)
 {
@@ -43,6 +43,7 @@ class AliAnalysisTaskSED0Mass : public AliAnalysisTaskSE
   virtual void Init();
   virtual void LocalInit() {Init();}
   virtual void UserExec(Option_t *option);
+  virtual void FinishTaskOutput();
   virtual void Terminate(Option_t *option);
 
   void CreateMCAcceptanceHistos();
@@ -77,6 +77,7 @@
 #include <TMVA/MethodCuts.h>
 
 #include "IClassifierReader.h"
+#include "AliHFBDTFlatForest.h"
 
 using std::cout;
 using std::endl;
@@ -1118,10 +1119,20 @@ void AliAnalysisTaskSELc2V0bachelorTMVAApp::UserCreateOutputObjects() {
     }
     delete tokensSpectators;
     if (fUseWeightsLibrary) {
-      void* lib = dlopen(fTMVAlibName.Data(), RTLD_NOW);
-      void* p = dlsym(lib, Form("%s", fTMVAlibPtBin.Data()));
-      IClassifierReader* (*maker1)(std::vector<std::string>&) = (IClassifierReader* (*)(std::vector<std::string>&)) p;
-      fBDTReader = maker1(inputNamesVec);
+      if (fTMVAlibName.EndsWith(".class.cxx") || fTMVAlibName.EndsWith(".xml")) {
+        // forest converted at run time into the flat evaluator, no compiled library needed
+        AliHFBDTFlatForest* flatForest = new AliHFBDTFlatForest();
+        if (!flatForest->Load(fTMVAlibName.Data()) || !flatForest->CheckInputVariables(inputNamesVec)) {
+          AliFatal(Form("Cannot use BDT forest from %s", fTMVAlibName.Data()));
+        }
+        fBDTReader = flatForest;
+      }
+      else {
+        void* lib = dlopen(fTMVAlibName.Data(), RTLD_NOW);
+        void* p = dlsym(lib, Form("%s", fTMVAlibPtBin.Data()));
+        IClassifierReader* (*maker1)(std::vector<std::string>&) = (IClassifierReader* (*)(std::vector<std::string>&)) p;
+        fBDTReader = maker1(inputNamesVec);
+      }
     }
     
     if (fUseXmlWeightsFile) fReader->BookMVA("BDT method", fXmlWeightsFile);
@@ -99,6 +99,7 @@ class AliAnalysisTaskSELc2V0bachelorTMVAApp : public AliAnalysisTaskSE
   
   void SetMVReader(IClassifierReader* r) {fBDTReader = r;}
   IClassifierReader* const GetMVReader() {return fBDTReader;}
+  /// library with the compiled TMVA reader, or a TMVA .class.cxx/.xml file evaluated with AliHFBDTFlatForest
   void SetTMVAlibName(const char* libName) {fTMVAlibName = libName;}
   TString GetTMVAlibName() {return fTMVAlibName;}
   void SetTMVAlibPtBin(const char* libPtBin) {fTMVAlibPtBin = libPtBin;}
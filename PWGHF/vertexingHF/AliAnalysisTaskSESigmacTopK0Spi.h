@@ -106,6 +106,7 @@ class AliAnalysisTaskSESigmacTopK0Spi : public AliAnalysisTaskSE
   
   void SetMVReader(IClassifierReader* r) {fBDTReader = r;}
   IClassifierReader* const GetMVReader() {return fBDTReader;}
+  /// library with the compiled TMVA reader, or a TMVA .class.cxx/.xml file evaluated with AliHFBDTFlatForest
   void SetTMVAlibName(const char* libName) {fTMVAlibName = libName;}
   TString GetTMVAlibName() {return fTMVAlibName;}
   void SetTMVAlibPtBin(const char* libPtBin) {fTMVAlibPtBin = libPtBin;}
@@ -34,6 +34,7 @@
 #include "AliAODHandler.h"
 #include "AliESDEvent.h"
 #include "AliAnalysisVertexingHF.h"
+#include "AliHFRecoCandCache.h"
 #include "AliAnalysisTaskSE.h"
 #include "AliAnalysisManager.h"
 #include "AliAnalysisTaskSEVertexingHF.h"
@@ -261,6 +262,16 @@ void AliAnalysisTaskSEVertexingHF::UserExec(Option_t */*option*/)
   return;
 }
 
+//________________________________________________________________________
+void AliAnalysisTaskSEVertexingHF::FinishTaskOutput()
+{
+  // Print the statistics of the preselection of the track combinations
+  // (called on each worker, where the candidates are made)
+  //
+  if(fVHF) fVHF->PrintPreselectionStatus();
+  AliHFRecoCandCache::Instance().PrintSummary();
+}
+
 //________________________________________________________________________
 void AliAnalysisTaskSEVertexingHF::Terminate(Option_t */*option*/)
 {
@@ -32,6 +32,8 @@
 #include <TString.h>
 #include <TList.h>
 #include <TProcessID.h>
+#include <TROOT.h>
+#include <TClass.h>
 #include "AliLog.h"
 #include "AliVEvent.h"
 #include "AliVVertex.h"
@@ -64,17 +66,122 @@
 #include "AliRDHFCutsDStartoKpipi.h"
 #include "AliAnalysisFilter.h"
 #include "AliAnalysisVertexingHF.h"
+#include "AliHFRecoCandCache.h"
 #include "AliMixedEvent.h"
 #include "AliESDv0.h"
 #include "AliAODv0.h"
 #include "AliCodeTimer.h"
 #include "AliMultSelection.h"
 #include <cstring>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
 
 /// \cond CLASSIMP
 ClassImp(AliAnalysisVertexingHF);
 /// \endcond
 
+namespace {
+  /// serializes the calls of the PID response shared by the threads
+  std::mutex gPIDResponseMutex;
+}
+
+/// \class AliAnalysisVertexingHFThreads
+/// \brief Threads of the candidate loops of AliAnalysisVertexingHF
+///
+/// The threads are started once and wait between events. Run() executes
+/// the job of the event on all threads, the calling thread included, and
+/// returns when all of them are done.
+class AliAnalysisVertexingHFThreads {
+ public:
+  AliAnalysisVertexingHFThreads(Int_t nThreads);
+  ~AliAnalysisVertexingHFThreads();
+
+  /// Call job(iThread) on each thread, iThread=0 being the calling thread
+  void Run(const std::function<void(Int_t)> &job);
+
+ private:
+  AliAnalysisVertexingHFThreads(const AliAnalysisVertexingHFThreads&);
+  AliAnalysisVertexingHFThreads& operator=(const AliAnalysisVertexingHFThreads&);
+
+  void Loop(Int_t iThread);
+
+  std::vector<std::thread> fThreads;         /// threads 1...nThreads-1
+  std::mutex fMutex;                         /// protects the members below
+  std::condition_variable fStart;            /// signals a new job or the stop to the threads
+  std::condition_variable fDone;             /// signals the calling thread that the threads are done
+  const std::function<void(Int_t)> *fJob;    /// job of the current event
+  ULong64_t fNJobs;                          /// number of jobs given to the threads
+  Int_t fNBusy;                              /// number of threads still running the job
+  Bool_t fStop;                              /// the threads have to return
+};
+//----------------------------------------------------------------------------
+AliAnalysisVertexingHFThreads::AliAnalysisVertexingHFThreads(Int_t nThreads):
+fThreads(),
+fMutex(),
+fStart(),
+fDone(),
+fJob(0x0),
+fNJobs(0),
+fNBusy(0),
+fStop(kFALSE)
+{
+  for(Int_t iThread=1; iThread<nThreads; iThread++) {
+    fThreads.emplace_back(&AliAnalysisVertexingHFThreads::Loop,this,iThread);
+  }
+}
+//----------------------------------------------------------------------------
+AliAnalysisVertexingHFThreads::~AliAnalysisVertexingHFThreads()
+{
+  {
+    std::lock_guard<std::mutex> lock(fMutex);
+    fStop = kTRUE;
+  }
+  fStart.notify_all();
+  for(UInt_t iThread=0; iThread<fThreads.size(); iThread++) fThreads[iThread].join();
+}
+//----------------------------------------------------------------------------
+void AliAnalysisVertexingHFThreads::Run(const std::function<void(Int_t)> &job)
+{
+  {
+    std::lock_guard<std::mutex> lock(fMutex);
+    fJob = &job;
+    fNBusy = fThreads.size();
+    fNJobs++;
+  }
+  fStart.notify_all();
+
+  job(0);
+
+  std::unique_lock<std::mutex> lock(fMutex);
+  fDone.wait(lock,[this]() { return fNBusy==0; });
+  fJob = 0x0;
+}
+//----------------------------------------------------------------------------
+void AliAnalysisVertexingHFThreads::Loop(Int_t iThread)
+{
+  ULong64_t nJobs = 0;
+  while(kTRUE) {
+    const std::function<void(Int_t)> *job = 0x0;
+    {
+      std::unique_lock<std::mutex> lock(fMutex);
+      fStart.wait(lock,[&]() { return fStop || fNJobs!=nJobs; });
+      if(fStop) return;
+      nJobs = fNJobs;
+      job = fJob;
+    }
+
+    (*job)(iThread);
+
+    std::lock_guard<std::mutex> lock(fMutex);
+    if(--fNBusy==0) fDone.notify_one();
+  }
+}
+
 //----------------------------------------------------------------------------
 AliAnalysisVertexingHF::AliAnalysisVertexingHF():
 fInputAOD(kFALSE),
@@ -161,7 +268,22 @@ fMassLambdaC(0.),
 fMassDstar(0.),
 fMassJpsi(0.),
 fMassPhi(0.),
-fMassK(0.)
+fMassK(0.),
+fMassPion(0.),
+fMaxMass3Prong(0.),
+fMaxMass4Prong(0.),
+fPxAtVtx(),
+fPyAtVtx(),
+fPzAtVtx(),
+fnTrksPairDCACache(0),
+fPairDCACacheIndex(),
+fPairDCACache(),
+fNThreads(1),
+fWorkers(),
+fWorkerArrays(),
+fThreads(0x0),
+fWorkerTrks(0x0),
+fWorkerTrksAtVertex(0x0)
 {
   /// Default constructor
 
@@ -172,6 +294,7 @@ fMassK(0.)
   fMassCalc3 = new AliAODRecoDecay(0x0,3,1,d03);
   fMassCalc4 = new AliAODRecoDecay(0x0,4,0,d04);
   SetMasses();
+  for(Int_t i=0; i<kNPreselCounters; i++) fPreselCounters[i]=0;
 }
 //--------------------------------------------------------------------------
 AliAnalysisVertexingHF::AliAnalysisVertexingHF(const AliAnalysisVertexingHF &source) :
@@ -260,11 +383,27 @@ fMassLambdaC(source.fMassLambdaC),
 fMassDstar(source.fMassDstar),
 fMassJpsi(source.fMassJpsi),
 fMassPhi(source.fMassPhi),
-fMassK(source.fMassK)
+fMassK(source.fMassK),
+fMassPion(source.fMassPion),
+fMaxMass3Prong(0.),
+fMaxMass4Prong(0.),
+fPxAtVtx(),
+fPyAtVtx(),
+fPzAtVtx(),
+fnTrksPairDCACache(0),
+fPairDCACacheIndex(),
+fPairDCACache(),
+fNThreads(source.fNThreads),
+fWorkers(),
+fWorkerArrays(),
+fThreads(0x0),
+fWorkerTrks(0x0),
+fWorkerTrksAtVertex(0x0)
 {
   ///
   /// Copy constructor
   ///
+  for(Int_t i=0; i<kNPreselCounters; i++) fPreselCounters[i]=0;
 }
 //--------------------------------------------------------------------------
 AliAnalysisVertexingHF &AliAnalysisVertexingHF::operator=(const AliAnalysisVertexingHF &source)
@@ -356,6 +495,8 @@ AliAnalysisVertexingHF &AliAnalysisVertexingHF::operator=(const AliAnalysisVerte
   fMassJpsi = source.fMassJpsi;
   fMassPhi = source.fMassPhi;
   fMassK = source.fMassK;
+  fMassPion = source.fMassPion;
+  fNThreads = source.fNThreads;
 
   return *this;
 }
@@ -384,6 +525,11 @@ AliAnalysisVertexingHF::~AliAnalysisVertexingHF() {
   if(fMassCalc2) { delete fMassCalc2; fMassCalc2=0; }
   if(fMassCalc3) { delete fMassCalc3; fMassCalc3=0; }
   if(fMassCalc4) { delete fMassCalc4; fMassCalc4=0; }
+  if(fThreads) { delete fThreads; fThreads=0; }
+  for(UInt_t i=0; i<fWorkers.size(); i++) delete fWorkers[i];
+  for(UInt_t i=0; i<fWorkerArrays.size(); i++) delete fWorkerArrays[i];
+  if(fWorkerTrks) { delete fWorkerTrks; fWorkerTrks=0; }
+  if(fWorkerTrksAtVertex) { delete fWorkerTrksAtVertex; fWorkerTrksAtVertex=0; }
 }
 //----------------------------------------------------------------------------
 TList *AliAnalysisVertexingHF::FillListOfCuts() {
@@ -508,80 +654,34 @@ void AliAnalysisVertexingHF::FindCandidates(AliVEvent *event,
     return;
   }
 
-  // delete candidates from previous event and create references
-  Int_t iVerticesHF=0,iD0toKpi=0,iJPSItoEle=0,i3Prong=0,i4Prong=0,iDstar=0,iCascades=0,iLikeSign2Prong=0,iLikeSign3Prong=0;
+  // delete candidates from previous event
   aodVerticesHFTClArr->Delete();
-  iVerticesHF = aodVerticesHFTClArr->GetEntriesFast();
-  TClonesArray &verticesHFRef = *aodVerticesHFTClArr;
   if(fD0toKpi || fDstar)   {
     aodD0toKpiTClArr->Delete();
-    iD0toKpi = aodD0toKpiTClArr->GetEntriesFast();
   }
   if(fJPSItoEle) {
     aodJPSItoEleTClArr->Delete();
-    iJPSItoEle = aodJPSItoEleTClArr->GetEntriesFast();
   }
   if(f3Prong) {
     aodCharm3ProngTClArr->Delete();
-    i3Prong = aodCharm3ProngTClArr->GetEntriesFast();
   }
   if(f4Prong) {
     aodCharm4ProngTClArr->Delete();
-    i4Prong = aodCharm4ProngTClArr->GetEntriesFast();
   }
   if(fDstar) {
     aodDstarTClArr->Delete();
-    iDstar = aodDstarTClArr->GetEntriesFast();
   }
   if(fCascades) {
     aodCascadesTClArr->Delete();
-    iCascades = aodCascadesTClArr->GetEntriesFast();
   }
   if(fLikeSign) {
     aodLikeSign2ProngTClArr->Delete();
-    iLikeSign2Prong = aodLikeSign2ProngTClArr->GetEntriesFast();
   }
   if(fLikeSign3prong && f3Prong) {
     aodLikeSign3ProngTClArr->Delete();
-    iLikeSign3Prong = aodLikeSign3ProngTClArr->GetEntriesFast();
   }
 
-  TClonesArray &aodD0toKpiRef        = *aodD0toKpiTClArr;
-  TClonesArray &aodJPSItoEleRef      = *aodJPSItoEleTClArr;
-  TClonesArray &aodCharm3ProngRef    = *aodCharm3ProngTClArr;
-  TClonesArray &aodCharm4ProngRef    = *aodCharm4ProngTClArr;
-  TClonesArray &aodDstarRef          = *aodDstarTClArr;
-  TClonesArray &aodCascadesRef       = *aodCascadesTClArr;
-  TClonesArray &aodLikeSign2ProngRef = *aodLikeSign2ProngTClArr;
-  TClonesArray &aodLikeSign3ProngRef = *aodLikeSign3ProngTClArr;
-
-
-  AliAODRecoDecayHF2Prong *io2Prong  = 0;
-  AliAODRecoDecayHF3Prong *io3Prong  = 0;
-  AliAODRecoDecayHF4Prong *io4Prong  = 0;
-  AliAODRecoCascadeHF     *ioCascade = 0;
-
-  Int_t    iTrkP1,iTrkP2,iTrkN1,iTrkN2,iTrkSoftPi,trkEntries,iv0,nv0;
-  Double_t xdummy,ydummy,dcap1n1,dcap1n2,dcap2n1,dcap1p2,dcan1n2,dcap2n2,dcaCasc;
-  Bool_t   okD0=kFALSE,okJPSI=kFALSE,ok3Prong=kFALSE,ok4Prong=kFALSE;
-  Bool_t   okDstar=kFALSE,okD0fromDstar=kFALSE;
-  Bool_t   okCascades=kFALSE;
-  AliESDtrack *postrack1 = 0;
-  AliESDtrack *postrack2 = 0;
-  AliESDtrack *negtrack1 = 0;
-  AliESDtrack *negtrack2 = 0;
-  AliESDtrack *trackPi   = 0;
-  Double_t mompos1[3],mompos2[3],momneg1[3],momneg2[3];
-  Float_t dcaMax = fCutsD0toKpi->GetDCACut();
-  if(fCutsJpsitoee) dcaMax=TMath::Max(dcaMax,fCutsJpsitoee->GetDCACut());
-  if(fCutsDplustoKpipi) dcaMax=TMath::Max(dcaMax,fCutsDplustoKpipi->GetDCACut());
-  if(fCutsDstoKKpi) dcaMax=TMath::Max(dcaMax,fCutsDstoKKpi->GetDCACut());
-  if(fCutsLctopKpi) dcaMax=TMath::Max(dcaMax,fCutsLctopKpi->GetDCACut());
-  if(fCutsD0toKpipipi) dcaMax=TMath::Max(dcaMax,fCutsD0toKpipipi->GetDCACut());
-  if(fCutsDStartoKpipi) dcaMax=TMath::Max(dcaMax,fCutsDStartoKpipi->GetDCACut());
-
-  AliDebug(2,Form(" dca cut set to %f cm",dcaMax));
-
+  Int_t trkEntries,nv0;
 
   // get Bz
   fBzkG = (Double_t)event->GetMagneticField();
@@ -629,6 +729,139 @@ void AliAnalysisVertexingHF::FindCandidates(AliVEvent *event,
   AliDebug(1,Form(" Selected tracks: %d",nSeleTrks));
   fnSeleTrksTotal += nSeleTrks;
 
+  // momenta at the primary vertex and pair DCA cache for the preselection
+  // of the 3 and 4 prong candidates
+  PrepareTrackPreselection(tracksAtVertex,nSeleTrks,seleFlags);
+
+  // build the candidates, on several threads if requested (only for AOD
+  // input: with ESD input the tracks of the event are modified in place)
+  TClonesArray *outArrays[kNOutputArrays]={aodVerticesHFTClArr,aodD0toKpiTClArr,
+					    aodJPSItoEleTClArr,aodCharm3ProngTClArr,
+					    aodCharm4ProngTClArr,aodDstarTClArr,
+					    aodCascadesTClArr,aodLikeSign2ProngTClArr,
+					    aodLikeSign3ProngTClArr};
+  if(fNThreads>1 && fInputAOD && nSeleTrks>kNTrksPerThreadChunk) {
+    MakeCandidatesThreaded(event,trkEntries,nv0,seleTrksArray,tracksAtVertex,
+			   nSeleTrks,seleFlags,evtNumber,outArrays);
+  } else {
+    MakeCandidates(event,trkEntries,nv0,seleTrksArray,tracksAtVertex,
+		   nSeleTrks,seleFlags,evtNumber,0,nSeleTrks,outArrays);
+  }
+
+
+  //  AliDebug(1,Form(" Total HF vertices in event = %d;",
+  //		  (Int_t)aodVerticesHFTClArr->GetEntriesFast()));
+  if(fD0toKpi) {
+    AliDebug(1,Form(" D0->Kpi in event = %d;",
+		    (Int_t)aodD0toKpiTClArr->GetEntriesFast()));
+  }
+  if(fJPSItoEle) {
+    AliDebug(1,Form(" JPSI->ee in event = %d;",
+		    (Int_t)aodJPSItoEleTClArr->GetEntriesFast()));
+  }
+  if(f3Prong) {
+    AliDebug(1,Form(" Charm->3Prong in event = %d;",
+		    (Int_t)aodCharm3ProngTClArr->GetEntriesFast()));
+  }
+  if(f4Prong) {
+    AliDebug(1,Form(" Charm->4Prong in event = %d;\n",
+		    (Int_t)aodCharm4ProngTClArr->GetEntriesFast()));
+  }
+  if(fDstar) {
+    AliDebug(1,Form(" D*->D0pi in event = %d;\n",
+		    (Int_t)aodDstarTClArr->GetEntriesFast()));
+  }
+  if(fCascades){
+    AliDebug(1,Form(" cascades -> v0 + track in event = %d;\n",
+		    (Int_t)aodCascadesTClArr->GetEntriesFast()));
+  }
+  if(fLikeSign) {
+    AliDebug(1,Form(" Like-sign 2Prong in event = %d;\n",
+		    (Int_t)aodLikeSign2ProngTClArr->GetEntriesFast()));
+  }
+  if(fLikeSign3prong && f3Prong) {
+    AliDebug(1,Form(" Like-sign 3Prong in event = %d;\n",
+		    (Int_t)aodLikeSign3ProngTClArr->GetEntriesFast()));
+  }
+
+
+  delete [] seleFlags; seleFlags=NULL;
+  if(evtNumber) {delete [] evtNumber; evtNumber=NULL;}
+  tracksAtVertex.Delete();
+
+  if(fInputAOD) {
+    seleTrksArray.Delete();
+    if(fAODMap) { delete [] fAODMap; fAODMap=NULL; }
+  }
+
+
+  //printf("Trks: total %d  sele %d\n",fnTrksTotal,fnSeleTrksTotal);
+
+  return;
+}
+//----------------------------------------------------------------------------
+void AliAnalysisVertexingHF::MakeCandidates(AliVEvent *event,
+					    Int_t trkEntries,Int_t nv0,
+					    TObjArray &seleTrksArray,
+					    TObjArray &tracksAtVertex,
+					    Int_t nSeleTrks,
+					    const UChar_t *seleFlags,
+					    const Int_t *evtNumber,
+					    Int_t firstTrkP1,Int_t lastTrkP1,
+					    TClonesArray **outArrays)
+{
+  /// Loops on the selected tracks building the candidates whose first
+  /// positive track is in [firstTrkP1,lastTrkP1). The candidates and their
+  /// vertices are added at the end of the arrays outArrays (EOutputArray)
+  //AliCodeTimerAuto("",0);
+
+  TClonesArray &verticesHFRef        = *outArrays[kOutVerticesHF];
+  TClonesArray &aodD0toKpiRef        = *outArrays[kOutD0toKpi];
+  TClonesArray &aodJPSItoEleRef      = *outArrays[kOutJPSItoEle];
+  TClonesArray &aodCharm3ProngRef    = *outArrays[kOutCharm3Prong];
+  TClonesArray &aodCharm4ProngRef    = *outArrays[kOutCharm4Prong];
+  TClonesArray &aodDstarRef          = *outArrays[kOutDstar];
+  TClonesArray &aodCascadesRef       = *outArrays[kOutCascades];
+  TClonesArray &aodLikeSign2ProngRef = *outArrays[kOutLikeSign2Prong];
+  TClonesArray &aodLikeSign3ProngRef = *outArrays[kOutLikeSign3Prong];
+
+  Int_t iVerticesHF=0,iD0toKpi=0,iJPSItoEle=0,i3Prong=0,i4Prong=0,iDstar=0,iCascades=0,iLikeSign2Prong=0,iLikeSign3Prong=0;
+  iVerticesHF = verticesHFRef.GetEntriesFast();
+  if(outArrays[kOutD0toKpi])         iD0toKpi = aodD0toKpiRef.GetEntriesFast();
+  if(outArrays[kOutJPSItoEle])       iJPSItoEle = aodJPSItoEleRef.GetEntriesFast();
+  if(outArrays[kOutCharm3Prong])     i3Prong = aodCharm3ProngRef.GetEntriesFast();
+  if(outArrays[kOutCharm4Prong])     i4Prong = aodCharm4ProngRef.GetEntriesFast();
+  if(outArrays[kOutDstar])           iDstar = aodDstarRef.GetEntriesFast();
+  if(outArrays[kOutCascades])        iCascades = aodCascadesRef.GetEntriesFast();
+  if(outArrays[kOutLikeSign2Prong])  iLikeSign2Prong = aodLikeSign2ProngRef.GetEntriesFast();
+  if(outArrays[kOutLikeSign3Prong])  iLikeSign3Prong = aodLikeSign3ProngRef.GetEntriesFast();
+
+
+  AliAODRecoDecayHF2Prong *io2Prong  = 0;
+  AliAODRecoDecayHF3Prong *io3Prong  = 0;
+  AliAODRecoDecayHF4Prong *io4Prong  = 0;
+  AliAODRecoCascadeHF     *ioCascade = 0;
+
+  Int_t    iTrkP1,iTrkP2,iTrkN1,iTrkN2,iTrkSoftPi,iv0;
+  Double_t xdummy,ydummy,dcap1n1,dcap1n2,dcap2n1,dcap1p2,dcan1n2,dcap2n2,dcaCasc;
+  Bool_t   okD0=kFALSE,okJPSI=kFALSE,ok3Prong=kFALSE,ok4Prong=kFALSE;
+  Bool_t   okDstar=kFALSE,okD0fromDstar=kFALSE;
+  Bool_t   okCascades=kFALSE;
+  AliESDtrack *postrack1 = 0;
+  AliESDtrack *postrack2 = 0;
+  AliESDtrack *negtrack1 = 0;
+  AliESDtrack *negtrack2 = 0;
+  AliESDtrack *trackPi   = 0;
+  Float_t dcaMax = fCutsD0toKpi->GetDCACut();
+  if(fCutsJpsitoee) dcaMax=TMath::Max(dcaMax,fCutsJpsitoee->GetDCACut());
+  if(fCutsDplustoKpipi) dcaMax=TMath::Max(dcaMax,fCutsDplustoKpipi->GetDCACut());
+  if(fCutsDstoKKpi) dcaMax=TMath::Max(dcaMax,fCutsDstoKKpi->GetDCACut());
+  if(fCutsLctopKpi) dcaMax=TMath::Max(dcaMax,fCutsLctopKpi->GetDCACut());
+  if(fCutsD0toKpipipi) dcaMax=TMath::Max(dcaMax,fCutsD0toKpipipi->GetDCACut());
+  if(fCutsDStartoKpipi) dcaMax=TMath::Max(dcaMax,fCutsDStartoKpipi->GetDCACut());
+
+  AliDebug(2,Form(" dca cut set to %f cm",dcaMax));
+
 
   TObjArray *twoTrackArray1    = new TObjArray(2);
   TObjArray *twoTrackArray2    = new TObjArray(2);
@@ -663,18 +896,20 @@ void AliAnalysisVertexingHF::FindCandidates(AliVEvent *event,
   }
    
   // LOOP ON  POSITIVE  TRACKS
-  for(iTrkP1=0; iTrkP1<nSeleTrks; iTrkP1++) {
+  for(iTrkP1=firstTrkP1; iTrkP1<lastTrkP1; iTrkP1++) {
 
     //if(iTrkP1%1==0) AliDebug(1,Form("  1st loop on pos: track number %d of %d",iTrkP1,nSeleTrks));
     //if(iTrkP1%1==0) printf("  1st loop on pos: track number %d of %d\n",iTrkP1,nSeleTrks);
 
     // get track from tracks array
     postrack1 = (AliESDtrack*)seleTrksArray.UncheckedAt(iTrkP1);
-    postrack1->GetPxPyPz(mompos1);
 
     // Make cascades with V0+track
     //
     if(fCascades) {
+      // start from the parameters at the primary vertex (the track may have
+      // been propagated by the candidates of the previous positive tracks)
+      SetParametersAtVertex(postrack1,(AliExternalTrackParam*)tracksAtVertex.UncheckedAt(iTrkP1));
       // loop on V0's
       for(iv0=0; iv0<nv0; iv0++){
 
@@ -873,10 +1108,9 @@ void AliAnalysisVertexingHF::FindCandidates(AliVEvent *event,
       //      negtrack1->PropagateToDCA(fV1,fBzkG,kVeryBig);
       SetParametersAtVertex(postrack1,(AliExternalTrackParam*)tracksAtVertex.UncheckedAt(iTrkP1));
       SetParametersAtVertex(negtrack1,(AliExternalTrackParam*)tracksAtVertex.UncheckedAt(iTrkN1));
-      negtrack1->GetPxPyPz(momneg1);
 
       // DCA between the two tracks
-      dcap1n1 = postrack1->GetDCA(negtrack1,fBzkG,xdummy,ydummy);
+      dcap1n1 = GetPairDCA(postrack1,iTrkP1,negtrack1,iTrkN1);
       if(dcap1n1>dcaMax) { negtrack1=0; continue; }
 
       // Vertexing
@@ -1056,6 +1290,29 @@ void AliAnalysisVertexingHF::FindCandidates(AliVEvent *event,
 	continue;
       }
 
+      // preselection of the pair for the 3 and 4 prong candidates, with the
+      // momenta at the primary vertex: lower bound of the invariant mass
+      // (all daughters with the pion mass) compared to the mass windows
+      Bool_t okPair3Prong=f3Prong;
+      Bool_t okPair4Prong=f4Prong && !isLikeSign2Prong && dcap1n1<fCutsD0toKpipipi->GetDCACut();
+      if(!TESTBIT(seleFlags[iTrkP1],kBit3Prong) || !TESTBIT(seleFlags[iTrkN1],kBit3Prong)) {
+	okPair3Prong=kFALSE;
+	okPair4Prong=kFALSE;
+      }
+      if(fMassCutBeforeVertexing) {
+	Int_t iTrkDau[2]={iTrkP1,iTrkN1};
+	Double_t minMass=MinInvMass(2,iTrkDau);
+	if(minMass+fMassPion>fMaxMass3Prong) okPair3Prong=kFALSE;
+	if(minMass+2.*fMassPion>fMaxMass4Prong) okPair4Prong=kFALSE;
+      }
+      fPreselCounters[kPreselPairs]++;
+      if(!okPair3Prong && !okPair4Prong) {
+	fPreselCounters[kPreselPairsPruned]++;
+	negtrack1=0;
+	delete vertexp1n1;
+	continue;
+      }
+
 
       // 2nd LOOP  ON  POSITIVE  TRACKS
       for(iTrkP2=iTrkP1+1; iTrkP2<nSeleTrks; iTrkP2++) {
@@ -1129,6 +1386,30 @@ void AliAnalysisVertexingHF::FindCandidates(AliVEvent *event,
 	  if(!TESTBIT(seleFlags[iTrkP1],kBitKaonCompat) &&
 	     !TESTBIT(seleFlags[iTrkP2],kBitKaonCompat) ) okForDsToKKpi=kFALSE;
 	}
+	// preselection with the momenta at the primary vertex, before the pair
+	// DCAs and the vertexing: check invariant mass cuts for D+,Ds,Lc, and
+	// lower bound of the invariant mass of the 4 prong candidates
+        massCutOK=kTRUE;
+	Bool_t ok4ProngMass=okPair4Prong && !isLikeSign3Prong;
+	if(fMassCutBeforeVertexing){
+	  Int_t iTrkDau[3]={iTrkP1,iTrkN1,iTrkP2};
+	  if(f3Prong){
+	    Double_t pxDau[3],pyDau[3],pzDau[3];
+	    GetMomentaAtVertex(3,iTrkDau,pxDau,pyDau,pzDau);
+	    massCutOK = SelectInvMassAndPt3prong(pxDau,pyDau,pzDau,pidLcStatus);
+	  }
+	  if(ok4ProngMass && MinInvMass(3,iTrkDau)+fMassPion>fMaxMass4Prong) ok4ProngMass=kFALSE;
+	}
+	if(f3Prong) {
+	  fPreselCounters[kPresel3Prong]++;
+	  if(!massCutOK) fPreselCounters[kPresel3ProngPruned]++;
+	}
+	if(okPair4Prong && !isLikeSign3Prong) {
+	  fPreselCounters[kPresel4ProngTriplets]++;
+	  if(!ok4ProngMass) fPreselCounters[kPresel4ProngTripletsPruned]++;
+	}
+	if((!f3Prong || !massCutOK) && !ok4ProngMass) { postrack2=0; continue; }
+
 	// back to primary vertex
 	//	postrack1->PropagateToDCA(fV1,fBzkG,kVeryBig);
 	//	postrack2->PropagateToDCA(fV1,fBzkG,kVeryBig);
@@ -1139,13 +1420,11 @@ void AliAnalysisVertexingHF::FindCandidates(AliVEvent *event,
 
 	//printf("********** %d %d %d\n",postrack1->GetID(),postrack2->GetID(),negtrack1->GetID());
 
-	dcap2n1 = postrack2->GetDCA(negtrack1,fBzkG,xdummy,ydummy);
+	dcap2n1 = GetPairDCA(postrack2,iTrkP2,negtrack1,iTrkN1);
 	if(dcap2n1>dcaMax) { postrack2=0; continue; }
-	dcap1p2 = postrack2->GetDCA(postrack1,fBzkG,xdummy,ydummy);
+	dcap1p2 = GetPairDCA(postrack2,iTrkP2,postrack1,iTrkP1);
 	if(dcap1p2>dcaMax) { postrack2=0; continue; }
 
-	// check invariant mass cuts for D+,Ds,Lc
-        massCutOK=kTRUE;
 	if(f3Prong) {
 	  if(postrack2->Charge()>0) {
 	    threeTrackArray->AddAt(postrack1,0);
@@ -1156,14 +1435,6 @@ void AliAnalysisVertexingHF::FindCandidates(AliVEvent *event,
 	    threeTrackArray->AddAt(postrack1,1);
 	    threeTrackArray->AddAt(postrack2,2);
 	  }
-	  if(fMassCutBeforeVertexing){
-	    postrack2->GetPxPyPz(mompos2);
-	    Double_t pxDau[3]={mompos1[0],momneg1[0],mompos2[0]};
-	    Double_t pyDau[3]={mompos1[1],momneg1[1],mompos2[1]};
-	    Double_t pzDau[3]={mompos1[2],momneg1[2],mompos2[2]};
-	    //	    massCutOK = SelectInvMassAndPt3prong(threeTrackArray);
-	    massCutOK = SelectInvMassAndPt3prong(pxDau,pyDau,pzDau,pidLcStatus);
-	  }
 	}
 
 	if(f3Prong && !massCutOK) {
@@ -1230,7 +1501,9 @@ void AliAnalysisVertexingHF::FindCandidates(AliVEvent *event,
 	   && !isLikeSign2Prong && !isLikeSign3Prong
 	   // track-to-track dca cuts already now
 	   && dcap1n1 < fCutsD0toKpipipi->GetDCACut()
-	   && dcap2n1 < fCutsD0toKpipipi->GetDCACut()) {
+	   && dcap2n1 < fCutsD0toKpipipi->GetDCACut()
+	   // mass preselection of the triplet
+	   && ok4ProngMass) {
 	  // back to primary vertex
 	  //	  postrack1->PropagateToDCA(fV1,fBzkG,kVeryBig);
 	  //	  postrack2->PropagateToDCA(fV1,fBzkG,kVeryBig);
@@ -1267,6 +1540,20 @@ void AliAnalysisVertexingHF::FindCandidates(AliVEvent *event,
 		 evtNumber[iTrkN1]==evtNumber[iTrkP2]) continue;
 	    }
 
+	    // preselection with the momenta at the primary vertex, before the
+	    // pair DCAs and the vertexing: check invariant mass cuts for D0
+	    fPreselCounters[kPresel4Prong]++;
+	    if(fMassCutBeforeVertexing){
+	      Int_t iTrkDau[4]={iTrkP1,iTrkN1,iTrkP2,iTrkN2};
+	      Double_t pxDau[4],pyDau[4],pzDau[4];
+	      GetMomentaAtVertex(4,iTrkDau,pxDau,pyDau,pzDau);
+	      if(!SelectInvMassAndPt4prong(pxDau,pyDau,pzDau)) {
+	        fPreselCounters[kPresel4ProngPruned]++;
+	        negtrack2=0;
+	        continue;
+	      }
+	    }
+
 	    // back to primary vertex
 	    // postrack1->PropagateToDCA(fV1,fBzkG,kVeryBig);
 	    // postrack2->PropagateToDCA(fV1,fBzkG,kVeryBig);
@@ -1277,9 +1564,9 @@ void AliAnalysisVertexingHF::FindCandidates(AliVEvent *event,
 	    SetParametersAtVertex(postrack2,(AliExternalTrackParam*)tracksAtVertex.UncheckedAt(iTrkP2));
 	    SetParametersAtVertex(negtrack2,(AliExternalTrackParam*)tracksAtVertex.UncheckedAt(iTrkN2));
 
-	    dcap1n2 = postrack1->GetDCA(negtrack2,fBzkG,xdummy,ydummy);
+	    dcap1n2 = GetPairDCA(postrack1,iTrkP1,negtrack2,iTrkN2);
 	    if(dcap1n2 > fCutsD0toKpipipi->GetDCACut()) { negtrack2=0; continue; }
-            dcap2n2 = postrack2->GetDCA(negtrack2,fBzkG,xdummy,ydummy);
+            dcap2n2 = GetPairDCA(postrack2,iTrkP2,negtrack2,iTrkN2);
             if(dcap2n2 > fCutsD0toKpipipi->GetDCACut()) { negtrack2=0; continue; }
 
 
@@ -1288,17 +1575,6 @@ void AliAnalysisVertexingHF::FindCandidates(AliVEvent *event,
 	    fourTrackArray->AddAt(postrack2,2);
 	    fourTrackArray->AddAt(negtrack2,3);
 
-	    // check invariant mass cuts for D0
-	    massCutOK=kTRUE;
-	    if(fMassCutBeforeVertexing)
-	      massCutOK = SelectInvMassAndPt4prong(fourTrackArray);
-
-	    if(!massCutOK) {
-	      fourTrackArray->Clear();
-	      negtrack2=0;
-	      continue;
-	    }
-
 	    // Vertexing
 	    AliAODVertex* secVert4PrAOD = ReconstructSecondaryVertex(fourTrackArray,dispersion);
 	    io4Prong = Make4Prong(fourTrackArray,event,secVert4PrAOD,vertexp1n1,vertexp1n1p2,dcap1n1,dcap1n2,dcap2n1,dcap2n2,ok4Prong);
@@ -1336,6 +1612,8 @@ void AliAnalysisVertexingHF::FindCandidates(AliVEvent *event,
       // 2nd LOOP  ON  NEGATIVE  TRACKS (for 3 prong -+-)
       for(iTrkN2=iTrkN1+1; iTrkN2<nSeleTrks; iTrkN2++) {
 
+	if(!okPair3Prong) break; // no 3 prong candidate from this pair
+
 	if(iTrkN2==iTrkP1 || iTrkN2==iTrkP2 || iTrkN2==iTrkN1) continue;
 
 	//if(iTrkN2%1==0) AliDebug(1,Form("    2nd loop on neg: track number %d of %d",iTrkN2,nSeleTrks));
@@ -1401,6 +1679,22 @@ void AliAnalysisVertexingHF::FindCandidates(AliVEvent *event,
 	     !TESTBIT(seleFlags[iTrkN2],kBitKaonCompat) ) okForDsToKKpi=kFALSE;
 	}
 
+	// preselection with the momenta at the primary vertex, before the pair
+	// DCAs and the vertexing: check invariant mass cuts for D+,Ds,Lc
+        massCutOK=kTRUE;
+	if(fMassCutBeforeVertexing && f3Prong){
+	  Int_t iTrkDau[3]={iTrkN1,iTrkP1,iTrkN2};
+	  Double_t pxDau[3],pyDau[3],pzDau[3];
+	  GetMomentaAtVertex(3,iTrkDau,pxDau,pyDau,pzDau);
+	  massCutOK = SelectInvMassAndPt3prong(pxDau,pyDau,pzDau,pidLcStatus);
+	}
+	fPreselCounters[kPresel3Prong]++;
+	if(!massCutOK) {
+	  fPreselCounters[kPresel3ProngPruned]++;
+	  negtrack2=0;
+	  continue;
+	}
+
 	// back to primary vertex
 	// postrack1->PropagateToDCA(fV1,fBzkG,kVeryBig);
 	// negtrack1->PropagateToDCA(fV1,fBzkG,kVeryBig);
@@ -1410,31 +1704,15 @@ void AliAnalysisVertexingHF::FindCandidates(AliVEvent *event,
 	SetParametersAtVertex(negtrack2,(AliExternalTrackParam*)tracksAtVertex.UncheckedAt(iTrkN2));
 	//printf("********** %d %d %d\n",postrack1->GetID(),negtrack1->GetID(),negtrack2->GetID());
 
-	dcap1n2 = postrack1->GetDCA(negtrack2,fBzkG,xdummy,ydummy);
+	dcap1n2 = GetPairDCA(postrack1,iTrkP1,negtrack2,iTrkN2);
 	if(dcap1n2>dcaMax) { negtrack2=0; continue; }
-	dcan1n2 = negtrack1->GetDCA(negtrack2,fBzkG,xdummy,ydummy);
+	dcan1n2 = GetPairDCA(negtrack1,iTrkN1,negtrack2,iTrkN2);
 	if(dcan1n2>dcaMax) { negtrack2=0; continue; }
 
 	threeTrackArray->AddAt(negtrack1,0);
 	threeTrackArray->AddAt(postrack1,1);
 	threeTrackArray->AddAt(negtrack2,2);
 
-	// check invariant mass cuts for D+,Ds,Lc
-        massCutOK=kTRUE;
-	if(fMassCutBeforeVertexing && f3Prong){
-	  negtrack2->GetPxPyPz(momneg2);
-	  Double_t pxDau[3]={momneg1[0],mompos1[0],momneg2[0]};
-	  Double_t pyDau[3]={momneg1[1],mompos1[1],momneg2[1]};
-	  Double_t pzDau[3]={momneg1[2],mompos1[2],momneg2[2]};
-	  //	  massCutOK = SelectInvMassAndPt3prong(threeTrackArray);
-	  massCutOK = SelectInvMassAndPt3prong(pxDau,pyDau,pzDau,pidLcStatus);
-	}
-	if(!massCutOK) {
-	  threeTrackArray->Clear();
-	  negtrack2=0;
-	  continue;
-	}
-
 	// Vertexing
 	twoTrackArray2->AddAt(postrack1,0);
 	twoTrackArray2->AddAt(negtrack2,1);
@@ -1494,42 +1772,6 @@ void AliAnalysisVertexingHF::FindCandidates(AliVEvent *event,
  }  // end 1st loop on positive tracks
 
 
-  //  AliDebug(1,Form(" Total HF vertices in event = %d;",
-  //		  (Int_t)aodVerticesHFTClArr->GetEntriesFast()));
-  if(fD0toKpi) {
-    AliDebug(1,Form(" D0->Kpi in event = %d;",
-		    (Int_t)aodD0toKpiTClArr->GetEntriesFast()));
-  }
-  if(fJPSItoEle) {
-    AliDebug(1,Form(" JPSI->ee in event = %d;",
-		    (Int_t)aodJPSItoEleTClArr->GetEntriesFast()));
-  }
-  if(f3Prong) {
-    AliDebug(1,Form(" Charm->3Prong in event = %d;",
-		    (Int_t)aodCharm3ProngTClArr->GetEntriesFast()));
-  }
-  if(f4Prong) {
-    AliDebug(1,Form(" Charm->4Prong in event = %d;\n",
-		    (Int_t)aodCharm4ProngTClArr->GetEntriesFast()));
-  }
-  if(fDstar) {
-    AliDebug(1,Form(" D*->D0pi in event = %d;\n",
-		    (Int_t)aodDstarTClArr->GetEntriesFast()));
-  }
-  if(fCascades){
-    AliDebug(1,Form(" cascades -> v0 + track in event = %d;\n",
-		    (Int_t)aodCascadesTClArr->GetEntriesFast()));
-  }
-  if(fLikeSign) {
-    AliDebug(1,Form(" Like-sign 2Prong in event = %d;\n",
-		    (Int_t)aodLikeSign2ProngTClArr->GetEntriesFast()));
-  }
-  if(fLikeSign3prong && f3Prong) {
-    AliDebug(1,Form(" Like-sign 3Prong in event = %d;\n",
-		    (Int_t)aodLikeSign3ProngTClArr->GetEntriesFast()));
-  }
-
-
   twoTrackArray1->Delete();  delete twoTrackArray1;
   twoTrackArray2->Delete();  delete twoTrackArray2;
   twoTrackArrayCasc->Delete();  delete twoTrackArrayCasc;
@@ -1537,21 +1779,273 @@ void AliAnalysisVertexingHF::FindCandidates(AliVEvent *event,
   threeTrackArray->Clear();
   threeTrackArray->Delete(); delete threeTrackArray;
   fourTrackArray->Delete();  delete fourTrackArray;
-  delete [] seleFlags; seleFlags=NULL;
-  if(evtNumber) {delete [] evtNumber; evtNumber=NULL;}
-  tracksAtVertex.Delete();
 
-  if(fInputAOD) {
-    seleTrksArray.Delete();
-    if(fAODMap) { delete [] fAODMap; fAODMap=NULL; }
+  return;
+}
+//----------------------------------------------------------------------------
+void AliAnalysisVertexingHF::MakeCandidatesThreaded(AliVEvent *event,
+						    Int_t trkEntries,Int_t nv0,
+						    const TObjArray &seleTrksArray,
+						    const TObjArray &tracksAtVertex,
+						    Int_t nSeleTrks,
+						    const UChar_t *seleFlags,
+						    const Int_t *evtNumber,
+						    TClonesArray **outArrays)
+{
+  /// Candidate loops on fNThreads threads.
+  /// The positive tracks of the 1st loop are split in chunks of
+  /// kNTrksPerThreadChunk tracks, each one taken by the next free thread.
+  /// Each thread uses its own copy of this object (cuts, vertexer) and of the
+  /// selected tracks, and stores the candidates in its own arrays. They are
+  /// then copied to the output arrays chunk after chunk, i.e. in the same
+  /// order as without threads, and the references between the vertices and
+  /// the candidates are moved to the copies.
+  /// The threads, the copies of this object and their arrays and track
+  /// buffers are kept from event to event. The PID response of the input
+  /// handler is shared by the cuts of all copies: its calls are serialized
+  /// in SetSelectionBitForPID, as it keeps per-event and per-track state.
+  //AliCodeTimerAuto("",0);
+
+  const Int_t nChunks = (nSeleTrks+kNTrksPerThreadChunk-1)/kNTrksPerThreadChunk;
+  const Int_t nThreads = TMath::Min(fNThreads,nChunks);
+
+  if(!fThreads) {
+    ROOT::EnableThreadSafety();
+    fThreads = new AliAnalysisVertexingHFThreads(fNThreads);
+  }
+  while((Int_t)fWorkers.size()<nThreads) {
+    fWorkers.push_back(MakeWorker());
+    for(Int_t iArr=0; iArr<kNOutputArrays; iArr++) fWorkerArrays.push_back(0);
+  }
+  for(Int_t iThread=0; iThread<nThreads; iThread++) {
+    fWorkers[iThread]->SetupWorker(*this,event);
+    for(Int_t iArr=0; iArr<kNOutputArrays; iArr++) {
+      TClonesArray *&array = fWorkerArrays[iThread*kNOutputArrays+iArr];
+      if(outArrays[iArr] && !array) array = new TClonesArray(outArrays[iArr]->GetClass()->GetName(),100);
+    }
+  }
+
+  // thread of each chunk and first, last+1 entries of the chunk in its arrays
+  std::vector<Int_t> chunkThread(nChunks);
+  std::vector<Int_t> chunkFirst(nChunks*kNOutputArrays),chunkLast(nChunks*kNOutputArrays);
+  std::atomic<Int_t> nextChunk(0);
+  fThreads->Run([&](Int_t iThread) {
+    if(iThread>=nThreads) return;
+    AliAnalysisVertexingHF *worker = fWorkers[iThread];
+    TClonesArray *arrays[kNOutputArrays];
+    for(Int_t iArr=0; iArr<kNOutputArrays; iArr++) {
+      arrays[iArr] = (outArrays[iArr] ? fWorkerArrays[iThread*kNOutputArrays+iArr] : 0);
+    }
+    worker->CopyTracksToWorker(seleTrksArray,tracksAtVertex,nSeleTrks);
+    for(Int_t iChunk=nextChunk++; iChunk<nChunks; iChunk=nextChunk++) {
+      Int_t *first = &chunkFirst[iChunk*kNOutputArrays];
+      Int_t *last = &chunkLast[iChunk*kNOutputArrays];
+      for(Int_t iArr=0; iArr<kNOutputArrays; iArr++) first[iArr] = (arrays[iArr] ? arrays[iArr]->GetEntriesFast() : 0);
+      Int_t firstTrkP1 = iChunk*kNTrksPerThreadChunk;
+      Int_t lastTrkP1 = TMath::Min(firstTrkP1+kNTrksPerThreadChunk,nSeleTrks);
+      worker->MakeCandidates(event,trkEntries,nv0,*worker->fWorkerTrks,*worker->fWorkerTrksAtVertex,
+			     nSeleTrks,seleFlags,evtNumber,firstTrkP1,lastTrkP1,arrays);
+      for(Int_t iArr=0; iArr<kNOutputArrays; iArr++) last[iArr] = (arrays[iArr] ? arrays[iArr]->GetEntriesFast() : 0);
+      chunkThread[iChunk] = iThread;
+    }
+  });
+
+  // copy the vertices and candidates to the output arrays, chunk after chunk
+  Int_t nOut[kNOutputArrays];
+  for(Int_t iArr=0; iArr<kNOutputArrays; iArr++) nOut[iArr] = (outArrays[iArr] ? outArrays[iArr]->GetEntriesFast() : 0);
+  std::map<const TObject*,TObject*> copies;
+  std::map<const TObject*,TObject*>::const_iterator it;
+  std::vector<TObject*> daughters;
+  for(Int_t iChunk=0; iChunk<nChunks; iChunk++) {
+    TClonesArray **arrays = &fWorkerArrays[chunkThread[iChunk]*kNOutputArrays];
+    const Int_t *first = &chunkFirst[iChunk*kNOutputArrays];
+    const Int_t *last = &chunkLast[iChunk*kNOutputArrays];
+    Int_t firstD0Out = nOut[kOutD0toKpi];
+    copies.clear();
+    for(Int_t iArr=0; iArr<kNOutputArrays; iArr++) {
+      for(Int_t i=first[iArr]; i<last[iArr]; i++) {
+	TObject *obj = arrays[iArr]->UncheckedAt(i);
+	if(iArr==kOutVerticesHF) {
+	  copies[obj] = new((*outArrays[iArr])[nOut[iArr]++])AliAODVertex(*(AliAODVertex*)obj);
+	} else {
+	  copies[obj] = CopyCandidate(*outArrays[iArr],nOut[iArr]++,(AliAODRecoDecayHF*)obj);
+	}
+      }
+    }
+    // parent and candidate daughters (D0 of the D*) of the vertices
+    for(Int_t i=first[kOutVerticesHF]; i<last[kOutVerticesHF]; i++) {
+      AliAODVertex *vtx = (AliAODVertex*)arrays[kOutVerticesHF]->UncheckedAt(i);
+      AliAODVertex *vtxCopy = (AliAODVertex*)copies[vtx];
+      it = copies.find(vtx->GetParent());
+      if(it!=copies.end()) vtxCopy->SetParent(it->second);
+      Int_t nDg = vtx->GetNDaughters();
+      Bool_t copiedDaughter = kFALSE;
+      daughters.resize(nDg);
+      for(Int_t iDg=0; iDg<nDg; iDg++) {
+	daughters[iDg] = vtx->GetDaughter(iDg);
+	it = copies.find(daughters[iDg]);
+	if(it!=copies.end()) { daughters[iDg] = it->second; copiedDaughter = kTRUE; }
+      }
+      if(copiedDaughter) {
+	vtxCopy->RemoveDaughters();
+	for(Int_t iDg=0; iDg<nDg; iDg++) vtxCopy->AddDaughter(daughters[iDg]);
+      }
+    }
+    // secondary vertex of the candidates
+    for(Int_t iArr=kOutD0toKpi; iArr<kNOutputArrays; iArr++) {
+      for(Int_t i=first[iArr]; i<last[iArr]; i++) {
+	AliAODRecoDecayHF *cand = (AliAODRecoDecayHF*)arrays[iArr]->UncheckedAt(i);
+	AliAODRecoDecayHF *candCopy = (AliAODRecoDecayHF*)copies[cand];
+	it = copies.find(cand->GetSecondaryVtx());
+	if(it!=copies.end()) candCopy->SetSecondaryVtx((AliAODVertex*)it->second);
+	if(iArr==kOutDstar && fMakeReducedRHF) {
+	  // the D0 is identified by its position in the D0toKpi array
+	  UShort_t idCasc[2]={candCopy->GetProngID(0),(UShort_t)(candCopy->GetProngID(1)-first[kOutD0toKpi]+firstD0Out)};
+	  candCopy->SetProngIDs(2,idCasc);
+	}
+      }
+    }
   }
 
+  for(Int_t iThread=0; iThread<nThreads; iThread++) {
+    for(Int_t i=0; i<kNPreselCounters; i++) fPreselCounters[i] += fWorkers[iThread]->fPreselCounters[i];
+    for(Int_t iArr=0; iArr<kNOutputArrays; iArr++) {
+      TClonesArray *array = fWorkerArrays[iThread*kNOutputArrays+iArr];
+      if(array) array->Delete();
+    }
+  }
 
-  //printf("Trks: total %d  sele %d\n",fnTrksTotal,fnSeleTrksTotal);
+  return;
+}
+//----------------------------------------------------------------------------
+AliAnalysisVertexingHF* AliAnalysisVertexingHF::MakeWorker() const
+{
+  /// Copy of this object for a thread of the candidate loops, with its own
+  /// cuts, vertexer and invariant mass calculators
+
+  AliAnalysisVertexingHF *worker = new AliAnalysisVertexingHF(*this);
+  worker->fNThreads = 1;
+  worker->fMakeReducedRHF = fMakeReducedRHF;
+  worker->fAODMap = 0;
+  worker->fV1 = 0;
+  worker->fV1AOD = 0;
+  worker->fVertexerTracks = new AliVertexerTracks(fBzkG);
+  // the single-track selection is done before starting the threads
+  worker->fTrackFilter = 0;
+  worker->fTrackFilter2prongCentral = 0;
+  worker->fTrackFilter3prongCentral = 0;
+  worker->fTrackFilterSoftPi = 0;
+  worker->fTrackFilterBachelor = 0;
+  worker->fCutsD0toKpi = (fCutsD0toKpi ? new AliRDHFCutsD0toKpi(*fCutsD0toKpi) : 0);
+  worker->fCutsJpsitoee = (fCutsJpsitoee ? new AliRDHFCutsJpsitoee(*fCutsJpsitoee) : 0);
+  worker->fCutsDplustoK0spi = (fCutsDplustoK0spi ? new AliRDHFCutsDplustoK0spi(*fCutsDplustoK0spi) : 0);
+  worker->fCutsDplustoKpipi = (fCutsDplustoKpipi ? new AliRDHFCutsDplustoKpipi(*fCutsDplustoKpipi) : 0);
+  worker->fCutsDstoK0sK = (fCutsDstoK0sK ? new AliRDHFCutsDstoK0sK(*fCutsDstoK0sK) : 0);
+  worker->fCutsDstoKKpi = (fCutsDstoKKpi ? new AliRDHFCutsDstoKKpi(*fCutsDstoKKpi) : 0);
+  worker->fCutsLctopKpi = (fCutsLctopKpi ? new AliRDHFCutsLctopKpi(*fCutsLctopKpi) : 0);
+  worker->fCutsLctoV0 = (fCutsLctoV0 ? new AliRDHFCutsLctoV0(*fCutsLctoV0) : 0);
+  worker->fCutsD0toKpipipi = (fCutsD0toKpipipi ? new AliRDHFCutsD0toKpipipi(*fCutsD0toKpipipi) : 0);
+  worker->fCutsDStartoKpipi = (fCutsDStartoKpipi ? new AliRDHFCutsDStartoKpipi(*fCutsDStartoKpipi) : 0);
+  Double_t d02[2]={0.,0.};
+  Double_t d03[3]={0.,0.,0.};
+  Double_t d04[4]={0.,0.,0.,0.};
+  worker->fMassCalc2 = new AliAODRecoDecay(0x0,2,0,d02);
+  worker->fMassCalc3 = new AliAODRecoDecay(0x0,3,1,d03);
+  worker->fMassCalc4 = new AliAODRecoDecay(0x0,4,0,d04);
+
+  return worker;
+}
+//----------------------------------------------------------------------------
+void AliAnalysisVertexingHF::SetupWorker(const AliAnalysisVertexingHF &master,
+					 AliVEvent *event)
+{
+  /// Copy the event quantities of the master needed by the candidate loops
+  /// (primary vertex, AOD track map, preselection) and set up the cuts
+
+  fInputAOD = master.fInputAOD;
+  fBzkG = master.fBzkG;
+  if(fVertexerTracks->GetFieldkG()!=fBzkG) fVertexerTracks->SetFieldkG(fBzkG);
+  if(fV1) { delete fV1; fV1=0; }
+  if(fV1AOD) { delete fV1AOD; fV1AOD=0; }
+  if(master.fV1) fV1 = new AliESDVertex(*master.fV1);
+  if(master.fV1AOD) fV1AOD = new AliAODVertex(*master.fV1AOD);
+  if(fAODMap) { delete [] fAODMap; fAODMap=0; }
+  fAODMapSize = master.fAODMapSize;
+  if(master.fAODMap) {
+    fAODMap = new Int_t[fAODMapSize];
+    memcpy(fAODMap,master.fAODMap,sizeof(Int_t)*fAODMapSize);
+  }
+
+  fMaxMass3Prong = master.fMaxMass3Prong;
+  fMaxMass4Prong = master.fMaxMass4Prong;
+  fPxAtVtx = master.fPxAtVtx;
+  fPyAtVtx = master.fPyAtVtx;
+  fPzAtVtx = master.fPzAtVtx;
+  fnTrksPairDCACache = master.fnTrksPairDCACache;
+  fPairDCACacheIndex = master.fPairDCACacheIndex;
+  fPairDCACache.clear();
+  for(Int_t i=0; i<kNPreselCounters; i++) fPreselCounters[i]=0;
+
+  // same event selection + PID configuration as the master
+  fCutsD0toKpi->IsEventSelected(event);
+  if(fCutsJpsitoee) fCutsJpsitoee->SetupPID(event);
+  if(fCutsDplustoK0spi) fCutsDplustoK0spi->SetupPID(event);
+  if(fCutsDplustoKpipi) fCutsDplustoKpipi->SetupPID(event);
+  if(fCutsDstoK0sK) fCutsDstoK0sK->SetupPID(event);
+  if(fCutsDstoKKpi) fCutsDstoKKpi->SetupPID(event);
+  if(fCutsLctopKpi) fCutsLctopKpi->SetupPID(event);
+  if(fCutsLctoV0) fCutsLctoV0->SetupPID(event);
+  if(fCutsD0toKpipipi) fCutsD0toKpipipi->SetupPID(event);
+  if(fCutsDStartoKpipi) fCutsDStartoKpipi->SetupPID(event);
 
   return;
 }
 //----------------------------------------------------------------------------
+void AliAnalysisVertexingHF::CopyTracksToWorker(const TObjArray &seleTrksArray,
+						const TObjArray &tracksAtVertex,
+						Int_t nSeleTrks)
+{
+  /// The parameters of the tracks are changed by the candidate loops, so
+  /// each worker uses its own copies. The copies of the previous events
+  /// are overwritten, new ones are only created for additional tracks.
+
+  if(!fWorkerTrks) {
+    fWorkerTrks = new TObjArray(nSeleTrks);
+    fWorkerTrks->SetOwner(kTRUE);
+    fWorkerTrksAtVertex = new TObjArray(nSeleTrks);
+    fWorkerTrksAtVertex->SetOwner(kTRUE);
+  }
+  const Int_t nCopies = fWorkerTrks->GetEntriesFast();
+  for(Int_t iTrk=0; iTrk<nSeleTrks; iTrk++) {
+    const AliESDtrack *trk = (const AliESDtrack*)seleTrksArray.UncheckedAt(iTrk);
+    const AliExternalTrackParam *trkAtVertex = (const AliExternalTrackParam*)tracksAtVertex.UncheckedAt(iTrk);
+    if(iTrk<nCopies) {
+      *(AliESDtrack*)fWorkerTrks->UncheckedAt(iTrk) = *trk;
+      *(AliExternalTrackParam*)fWorkerTrksAtVertex->UncheckedAt(iTrk) = *trkAtVertex;
+    } else {
+      fWorkerTrks->AddLast(new AliESDtrack(*trk));
+      fWorkerTrksAtVertex->AddLast(new AliExternalTrackParam(*trkAtVertex));
+    }
+  }
+
+  return;
+}
+//----------------------------------------------------------------------------
+AliAODRecoDecayHF* AliAnalysisVertexingHF::CopyCandidate(TClonesArray &array,Int_t i,
+							  const AliAODRecoDecayHF *cand) const
+{
+  /// Copy of the candidate at position i of array
+
+  if(cand->IsA()==AliAODRecoCascadeHF::Class()) {
+    return new(array[i])AliAODRecoCascadeHF(*(const AliAODRecoCascadeHF*)cand);
+  } else if(cand->IsA()==AliAODRecoDecayHF4Prong::Class()) {
+    return new(array[i])AliAODRecoDecayHF4Prong(*(const AliAODRecoDecayHF4Prong*)cand);
+  } else if(cand->IsA()==AliAODRecoDecayHF3Prong::Class()) {
+    return new(array[i])AliAODRecoDecayHF3Prong(*(const AliAODRecoDecayHF3Prong*)cand);
+  }
+  return new(array[i])AliAODRecoDecayHF2Prong(*(const AliAODRecoDecayHF2Prong*)cand);
+}
+//----------------------------------------------------------------------------
 void AliAnalysisVertexingHF::AddRefs(AliAODVertex *v,AliAODRecoDecayHF *rd,
 				     const AliVEvent *event,
 				     const TObjArray *trkArray) const
@@ -1699,69 +2193,57 @@ Bool_t AliAnalysisVertexingHF::FillRecoCand(AliVEvent *event,AliAODRecoDecayHF3P
   // method to retrieve daughters from trackID and reconstruct secondary vertex
   // save the TRefs to the candidate AliAODRecoDecayHF3Prong rd
   // and fill on-the-fly the data member of rd
+  // the copies of the daughters and the primary vertex are taken from the pools of AliHFRecoCandCache
+  AliHFRecoCandCache &cache = AliHFRecoCandCache::Instance();
+  if(cache.Lookup(event,rd)==AliHFRecoCandCache::kFilled) return kTRUE;//already refilled by this or another task
   if(rd->GetIsFilled()!=0)return kTRUE;//if 0: reduced dAOD. skip if rd is already filled (1: standard dAOD, 2 already refilled)
   if(!fAODMap)MapAODtracks(event);//fill the AOD index map if it is not yet done
-  TObjArray *threeTrackArray   = new TObjArray(3);
 
   AliAODTrack *track1 =(AliAODTrack*)event->GetTrack(fAODMap[rd->GetProngID(0)]);//retrieve daughter from the trackID through the AOD index map
   if(!track1)return kFALSE;
   AliAODTrack *track2 =(AliAODTrack*)event->GetTrack(fAODMap[rd->GetProngID(1)]);
   if(!track2)return kFALSE;
-  AliESDtrack *postrack1 = 0;
-  AliESDtrack *negtrack1 = 0;
-  postrack1 = new AliESDtrack(track1);
-  negtrack1 = new AliESDtrack(track2);
+  AliAODTrack *track3 =(AliAODTrack*)event->GetTrack(fAODMap[rd->GetProngID(2)]);
+  if(!track3)return kFALSE;
+  AliESDtrack *postrack1 = cache.GetESDtrack(0,track1);
+  AliESDtrack *negtrack1 = cache.GetESDtrack(1,track2);
+  AliESDtrack *esdt3 = cache.GetESDtrack(2,track3);
 
   // DCA between the two tracks
   Double_t xdummy, ydummy;
   fBzkG = (Double_t)event->GetMagneticField();
   Double_t dca12 = postrack1->GetDCA(negtrack1,fBzkG,xdummy,ydummy);
 
-  const AliVVertex *vprimary = event->GetPrimaryVertex();
-  Double_t pos[3];
-  Double_t cov[6];
-  vprimary->GetXYZ(pos);
-  vprimary->GetCovarianceMatrix(cov);
-  fV1 = new AliESDVertex(pos,cov,100.,100,vprimary->GetName());
-  fV1->GetCovMatrix(cov);
+  fV1 = cache.GetPrimaryVertex(event);
   if(!fVertexerTracks)fVertexerTracks=new AliVertexerTracks(fBzkG);
 
-  AliAODTrack *track3 =(AliAODTrack*)event->GetTrack(fAODMap[rd->GetProngID(2)]);
-  if(!track3)return kFALSE;
-  AliESDtrack *esdt3 = new AliESDtrack(track3);
-
   Double_t dca2;
   Double_t dca3;
-  threeTrackArray->AddAt(postrack1,0);
-  threeTrackArray->AddAt(negtrack1,1);
-  threeTrackArray->AddAt(esdt3,2);
+  TObjArray threeTrackArray(3);
+  threeTrackArray.AddAt(postrack1,0);
+  threeTrackArray.AddAt(negtrack1,1);
+  threeTrackArray.AddAt(esdt3,2);
   dca2 = esdt3->GetDCA(negtrack1,fBzkG,xdummy,ydummy);
   dca3 = esdt3->GetDCA(postrack1,fBzkG,xdummy,ydummy);
   Double_t dispersion;
 
-  AliAODVertex* secVert3PrAOD = ReconstructSecondaryVertex(threeTrackArray, dispersion);
+  AliAODVertex* secVert3PrAOD = ReconstructSecondaryVertex(&threeTrackArray, dispersion);
   if (!secVert3PrAOD) {
-    threeTrackArray->Clear();
-    threeTrackArray->Delete(); delete threeTrackArray;
-    delete fV1; fV1=0;
-    delete postrack1; postrack1=NULL;
-    delete negtrack1; negtrack1=NULL;
-    delete esdt3; esdt3=NULL;
+    fV1=0;
+    cache.ReleaseTracks();
+    cache.SetFilled(rd,kFALSE);
     return kFALSE;
   }
 
   rd->SetNProngs();
   Double_t vtxRec=rd->GetDist12toPrim();
   Double_t vertexp2n1=rd->GetDist23toPrim();
-  rd= Make3Prong(threeTrackArray, event, secVert3PrAOD,dispersion, vtxRec, vertexp2n1, dca12, dca2, dca3, rd);
+  rd= Make3Prong(&threeTrackArray, event, secVert3PrAOD,dispersion, vtxRec, vertexp2n1, dca12, dca2, dca3, rd);
   rd->SetPrimaryVtxRef((AliAODVertex*)event->GetPrimaryVertex());
   rd->SetIsFilled(2);
-  threeTrackArray->Clear();
-  threeTrackArray->Delete(); delete threeTrackArray;
-  delete fV1; fV1=0;
-  delete postrack1; postrack1=NULL;
-  delete negtrack1; negtrack1=NULL;
-  delete esdt3; esdt3=NULL;
+  fV1=0;
+  cache.ReleaseTracks();
+  cache.SetFilled(rd,kTRUE);
   return kTRUE;
 }
 //___________________________
@@ -1769,68 +2251,61 @@ Bool_t AliAnalysisVertexingHF::FillRecoCand(AliVEvent *event,AliAODRecoDecayHF2P
   // method to retrieve daughters from trackID and reconstruct secondary vertex
   // save the TRefs to the candidate AliAODRecoDecayHF2Prong rd
   // and fill on-the-fly the data member of rd
+  // the copies of the daughters and the primary vertex are taken from the pools of AliHFRecoCandCache
+  AliHFRecoCandCache &cache = AliHFRecoCandCache::Instance();
+  if(cache.Lookup(event,rd)==AliHFRecoCandCache::kFilled) return kTRUE;//already refilled by this or another task
   if(rd->GetIsFilled()!=0)return kTRUE;//if 0: reduced dAOD. skip if rd is already filled (1:standard dAOD, 2 already refilled)
   if(!fAODMap)MapAODtracks(event);//fill the AOD index map if it is not yet done
 
   Double_t dispersion;
-  TObjArray *twoTrackArray1    = new TObjArray(2);
 
   AliAODTrack *track1 =(AliAODTrack*)event->GetTrack(fAODMap[rd->GetProngID(0)]);//retrieve daughter from the trackID through the AOD index map
   if(!track1)return kFALSE;
   AliAODTrack *track2 =(AliAODTrack*)event->GetTrack(fAODMap[rd->GetProngID(1)]);
   if(!track2)return kFALSE;
 
-  AliESDtrack *esdt1 = 0;
-  AliESDtrack *esdt2 = 0;
-  esdt1 = new AliESDtrack(track1);
-  esdt2 = new AliESDtrack(track2);
+  AliESDtrack *esdt1 = cache.GetESDtrack(0,track1);
+  AliESDtrack *esdt2 = cache.GetESDtrack(1,track2);
 
-  twoTrackArray1->AddAt(esdt1,0);
-  twoTrackArray1->AddAt(esdt2,1);
+  TObjArray twoTrackArray1(2);
+  twoTrackArray1.AddAt(esdt1,0);
+  twoTrackArray1.AddAt(esdt2,1);
   // DCA between the two tracks
   Double_t xdummy, ydummy;
   fBzkG = (Double_t)event->GetMagneticField();
   Double_t dca12 = esdt1->GetDCA(esdt2,fBzkG,xdummy,ydummy);
-  const AliVVertex *vprimary = event->GetPrimaryVertex();
-  Double_t pos[3];
-  Double_t cov[6];
-  vprimary->GetXYZ(pos);
-  vprimary->GetCovarianceMatrix(cov);
-  fV1 = new AliESDVertex(pos,cov,100.,100,vprimary->GetName());
-  fV1->GetCovMatrix(cov);
+  fV1 = cache.GetPrimaryVertex(event);
   if(!fVertexerTracks)fVertexerTracks=new AliVertexerTracks(fBzkG);
 
 
-  AliAODVertex *vtxRec = ReconstructSecondaryVertex(twoTrackArray1, dispersion);
+  AliAODVertex *vtxRec = ReconstructSecondaryVertex(&twoTrackArray1, dispersion);
   if(!vtxRec) {
-    twoTrackArray1->Clear();
-    twoTrackArray1->Delete();  delete twoTrackArray1;
-    delete fV1; fV1=0;
-    delete esdt1; esdt1=NULL;
-    delete esdt2; esdt2=NULL;
+    fV1=0;
+    cache.ReleaseTracks();
+    cache.SetFilled(rd,kFALSE);
     return kFALSE;     }
   Bool_t okD0=kFALSE;
   Bool_t okJPSI=kFALSE;
   Bool_t okD0FromDstar=kFALSE;
   Bool_t refill =kTRUE;
   rd->SetNProngs();
-  rd= Make2Prong(twoTrackArray1, event, vtxRec, dca12, okD0, okJPSI, okD0FromDstar, kFALSE, refill, rd);
+  rd= Make2Prong(&twoTrackArray1, event, vtxRec, dca12, okD0, okJPSI, okD0FromDstar, kFALSE, refill, rd);
   rd->SetPrimaryVtxRef((AliAODVertex*)event->GetPrimaryVertex());
   rd->SetIsFilled(2);
-  delete fV1; fV1=0;
-  twoTrackArray1->Clear();
-  twoTrackArray1->Delete();  delete twoTrackArray1;
-  delete esdt1; esdt1=NULL;
-  delete esdt2; esdt2=NULL;
+  fV1=0;
+  cache.ReleaseTracks();
+  cache.SetFilled(rd,kTRUE);
   return kTRUE;
 }
 //----------------------------------------------------------------------------
 Bool_t AliAnalysisVertexingHF::FillRecoCasc(AliVEvent *event,AliAODRecoCascadeHF *rCasc, Bool_t DStar, Bool_t recoSecVtx){
   // method to retrieve daughters from trackID
   // and fill on-the-fly the data member of rCasc and their AliAODRecoDecayHF2Prong daughters
+  // the copies of the daughters and the primary vertex are taken from the pools of AliHFRecoCandCache
+  AliHFRecoCandCache &cache = AliHFRecoCandCache::Instance();
+  if(cache.Lookup(event,rCasc)==AliHFRecoCandCache::kFilled) return kTRUE;//already refilled by this or another task
   if(rCasc->GetIsFilled()!=0) return kTRUE;//if 0: reduced dAOD. skip if rd is already filled (1: standard dAOD, 2: already refilled)
   if(!fAODMap)MapAODtracks(event);//fill the AOD index map if it is not yet done
-  TObjArray *twoTrackArrayCasc    = new TObjArray(2);
 
   AliAODTrack *trackB =(AliAODTrack*)event->GetTrack(fAODMap[rCasc->GetProngID(0)]);//retrieve bachelor from the trackID through the AOD index map
   if(!trackB)return kFALSE;
@@ -1843,24 +2318,25 @@ Bool_t AliAnalysisVertexingHF::FillRecoCasc(AliVEvent *event,AliAODRecoCascadeHF
   if(DStar){
   TClonesArray *inputArrayD0=(TClonesArray*)event->GetList()->FindObject("D0toKpi");
   if(!inputArrayD0) return kFALSE;
-  trackD0=(AliAODRecoDecayHF2Prong*)inputArrayD0->At(rCasc->GetProngID(1)); 
+  trackD0=(AliAODRecoDecayHF2Prong*)inputArrayD0->At(rCasc->GetProngID(1));
   if(!trackD0)return kFALSE;
-  if(!FillRecoCand(event,trackD0)) return kFALSE; //fill missing info of the corresponding D0 daughter
-  
-  trackV0 = new AliNeutralTrackParam(trackD0);
+  if(!FillRecoCand(event,trackD0)) return kFALSE; //fill missing info of the corresponding D0 daughter (before taking tracks from the pools)
+
+  trackV0 = cache.GetNeutralTrack(0,trackD0);
 
   }else{//is a V0 candidate
     v0 = ((AliAODEvent*)event)->GetV0(rCasc->GetProngID(1));
     if(!v0) return kFALSE;
     // Define the V0 (neutral) track
     const AliVTrack *trackVV0 = dynamic_cast<const AliVTrack*>(v0);
-    if(trackVV0)  trackV0 = new AliNeutralTrackParam(trackVV0);
+    if(trackVV0)  trackV0 = cache.GetNeutralTrack(0,trackVV0);
   }
 
-  AliESDtrack *esdB = new AliESDtrack(trackB);
+  AliESDtrack *esdB = cache.GetESDtrack(0,trackB);
 
-  twoTrackArrayCasc->AddAt(esdB,0);
-  twoTrackArrayCasc->AddAt(trackV0,1);
+  TObjArray twoTrackArrayCasc(2);
+  twoTrackArrayCasc.AddAt(esdB,0);
+  twoTrackArrayCasc.AddAt(trackV0,1);
 
   fBzkG = (Double_t)event->GetMagneticField();
   const AliVVertex *vprimary = event->GetPrimaryVertex();
@@ -1868,8 +2344,7 @@ Bool_t AliAnalysisVertexingHF::FillRecoCasc(AliVEvent *event,AliAODRecoCascadeHF
   Double_t pos[3];
   Double_t cov[6];
   vprimary->GetXYZ(pos);
-  vprimary->GetCovarianceMatrix(cov);
-  fV1 = new AliESDVertex(pos,cov,100.,100,vprimary->GetName());
+  fV1 = cache.GetPrimaryVertex(event);
   fV1->GetCovMatrix(cov);
 
   Double_t dca = 0.;
@@ -1879,26 +2354,19 @@ Bool_t AliAnalysisVertexingHF::FillRecoCasc(AliVEvent *event,AliAODRecoCascadeHF
     Double_t dispersion, xdummy, ydummy;
     dca = esdB->GetDCA(trackV0,fBzkG,xdummy,ydummy);
     if (!fVertexerTracks) fVertexerTracks = new AliVertexerTracks(fBzkG);
-    vtxCasc = ReconstructSecondaryVertex(twoTrackArrayCasc,dispersion,kFALSE);
+    vtxCasc = ReconstructSecondaryVertex(&twoTrackArrayCasc,dispersion,kFALSE);
   } else {
     vtxCasc = new AliAODVertex(pos,cov,chi2perNDF,0x0,-1,AliAODVertex::kUndef,2);
   }
   if(!vtxCasc) {
-    twoTrackArrayCasc->Clear();
-    twoTrackArrayCasc->Delete();  delete twoTrackArrayCasc;
-    delete fV1; fV1=0;
-    delete esdB; esdB=NULL;
-    delete vtxCasc;vtxCasc=NULL;
-    trackB=NULL;
-    delete trackV0; trackV0=NULL;
-    if(!DStar){
-    v0=NULL;
-    }
+    fV1=0;
+    cache.ReleaseTracks();
+    cache.SetFilled(rCasc,kFALSE);
     return kFALSE;
   }
   vtxCasc->SetParent(rCasc);
   rCasc->SetSecondaryVtx(vtxCasc);
-  AddDaughterRefs(vtxCasc,(AliAODEvent*)event,twoTrackArrayCasc);
+  AddDaughterRefs(vtxCasc,(AliAODEvent*)event,&twoTrackArrayCasc);
   if(DStar)vtxCasc->AddDaughter(trackD0);
   else vtxCasc->AddDaughter(v0);
   rCasc->SetPrimaryVtxRef((AliAODVertex*)event->GetPrimaryVertex());
@@ -1913,15 +2381,12 @@ Bool_t AliAnalysisVertexingHF::FillRecoCasc(AliVEvent *event,AliAODRecoCascadeHF
   trackV0->GetPxPyPz(momentum);
   px[1] = momentum[0]; py[1] = momentum[1]; pz[1] = momentum[2];
 
-  AliAODVertex *primVertexAOD  = PrimaryVertex(twoTrackArrayCasc,event);
+  AliAODVertex *primVertexAOD  = PrimaryVertex(&twoTrackArrayCasc,event);
   if(!primVertexAOD){
-    delete fV1; fV1=0;
+    fV1=0;
     delete vtxCasc; vtxCasc=NULL;
-    twoTrackArrayCasc->Clear();
-    twoTrackArrayCasc->Delete();  delete twoTrackArrayCasc;
-    delete esdB; esdB=NULL;
-    delete trackV0; trackV0=NULL;
-    if(!DStar)v0=NULL;
+    cache.ReleaseTracks();
+    cache.SetFilled(rCasc,kFALSE);
     return kFALSE;
   }
   Double_t d0z0[2],covd0z0[3];
@@ -1950,13 +2415,10 @@ Bool_t AliAnalysisVertexingHF::FillRecoCasc(AliVEvent *event,AliAODRecoCascadeHF
   rCasc->SetIsFilled(2);
 
 
-  delete fV1; fV1=0;
+  fV1=0;
   if(primVertexAOD) {delete primVertexAOD; primVertexAOD=NULL;}
-  twoTrackArrayCasc->Clear();
-  twoTrackArrayCasc->Delete();  delete twoTrackArrayCasc;
-  delete esdB; esdB=NULL;
-  delete trackV0; trackV0=NULL;
-  if(!DStar)v0=NULL;
+  cache.ReleaseTracks();
+  cache.SetFilled(rCasc,kTRUE);
   return kTRUE;
 }
 //---------------------------------------------------------------------------
@@ -3437,6 +3899,140 @@ Bool_t AliAnalysisVertexingHF::SelectInvMassAndPtCascade(Double_t *px,
   return retval;
 }
 //-----------------------------------------------------------------------------
+void AliAnalysisVertexingHF::PrepareTrackPreselection(const TObjArray &tracksAtVertex,
+						      Int_t nSeleTrks,
+						      const UChar_t *seleFlags){
+  /// Prepare the preselection of the 3 and 4 prong track combinations:
+  /// store the momenta of the selected tracks at the primary vertex,
+  /// compute the upper limits of the invariant mass windows and reset
+  /// the cache of the DCAs between pairs of displaced tracks
+  //AliCodeTimerAuto("",0);
+
+  Double_t momentum[3];
+  fPxAtVtx.resize(nSeleTrks);
+  fPyAtVtx.resize(nSeleTrks);
+  fPzAtVtx.resize(nSeleTrks);
+  for(Int_t iTrk=0; iTrk<nSeleTrks; iTrk++){
+    ((AliExternalTrackParam*)tracksAtVertex.UncheckedAt(iTrk))->GetPxPyPz(momentum);
+    fPxAtVtx[iTrk] = momentum[0];
+    fPyAtVtx[iTrk] = momentum[1];
+    fPzAtVtx[iTrk] = momentum[2];
+  }
+
+  // the mass windows of the 3 prong candidates depend on the pt bin
+  fMaxMass3Prong=0.;
+  if(f3Prong){
+    for(Int_t iPt=0; iPt<TMath::Max(1,fCutsDplustoKpipi->GetNPtBins()); iPt++)
+      fMaxMass3Prong=TMath::Max(fMaxMass3Prong,fMassDplus+fCutsDplustoKpipi->GetMassCut(iPt));
+    for(Int_t iPt=0; iPt<TMath::Max(1,fCutsDstoKKpi->GetNPtBins()); iPt++)
+      fMaxMass3Prong=TMath::Max(fMaxMass3Prong,fMassDs+fCutsDstoKKpi->GetMassCut(iPt));
+    for(Int_t iPt=0; iPt<TMath::Max(1,fCutsLctopKpi->GetNPtBins()); iPt++)
+      fMaxMass3Prong=TMath::Max(fMaxMass3Prong,fMassLambdaC+fCutsLctopKpi->GetMassCut(iPt));
+  }
+  fMaxMass4Prong=0.;
+  if(f4Prong) fMaxMass4Prong=fMassDzero+fCutsD0toKpipipi->GetMassCut();
+
+  // the DCAs between pairs of displaced tracks are needed several times
+  // in the loops of the 3 and 4 prong candidates
+  fnTrksPairDCACache=0;
+  fPairDCACacheIndex.assign(nSeleTrks,-1);
+  fPairDCACache.clear();
+  if(!f3Prong && !f4Prong) return;
+  Int_t nDispl=0;
+  for(Int_t iTrk=0; iTrk<nSeleTrks; iTrk++){
+    if(TESTBIT(seleFlags[iTrk],kBitDispl)) nDispl++;
+  }
+  if(nDispl>kMaxTrksPairDCACache) return;
+  for(Int_t iTrk=0; iTrk<nSeleTrks; iTrk++){
+    if(TESTBIT(seleFlags[iTrk],kBitDispl)) fPairDCACacheIndex[iTrk]=fnTrksPairDCACache++;
+  }
+
+  return;
+}
+//-----------------------------------------------------------------------------
+void AliAnalysisVertexingHF::GetMomentaAtVertex(Int_t nprongs,const Int_t *iTrk,
+						Double_t *px,Double_t *py,Double_t *pz) const {
+  /// Momenta at the primary vertex of the selected tracks iTrk.
+  /// They are used for all the mass preselections of the 3 and 4 prong
+  /// candidates: the momentum of the first track is no more taken from its
+  /// current parameters, which could be still those propagated to the
+  /// secondary vertex of a previous candidate, so that the preselection does
+  /// not depend on the loop history (and on the splitting of the loops
+  /// among threads) and the lower bounds of MinInvMass hold
+  for(Int_t i=0; i<nprongs; i++){
+    px[i] = fPxAtVtx[iTrk[i]];
+    py[i] = fPyAtVtx[iTrk[i]];
+    pz[i] = fPzAtVtx[iTrk[i]];
+  }
+  return;
+}
+//-----------------------------------------------------------------------------
+Double_t AliAnalysisVertexingHF::MinInvMass(Int_t nprongs,const Int_t *iTrk) const {
+  /// Invariant mass of the selected tracks iTrk at the primary vertex, with
+  /// the pion mass for all of them. It is a lower bound of the invariant
+  /// mass for any other mass hypothesis, and of the invariant mass of any
+  /// combination including these tracks plus the pion mass for each
+  /// additional track.
+  Double_t energy=0.,px=0.,py=0.,pz=0.;
+  for(Int_t i=0; i<nprongs; i++){
+    Double_t pxi=fPxAtVtx[iTrk[i]], pyi=fPyAtVtx[iTrk[i]], pzi=fPzAtVtx[iTrk[i]];
+    energy += TMath::Sqrt(fMassPion*fMassPion+pxi*pxi+pyi*pyi+pzi*pzi);
+    px += pxi; py += pyi; pz += pzi;
+  }
+  Double_t minv2=energy*energy-(px*px+py*py+pz*pz);
+  return minv2>0. ? TMath::Sqrt(minv2) : 0.;
+}
+//-----------------------------------------------------------------------------
+Double_t AliAnalysisVertexingHF::GetPairDCA(AliESDtrack *trk1,Int_t iTrk1,
+					    AliESDtrack *trk2,Int_t iTrk2){
+  /// DCA between the selected tracks iTrk1 and iTrk2, both with the
+  /// parameters at the primary vertex. The value is taken from the cache
+  /// if it was already computed in this event. The loops always request
+  /// a given pair in the same order (positive before negative, same-sign
+  /// tracks by their loop), so one entry per pair is enough.
+  fPreselCounters[kPreselDCARequests]++;
+  Double_t *cached=0x0;
+  if(fnTrksPairDCACache>0){
+    Int_t i1=fPairDCACacheIndex[iTrk1], i2=fPairDCACacheIndex[iTrk2];
+    if(i1>=0 && i2>=0 && i1!=i2){
+      if(fPairDCACache.empty()) fPairDCACache.assign(fnTrksPairDCACache*(fnTrksPairDCACache-1)/2,-1.);
+      if(i1<i2) std::swap(i1,i2);
+      cached=&fPairDCACache[i1*(i1-1)/2+i2];
+      if(*cached>=0.) return *cached;
+    }
+  }
+  Double_t xdummy,ydummy;
+  Double_t dca=trk1->GetDCA(trk2,fBzkG,xdummy,ydummy);
+  fPreselCounters[kPreselDCAComputed]++;
+  if(cached) *cached=dca;
+  return dca;
+}
+//-----------------------------------------------------------------------------
+void AliAnalysisVertexingHF::PrintPreselectionStatus() const {
+  /// Print the rejection rates of the preselection of the 3 and 4 prong
+  /// track combinations, applied before the pair DCAs and the vertexing
+
+  const Long64_t *c=fPreselCounters;
+  printf("Preselection of the 3 and 4 prong track combinations:\n");
+  printf("  pairs for 3/4 prongs:   %lld, rejected %lld (%.1f%%)\n",
+	 c[kPreselPairs],c[kPreselPairsPruned],
+	 c[kPreselPairs]>0 ? 100.*c[kPreselPairsPruned]/c[kPreselPairs] : 0.);
+  printf("  D+,Ds,Lc triplets:      %lld, rejected %lld (%.1f%%)\n",
+	 c[kPresel3Prong],c[kPresel3ProngPruned],
+	 c[kPresel3Prong]>0 ? 100.*c[kPresel3ProngPruned]/c[kPresel3Prong] : 0.);
+  printf("  D0->Kpipipi triplets:   %lld, rejected %lld (%.1f%%)\n",
+	 c[kPresel4ProngTriplets],c[kPresel4ProngTripletsPruned],
+	 c[kPresel4ProngTriplets]>0 ? 100.*c[kPresel4ProngTripletsPruned]/c[kPresel4ProngTriplets] : 0.);
+  printf("  D0->Kpipipi quadruplets: %lld, rejected %lld (%.1f%%)\n",
+	 c[kPresel4Prong],c[kPresel4ProngPruned],
+	 c[kPresel4Prong]>0 ? 100.*c[kPresel4ProngPruned]/c[kPresel4Prong] : 0.);
+  printf("  pair DCAs:              %lld, computed %lld (%.1f%% from cache)\n",
+	 c[kPreselDCARequests],c[kPreselDCAComputed],
+	 c[kPreselDCARequests]>0 ? 100.*(c[kPreselDCARequests]-c[kPreselDCAComputed])/c[kPreselDCARequests] : 0.);
+
+  return;
+}
+//-----------------------------------------------------------------------------
 void AliAnalysisVertexingHF::SelectTracksAndCopyVertex(const AliVEvent *event,
 						       Int_t trkEntries,
 						       TObjArray &seleTrksArray,
@@ -3627,6 +4223,8 @@ void AliAnalysisVertexingHF::SetSelectionBitForPID(AliRDHFCuts *cuts,AliAODRecoD
   if(fUsePidTag && cuts->GetPidHF()) {
     Bool_t usepid=cuts->GetIsUsePID();
     cuts->SetUsePID(kTRUE);
+    // the PID response is shared by the threads of the candidate loops
+    std::lock_guard<std::mutex> lock(gPIDResponseMutex);
     if(cuts->IsSelectedPID(rd))
       rd->SetSelectionBit(bit);
     cuts->SetUsePID(usepid);
@@ -3785,6 +4383,7 @@ void AliAnalysisVertexingHF::SetMasses(){
   fMassJpsi=TDatabasePDG::Instance()->GetParticle(443)->Mass();
   fMassPhi=TDatabasePDG::Instance()->GetParticle(333)->Mass();
   fMassK=TDatabasePDG::Instance()->GetParticle(321)->Mass();
+  fMassPion=TDatabasePDG::Instance()->GetParticle(211)->Mass();
 }
 //-----------------------------------------------------------------------------
 Bool_t AliAnalysisVertexingHF::CheckCutsConsistency(){
@@ -13,6 +13,8 @@
 /// \author Contact: andrea.dainese@pd.infn.it
 //-------------------------------------------------------------------------
 
+#include <vector>
+
 #include <TNamed.h>
 #include <TList.h>
 
@@ -20,6 +22,7 @@
 #include "AliESDtrackCuts.h"
 
 class AliPIDResponse;
+class AliAnalysisVertexingHFThreads;
 class AliESDVertex;
 class AliAODRecoDecay;
 class AliAODRecoDecayHF;
@@ -73,6 +76,7 @@ class AliAnalysisVertexingHF : public TNamed {
   Bool_t FillRecoCasc(AliVEvent *event,AliAODRecoCascadeHF *rc,Bool_t isDStar,Bool_t recoSecVtx=kFALSE);
   Bool_t RecoSecondaryVertexForCascades(AliVEvent *event, AliAODRecoCascadeHF *rc);
   void PrintStatus() const;
+  void PrintPreselectionStatus() const;
   void SetSecVtxWithKF() { fSecVtxWithKF=kTRUE; }
   void SetD0toKpiOn() { fD0toKpi=kTRUE; }
   void SetD0toKpiOff() { fD0toKpi=kFALSE; }
@@ -179,6 +183,10 @@ class AliAnalysisVertexingHF : public TNamed {
   void SetCutsDStartoKpipi(AliRDHFCutsDStartoKpipi* cuts) { fCutsDStartoKpipi = cuts; }
   AliRDHFCutsDStartoKpipi* GetCutsDStartoKpipi() const { return fCutsDStartoKpipi; }
   void SetMassCutBeforeVertexing(Bool_t flag) { fMassCutBeforeVertexing=flag; }
+  /// Number of threads for the candidate loops of FindCandidates (AOD input
+  /// only). Each thread has its own copy of the cuts and its own vertexer
+  void SetNThreads(Int_t nThreads=1) { fNThreads=nThreads; }
+  Int_t GetNThreads() const { return fNThreads; }
 
   void SetMasses();
   Bool_t CheckCutsConsistency();
@@ -250,6 +258,15 @@ class AliAnalysisVertexingHF : public TNamed {
  private:
   //
   enum { kBitDispl = 0, kBitSoftPi = 1, kBit3Prong = 2, kBitPionCompat = 3, kBitKaonCompat = 4, kBitProtonCompat = 5, kBitBachelor = 6};
+  /// counters of the preselection of the 3 and 4 prong track combinations
+  enum { kPreselPairs = 0, kPreselPairsPruned, kPresel3Prong, kPresel3ProngPruned,
+	 kPresel4ProngTriplets, kPresel4ProngTripletsPruned, kPresel4Prong, kPresel4ProngPruned,
+	 kPreselDCARequests, kPreselDCAComputed, kNPreselCounters };
+  enum { kMaxTrksPairDCACache = 1000 }; /// max. number of displaced tracks for the cache of the pair DCAs (4 MB)
+  /// output arrays of the candidate loops
+  enum EOutputArray { kOutVerticesHF = 0, kOutD0toKpi, kOutJPSItoEle, kOutCharm3Prong, kOutCharm4Prong,
+		      kOutDstar, kOutCascades, kOutLikeSign2Prong, kOutLikeSign3Prong, kNOutputArrays };
+  enum { kNTrksPerThreadChunk = 4 }; /// number of positive tracks of the 1st loop taken at once by a thread
 
   Bool_t fInputAOD; /// input from AOD (kTRUE) or ESD (kFALSE)
   Int_t fAODMapSize; /// size of fAODMap
@@ -354,6 +371,25 @@ class AliAnalysisVertexingHF : public TNamed {
   Double_t fMassJpsi;
   Double_t fMassPhi;
   Double_t fMassK;
+  Double_t fMassPion;
+
+  // preselection of the 3 and 4 prong track combinations
+  Double_t fMaxMass3Prong; //!<! upper limit of the D+, Ds, Lc mass windows
+  Double_t fMaxMass4Prong; //!<! upper limit of the D0->Kpipipi mass window
+  std::vector<Double_t> fPxAtVtx; //!<! px of the selected tracks at the primary vertex
+  std::vector<Double_t> fPyAtVtx; //!<! py of the selected tracks at the primary vertex
+  std::vector<Double_t> fPzAtVtx; //!<! pz of the selected tracks at the primary vertex
+  Int_t fnTrksPairDCACache; //!<! number of tracks in the cache of the pair DCAs (0 = no cache)
+  std::vector<Int_t> fPairDCACacheIndex; //!<! index of the selected tracks in the cache (-1 = not cached)
+  std::vector<Double_t> fPairDCACache; //!<! DCA of the pairs of cached tracks, lower triangle, allocated at the first request of the event (<0 = not yet computed)
+  Long64_t fPreselCounters[kNPreselCounters]; //!<! counters of the preselection
+
+  Int_t fNThreads; /// number of threads for the candidate loops (1 = no threads)
+  std::vector<AliAnalysisVertexingHF*> fWorkers; //!<! copies of this object used by the threads
+  std::vector<TClonesArray*> fWorkerArrays; //!<! output arrays of the threads (kNOutputArrays per thread)
+  AliAnalysisVertexingHFThreads *fThreads; //!<! threads of the candidate loops, kept from event to event
+  TObjArray *fWorkerTrks; //!<! copies of the selected tracks used by a worker, kept from event to event
+  TObjArray *fWorkerTrksAtVertex; //!<! copies of the track parameters at the primary vertex used by a worker
 
   //
   void AddRefs(AliAODVertex *v,AliAODRecoDecayHF *rd,const AliVEvent *event,
@@ -402,6 +438,24 @@ class AliAnalysisVertexingHF : public TNamed {
   AliAODVertex* PrimaryVertex(const TObjArray *trkArray=0x0,AliVEvent *event=0x0) const;
   AliAODVertex* ReconstructSecondaryVertex(TObjArray *trkArray,Double_t &dispersion,Bool_t useTRefArray=kTRUE) const;
 
+  void MakeCandidates(AliVEvent *event,Int_t trkEntries,Int_t nv0,
+		      TObjArray &seleTrksArray,TObjArray &tracksAtVertex,
+		      Int_t nSeleTrks,const UChar_t *seleFlags,const Int_t *evtNumber,
+		      Int_t firstTrkP1,Int_t lastTrkP1,TClonesArray **outArrays);
+  void MakeCandidatesThreaded(AliVEvent *event,Int_t trkEntries,Int_t nv0,
+			      const TObjArray &seleTrksArray,const TObjArray &tracksAtVertex,
+			      Int_t nSeleTrks,const UChar_t *seleFlags,const Int_t *evtNumber,
+			      TClonesArray **outArrays);
+  AliAnalysisVertexingHF* MakeWorker() const;
+  void SetupWorker(const AliAnalysisVertexingHF &master,AliVEvent *event);
+  void CopyTracksToWorker(const TObjArray &seleTrksArray,const TObjArray &tracksAtVertex,Int_t nSeleTrks);
+  AliAODRecoDecayHF* CopyCandidate(TClonesArray &array,Int_t i,const AliAODRecoDecayHF *cand) const;
+
+  void PrepareTrackPreselection(const TObjArray &tracksAtVertex,Int_t nSeleTrks,const UChar_t *seleFlags);
+  void GetMomentaAtVertex(Int_t nprongs,const Int_t *iTrk,Double_t *px,Double_t *py,Double_t *pz) const;
+  Double_t MinInvMass(Int_t nprongs,const Int_t *iTrk) const;
+  Double_t GetPairDCA(AliESDtrack *trk1,Int_t iTrk1,AliESDtrack *trk2,Int_t iTrk2);
+
   Bool_t SelectInvMassAndPt3prong(Double_t *px,Double_t *py,Double_t *pz, Int_t pidLcStatus=3);
   Bool_t SelectInvMassAndPt4prong(Double_t *px,Double_t *py,Double_t *pz);
   Bool_t SelectInvMassAndPtD0Kpi(Double_t *px,Double_t *py,Double_t *pz);
@@ -429,7 +483,7 @@ class AliAnalysisVertexingHF : public TNamed {
 				  TObjArray *twoTrackArrayV0);
 
   /// \cond CLASSIMP
-  ClassDef(AliAnalysisVertexingHF,30);  // Reconstruction of HF decay candidates
+  ClassDef(AliAnalysisVertexingHF,33);  // Reconstruction of HF decay candidates
   /// \endcond
 };
 
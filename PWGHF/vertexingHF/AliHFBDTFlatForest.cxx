@@ -0,0 +1,451 @@
+/**************************************************************************
+ * Copyright(c) 1998-2020, ALICE Experiment at CERN, All rights reserved. *
+ *                                                                        *
+ * Author: The ALICE Off-line Project.                                    *
+ * Contributors are mentioned in the code where appropriate.              *
+ *                                                                        *
+ * Permission to use, copy, modify and distribute this software and its   *
+ * documentation strictly for non-commercial purposes is hereby granted   *
+ * without fee, provided that the above copyright notice appears in all   *
+ * copies and that both the copyright notice and this permission notice   *
+ * appear in the supporting documentation. The authors make no claims     *
+ * about the suitability of this software for any purpose. It is          *
+ * provided "as is" without express or implied warranty.                  *
+ **************************************************************************/
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+#include <TString.h>
+#include <TXMLEngine.h>
+
+#include "AliLog.h"
+#include "AliHFBDTFlatForest.h"
+
+/////////////////////////////////////////////////////////////////////////////
+/// \file AliHFBDTFlatForest.cxx
+/// Flat evaluator of TMVA BDT forests loaded from generated classes or XML
+/// weight files
+/////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+  //______________________________________________________________________________
+  // Minimal cursor over the text of a TMVA generated class
+  struct ClassFileCursor {
+    const char* fPos;
+    Bool_t fOk;
+
+    void SkipSpaces() {
+      while (*fPos==' ' || *fPos=='\t' || *fPos=='\n' || *fPos=='\r') ++fPos;
+    }
+    Bool_t Expect(char c) {
+      SkipSpaces();
+      if (*fPos!=c) { fOk=kFALSE; return kFALSE; }
+      ++fPos;
+      return kTRUE;
+    }
+    Double_t ReadNumber() {
+      SkipSpaces();
+      char* end=0x0;
+      // strtod rounds decimal literals exactly as the compiler does for the generated class
+      Double_t val=std::strtod(fPos,&end);
+      if (end==fPos) fOk=kFALSE;
+      fPos=end;
+      return val;
+    }
+    Bool_t StartsNode() {
+      SkipSpaces();
+      return std::strncmp(fPos,"NN(",3)==0;
+    }
+  };
+
+  //______________________________________________________________________________
+  // Read the XML attribute of a node as double
+  Double_t GetAttrDouble(TXMLEngine& xml, XMLNodePointer_t node, const char* name) {
+    const char* val=xml.GetAttr(node,name);
+    return val ? std::atof(val) : 0.;
+  }
+
+}
+
+//______________________________________________________________________________
+AliHFBDTFlatForest::AliHFBDTFlatForest() :
+  IClassifierReader(),
+  fFeature(),
+  fThreshold(),
+  fCutType(),
+  fLeft(),
+  fRight(),
+  fLeafValue(),
+  fRoot(),
+  fDepth(),
+  fBoostWeight(),
+  fNorm(0.),
+  fNVars(0),
+  fBoostType(kAdaBoost),
+  fTMVAReaderConvention(kFALSE),
+  fVarNames()
+{
+  /// Default constructor
+  fStatusIsClean=kFALSE;
+}
+
+//______________________________________________________________________________
+void AliHFBDTFlatForest::Reset(){
+  /// Remove the stored forest
+  fFeature.clear();
+  fThreshold.clear();
+  fCutType.clear();
+  fLeft.clear();
+  fRight.clear();
+  fLeafValue.clear();
+  fRoot.clear();
+  fDepth.clear();
+  fBoostWeight.clear();
+  fVarNames.clear();
+  fNorm=0.;
+  fNVars=0;
+  fBoostType=kAdaBoost;
+  fTMVAReaderConvention=kFALSE;
+  fStatusIsClean=kFALSE;
+}
+
+//______________________________________________________________________________
+Int_t AliHFBDTFlatForest::AddNode(Int_t feature, Double_t threshold, Bool_t cutType, Double_t leafValue, Bool_t isLeaf){
+  /// Append a node, leaves point to themselves so that a walk can run past them
+  Int_t index=(Int_t)fFeature.size();
+  fFeature.push_back(isLeaf ? 0 : feature);
+  fThreshold.push_back(threshold);
+  fCutType.push_back(cutType ? 1 : 0);
+  fLeft.push_back(index);
+  fRight.push_back(index);
+  fLeafValue.push_back(isLeaf ? leafValue : 0.);
+  if(!isLeaf && feature+1>fNVars) fNVars=feature+1;
+  return index;
+}
+
+//______________________________________________________________________________
+void AliHFBDTFlatForest::Finalise(){
+  /// Compute the normalisation in the same order as the TMVA readers
+  fNorm=0.;
+  for(size_t iTree=0; iTree<fBoostWeight.size(); iTree++) fNorm+=fBoostWeight[iTree];
+  if((Int_t)fVarNames.size()>fNVars) fNVars=(Int_t)fVarNames.size();
+  fStatusIsClean=(!fRoot.empty() && fRoot.size()==fBoostWeight.size());
+}
+
+//______________________________________________________________________________
+Bool_t AliHFBDTFlatForest::Load(const char* path){
+  /// Load the forest choosing the format from the file extension
+  TString name(path);
+  if(name.EndsWith(".xml")) return LoadFromXML(path);
+  if(name.EndsWith(".cxx") || name.EndsWith(".C")) return LoadFromClassFile(path);
+  AliErrorClass(Form("Unknown BDT file format for %s",path));
+  return kFALSE;
+}
+
+//______________________________________________________________________________
+Bool_t AliHFBDTFlatForest::LoadFromClassFile(const char* path){
+  /// Convert the forest of a TMVA generated class (NN(left, right, selector, cut, cutType, nodeType, purity, response))
+  Reset();
+  std::ifstream in(path);
+  if(!in.good()){
+    AliErrorClass(Form("Cannot open %s",path));
+    return kFALSE;
+  }
+  std::stringstream buffer;
+  buffer << in.rdbuf();
+  const std::string text=buffer.str();
+
+  ClassFileCursor cur;
+  cur.fPos=text.c_str();
+  cur.fOk=kTRUE;
+
+  // the nodes are written children first, so they are built with an explicit stack of (node, depth)
+  std::vector<Int_t> nodeStack;
+  std::vector<Int_t> depthStack;
+  const char* kWeight="fBoostWeights.push_back(";
+  const char* kTree="fForest.push_back(";
+  while(cur.fOk){
+    const char* nextWeight=std::strstr(cur.fPos,kWeight);
+    if(!nextWeight) break;
+    cur.fPos=nextWeight+std::strlen(kWeight);
+    fBoostWeight.push_back(cur.ReadNumber());
+    const char* nextTree=std::strstr(cur.fPos,kTree);
+    if(!nextTree){ cur.fOk=kFALSE; break; }
+    cur.fPos=nextTree+std::strlen(kTree);
+
+    // iterative descent: count the open NN( and pop the children when a node closes
+    nodeStack.clear();
+    depthStack.clear();
+    std::vector<Int_t> nChildren;
+    Int_t openNodes=0;
+    do {
+      if(cur.StartsNode()){
+        cur.fPos+=3;
+        nChildren.push_back(0);
+        openNodes++;
+        continue;
+      }
+      if(nChildren.empty()){ cur.fOk=kFALSE; break; }
+      if(nChildren.back()<2){
+        // the null child of a leaf
+        cur.ReadNumber();
+        cur.Expect(',');
+        nodeStack.push_back(-1);
+        depthStack.push_back(0);
+        nChildren.back()++;
+        continue;
+      }
+      Int_t selector=(Int_t)cur.ReadNumber(); cur.Expect(',');
+      Double_t cutValue=cur.ReadNumber(); cur.Expect(',');
+      Bool_t cutType=(cur.ReadNumber()!=0.); cur.Expect(',');
+      Int_t nodeType=(Int_t)cur.ReadNumber(); cur.Expect(',');
+      cur.ReadNumber(); cur.Expect(',');
+      cur.ReadNumber(); cur.Expect(')');
+      if(!cur.fOk) break;
+      Int_t right=nodeStack.back(); nodeStack.pop_back();
+      Int_t dRight=depthStack.back(); depthStack.pop_back();
+      Int_t left=nodeStack.back(); nodeStack.pop_back();
+      Int_t dLeft=depthStack.back(); depthStack.pop_back();
+      // GetMvaValue__ walks the tree while the node type is 0
+      Bool_t isLeaf=(nodeType!=0);
+      Int_t node=AddNode(selector,cutValue,cutType,(Double_t)nodeType,isLeaf);
+      Int_t depth=0;
+      if(!isLeaf){
+        if(left<0 || right<0){ cur.fOk=kFALSE; break; }
+        fLeft[node]=left;
+        fRight[node]=right;
+        depth=1+(dLeft>dRight ? dLeft : dRight);
+      }
+      nodeStack.push_back(node);
+      depthStack.push_back(depth);
+      nChildren.pop_back();
+      openNodes--;
+      if(!nChildren.empty()){
+        nChildren.back()++;
+        if(nChildren.back()<=2) cur.Expect(',');
+      }
+    } while(cur.fOk && openNodes>0);
+    if(!cur.fOk || nodeStack.size()!=1) break;
+    fRoot.push_back(nodeStack.back());
+    fDepth.push_back(depthStack.back());
+  }
+  if(!cur.fOk || fRoot.size()!=fBoostWeight.size()){
+    AliErrorClass(Form("Failed to parse the forest of %s (%d trees read)",path,(Int_t)fRoot.size()));
+    Reset();
+    return kFALSE;
+  }
+
+  // the input variable names are in the companion header, if available
+  TString header(path);
+  header.ReplaceAll(".cxx",".h");
+  std::ifstream inHeader(header.Data());
+  if(inHeader.good()){
+    std::stringstream hbuffer;
+    hbuffer << inHeader.rdbuf();
+    const std::string htext=hbuffer.str();
+    size_t start=htext.find("inputVars[] = {");
+    size_t stop=(start==std::string::npos) ? std::string::npos : htext.find("}",start);
+    if(stop!=std::string::npos){
+      TString list(htext.substr(start+15,stop-start-15).c_str());
+      TObjArray* tokens=list.Tokenize(",");
+      for(Int_t i=0; i<tokens->GetEntries(); i++){
+        TString var=tokens->At(i)->GetName();
+        var.ReplaceAll("\"","");
+        var=var.Strip(TString::kBoth,' ');
+        fVarNames.push_back(var.Data());
+      }
+      delete tokens;
+    }
+  }
+
+  fBoostType=kAdaBoost;
+  fTMVAReaderConvention=kFALSE;
+  Finalise();
+  return fStatusIsClean;
+}
+
+//______________________________________________________________________________
+Bool_t AliHFBDTFlatForest::LoadFromXML(const char* path){
+  /// Convert the forest stored in a TMVA XML weight file
+  Reset();
+  TXMLEngine xml;
+  XMLDocPointer_t doc=xml.ParseFile(path);
+  if(!doc){
+    AliErrorClass(Form("Cannot parse %s",path));
+    return kFALSE;
+  }
+  XMLNodePointer_t setup=xml.DocGetRootElement(doc);
+  Bool_t useYesNoLeaf=kTRUE;
+  Bool_t ok=kTRUE;
+
+  for(XMLNodePointer_t section=xml.GetChild(setup); section; section=xml.GetNext(section)){
+    TString sectionName=xml.GetNodeName(section);
+    if(sectionName=="Options"){
+      for(XMLNodePointer_t opt=xml.GetChild(section); opt; opt=xml.GetNext(opt)){
+        TString optName=xml.GetAttr(opt,"name");
+        TString content=xml.GetNodeContent(opt) ? xml.GetNodeContent(opt) : "";
+        if(optName=="BoostType") fBoostType=(content=="Grad") ? kGradBoost : kAdaBoost;
+        if(optName=="UseYesNoLeaf") useYesNoLeaf=(content=="True");
+      }
+    }
+    else if(sectionName=="Variables"){
+      for(XMLNodePointer_t var=xml.GetChild(section); var; var=xml.GetNext(var)){
+        const char* expr=xml.GetAttr(var,"Expression");
+        if(expr) fVarNames.push_back(expr);
+      }
+    }
+    else if(sectionName=="Weights"){
+      for(XMLNodePointer_t tree=xml.GetChild(section); tree && ok; tree=xml.GetNext(tree)){
+        XMLNodePointer_t rootNode=xml.GetChild(tree);
+        if(!rootNode){ ok=kFALSE; break; }
+        fBoostWeight.push_back(GetAttrDouble(xml,tree,"boostWeight"));
+
+        // depth-first conversion, children are appended after their parent
+        std::vector<XMLNodePointer_t> xmlStack(1,rootNode);
+        std::vector<Int_t> parentStack(1,-1);
+        std::vector<Bool_t> isRightStack(1,kFALSE);
+        std::vector<Int_t> depthStack(1,0);
+        Int_t treeDepth=0;
+        Int_t root=-1;
+        while(!xmlStack.empty()){
+          XMLNodePointer_t xnode=xmlStack.back(); xmlStack.pop_back();
+          Int_t parent=parentStack.back(); parentStack.pop_back();
+          Bool_t isRight=isRightStack.back(); isRightStack.pop_back();
+          Int_t depth=depthStack.back(); depthStack.pop_back();
+
+          Int_t nodeType=(Int_t)GetAttrDouble(xml,xnode,"nType");
+          Bool_t isLeaf=(nodeType!=0 || !xml.GetChild(xnode));
+          Double_t leafValue=0.;
+          if(fBoostType==kGradBoost) leafValue=GetAttrDouble(xml,xnode,"res");
+          else leafValue=useYesNoLeaf ? (Double_t)nodeType : GetAttrDouble(xml,xnode,"purity");
+          // TMVA::DecisionTreeNode stores the cut as Float_t
+          Float_t cutValue=(Float_t)GetAttrDouble(xml,xnode,"Cut");
+          Int_t node=AddNode((Int_t)GetAttrDouble(xml,xnode,"IVar"),(Double_t)cutValue,
+                             GetAttrDouble(xml,xnode,"cType")!=0.,leafValue,isLeaf);
+          if(parent<0) root=node;
+          else if(isRight) fRight[parent]=node;
+          else fLeft[parent]=node;
+          if(depth>treeDepth) treeDepth=depth;
+          if(isLeaf) continue;
+          for(XMLNodePointer_t child=xml.GetChild(xnode); child; child=xml.GetNext(child)){
+            TString pos=xml.GetAttr(child,"pos");
+            xmlStack.push_back(child);
+            parentStack.push_back(node);
+            isRightStack.push_back(pos=="r");
+            depthStack.push_back(depth+1);
+          }
+        }
+        fRoot.push_back(root);
+        fDepth.push_back(treeDepth);
+      }
+    }
+  }
+  xml.FreeDoc(doc);
+
+  if(!ok || fRoot.empty()){
+    AliErrorClass(Form("Failed to read the forest from %s",path));
+    Reset();
+    return kFALSE;
+  }
+  fTMVAReaderConvention=kTRUE;
+  Finalise();
+  return fStatusIsClean;
+}
+
+//______________________________________________________________________________
+Bool_t AliHFBDTFlatForest::CheckInputVariables(const std::vector<std::string>& inputVars){
+  /// Compare the input variables with the ones of the training (if known)
+  if((Int_t)inputVars.size()!=fNVars){
+    AliErrorClass(Form("Mismatch in number of input values: %d != %d",(Int_t)inputVars.size(),fNVars));
+    fStatusIsClean=kFALSE;
+    return kFALSE;
+  }
+  for(size_t iVar=0; iVar<fVarNames.size() && iVar<inputVars.size(); iVar++){
+    if(inputVars[iVar]!=fVarNames[iVar]){
+      AliErrorClass(Form("Mismatch in input variable names for variable [%d]: %s != %s",
+                         (Int_t)iVar,inputVars[iVar].c_str(),fVarNames[iVar].c_str()));
+      fStatusIsClean=kFALSE;
+      return kFALSE;
+    }
+  }
+  return kTRUE;
+}
+
+//______________________________________________________________________________
+template<Bool_t kTMVAReader>
+void AliHFBDTFlatForest::Evaluate(const Double_t* inputValues, Int_t nCandidates, Double_t* outputValues) const{
+  /// Walk each tree for all the candidates; the per-candidate sum follows the tree order of the readers
+
+  const Int_t*    feature=fFeature.data();
+  const Double_t* threshold=fThreshold.data();
+  const UChar_t*  cutType=fCutType.data();
+  const Int_t*    left=fLeft.data();
+  const Int_t*    right=fRight.data();
+  const Double_t* leafValue=fLeafValue.data();
+  const Int_t nVars=fNVars;
+
+  for(Int_t iCand=0; iCand<nCandidates; iCand++) outputValues[iCand]=0.;
+
+  const Int_t nTrees=(Int_t)fRoot.size();
+  for(Int_t iTree=0; iTree<nTrees; iTree++){
+    const Int_t root=fRoot[iTree];
+    const Int_t depth=fDepth[iTree];
+    const Double_t weight=fBoostWeight[iTree];
+    for(Int_t iCand=0; iCand<nCandidates; iCand++){
+      const Double_t* x=inputValues+(size_t)iCand*nVars;
+      Int_t node=root;
+      for(Int_t iStep=0; iStep<depth; iStep++){
+        Bool_t above;
+        if(kTMVAReader) above=((Float_t)x[feature[node]]>=(Float_t)threshold[node]);
+        else above=(x[feature[node]]>threshold[node]);
+        const Bool_t goesRight=(above==(cutType[node]!=0));
+        node=goesRight ? right[node] : left[node];
+      }
+      if(fBoostType==kGradBoost) outputValues[iCand]+=leafValue[node];
+      else outputValues[iCand]+=weight*leafValue[node];
+    }
+  }
+
+  for(Int_t iCand=0; iCand<nCandidates; iCand++){
+    if(fBoostType==kGradBoost){
+      outputValues[iCand]=2./(1.+std::exp(-2.*outputValues[iCand]))-1.;
+    }
+    else if(kTMVAReader){
+      outputValues[iCand]=(fNorm>std::numeric_limits<double>::epsilon()) ? outputValues[iCand]/fNorm : 0.;
+    }
+    else {
+      outputValues[iCand]/=fNorm;
+    }
+  }
+}
+
+//______________________________________________________________________________
+void AliHFBDTFlatForest::GetMvaValues(const Double_t* inputValues, Int_t nCandidates, Double_t* outputValues) const{
+  /// Classifier response for a batch of candidates
+  if(!IsStatusClean()){
+    AliErrorClass("Cannot return classifier response because status is dirty");
+    for(Int_t iCand=0; iCand<nCandidates; iCand++) outputValues[iCand]=0.;
+    return;
+  }
+  if(fTMVAReaderConvention) Evaluate<kTRUE>(inputValues,nCandidates,outputValues);
+  else Evaluate<kFALSE>(inputValues,nCandidates,outputValues);
+}
+
+//______________________________________________________________________________
+double AliHFBDTFlatForest::GetMvaValue(const std::vector<double>& inputValues) const{
+  /// Classifier response for a single candidate
+  if((Int_t)inputValues.size()<fNVars){
+    AliErrorClass(Form("Too few input values: %d < %d",(Int_t)inputValues.size(),fNVars));
+    return 0.;
+  }
+  Double_t response=0.;
+  GetMvaValues(inputValues.data(),1,&response);
+  return response;
+}
@@ -0,0 +1,84 @@
+#ifndef ALIHFBDTFLATFOREST_H
+#define ALIHFBDTFLATFOREST_H
+
+/* Copyright(c) 1998-2020, ALICE Experiment at CERN, All rights reserved. *
+ * See cxx source for full Copyright notice                               */
+
+/////////////////////////////////////////////////////////////////////////////
+/// \class AliHFBDTFlatForest
+/// \brief Flat (struct-of-arrays) evaluator for TMVA BDT forests
+///
+/// Loads the forest either from a TMVA generated reader class
+/// (*.class.cxx, as the ones in PWGHF/vertexingHF/TMVA) or from the
+/// TMVA XML weight file, and stores all the nodes of all the trees in
+/// contiguous arrays (feature index, threshold, cut type, children, leaf
+/// value). Trees are walked a fixed number of steps with leaves pointing
+/// to themselves, so that the batch evaluation is a branch-light loop over
+/// candidates for each tree.
+///
+/// When loaded from a .class.cxx file the response is bit-identical to the
+/// GetMvaValue of the generated class (same cut values, same comparison,
+/// same summation order). When loaded from XML the TMVA::Reader convention
+/// is followed (float inputs and cuts, inclusive cut).
+///
+/// It implements IClassifierReader, so it can be used in place of the
+/// readers loaded from the compiled TMVA libraries.
+/////////////////////////////////////////////////////////////////////////////
+
+#include <string>
+#include <vector>
+#include <Rtypes.h>
+#include "IClassifierReader.h"
+
+class AliHFBDTFlatForest : public IClassifierReader {
+
+ public:
+
+  enum EBoostType {kAdaBoost=0, kGradBoost=1};
+
+  AliHFBDTFlatForest();
+  virtual ~AliHFBDTFlatForest() {}
+
+  /// load the forest from a TMVA generated class (.class.cxx) or from a TMVA XML weight file (.xml)
+  Bool_t Load(const char* path);
+  Bool_t LoadFromClassFile(const char* path);
+  Bool_t LoadFromXML(const char* path);
+
+  /// check the input variables against the ones used in the training, the status becomes dirty on mismatch
+  Bool_t CheckInputVariables(const std::vector<std::string>& inputVars);
+
+  /// classifier response for a single candidate
+  virtual double GetMvaValue(const std::vector<double>& inputValues) const;
+  /// classifier response for nCandidates candidates stored row-major (nCandidates x GetNVariables()) in inputValues;
+  /// outputValues is owned by the caller and must hold nCandidates values
+  void GetMvaValues(const Double_t* inputValues, Int_t nCandidates, Double_t* outputValues) const;
+
+  Int_t GetNTrees() const {return (Int_t)fRoot.size();}
+  Int_t GetNNodes() const {return (Int_t)fFeature.size();}
+  Int_t GetNVariables() const {return fNVars;}
+  const std::vector<std::string>& GetVariableNames() const {return fVarNames;}
+
+ private:
+
+  void Reset();
+  Int_t AddNode(Int_t feature, Double_t threshold, Bool_t cutType, Double_t leafValue, Bool_t isLeaf);
+  void Finalise();
+  template<Bool_t kTMVAReader> void Evaluate(const Double_t* inputValues, Int_t nCandidates, Double_t* outputValues) const;
+
+  std::vector<Int_t>    fFeature;     /// variable index used by each node (0 for leaves)
+  std::vector<Double_t> fThreshold;   /// cut value of each node
+  std::vector<UChar_t>  fCutType;     /// 1: right if value above cut, 0: right if value below cut
+  std::vector<Int_t>    fLeft;        /// left child of each node (the node itself for leaves)
+  std::vector<Int_t>    fRight;       /// right child of each node (the node itself for leaves)
+  std::vector<Double_t> fLeafValue;   /// value returned by the leaves (node type or purity or response)
+  std::vector<Int_t>    fRoot;        /// root node of each tree
+  std::vector<Int_t>    fDepth;       /// depth of each tree, i.e. number of steps to reach any leaf
+  std::vector<Double_t> fBoostWeight; /// boost weight of each tree
+  Double_t fNorm;                     /// sum of the boost weights, summed in tree order
+  Int_t fNVars;                       /// number of input variables
+  Int_t fBoostType;                   /// AdaBoost (weighted average of leaves) or gradient boost
+  Bool_t fTMVAReaderConvention;       /// use float inputs and inclusive cuts as TMVA::Reader (XML weights)
+  std::vector<std::string> fVarNames; /// names of the input variables (if known)
+};
+
+#endif
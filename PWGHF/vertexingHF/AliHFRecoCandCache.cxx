@@ -0,0 +1,185 @@
+/**************************************************************************
+ * Copyright(c) 1998-2008, ALICE Experiment at CERN, All rights reserved. *
+ *                                                                        *
+ * Author: The ALICE Off-line Project.                                    *
+ * Contributors are mentioned in the code where appropriate.              *
+ *                                                                        *
+ * Permission to use, copy, modify and distribute this software and its   *
+ * documentation strictly for non-commercial purposes is hereby granted   *
+ * without fee, provided that the above copyright notice appears in all   *
+ * copies and that both the copyright notice and this permission notice   *
+ * appear in the supporting documentation. The authors make no claims     *
+ * about the suitability of this software for any purpose. It is          *
+ * provided "as is" without express or implied warranty.                  *
+ **************************************************************************/
+
+/* $Id$ */
+
+//----------------------------------------------------------------------------
+//    Implementation of the class AliHFRecoCandCache
+//    Per-event state shared by the on-the-fly reconstruction of the
+//    candidates of reduced HF delta AODs
+//----------------------------------------------------------------------------
+
+#include <cstdio>
+#include <TTree.h>
+#include "AliAnalysisManager.h"
+#include "AliVEvent.h"
+#include "AliVVertex.h"
+#include "AliVTrack.h"
+#include "AliESDVertex.h"
+#include "AliESDtrack.h"
+#include "AliNeutralTrackParam.h"
+#include "AliAODRecoDecayHF.h"
+#include "AliHFRecoCandCache.h"
+
+/// \cond CLASSIMP
+ClassImp(AliHFRecoCandCache);
+/// \endcond
+
+//----------------------------------------------------------------------------
+AliHFRecoCandCache::AliHFRecoCandCache():
+TObject(),
+fEvent(0x0),
+fTree(0x0),
+fEntry(-1),
+fPrimaryVtx(0x0),
+fPrimaryVtxSet(kFALSE),
+fESDTracks("AliESDtrack",3),
+fNeutralTracks("AliNeutralTrackParam",1),
+fNHits(0),
+fNRecomputed(0),
+fNFailed(0)
+{
+  /// Default constructor (use Instance() to get the instance shared by the tasks)
+}
+//----------------------------------------------------------------------------
+AliHFRecoCandCache::~AliHFRecoCandCache()
+{
+  /// Destructor
+  PrintSummary();
+  fESDTracks.Delete();
+  fNeutralTracks.Delete();
+  delete fPrimaryVtx;
+}
+//----------------------------------------------------------------------------
+AliHFRecoCandCache& AliHFRecoCandCache::Instance()
+{
+  /// Instance of the analysis process
+
+  static AliHFRecoCandCache cache;
+  return cache;
+}
+//----------------------------------------------------------------------------
+void AliHFRecoCandCache::SetEvent(const AliVEvent *event)
+{
+  /// Clear the state if the event is not the one of the previous call.
+  /// The event is identified by the current entry of the analysis manager;
+  /// without analysis manager nothing is kept from one call to the next.
+
+  AliAnalysisManager *mgr = AliAnalysisManager::GetAnalysisManager();
+  Long64_t entry = (mgr ? mgr->GetCurrentEntry() : -1);
+  const TTree *tree = (mgr ? mgr->GetTree() : 0x0);
+  if(entry>=0 && entry==fEntry && tree==fTree && event==fEvent) return;
+
+  fEvent = event;
+  fTree = tree;
+  fEntry = entry;
+  fPrimaryVtxSet = kFALSE;
+
+  return;
+}
+//----------------------------------------------------------------------------
+AliHFRecoCandCache::ECandStatus AliHFRecoCandCache::Lookup(const AliVEvent *event,
+							   const AliAODRecoDecayHF *cand)
+{
+  /// kFilled if the candidate was already refilled (by this or another task)
+
+  SetEvent(event);
+  if(cand->GetIsFilled()==2) {
+    fNHits++;
+    return kFilled;
+  }
+  return kNotCached;
+}
+//----------------------------------------------------------------------------
+void AliHFRecoCandCache::SetFilled(const AliAODRecoDecayHF * /*cand*/,Bool_t ok)
+{
+  /// Count a reconstruction. Failures are only counted, not shared: the
+  /// next task may succeed with its own settings.
+
+  fNRecomputed++;
+  if(!ok) fNFailed++;
+
+  return;
+}
+//----------------------------------------------------------------------------
+AliESDVertex* AliHFRecoCandCache::GetPrimaryVertex(const AliVEvent *event)
+{
+  /// Primary vertex of the event as AliESDVertex, built once per event.
+  /// It stays owned by the cache.
+
+  SetEvent(event);
+  if(fPrimaryVtxSet) return fPrimaryVtx;
+
+  const AliVVertex *vprimary = event->GetPrimaryVertex();
+  Double_t pos[3];
+  Double_t cov[6];
+  vprimary->GetXYZ(pos);
+  vprimary->GetCovarianceMatrix(cov);
+  if(fPrimaryVtx) *fPrimaryVtx = AliESDVertex(pos,cov,100.,100,vprimary->GetName());
+  else fPrimaryVtx = new AliESDVertex(pos,cov,100.,100,vprimary->GetName());
+  fPrimaryVtxSet = kTRUE;
+
+  return fPrimaryVtx;
+}
+//----------------------------------------------------------------------------
+AliESDtrack* AliHFRecoCandCache::GetESDtrack(Int_t i,const AliVTrack *track)
+{
+  /// AliESDtrack copy of the daughter track in the slot i of the pool.
+  /// The previous track of the slot is destroyed, its memory is reused.
+
+  if(i<fESDTracks.GetEntriesFast() && fESDTracks.UncheckedAt(i)) fESDTracks.RemoveAt(i);
+  return new(fESDTracks[i]) AliESDtrack(track);
+}
+//----------------------------------------------------------------------------
+AliNeutralTrackParam* AliHFRecoCandCache::GetNeutralTrack(Int_t i,const AliVTrack *track)
+{
+  /// AliNeutralTrackParam of the neutral daughter in the slot i of the pool
+
+  if(i<fNeutralTracks.GetEntriesFast() && fNeutralTracks.UncheckedAt(i)) fNeutralTracks.RemoveAt(i);
+  return new(fNeutralTracks[i]) AliNeutralTrackParam(track);
+}
+//----------------------------------------------------------------------------
+void AliHFRecoCandCache::ReleaseTracks()
+{
+  /// Destroy the tracks of the pools, keeping their memory
+
+  fESDTracks.Delete();
+  fNeutralTracks.Delete();
+
+  return;
+}
+//----------------------------------------------------------------------------
+void AliHFRecoCandCache::Print(Option_t * /*option*/) const
+{
+  /// Print the counters
+
+  printf("On-the-fly HF candidate reconstruction: %llu candidates reconstructed (%llu failed), %llu found already filled\n",
+	 fNRecomputed,fNFailed,fNHits);
+
+  return;
+}
+//----------------------------------------------------------------------------
+void AliHFRecoCandCache::PrintSummary()
+{
+  /// Print the counters and reset them. Called by all the tasks of a train at
+  /// the end of the job: only the first one prints, the others find nothing
+  /// counted since.
+
+  if(fNHits==0 && fNRecomputed==0) return;
+  Print();
+  ResetCounters();
+
+  return;
+}
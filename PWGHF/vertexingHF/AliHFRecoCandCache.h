@@ -0,0 +1,87 @@
+#ifndef ALIHFRECOCANDCACHE_H
+#define ALIHFRECOCANDCACHE_H
+/* Copyright(c) 1998-2008, ALICE Experiment at CERN, All rights reserved. *
+ * See cxx source for full Copyright notice                               */
+
+/* $Id$ */
+
+//***********************************************************
+/// \class AliHFRecoCandCache
+/// \brief Per-event state shared by the on-the-fly reconstruction of the
+/// candidates of reduced HF delta AODs (AliAnalysisVertexingHF::FillRecoCand,
+/// AliAnalysisVertexingHF::FillRecoCasc)
+///
+/// The refilled secondary vertex and prong parameters are stored in the
+/// candidates of the delta AOD (GetIsFilled()==2), which are the same objects
+/// for all the tasks of a train: the look-up counts them as hits. Failed
+/// reconstructions are not shared: whether the refit fails depends on the
+/// settings of the calling task (AliAnalysisVertexingHF configuration,
+/// recoSecVtx of FillRecoCasc), so each task retries them.
+/// The AliESDtrack and AliNeutralTrackParam copies of the daughters and the
+/// primary vertex are taken from pools that are reset, not reallocated.
+///
+/// One instance per analysis process, see Instance(). The counters are
+/// printed by PrintSummary() at the end of the tasks (FinishTaskOutput), or
+/// when the instance is destroyed if no task printed them.
+//***********************************************************
+
+#include <TObject.h>
+#include <TClonesArray.h>
+
+class TTree;
+class AliVEvent;
+class AliVTrack;
+class AliESDtrack;
+class AliESDVertex;
+class AliNeutralTrackParam;
+class AliAODRecoDecayHF;
+
+class AliHFRecoCandCache : public TObject {
+ public:
+
+  enum ECandStatus {kNotCached=0, kFilled};
+
+  AliHFRecoCandCache();
+  virtual ~AliHFRecoCandCache();
+
+  static AliHFRecoCandCache& Instance();
+
+  ECandStatus Lookup(const AliVEvent *event,const AliAODRecoDecayHF *cand);
+  void SetFilled(const AliAODRecoDecayHF *cand,Bool_t ok);
+
+  AliESDVertex* GetPrimaryVertex(const AliVEvent *event);
+  AliESDtrack* GetESDtrack(Int_t i,const AliVTrack *track);
+  AliNeutralTrackParam* GetNeutralTrack(Int_t i,const AliVTrack *track);
+  void ReleaseTracks();
+
+  ULong64_t GetNHits() const {return fNHits;}
+  ULong64_t GetNRecomputed() const {return fNRecomputed;}
+  ULong64_t GetNFailed() const {return fNFailed;}
+  void ResetCounters() {fNHits=0; fNRecomputed=0; fNFailed=0;}
+  virtual void Print(Option_t *option="") const;
+  void PrintSummary();
+
+ private:
+
+  AliHFRecoCandCache(const AliHFRecoCandCache& source);
+  AliHFRecoCandCache& operator=(const AliHFRecoCandCache& source);
+
+  void SetEvent(const AliVEvent *event);
+
+  const AliVEvent *fEvent; //!<! event of the cached state
+  const TTree *fTree;      //!<! input tree of the cached state
+  Long64_t fEntry;         //!<! entry of the cached state (-1: no analysis manager, nothing kept)
+  AliESDVertex *fPrimaryVtx; //!<! primary vertex of the event, for the refit
+  Bool_t fPrimaryVtxSet;   //!<! fPrimaryVtx filled for this event
+  TClonesArray fESDTracks; //!<! pool of AliESDtrack copies of the daughters
+  TClonesArray fNeutralTracks; //!<! pool of AliNeutralTrackParam (V0, D0 of the D*)
+  ULong64_t fNHits;        //!<! candidates found already filled
+  ULong64_t fNRecomputed;  //!<! candidates reconstructed
+  ULong64_t fNFailed;      //!<! candidates whose reconstruction failed
+
+  /// \cond CLASSIMP
+  ClassDef(AliHFRecoCandCache,2); // shared state of the on-the-fly HF candidate reconstruction
+  /// \endcond
+};
+
+#endif
@@ -31,6 +31,7 @@
 #include <TRandom3.h>
 #include <TGrid.h>
 #include <TFile.h>
+#include <TStopwatch.h>
 
 #include <AliVCluster.h>
 #include <AliVEvent.h>
@@ -45,6 +46,7 @@
 #include "AliEmcalJet.h"
 #include "AliEmcalParticle.h"
 #include "AliFJWrapper.h"
+#include "AliFJClusteringCache.h"
 #include "AliEmcalJetUtility.h"
 #include "AliParticleContainer.h"
 #include "AliClusterContainer.h"
@@ -98,6 +100,9 @@ AliEmcalJetTask::AliEmcalJetTask() :
   fEnableAliBasicParticleCompatibility(kFALSE),
   fLegacyMode(kFALSE),
   fFillGhost(kFALSE),
+  fUseSharedClustering(kFALSE),
+  fNClusteringDone(0),
+  fNClusteringReused(0),
   fJets(0),
   fFastJetWrapper("AliEmcalJetTask","AliEmcalJetTask"),
   fClusterContainerIndexMap(),
@@ -140,6 +145,9 @@ AliEmcalJetTask::AliEmcalJetTask(const char *name) :
   fEnableAliBasicParticleCompatibility(kFALSE),
   fLegacyMode(kFALSE),
   fFillGhost(kFALSE),
+  fUseSharedClustering(kFALSE),
+  fNClusteringDone(0),
+  fNClusteringReused(0),
   fJets(0),
   fFastJetWrapper(name,name),
   fClusterContainerIndexMap(),
@@ -323,11 +331,55 @@ Int_t AliEmcalJetTask::FindJets()
   if (fFastJetWrapper.GetInputVectors().size() == 0) return 0;
 
   // run jet finder
-  fFastJetWrapper.Run();
+  if (fUseSharedClustering) RunClustering();
+  else fFastJetWrapper.Run();
 
   return fFastJetWrapper.GetInclusiveJets().size();
 }
 
+/**
+ * Runs the jet finder through the shared clustering cache (AliFJClusteringCache):
+ * if another jet finder already clustered the same input vectors with the same
+ * settings in this event, its cluster sequence is reused, otherwise the input is
+ * clustered and the result is stored in the cache for the following jet finders.
+ */
+void AliEmcalJetTask::RunClustering()
+{
+  AliFJClusteringCache& cache = AliFJClusteringCache::Instance();
+  std::string key = fFastJetWrapper.GetClusteringKey();
+  if (key.empty()) {
+    fFastJetWrapper.Run();
+    return;
+  }
+
+  std::shared_ptr<fastjet::ClusterSequenceArea> clustSeq = cache.Find(key, fFastJetWrapper.GetInputVectors());
+  if (clustSeq) {
+    AliDebug(2, "Reusing the clustering of another jet finder");
+    fFastJetWrapper.RunShared(clustSeq);
+    fNClusteringReused++;
+    return;
+  }
+
+  TStopwatch timer;
+  timer.Start();
+  fFastJetWrapper.RunShared(clustSeq);
+  timer.Stop();
+  cache.Store(key, fFastJetWrapper.GetInputVectors(), fFastJetWrapper.GetSharedClusterSequence(), timer.CpuTime());
+  fNClusteringDone++;
+}
+
+/**
+ * This method is called once at the end of the analysis on each worker.
+ * It reports the use of the shared clustering.
+ */
+void AliEmcalJetTask::FinishTaskOutput()
+{
+  if (!fUseSharedClustering) return;
+
+  AliInfo(Form("%s: clustering done in %llu events, reused from other jet finders in %llu events", GetName(), fNClusteringDone, fNClusteringReused));
+  AliFJClusteringCache::Instance().Print();
+}
+
 /**
  * This method fills the jet output branch (TClonesArray) with the jet found by the FastJet
  * wrapper. Before filling the jet branch, the utilities are prepared. Then the utilities are
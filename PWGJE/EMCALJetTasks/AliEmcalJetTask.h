@@ -108,6 +108,7 @@ class AliEmcalJetTask : public AliAnalysisTaskEmcal {
   void                   SetLegacyMode(Bool_t mode)                 { if (IsLocked()) return; fLegacyMode       = mode  ; }
   void                   SetFillGhost(Bool_t b=kTRUE)               { if (IsLocked()) return; fFillGhost        = b     ; }
   void                   SetRadius(Double_t r)                      { if (IsLocked()) return; fRadius           = r     ; }
+  void                   SetUseSharedClustering(Bool_t b=kTRUE)     { if (IsLocked()) return; fUseSharedClustering = b  ; }
 
   void                   SetEtaRange(Double_t emi, Double_t ema);
   void                   SetMinJetClusPt(Double_t min);
@@ -134,6 +135,7 @@ class AliEmcalJetTask : public AliAnalysisTaskEmcal {
   Int_t                  GetRecombScheme()                { return fRecombScheme      ; }
   Double_t               GetTrackEfficiency()             { return fTrackEfficiency   ; }
   Bool_t                 GetTrackEfficiencyOnlyForEmbedding() { return fTrackEfficiencyOnlyForEmbedding; }
+  Bool_t                 GetUseSharedClustering()         { return fUseSharedClustering; }
 
   TClonesArray*          GetJets()                        { return fJets              ; }
   TObjArray*             GetUtilities()                   { return fUtilities         ; }
@@ -146,6 +148,7 @@ class AliEmcalJetTask : public AliAnalysisTaskEmcal {
   void                   LoadTrackEfficiencyFunction(const std::string & path, const std::string & name);
 
   Bool_t                 IsLocked() const;
+  void                   FinishTaskOutput();
   void                   SelectCollisionCandidates(UInt_t offlineTriggerMask = AliVEvent::kMB);
   void                   SetType(Int_t t);
 
@@ -183,6 +186,7 @@ class AliEmcalJetTask : public AliAnalysisTaskEmcal {
  protected:
 
   Int_t                  FindJets();
+  void                   RunClustering();
   void                   FillJetBranch();
   void                   ExecOnce();
   void                   InitEvent();
@@ -227,6 +231,9 @@ class AliEmcalJetTask : public AliAnalysisTaskEmcal {
   Bool_t                 fEnableAliBasicParticleCompatibility; ///< Flag to allow compatibility with AliBasicParticle constituents
   Bool_t                 fLegacyMode;             //!<!=true to enable FJ 2.x behavior
   Bool_t                 fFillGhost;              ///< =true ghost particles will be filled in AliEmcalJet obj
+  Bool_t                 fUseSharedClustering;    ///< =true reuse the clustering of other jet finders with the same settings and input (see AliFJClusteringCache)
+  ULong64_t              fNClusteringDone;        //!<!number of events clustered by this task
+  ULong64_t              fNClusteringReused;      //!<!number of events where the clustering of another task was reused
 
   TClonesArray          *fJets;                   //!<!jet collection
   AliFJWrapper           fFastJetWrapper;         //!<!fastjet wrapper
@@ -244,7 +251,7 @@ class AliEmcalJetTask : public AliAnalysisTaskEmcal {
   AliEmcalJetTask &operator=(const AliEmcalJetTask&); // not implemented
 
   /// \cond CLASSIMP
-  ClassDef(AliEmcalJetTask, 30);
+  ClassDef(AliEmcalJetTask, 31);
   /// \endcond
 };
 #endif
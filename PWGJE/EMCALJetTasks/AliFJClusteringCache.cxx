@@ -0,0 +1,165 @@
+/**************************************************************************************
+ * Copyright (C) 2016, Copyright Holders of the ALICE Collaboration                   *
+ * All rights reserved.                                                               *
+ *                                                                                    *
+ * Redistribution and use in source and binary forms, with or without                 *
+ * modification, are permitted provided that the following conditions are met:        *
+ *     * Redistributions of source code must retain the above copyright               *
+ *       notice, this list of conditions and the following disclaimer.                *
+ *     * Redistributions in binary form must reproduce the above copyright            *
+ *       notice, this list of conditions and the following disclaimer in the          *
+ *       documentation and/or other materials provided with the distribution.         *
+ *     * Neither the name of the <organization> nor the                               *
+ *       names of its contributors may be used to endorse or promote products         *
+ *       derived from this software without specific prior written permission.        *
+ *                                                                                    *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND    *
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED      *
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE             *
+ * DISCLAIMED. IN NO EVENT SHALL ALICE COLLABORATION BE LIABLE FOR ANY                *
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES         *
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;       *
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND        *
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT         *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS      *
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                       *
+ **************************************************************************************/
+#include <iostream>
+
+#include "AliFJClusteringCache.h"
+
+/**
+ * Access to the cache of the analysis process.
+ * @return The cache
+ */
+AliFJClusteringCache& AliFJClusteringCache::Instance()
+{
+  static AliFJClusteringCache cache;
+  return cache;
+}
+
+/**
+ * Default constructor.
+ */
+AliFJClusteringCache::AliFJClusteringCache() :
+  fEntries(),
+  fMaxEntriesPerKey(4),
+  fNUses(0),
+  fNHits(0),
+  fNMisses(0),
+  fTime(0.),
+  fTimeSaved(0.)
+{
+}
+
+/**
+ * Looks up the clustering of the input vectors with the settings key.
+ * @param key Clustering settings (AliFJWrapper::GetClusteringKey())
+ * @param input Input vectors
+ * @return The cluster sequence if the same input was already clustered with these settings, null otherwise
+ */
+std::shared_ptr<fastjet::ClusterSequenceArea> AliFJClusteringCache::Find(const std::string& key, const std::vector<fastjet::PseudoJet>& input)
+{
+  fNUses++;
+  std::map<std::string, KeyEntries>::iterator it = fEntries.find(key);
+  if (it == fEntries.end()) return std::shared_ptr<fastjet::ClusterSequenceArea>();
+
+  for (std::vector<Entry>::iterator entry = it->second.fEntries.begin(); entry != it->second.fEntries.end(); ++entry) {
+    if (!IsSameInput(*entry, input)) continue;
+    entry->fLastUse = fNUses;
+    it->second.fNHits++;
+    fNHits++;
+    fTimeSaved += entry->fTime;
+    return entry->fClustSeq;
+  }
+  return std::shared_ptr<fastjet::ClusterSequenceArea>();
+}
+
+/**
+ * Stores the clustering of the input vectors with the settings key.
+ * If fMaxEntriesPerKey clusterings are already kept for these settings, it replaces the least recently used one.
+ * @param key Clustering settings (AliFJWrapper::GetClusteringKey())
+ * @param input Input vectors
+ * @param clustSeq Cluster sequence of the input vectors
+ * @param time CPU time of the clustering (s)
+ */
+void AliFJClusteringCache::Store(const std::string& key, const std::vector<fastjet::PseudoJet>& input,
+                                 const std::shared_ptr<fastjet::ClusterSequenceArea>& clustSeq, Double_t time)
+{
+  fNUses++;
+  fNMisses++;
+  fTime += time;
+  KeyEntries& keyEntries = fEntries[key];
+  keyEntries.fNMisses++;
+  if (!clustSeq) return;
+
+  std::vector<Entry>& entries = keyEntries.fEntries;
+  std::vector<Entry>::iterator entry;
+  if (entries.size() < fMaxEntriesPerKey) {
+    entries.push_back(Entry());
+    entry = entries.end() - 1;
+  }
+  else {
+    entry = entries.begin();
+    for (std::vector<Entry>::iterator it = entries.begin(); it != entries.end(); ++it) {
+      if (it->fLastUse < entry->fLastUse) entry = it;
+    }
+  }
+
+  entry->fMomenta.resize(4 * input.size());
+  entry->fIndices.resize(input.size());
+  for (UInt_t i = 0; i < input.size(); i++) {
+    entry->fMomenta[4*i]   = input[i].px();
+    entry->fMomenta[4*i+1] = input[i].py();
+    entry->fMomenta[4*i+2] = input[i].pz();
+    entry->fMomenta[4*i+3] = input[i].E();
+    entry->fIndices[i]     = input[i].user_index();
+  }
+  entry->fClustSeq = clustSeq;
+  entry->fTime     = time;
+  entry->fLastUse  = fNUses;
+}
+
+/**
+ * Releases all the cluster sequences and resets the counters.
+ */
+void AliFJClusteringCache::Clear()
+{
+  fEntries.clear();
+  fNUses     = 0;
+  fNHits     = 0;
+  fNMisses   = 0;
+  fTime      = 0.;
+  fTimeSaved = 0.;
+}
+
+/**
+ * Prints the number of clusterings done and reused, per clustering settings.
+ */
+void AliFJClusteringCache::Print() const
+{
+  std::cout << "Shared jet clustering: " << fNMisses << " clusterings done (" << fTime << " s), "
+            << fNHits << " reused (" << fTimeSaved << " s saved)" << std::endl;
+  for (std::map<std::string, KeyEntries>::const_iterator it = fEntries.begin(); it != fEntries.end(); ++it) {
+    std::cout << "  " << it->first << ": " << it->second.fNMisses << " done, " << it->second.fNHits << " reused" << std::endl;
+  }
+}
+
+/**
+ * Checks that the input vectors are the ones of the stored clustering.
+ * @param entry Stored clustering
+ * @param input Input vectors
+ * @return kTRUE if all the momenta and user indices are the same
+ */
+Bool_t AliFJClusteringCache::IsSameInput(const Entry& entry, const std::vector<fastjet::PseudoJet>& input)
+{
+  if (entry.fIndices.size() != input.size()) return kFALSE;
+  for (UInt_t i = 0; i < input.size(); i++) {
+    if (entry.fIndices[i]     != input[i].user_index() ||
+        entry.fMomenta[4*i]   != input[i].px() ||
+        entry.fMomenta[4*i+1] != input[i].py() ||
+        entry.fMomenta[4*i+2] != input[i].pz() ||
+        entry.fMomenta[4*i+3] != input[i].E()) return kFALSE;
+  }
+  return kTRUE;
+}
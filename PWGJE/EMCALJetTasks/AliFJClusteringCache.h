@@ -0,0 +1,110 @@
+/**************************************************************************************
+ * Copyright (C) 2016, Copyright Holders of the ALICE Collaboration                   *
+ * All rights reserved.                                                               *
+ *                                                                                    *
+ * Redistribution and use in source and binary forms, with or without                 *
+ * modification, are permitted provided that the following conditions are met:        *
+ *     * Redistributions of source code must retain the above copyright               *
+ *       notice, this list of conditions and the following disclaimer.                *
+ *     * Redistributions in binary form must reproduce the above copyright            *
+ *       notice, this list of conditions and the following disclaimer in the          *
+ *       documentation and/or other materials provided with the distribution.         *
+ *     * Neither the name of the <organization> nor the                               *
+ *       names of its contributors may be used to endorse or promote products         *
+ *       derived from this software without specific prior written permission.        *
+ *                                                                                    *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND    *
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED      *
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE             *
+ * DISCLAIMED. IN NO EVENT SHALL ALICE COLLABORATION BE LIABLE FOR ANY                *
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES         *
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;       *
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND        *
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT         *
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS      *
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                       *
+ **************************************************************************************/
+#ifndef ALIFJCLUSTERINGCACHE_H
+#define ALIFJCLUSTERINGCACHE_H
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <Rtypes.h>
+
+#if !defined(__CINT__)
+
+#include "FJ_includes.h"
+
+/**
+ * @class AliFJClusteringCache
+ * @brief Cluster sequences shared between the jet finders of a train
+ * @ingroup PWGJEBASE
+ *
+ * Jet finder tasks (AliEmcalJetTask) with the same clustering settings
+ * (algorithm, R, recombination scheme, area definition) and the same input vectors
+ * produce the same cluster sequence, ghosts included. This happens in trains where
+ * several wagons add their own jet finders, e.g. the kT jet finders of the rho tasks.
+ * The jet finders with AliEmcalJetTask::SetUseSharedClustering() look up their
+ * clustering in this cache, and the first one of each event clusters and stores the result.
+ * The input vectors are compared exactly, so that a result is only reused for the same input
+ * (same input selection, same event). For each clustering settings, the last clusterings
+ * (one per input selection, see SetMaxEntriesPerKey()) are kept.
+ *
+ * The cache is a singleton (one per analysis process).
+ */
+class AliFJClusteringCache {
+ public:
+  static AliFJClusteringCache& Instance();
+
+  std::shared_ptr<fastjet::ClusterSequenceArea> Find(const std::string& key, const std::vector<fastjet::PseudoJet>& input);
+  void                   Store(const std::string& key, const std::vector<fastjet::PseudoJet>& input,
+                               const std::shared_ptr<fastjet::ClusterSequenceArea>& clustSeq, Double_t time);
+  void                   Clear();
+  void                   Print() const;
+
+  void                   SetMaxEntriesPerKey(UInt_t n)   { fMaxEntriesPerKey = n > 0 ? n : 1; }
+
+  ULong64_t              GetNHits()      const { return fNHits      ; }
+  ULong64_t              GetNMisses()    const { return fNMisses    ; }
+  Double_t               GetTime()       const { return fTime       ; }
+  Double_t               GetTimeSaved()  const { return fTimeSaved  ; }
+
+ protected:
+  /// Clustering stored for one set of settings
+  struct Entry {
+    std::vector<Double_t>  fMomenta;      ///< px, py, pz, E of the input vectors
+    std::vector<Int_t>     fIndices;      ///< user index of the input vectors
+    std::shared_ptr<fastjet::ClusterSequenceArea> fClustSeq; ///< cluster sequence of the input vectors
+    Double_t               fTime;         ///< CPU time of the clustering (s)
+    ULong64_t              fLastUse;      ///< value of fNUses at the last use
+  };
+  /// Clusterings stored for one set of settings
+  struct KeyEntries {
+    KeyEntries() : fEntries(), fNHits(0), fNMisses(0) {}
+    std::vector<Entry>     fEntries;      ///< last clusterings, one per input
+    ULong64_t              fNHits;        ///< number of reused clusterings
+    ULong64_t              fNMisses;      ///< number of clusterings done
+  };
+
+  AliFJClusteringCache();
+
+  static Bool_t          IsSameInput(const Entry& entry, const std::vector<fastjet::PseudoJet>& input);
+
+  std::map<std::string, KeyEntries> fEntries; ///< clusterings per settings
+  UInt_t                 fMaxEntriesPerKey; ///< maximum number of clusterings kept per settings
+  ULong64_t              fNUses;          ///< number of look-ups and stores
+  ULong64_t              fNHits;          ///< number of reused clusterings
+  ULong64_t              fNMisses;        ///< number of clusterings done
+  Double_t               fTime;           ///< CPU time of the clusterings done (s)
+  Double_t               fTimeSaved;      ///< CPU time of the reused clusterings (s)
+
+ private:
+  AliFJClusteringCache(const AliFJClusteringCache&);            // not implemented
+  AliFJClusteringCache &operator=(const AliFJClusteringCache&); // not implemented
+};
+
+#endif /*__CINT__*/
+#endif
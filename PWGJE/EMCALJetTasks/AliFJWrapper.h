@@ -1,6 +1,8 @@
 #ifndef AliFJWrapper_H
 #define AliFJWrapper_H
 
+#include <memory>
+#include <string>
 #include <vector>
 #include <TString.h>
 
@@ -28,6 +30,8 @@ class AliFJWrapper
   fastjet::ClusterSequenceArea*           GetClusterSequence() const   { return fClustSeq;                 }
   fastjet::ClusterSequence*               GetClusterSequenceSA() const { return fClustSeqSA;               }
   fastjet::ClusterSequenceActiveAreaExplicitGhosts* GetClusterSequenceGhosts() const { return fClustSeqActGhosts; }
+  const std::shared_ptr<fastjet::ClusterSequenceArea>& GetSharedClusterSequence() const { return fClustSeqShared; }
+  std::string                             GetClusteringKey()   const;
   const std::vector<fastjet::PseudoJet>&  GetInputVectors()    const { return fInputVectors;               }
   const std::vector<fastjet::PseudoJet>&  GetEventSubInputVectors()    const { return fEventSubInputVectors;               }
   const std::vector<fastjet::PseudoJet>&  GetInputGhosts()     const { return fInputGhosts;                }
@@ -88,6 +92,7 @@ class AliFJWrapper
   virtual void RemoveLastInputVector();
 
   virtual Int_t Run();
+  virtual Int_t RunShared(const std::shared_ptr<fastjet::ClusterSequenceArea>& clustSeq);
   virtual Int_t Filter();
   virtual void  DoGenericSubtraction(const fastjet::FunctionOfPseudoJet<Double32_t>& jetshape, std::vector<fastjet::contrib::GenericSubtractorInfo>& output);
   virtual Int_t DoGenericSubtractionJetMass();
@@ -169,6 +174,7 @@ class AliFJWrapper
   fastjet::Selector                     *fRange;              //!
 #endif
   fastjet::ClusterSequenceArea          *fClustSeq;           //!
+  std::shared_ptr<fastjet::ClusterSequenceArea> fClustSeqShared; //! owner of fClustSeq when it is shared with other wrappers
   fastjet::ClusterSequenceArea          *fClustSeqES;           //!
   fastjet::ClusterSequence              *fClustSeqSA;                //!
   fastjet::ClusterSequenceActiveAreaExplicitGhosts *fClustSeqActGhosts; //!
@@ -278,6 +284,7 @@ AliFJWrapper::AliFJWrapper(const char *name, const char *title)
   , fPlugin            (0)
   , fRange             (0)
   , fClustSeq          (0)
+  , fClustSeqShared    ( )
   , fClustSeqES        (0)
   , fClustSeqSA        (0)
   , fClustSeqActGhosts (0)
@@ -361,6 +368,7 @@ void AliFJWrapper::ClearMemory()
   if (fJetDef)            { delete fJetDef;            fJetDef          = NULL; }
   if (fPlugin)            { delete fPlugin;            fPlugin          = NULL; }
   if (fRange)             { delete fRange;             fRange           = NULL; }
+  if (fClustSeqShared)    { fClustSeqShared.reset();   fClustSeq        = NULL; }
   if (fClustSeq)          { delete fClustSeq;          fClustSeq        = NULL; }
   if (fClustSeqES)          { delete fClustSeqES;        fClustSeqES        = NULL; }
   if (fClustSeqSA)        { delete fClustSeqSA;        fClustSeqSA        = NULL; }
@@ -747,7 +755,8 @@ Int_t AliFJWrapper::Run()
   }
 
   try {
-    fClustSeq = new fj::ClusterSequenceArea(fInputVectors, *fJetDef, *fAreaDef);
+    if (fClustSeqShared) fClustSeq = fClustSeqShared.get(); // clustering of the same input done by another wrapper
+    else                 fClustSeq = new fj::ClusterSequenceArea(fInputVectors, *fJetDef, *fAreaDef);
     if(fEventSub){
       DoEventConstituentSubtraction();
       fClustSeqES = new fj::ClusterSequenceArea(fEventSubCorrectedVectors, *fJetDef, *fAreaDef);
@@ -773,6 +782,35 @@ Int_t AliFJWrapper::Run()
   return 0;
 }
 
+//_________________________________________________________________________________________________
+Int_t AliFJWrapper::RunShared(const std::shared_ptr<fj::ClusterSequenceArea>& clustSeq)
+{
+  // Run the jet finder with a cluster sequence that can be shared with other wrappers.
+  // If clustSeq is given, it must be the clustering of the same input vectors with the
+  // same settings (same GetClusteringKey()): it is used instead of clustering again.
+  // Otherwise the input is clustered and the result is available in GetSharedClusterSequence().
+  // The event-wise constituent subtraction is not shared.
+
+  if (fEventSub || GetClusteringKey().empty()) return Run();
+
+  fClustSeqShared = clustSeq;
+  Int_t ret = Run();
+  if (ret == 0 && !fClustSeqShared) fClustSeqShared.reset(fClustSeq);
+  return ret;
+}
+
+//_________________________________________________________________________________________________
+std::string AliFJWrapper::GetClusteringKey() const
+{
+  // Key of the settings that determine the cluster sequence of Run().
+  // Empty if the clustering cannot be shared (plugin algorithms).
+
+  if (fAlgor == fj::plugin_algorithm) return std::string();
+  return std::string(Form("algo=%d scheme=%d strategy=%d area=%d R=%.17g ghostArea=%.17g maxRap=%.17g repeats=%d gridScatter=%.17g ktScatter=%.17g meanGhostKt=%.17g",
+                          (Int_t)fAlgor, (Int_t)fScheme, (Int_t)fStrategy, (Int_t)fAreaType, fR, fGhostArea, fMaxRap,
+                          fNGhostRepeats, fGridScatter, fKtScatter, fMeanGhostKt));
+}
+
 //_________________________________________________________________________________________________
 Int_t AliFJWrapper::Filter()
 {
@@ -18,6 +18,8 @@
 #include <TVector3.h>
 #include <TStopwatch.h>
 #include <TParameter.h>
+#include <TObjArray.h>
+#include <TArrayD.h>
 #include <iostream>
 #include <iomanip>
 #include <cstring>
@@ -60,7 +62,15 @@ AliFMDDensityCalculator::AliFMDDensityCalculator()
     fDoTiming(false),
     fHTiming(0), 
     fMaxOutliers(0.05),
-    fOutlierCut(0.50)
+    fOutlierCut(0.50),
+    fWeightTableError(0),
+    fWeightTableStep(0.01),
+    fWeightTableMax(20),
+    fValidateWeightTable(false),
+    fWeightTableDeviation(0),
+    fWeightTableIndex(),
+    fWeightTable(),
+    fWeightTableExact()
 {
   // 
   // Constructor 
@@ -98,7 +108,15 @@ AliFMDDensityCalculator::AliFMDDensityCalculator(const char* title)
     fDoTiming(false),
     fHTiming(0), 
     fMaxOutliers(0.05),
-    fOutlierCut(0.50)
+    fOutlierCut(0.50),
+    fWeightTableError(0),
+    fWeightTableStep(0.01),
+    fWeightTableMax(20),
+    fValidateWeightTable(false),
+    fWeightTableDeviation(0),
+    fWeightTableIndex(),
+    fWeightTable(),
+    fWeightTableExact()
 {
   // 
   // Constructor 
@@ -167,7 +185,15 @@ AliFMDDensityCalculator::AliFMDDensityCalculator(const
     fDoTiming(o.fDoTiming),
     fHTiming(o.fHTiming), 
   fMaxOutliers(o.fMaxOutliers),
-  fOutlierCut(o.fOutlierCut)
+  fOutlierCut(o.fOutlierCut),
+  fWeightTableError(o.fWeightTableError),
+  fWeightTableStep(o.fWeightTableStep),
+  fWeightTableMax(o.fWeightTableMax),
+  fValidateWeightTable(o.fValidateWeightTable),
+  fWeightTableDeviation(o.fWeightTableDeviation),
+  fWeightTableIndex(o.fWeightTableIndex),
+  fWeightTable(o.fWeightTable),
+  fWeightTableExact(o.fWeightTableExact)
 {
   // 
   // Copy constructor 
@@ -232,6 +258,14 @@ AliFMDDensityCalculator::operator=(const AliFMDDensityCalculator& o)
   fHTiming            = o.fHTiming;
   fMaxOutliers        = o.fMaxOutliers;
   fOutlierCut         = o.fOutlierCut;
+  fWeightTableError   = o.fWeightTableError;
+  fWeightTableStep    = o.fWeightTableStep;
+  fWeightTableMax     = o.fWeightTableMax;
+  fValidateWeightTable= o.fValidateWeightTable;
+  fWeightTableDeviation = o.fWeightTableDeviation;
+  fWeightTableIndex   = o.fWeightTableIndex;
+  fWeightTable        = o.fWeightTable;
+  fWeightTableExact   = o.fWeightTableExact;
 
   fRingHistos.Delete();
   TIter    next(&o.fRingHistos);
@@ -251,6 +285,7 @@ AliFMDDensityCalculator::SetupForData(const TAxis& axis)
   //   etaAxis   Eta axis
   DGUARD(fDebug, 1, "Initialize FMD density calculator");
   CacheMaxWeights(axis);
+  CacheWeightTables();
  
   fCache.Init(axis);
 
@@ -835,6 +870,174 @@ AliFMDDensityCalculator::GetMaxWeight(UShort_t d, Char_t r, Float_t eta) const
   return GetMaxWeight(d, r, iEta);
 }
 
+//_____________________________________________________________________
+void
+AliFMDDensityCalculator::CacheWeightTables()
+{
+  // 
+  // Tabulate the weighted number of particles for each ring and eta
+  // bin with a fit.  Eta bins using the same fit and maximum weight
+  // share the same table.
+  //
+  // Each table holds the values and slopes (times the step) at the
+  // grid points.  The slopes are the harmonic means of the
+  // neighbouring secants, or zero at local extrema, which keeps the
+  // cubic interpolation monotone between grid points.  Intervals
+  // where the interpolation at 1/4, 1/2, or 3/4 of the interval
+  // differs from the fit by more than the allowed error are flagged
+  // to be evaluated from the fit.
+  // 
+  DGUARD(fDebug, 2, "Cache weight tables in FMD density calculator");
+  fWeightTableIndex.Set(0);
+  fWeightTable.Set(0);
+  fWeightTableExact.Set(0);
+  if (fWeightTableError <= 0) return;
+
+  AliForwardCorrectionManager&  fcm    = AliForwardCorrectionManager::Instance();
+  const AliFMDCorrELossFit*     cor    = fcm.GetELossFit();
+  Int_t                         nEta   = cor->GetEtaAxis().GetNbins();
+  Int_t                         nNodes = Int_t(fWeightTableMax / 
+						fWeightTableStep + .5) + 1;
+  if (nEta <= 0 || nNodes < 2) return;
+
+  // Find the fit and number of particles for each ring and eta bin,
+  // as done in NParticles
+  TArrayI   index(5*nEta);
+  TArrayI   ns(5*nEta);
+  TObjArray fits(5*nEta);
+  Int_t     nTables = 0;
+  index.Reset(-1);
+  for (UShort_t d=1; d<=3; d++) { 
+    UShort_t nr = (d == 1 ? 1 : 2);
+    for (UShort_t q=0; q<nr; q++) { 
+      Char_t   r     = (q == 0 ? 'I' : 'O');
+      Int_t    iRing = (d == 1 ? 0 : (d - 2) * 2 + 1 + q);
+      TObject* last  = 0;
+      Int_t    lastN = -1;
+      for (Int_t iEta = 0; iEta < nEta; iEta++) { 
+	AliFMDCorrELossFit::ELossFit* fit = cor->FindFit(d, r, iEta+1, -1);
+	Int_t                         m   = GetMaxWeight(d, r, iEta);
+	if (!fit || m < 1) continue;
+
+	Int_t n = TMath::Min(fMaxParticles, UShort_t(m));
+	if (fit != last || n != lastN) { 
+	  fits.AddAt(fit, nTables);
+	  ns[nTables] = n;
+	  nTables++;
+	  last  = fit;
+	  lastN = n;
+	}
+	index[iRing*nEta+iEta] = nTables-1;
+      }
+    }
+  }
+  if (nTables <= 0) return;
+
+  // Fill the tables 
+  fWeightTable.Set(2*nTables*nNodes);
+  fWeightTableExact.Set(nTables*(nNodes-1));
+  fWeightTableExact.Reset(0);
+
+  Double_t h      = fWeightTableStep;
+  Int_t    nExact = 0;
+  Double_t maxDev = 0;
+  TArrayD  y(nNodes);
+  for (Int_t t = 0; t < nTables; t++) { 
+    AliFMDCorrELossFit::ELossFit* fit = 
+      static_cast<AliFMDCorrELossFit::ELossFit*>(fits.At(t));
+    UShort_t n = ns[t];
+    for (Int_t k = 0; k < nNodes; k++) y[k] = fit->EvaluateWeighted(k*h, n);
+
+    Float_t* p = &(fWeightTable.fArray[2*t*nNodes]);
+    for (Int_t k = 0; k < nNodes; k++) { 
+      Double_t dl = (k > 0        ? y[k]   - y[k-1] : 0);
+      Double_t dr = (k < nNodes-1 ? y[k+1] - y[k]   : 0);
+      Double_t sl = 0;
+      if      (k == 0)        sl = dr;
+      else if (k == nNodes-1) sl = dl;
+      else if (dl * dr > 0)   sl = 2 * dl * dr / (dl + dr);
+      p[2*k]   = y[k];
+      p[2*k+1] = sl;
+    }
+
+    // Check 1/4, 1/2, and 3/4 of each interval against the fit, 
+    // with the interpolation of EvaluateWeightTable 
+    for (Int_t k = 0; k < nNodes-1; k++) { 
+      Double_t kDev = 0;
+      for (Int_t i = 1; i <= 3; i++) { 
+	Double_t u   = .25 * i;
+	Double_t w   = 1 - u;
+	Double_t v   = ((1 + 2 * u) * w * w * p[2*k] + u * w * w * p[2*k+1] 
+			+ (3 - 2 * u) * u * u * p[2*k+2] - w * u * u * p[2*k+3]);
+	Double_t e   = fit->EvaluateWeighted((k+u)*h, n);
+	Double_t dev = (e != 0 ? TMath::Abs(v - e) / TMath::Abs(e) 
+			: TMath::Abs(v));
+	kDev         = TMath::Max(kDev, dev);
+      }
+      if (kDev > fWeightTableError) { 
+	fWeightTableExact[t*(nNodes-1)+k] = 1;
+	nExact++;
+	continue;
+      }
+      maxDev = TMath::Max(maxDev, kDev);
+    }
+  }
+  fWeightTableIndex = index;
+
+  AliInfoF("Tabulated %d fits at %d points in [0,%f], "
+	   "%d of %d intervals evaluated from fits, "
+	   "largest relative deviation elsewhere %g", 
+	   nTables, nNodes, (nNodes-1)*h, nExact, nTables*(nNodes-1), maxDev);
+}
+
+//_____________________________________________________________________
+Double_t
+AliFMDDensityCalculator::EvaluateWeightTable(Float_t  mult, 
+					     UShort_t d, 
+					     Char_t   r, 
+					     Float_t  eta) const
+{
+  // 
+  // Get the tabulated weighted number of particles for the signal
+  // mult in FMD<i>dr</i> at @f$\eta@f$
+  // 
+  // Parameters:
+  //    mult  Signal
+  //    d     Detector
+  //    r     Ring
+  //    eta   Pseudo-rapidity
+  // 
+  // Return:
+  //    The number of particles, or negative if the fit must be
+  //    evaluated
+  //
+  Int_t nEta   = fWeightTableIndex.fN / 5;
+  Int_t nNodes = Int_t(fWeightTableMax / fWeightTableStep + .5) + 1;
+  if (nEta <= 0 || mult < 0) return -1;
+
+  Double_t x = mult / fWeightTableStep;
+  Int_t    k = Int_t(x);
+  if (k >= nNodes-1) return -1;
+
+  AliForwardCorrectionManager&  fcm  = AliForwardCorrectionManager::Instance();
+  Int_t                         iEta = fcm.GetELossFit()->FindEtaBin(eta) -1;
+  if (iEta < 0 || iEta >= nEta) return -1;
+
+  Int_t iRing = (d == 1 ? 0 : 
+		 (d - 2) * 2 + 1 + (r=='I' || r=='i' ? 0 : 1));
+  Int_t t     = fWeightTableIndex[iRing*nEta+iEta];
+  if (t < 0 || fWeightTableExact[t*(nNodes-1)+k]) return -1;
+
+  // Monotone cubic Hermite interpolation between grid points k and k+1
+  const Float_t* p  = &(fWeightTable.fArray[2*(t*nNodes+k)]);
+  Double_t       u  = x - k;
+  Double_t       w  = 1 - u;
+  Double_t       u2 = u * u;
+  Double_t       w2 = w * w;
+  return (1 + 2 * u) * w2 * p[0] + u * w2 * p[1] 
+    +    (3 - 2 * u) * u2 * p[2] - w * u2 * p[3];
+}
+
 //_____________________________________________________________________
 Float_t 
 AliFMDDensityCalculator::NParticles(Float_t  mult, 
@@ -878,7 +1081,14 @@ AliFMDDensityCalculator::NParticles(Float_t  mult,
   }
   
   UShort_t n   = TMath::Min(fMaxParticles, UShort_t(m));
-  Double_t ret = fit->EvaluateWeighted(mult, n);
+  Double_t ret = -1;
+  if (fWeightTable.fN > 0) ret = EvaluateWeightTable(mult, d, r, eta);
+  if (ret < 0) 
+    ret = fit->EvaluateWeighted(mult, n);
+  else if (fValidateWeightTable && fWeightTableDeviation) {
+    Double_t exact = fit->EvaluateWeighted(mult, n);
+    if (exact != 0) fWeightTableDeviation->Fill(mult, (ret - exact) / exact);
+  }
   
   if (fDebug > 10) {
     AliInfo(Form("FMD%d%c, eta=%7.4f, %8.5f -> %8.5f", d, r, eta, mult, ret));
@@ -1106,6 +1316,17 @@ AliFMDDensityCalculator::CreateOutputObjects(TList* dir)
   d->Add(fMaxWeights);
   d->Add(fLowCuts);
 
+  if (fWeightTableError > 0 && fValidateWeightTable) {
+    Double_t dev = 5 * fWeightTableError;
+    fWeightTableDeviation = new TH2D("weightTableDeviation", 
+				     "Relative deviation of tabulated N_{ch}",
+				     200, 0, fWeightTableMax, 200, -dev, dev);
+    fWeightTableDeviation->SetXTitle("#Delta/#Delta_{mip}");
+    fWeightTableDeviation->SetYTitle("(N_{table}-N_{fit})/N_{fit}");
+    fWeightTableDeviation->SetDirectory(0);
+    d->Add(fWeightTableDeviation);
+  }
+
   TParameter<int>* nFiles = new TParameter<int>("nFiles", 1);
   nFiles->SetMergeMode('+');
   
@@ -1120,6 +1341,7 @@ AliFMDDensityCalculator::CreateOutputObjects(TList* dir)
   d->Add(AliForwardUtil::MakeParameter("maxOutliers",  fMaxOutliers));
   d->Add(AliForwardUtil::MakeParameter("outlierCut",   fOutlierCut));
   d->Add(AliForwardUtil::MakeParameter("hitThreshold", fHitThreshold));
+  d->Add(AliForwardUtil::MakeParameter("weightTable",  fWeightTableError));
   d->Add(nFiles);
   // d->Add(nxi);
   fCuts.Output(d,"lCuts");
@@ -1201,6 +1423,10 @@ AliFMDDensityCalculator::Print(Option_t* option) const
   PFV("Threshold(hit)",         fHitThreshold);
   PFV("Max(outliers)",          fMaxOutliers);
   PFV("Cut(outlier)",           fOutlierCut);
+  PFV("Weight table error",     fWeightTableError);
+  PFV("Weight table step",      fWeightTableStep);
+  PFV("Weight table max",       fWeightTableMax);
+  PFB("Validate weight table",  fValidateWeightTable);
   PFV("Lower cut", "");
   fCuts.Print();
 
@@ -16,6 +16,8 @@
 #include <TNamed.h>
 #include <TList.h>
 #include <TArrayI.h>
+#include <TArrayF.h>
+#include <TArrayC.h>
 #include <TVector3.h>
 #include "AliForwardUtil.h"
 #include "AliFMDMultCuts.h"
@@ -141,6 +143,37 @@ public:
    * @param m 
    */
   void SetMaxParticles(UShort_t m) { fMaxParticles = m; }  
+  /** 
+   * Use tables of the weighted number of particles, instead of
+   * evaluating the energy loss fits for each strip.  For each ring
+   * and @f$\eta@f$ bin, the weighted number of particles is
+   * tabulated at the start of a run on a grid of @f$\Delta/\Delta_{mip}@f$
+   * from 0 to @a maxMult in steps of @a step, and interpolated with
+   * monotone cubic splines.  Grid intervals where the interpolation
+   * differs from the fit by more than @a maxError (relative) at 1/4,
+   * 1/2 or 3/4 of the interval, and signals above @a maxMult, are
+   * evaluated from the fit.
+   * 
+   * @param maxError Largest relative error, if 0 or less, do not use tables
+   * @param step     Step size of the grid 
+   * @param maxMult  Largest tabulated signal 
+   */
+  void SetWeightTable(Double_t maxError=1e-4, 
+		      Double_t step=0.01, 
+		      Double_t maxMult=20) { 
+    fWeightTableError = maxError; 
+    fWeightTableStep  = (step    > 0 ? step    : 0.01);
+    fWeightTableMax   = (maxMult > 0 ? maxMult : 20); 
+  }
+  /** 
+   * Whether to compare the tabulated number of particles to the
+   * evaluation of the fits for all strips.  The relative deviations
+   * are histogrammed versus the signal.  This is slow.
+   * 
+   * @param validate If true, validate the tables 
+   */
+  void SetValidateWeightTable(Bool_t validate=true) { 
+    fValidateWeightTable = validate; }
   /** 
    * Set whether to use poisson statistics to estimate the 
    * number of particles that has hit within a region.  If this is true, 
@@ -319,6 +352,25 @@ protected:
    * @return max weight or <= 0 in case of problems 
    */
   Int_t GetMaxWeight(UShort_t d, Char_t r, Float_t eta) const;
+  /** 
+   * Tabulate the weighted number of particles for all rings and
+   * @f$\eta@f$ bins with fits.  Must be called after CacheMaxWeights
+   */
+  void CacheWeightTables();
+  /** 
+   * Get the tabulated weighted number of particles for the signal
+   * @a mult in FMD<i>dr</i> at @f$\eta@f$
+   * 
+   * @param mult  Signal
+   * @param d     Detector
+   * @param r     Ring
+   * @param eta   Pseudo-rapidity
+   * 
+   * @return The number of particles, or negative if the fit must be
+   * evaluated
+   */
+  Double_t EvaluateWeightTable(Float_t mult, UShort_t d, Char_t r, 
+			       Float_t eta) const;
 
   /** 
    * Get the number of particles corresponding to the signal mult
@@ -504,8 +556,16 @@ protected:
   TProfile*              fHTiming;
   Double_t               fMaxOutliers; // Maximum ratio of outlier bins 
   Double_t               fOutlierCut;  // Maximum relative diviation 
+  Double_t               fWeightTableError; // Largest relative error of tables
+  Double_t               fWeightTableStep;  // Step of the tables 
+  Double_t               fWeightTableMax;   // Largest tabulated signal 
+  Bool_t                 fValidateWeightTable; // Compare tables to fits 
+  TH2D*                  fWeightTableDeviation; // Deviation of tables
+  TArrayI                fWeightTableIndex; //! Table of ring and eta bin
+  TArrayF                fWeightTable;      //! Values and slopes of tables
+  TArrayC                fWeightTableExact; //! Intervals to evaluate 
 
-  ClassDef(AliFMDDensityCalculator,16); // Calculate Nch density 
+  ClassDef(AliFMDDensityCalculator,17); // Calculate Nch density 
 };
 
 #endif
@@ -25,6 +25,8 @@
 #include <TMath.h>
 #include <TTimeStamp.h>
 #include <TSystem.h>
+#include <TROOT.h>
+#include <cstring>
 #include "AliAnalysisTask.h"
 #include "AliAnalysisManager.h"
 #include "AliESDEvent.h"
@@ -62,7 +64,6 @@
 #include "AliGenPythiaEventHeader.h"
 #include "AliGenToyEventHeader.h"
 
-#include "AliMathBase.h"
 #include "AliLog.h"
 
 ClassImp(AliAnalysisTaskAO2Dconverter);
@@ -83,6 +84,32 @@ namespace
             (ULong64_t)header->GetPeriodNumber() * 16777216 * 3564);
   }
 
+  // Truncation of the float fraction, as in AliMathBase::TruncateFloatFraction,
+  // inlined since it is called for every float stored
+  inline Float_t TruncateFloatFraction(Float_t x, UInt_t mask)
+  {
+    UInt_t ix;
+    memcpy(&ix, &x, sizeof(ix));
+    ix &= mask;
+    memcpy(&x, &ix, sizeof(x));
+    return x;
+  }
+
+  // Truncation of the float fraction of a whole array (column) in place.
+  // The loop has no dependencies and is vectorized by the compiler
+  void TruncateFloatFractions(Float_t *x, Int_t n, UInt_t mask)
+  {
+    if (mask == 0xFFFFFFFF)
+      return;
+    for (Int_t i = 0; i < n; ++i)
+    {
+      UInt_t ix;
+      memcpy(&ix, &x[i], sizeof(ix));
+      ix &= mask;
+      memcpy(&x[i], &ix, sizeof(ix));
+    }
+  }
+
   // Initialize the precision masks used to truncate the corresponding float data members
   // By default no truncation
 
@@ -213,6 +240,27 @@ void AliAnalysisTaskAO2Dconverter::UserCreateOutputObjects()
     mT0Amplitude = 0xFFFFF000; // 11 bits
   }
 
+  // Compress the baskets of the output trees in parallel.
+  // With implicit multi-threading, TTree::Fill compresses the full baskets of
+  // the different branches in parallel tasks and waits for them before returning,
+  // so the memory used stays bounded by the basket sizes. The trees and their
+  // baskets are the same as in the sequential mode.
+  // Implicit MT is a process-wide setting: it is disabled on the input tree
+  // of each new file (UserNotify) and at the end of the event loop.
+  if (fNThreads != 1)
+  {
+#ifdef R__USE_IMT
+    if (!ROOT::IsImplicitMTEnabled())
+    {
+      ROOT::EnableImplicitMT(fNThreads > 0 ? fNThreads : 0);
+      fImplicitMTEnabled = kTRUE;
+    }
+    AliInfo(Form("Compressing the output with %u threads, implicit MT is enabled for the whole train", ROOT::GetImplicitMTPoolSize()));
+#else
+    AliWarning("ROOT built without implicit multi-threading, the output is compressed sequentially");
+#endif
+  }
+
   // create output objects
   OpenFile(1); // Here we have the histograms
   /// Option compress is used to specify the compression level and algorithm:
@@ -386,17 +434,53 @@ void AliAnalysisTaskAO2Dconverter::UserExec(Option_t *)
   PostData(1, fOutputList);
 } // void AliAnalysisTaskAO2Dconverter::UserExec(Option_t *)
 
+Bool_t AliAnalysisTaskAO2Dconverter::UserNotify()
+{
+  // called when a new file of the input chain is opened, before its first entry is read
+  if (fNThreads != 1)
+    DisableInputImplicitMT();
+  return kTRUE;
+}
+
+void AliAnalysisTaskAO2Dconverter::DisableInputImplicitMT()
+{
+  // The implicit MT enabled for the compression of the output applies to all trees,
+  // keep the reading of the input tree (and of each new file of the chain) sequential
+  AliAnalysisManager *mgr = AliAnalysisManager::GetAnalysisManager();
+  TTree *tree = mgr ? mgr->GetTree() : nullptr;
+  if (!tree)
+    return;
+  tree->SetImplicitMT(kFALSE);
+  if (tree->GetTree())
+    tree->GetTree()->SetImplicitMT(kFALSE);
+}
+
 void AliAnalysisTaskAO2Dconverter::FinishTaskOutput()
 {
   // called at the end of the event loop on the worker
   FinishTF();
   fOutputFile->Write(); // Do not close the file since this is then re-opened and overwritten by the framework
   AliInfo(Form("Total size of output trees: %lu bytes\n", fBytes));
+#ifdef R__USE_IMT
+  // do not leave implicit MT enabled for the rest of the process
+  if (fImplicitMTEnabled)
+  {
+    ROOT::DisableImplicitMT();
+    fImplicitMTEnabled = kFALSE;
+  }
+#endif
 }
 
 void AliAnalysisTaskAO2Dconverter::Terminate(Option_t *)
 {
   // called at the END of the analysis AFTER merging. In grid this is NOT called on the workers
+#ifdef R__USE_IMT
+  if (fImplicitMTEnabled)
+  {
+    ROOT::DisableImplicitMT();
+    fImplicitMTEnabled = kFALSE;
+  }
+#endif
 }
 
 AliAnalysisTaskAO2Dconverter *AliAnalysisTaskAO2Dconverter::AddTask(TString suffix)
@@ -446,6 +530,7 @@ TTree *AliAnalysisTaskAO2Dconverter::CreateTree(TreeIndex t)
   AliInfo(Form("Creating tree %s\n", TreeName[t].Data()));
   fTree[t] = new TTree(TreeName[t], TreeTitle[t]);
   fTree[t]->SetAutoFlush(0);
+  fTree[t]->SetImplicitMT(fNThreads != 1);
   return fTree[t];
 } // TTree* AliAnalysisTaskAO2Dconverter::CreateTree(TreeIndex t)
 
@@ -900,21 +985,21 @@ void AliAnalysisTaskAO2Dconverter::FillEventInTF()
 
   eventextra.fNentries[kEvents] = 1; // one entry per vertex
   collision.fIndexBCs = eventID;
-  collision.fPosX = AliMathBase::TruncateFloatFraction(pvtx->GetX(), mCollisionPosition);
-  collision.fPosY = AliMathBase::TruncateFloatFraction(pvtx->GetY(), mCollisionPosition);
-  collision.fPosZ = AliMathBase::TruncateFloatFraction(pvtx->GetZ(), mCollisionPosition);
+  collision.fPosX = TruncateFloatFraction(pvtx->GetX(), mCollisionPosition);
+  collision.fPosY = TruncateFloatFraction(pvtx->GetY(), mCollisionPosition);
+  collision.fPosZ = TruncateFloatFraction(pvtx->GetZ(), mCollisionPosition);
 
   Double_t covmatrix[6];
   pvtx->GetCovMatrix(covmatrix);
 
-  collision.fCovXX = AliMathBase::TruncateFloatFraction(covmatrix[0], mCollisionPositionCov);
-  collision.fCovXY = AliMathBase::TruncateFloatFraction(covmatrix[1], mCollisionPositionCov);
-  collision.fCovXZ = AliMathBase::TruncateFloatFraction(covmatrix[2], mCollisionPositionCov);
-  collision.fCovYY = AliMathBase::TruncateFloatFraction(covmatrix[3], mCollisionPositionCov);
-  collision.fCovYZ = AliMathBase::TruncateFloatFraction(covmatrix[4], mCollisionPositionCov);
-  collision.fCovZZ = AliMathBase::TruncateFloatFraction(covmatrix[5], mCollisionPositionCov);
+  collision.fCovXX = TruncateFloatFraction(covmatrix[0], mCollisionPositionCov);
+  collision.fCovXY = TruncateFloatFraction(covmatrix[1], mCollisionPositionCov);
+  collision.fCovXZ = TruncateFloatFraction(covmatrix[2], mCollisionPositionCov);
+  collision.fCovYY = TruncateFloatFraction(covmatrix[3], mCollisionPositionCov);
+  collision.fCovYZ = TruncateFloatFraction(covmatrix[4], mCollisionPositionCov);
+  collision.fCovZZ = TruncateFloatFraction(covmatrix[5], mCollisionPositionCov);
 
-  collision.fChi2 = AliMathBase::TruncateFloatFraction(pvtx->GetChi2(), mCollisionPositionCov);
+  collision.fChi2 = TruncateFloatFraction(pvtx->GetChi2(), mCollisionPositionCov);
   collision.fN = (pvtx->GetNDF() + 3) / 2;
 
   Float_t eventTime[10];
@@ -948,8 +1033,8 @@ void AliAnalysisTaskAO2Dconverter::FillEventInTF()
   }
 
   // Recalculate unique event time and its resolution
-  collision.fCollisionTime = AliMathBase::TruncateFloatFraction(TMath::Mean(10, eventTime, eventTimeWeight), mCollisionPosition);                 // Weighted mean of times per momentum interval
-  collision.fCollisionTimeRes = AliMathBase::TruncateFloatFraction(TMath::Sqrt(9. / 10.) * TMath::Mean(10, eventTimeRes), mCollisionPositionCov); // PH bad approximation
+  collision.fCollisionTime = TruncateFloatFraction(TMath::Mean(10, eventTime, eventTimeWeight), mCollisionPosition);                 // Weighted mean of times per momentum interval
+  collision.fCollisionTimeRes = TruncateFloatFraction(TMath::Sqrt(9. / 10.) * TMath::Mean(10, eventTimeRes), mCollisionPositionCov); // PH bad approximation
 
   //---------------------------------------------------------------------------
   // BC data
@@ -1158,17 +1243,17 @@ void AliAnalysisTaskAO2Dconverter::FillEventInTF()
       mcparticle.fDaughter1 = particle->GetLastDaughter();
       if (mcparticle.fDaughter1 > -1)
         mcparticle.fDaughter1 = kineIndex[mcparticle.fDaughter1] > -1 ? kineIndex[mcparticle.fDaughter1] + fOffsetLabel : -1;
-      mcparticle.fWeight = AliMathBase::TruncateFloatFraction(particle->GetWeight(), mMcParticleW);
+      mcparticle.fWeight = TruncateFloatFraction(particle->GetWeight(), mMcParticleW);
 
-      mcparticle.fPx = AliMathBase::TruncateFloatFraction(particle->Px(), mMcParticleMom);
-      mcparticle.fPy = AliMathBase::TruncateFloatFraction(particle->Py(), mMcParticleMom);
-      mcparticle.fPz = AliMathBase::TruncateFloatFraction(particle->Pz(), mMcParticleMom);
-      mcparticle.fE = AliMathBase::TruncateFloatFraction(particle->Energy(), mMcParticleMom);
+      mcparticle.fPx = TruncateFloatFraction(particle->Px(), mMcParticleMom);
+      mcparticle.fPy = TruncateFloatFraction(particle->Py(), mMcParticleMom);
+      mcparticle.fPz = TruncateFloatFraction(particle->Pz(), mMcParticleMom);
+      mcparticle.fE = TruncateFloatFraction(particle->Energy(), mMcParticleMom);
 
-      mcparticle.fVx = AliMathBase::TruncateFloatFraction(particle->Vx(), mMcParticlePos);
-      mcparticle.fVy = AliMathBase::TruncateFloatFraction(particle->Vy(), mMcParticlePos);
-      mcparticle.fVz = AliMathBase::TruncateFloatFraction(particle->Vz(), mMcParticlePos);
-      mcparticle.fVt = AliMathBase::TruncateFloatFraction(particle->T(), mMcParticlePos);
+      mcparticle.fVx = TruncateFloatFraction(particle->Vx(), mMcParticlePos);
+      mcparticle.fVy = TruncateFloatFraction(particle->Vy(), mMcParticlePos);
+      mcparticle.fVz = TruncateFloatFraction(particle->Vz(), mMcParticlePos);
+      mcparticle.fVt = TruncateFloatFraction(particle->T(), mMcParticlePos);
 
       if (toWrite[i] > 0)
       {
@@ -1195,22 +1280,22 @@ void AliAnalysisTaskAO2Dconverter::FillEventInTF()
     tracks.fIndexCollisions = eventID;
     tracks.fTrackType = TrackTypeEnum::Run2GlobalTrack;
 
-    tracks.fX = AliMathBase::TruncateFloatFraction(track->GetX(), mTrackX);
-    tracks.fAlpha = AliMathBase::TruncateFloatFraction(track->GetAlpha(), mTrackAlpha);
+    tracks.fX = TruncateFloatFraction(track->GetX(), mTrackX);
+    tracks.fAlpha = TruncateFloatFraction(track->GetAlpha(), mTrackAlpha);
 
     tracks.fY = track->GetY(); // no lossy compression
     tracks.fZ = track->GetZ();
-    tracks.fSnp = AliMathBase::TruncateFloatFraction(track->GetSnp(), mtrackSnp);
-    tracks.fTgl = AliMathBase::TruncateFloatFraction(track->GetTgl(), mTrackTgl);
-    tracks.fSigned1Pt = AliMathBase::TruncateFloatFraction(track->GetSigned1Pt(), mTrack1Pt);
+    tracks.fSnp = TruncateFloatFraction(track->GetSnp(), mtrackSnp);
+    tracks.fTgl = TruncateFloatFraction(track->GetTgl(), mTrackTgl);
+    tracks.fSigned1Pt = TruncateFloatFraction(track->GetSigned1Pt(), mTrack1Pt);
 
     // Modified covariance matrix
     // First sigmas on the diagonal
-    tracks.fSigmaY = AliMathBase::TruncateFloatFraction(TMath::Sqrt(track->GetSigmaY2()), mTrackCovDiag);
-    tracks.fSigmaZ = AliMathBase::TruncateFloatFraction(TMath::Sqrt(track->GetSigmaZ2()), mTrackCovDiag);
-    tracks.fSigmaSnp = AliMathBase::TruncateFloatFraction(TMath::Sqrt(track->GetSigmaSnp2()), mTrackCovDiag);
-    tracks.fSigmaTgl = AliMathBase::TruncateFloatFraction(TMath::Sqrt(track->GetSigmaTgl2()), mTrackCovDiag);
-    tracks.fSigma1Pt = AliMathBase::TruncateFloatFraction(TMath::Sqrt(track->GetSigma1Pt2()), mTrackCovDiag);
+    tracks.fSigmaY = TruncateFloatFraction(TMath::Sqrt(track->GetSigmaY2()), mTrackCovDiag);
+    tracks.fSigmaZ = TruncateFloatFraction(TMath::Sqrt(track->GetSigmaZ2()), mTrackCovDiag);
+    tracks.fSigmaSnp = TruncateFloatFraction(TMath::Sqrt(track->GetSigmaSnp2()), mTrackCovDiag);
+    tracks.fSigmaTgl = TruncateFloatFraction(TMath::Sqrt(track->GetSigmaTgl2()), mTrackCovDiag);
+    tracks.fSigma1Pt = TruncateFloatFraction(TMath::Sqrt(track->GetSigma1Pt2()), mTrackCovDiag);
     //
     tracks.fRhoZY = (Char_t)(128. * track->GetSigmaZY() / tracks.fSigmaZ / tracks.fSigmaY);
     tracks.fRhoSnpY = (Char_t)(128. * track->GetSigmaSnpY() / tracks.fSigmaSnp / tracks.fSigmaY);
@@ -1224,7 +1309,7 @@ void AliAnalysisTaskAO2Dconverter::FillEventInTF()
     tracks.fRho1PtTgl = (Char_t)(128. * track->GetSigma1PtTgl() / tracks.fSigma1Pt / tracks.fSigmaTgl);
 
     const AliExternalTrackParam *intp = track->GetInnerParam();
-    tracks.fTPCinnerP = AliMathBase::TruncateFloatFraction((intp ? intp->GetP() : 0), mTrack1Pt); // Set the momentum to 0 if the track did not reach TPC
+    tracks.fTPCinnerP = TruncateFloatFraction((intp ? intp->GetP() : 0), mTrack1Pt); // Set the momentum to 0 if the track did not reach TPC
 
     // Compressing and reassigned flags. Keeping only the ones we need.
     tracks.fFlags = 0x0;
@@ -1263,15 +1348,15 @@ void AliAnalysisTaskAO2Dconverter::FillEventInTF()
       if (track->GetTRDslice(i) > 0)
         tracks.fTRDPattern |= 0x1 << i; // flag tracklet on this layer
 
-    tracks.fITSChi2NCl = AliMathBase::TruncateFloatFraction((track->GetITSNcls() ? track->GetITSchi2() / track->GetITSNcls() : 0), mTrackCovOffDiag);
-    tracks.fTPCChi2NCl = AliMathBase::TruncateFloatFraction((track->GetTPCNcls() ? track->GetTPCchi2() / track->GetTPCNcls() : 0), mTrackCovOffDiag);
-    tracks.fTRDChi2 = AliMathBase::TruncateFloatFraction(track->GetTRDchi2(), mTrackCovOffDiag);
-    tracks.fTOFChi2 = AliMathBase::TruncateFloatFraction(track->GetTOFchi2(), mTrackCovOffDiag);
+    tracks.fITSChi2NCl = TruncateFloatFraction((track->GetITSNcls() ? track->GetITSchi2() / track->GetITSNcls() : 0), mTrackCovOffDiag);
+    tracks.fTPCChi2NCl = TruncateFloatFraction((track->GetTPCNcls() ? track->GetTPCchi2() / track->GetTPCNcls() : 0), mTrackCovOffDiag);
+    tracks.fTRDChi2 = TruncateFloatFraction(track->GetTRDchi2(), mTrackCovOffDiag);
+    tracks.fTOFChi2 = TruncateFloatFraction(track->GetTOFchi2(), mTrackCovOffDiag);
 
-    tracks.fTPCSignal = AliMathBase::TruncateFloatFraction(track->GetTPCsignal(), mTrackSignal);
-    tracks.fTRDSignal = AliMathBase::TruncateFloatFraction(track->GetTRDsignal(), mTrackSignal);
-    tracks.fTOFSignal = AliMathBase::TruncateFloatFraction(track->GetTOFsignal(), mTrackSignal);
-    tracks.fLength = AliMathBase::TruncateFloatFraction(track->GetIntegratedLength(), mTrackSignal);
+    tracks.fTPCSignal = TruncateFloatFraction(track->GetTPCsignal(), mTrackSignal);
+    tracks.fTRDSignal = TruncateFloatFraction(track->GetTRDsignal(), mTrackSignal);
+    tracks.fTOFSignal = TruncateFloatFraction(track->GetTOFsignal(), mTrackSignal);
+    tracks.fLength = TruncateFloatFraction(track->GetIntegratedLength(), mTrackSignal);
 
     // Speed of ligth in TOF units
     const Float_t cspeed = 0.029979246f;
@@ -1282,13 +1367,13 @@ void AliAnalysisTaskAO2Dconverter::FillEventInTF()
         (track->GetIntegratedLength() /
          TOFResponse.GetExpectedSignal(track, tof_pid) / cspeed);
 
-    tracks.fTOFExpMom = AliMathBase::TruncateFloatFraction(
+    tracks.fTOFExpMom = TruncateFloatFraction(
         AliPID::ParticleMass(tof_pid) * exp_beta * cspeed /
             TMath::Sqrt(1. - (exp_beta * exp_beta)),
         mTrack1Pt);
 
-    tracks.fTrackEtaEMCAL = AliMathBase::TruncateFloatFraction(track->GetTrackEtaOnEMCal(), mTrackPosEMCAL);
-    tracks.fTrackPhiEMCAL = AliMathBase::TruncateFloatFraction(track->GetTrackPhiOnEMCal(), mTrackPosEMCAL);
+    tracks.fTrackEtaEMCAL = TruncateFloatFraction(track->GetTrackEtaOnEMCal(), mTrackPosEMCAL);
+    tracks.fTrackPhiEMCAL = TruncateFloatFraction(track->GetTrackPhiOnEMCal(), mTrackPosEMCAL);
 
     if (fTaskMode == kMC)
     {
@@ -1396,7 +1481,7 @@ void AliAnalysisTaskAO2Dconverter::FillEventInTF()
       // inversion formulas for snp and alpha
       tracks.fSnp = 0.;
       alpha = phi;
-      tracks.fAlpha = AliMathBase::TruncateFloatFraction(alpha, mTracklets);
+      tracks.fAlpha = TruncateFloatFraction(alpha, mTracklets);
 
       // inversion formulas for tgl
       x = (TMath::Tan(theta / 2.) - 1.) / (TMath::Tan(theta / 2.) + 1.);
@@ -1404,7 +1489,7 @@ void AliAnalysisTaskAO2Dconverter::FillEventInTF()
         tgl = TMath::Sqrt((TMath::Power((1. + TMath::Power(x, 2)) / (1. - TMath::Power(x, 2)), 2)) - 1.);
       else
         tgl = -TMath::Sqrt((TMath::Power((1. + TMath::Power(x, 2)) / (1. - TMath::Power(x, 2)), 2)) - 1.);
-      tracks.fTgl = AliMathBase::TruncateFloatFraction(tgl, mTracklets);
+      tracks.fTgl = TruncateFloatFraction(tgl, mTracklets);
 
       // set global track parameters to NAN
       tracks.fX = NAN;
@@ -1493,8 +1578,8 @@ void AliAnalysisTaskAO2Dconverter::FillEventInTF()
     // Mimic run3 compression: Store only cells with energy larger than the threshold
     if (amplitude < fEMCALAmplitudeThreshold)
       continue;
-    calo.fAmplitude = AliMathBase::TruncateFloatFraction(amplitude, mCaloAmp);
-    calo.fTime = AliMathBase::TruncateFloatFraction(time * kSecToNanoSec, mCaloAmp);
+    calo.fAmplitude = TruncateFloatFraction(amplitude, mCaloAmp);
+    calo.fTime = TruncateFloatFraction(time * kSecToNanoSec, mCaloAmp);
     calo.fCaloType = cells->GetType(); // common for all cells
     calo.fCellType = cells->GetHighGain(ice) ? 1. : 0.;
     FillTree(kCalo);
@@ -1534,10 +1619,10 @@ void AliAnalysisTaskAO2Dconverter::FillEventInTF()
     geo->GetTriggerMapping()->GetAbsFastORIndexFromPositionInEMCAL(col, row, fastorID);
     calotrigger.fFastOrAbsID = fastorID;
     calotriggers->GetAmplitude(calotrigger.fL0Amplitude);
-    calotrigger.fL0Amplitude = AliMathBase::TruncateFloatFraction(calotrigger.fL0Amplitude, mCaloAmp);
-    calotrigger.fL1TimeSum = AliMathBase::TruncateFloatFraction(l1timesum, mCaloAmp);
+    calotrigger.fL0Amplitude = TruncateFloatFraction(calotrigger.fL0Amplitude, mCaloAmp);
+    calotrigger.fL1TimeSum = TruncateFloatFraction(l1timesum, mCaloAmp);
     calotriggers->GetTime(calotrigger.fL0Time);
-    calotrigger.fL0Time = AliMathBase::TruncateFloatFraction(calotrigger.fL0Time, mCaloTime);
+    calotrigger.fL0Time = TruncateFloatFraction(calotrigger.fL0Time, mCaloTime);
     calotriggers->GetTriggerBits(calotrigger.fTriggerBits);
     Int_t nL0times;
     calotriggers->GetNL0Times(nL0times);
@@ -1565,8 +1650,8 @@ void AliAnalysisTaskAO2Dconverter::FillEventInTF()
 
     cells->GetCell(icp, cellNumber, amplitude, time, mclabel, efrac);
     calo.fCellNumber = cellNumber;
-    calo.fAmplitude = AliMathBase::TruncateFloatFraction(amplitude, mCaloAmp);
-    calo.fTime = AliMathBase::TruncateFloatFraction(time, mCaloTime);
+    calo.fAmplitude = TruncateFloatFraction(amplitude, mCaloAmp);
+    calo.fTime = TruncateFloatFraction(time, mCaloTime);
     calo.fCellType = cells->GetHighGain(icp) ? 0. : 1.; /// @TODO cell type value to be confirmed by PHOS experts
     calo.fCaloType = cells->GetType();                  // common for all cells
 
@@ -1598,21 +1683,22 @@ void AliAnalysisTaskAO2Dconverter::FillEventInTF()
   {
     AliESDMuonTrack *mutrk = fESD->GetMuonTrack(imu);
 
-    muons.fInverseBendingMomentum = AliMathBase::TruncateFloatFraction(mutrk->GetInverseBendingMomentum(), mMuonTr1P);
-    muons.fThetaX = AliMathBase::TruncateFloatFraction(mutrk->GetThetaX(), mMuonTrThetaX);
-    muons.fThetaY = AliMathBase::TruncateFloatFraction(mutrk->GetThetaY(), mMuonTrThetaY);
-    muons.fZMu = AliMathBase::TruncateFloatFraction(mutrk->GetZ(), mMuonTrZmu);
-    muons.fBendingCoor = AliMathBase::TruncateFloatFraction(mutrk->GetBendingCoor(), mMuonTrBend);
-    muons.fNonBendingCoor = AliMathBase::TruncateFloatFraction(mutrk->GetNonBendingCoor(), mMuonTrNonBend);
+    muons.fInverseBendingMomentum = TruncateFloatFraction(mutrk->GetInverseBendingMomentum(), mMuonTr1P);
+    muons.fThetaX = TruncateFloatFraction(mutrk->GetThetaX(), mMuonTrThetaX);
+    muons.fThetaY = TruncateFloatFraction(mutrk->GetThetaY(), mMuonTrThetaY);
+    muons.fZMu = TruncateFloatFraction(mutrk->GetZ(), mMuonTrZmu);
+    muons.fBendingCoor = TruncateFloatFraction(mutrk->GetBendingCoor(), mMuonTrBend);
+    muons.fNonBendingCoor = TruncateFloatFraction(mutrk->GetNonBendingCoor(), mMuonTrNonBend);
 
     TMatrixD cov;
     mutrk->GetCovariances(cov);
     for (Int_t i = 0; i < 5; i++)
       for (Int_t j = 0; j <= i; j++)
-        muons.fCovariances[i * (i + 1) / 2 + j] = AliMathBase::TruncateFloatFraction(cov(i, j), mMuonTrCov);
+        muons.fCovariances[i * (i + 1) / 2 + j] = cov(i, j);
+    TruncateFloatFractions(muons.fCovariances, 15, mMuonTrCov);
 
-    muons.fChi2 = AliMathBase::TruncateFloatFraction(mutrk->GetChi2(), mMuonTrCov);
-    muons.fChi2MatchTrigger = AliMathBase::TruncateFloatFraction(mutrk->GetChi2MatchTrigger(), mMuonTrCov);
+    muons.fChi2 = TruncateFloatFraction(mutrk->GetChi2(), mMuonTrCov);
+    muons.fChi2MatchTrigger = TruncateFloatFraction(mutrk->GetChi2MatchTrigger(), mMuonTrCov);
 
     // Now MUON clusters for the current track
     Int_t muTrackID = fOffsetMuTrackID + imu;
@@ -1621,13 +1707,13 @@ void AliAnalysisTaskAO2Dconverter::FillEventInTF()
     {
       AliESDMuonCluster *muCluster = fESD->FindMuonCluster(mutrk->GetClusterId(imucl));
       mucls.fIndexMuons = muTrackID;
-      mucls.fX = AliMathBase::TruncateFloatFraction(muCluster->GetX(), mMuonCl);
-      mucls.fY = AliMathBase::TruncateFloatFraction(muCluster->GetY(), mMuonCl);
-      mucls.fZ = AliMathBase::TruncateFloatFraction(muCluster->GetZ(), mMuonCl);
-      mucls.fErrX = AliMathBase::TruncateFloatFraction(muCluster->GetErrX(), mMuonClErr);
-      mucls.fErrY = AliMathBase::TruncateFloatFraction(muCluster->GetErrY(), mMuonClErr);
-      mucls.fCharge = AliMathBase::TruncateFloatFraction(muCluster->GetCharge(), mMuonCl);
-      mucls.fChi2 = AliMathBase::TruncateFloatFraction(muCluster->GetChi2(), mMuonClErr);
+      mucls.fX = TruncateFloatFraction(muCluster->GetX(), mMuonCl);
+      mucls.fY = TruncateFloatFraction(muCluster->GetY(), mMuonCl);
+      mucls.fZ = TruncateFloatFraction(muCluster->GetZ(), mMuonCl);
+      mucls.fErrX = TruncateFloatFraction(muCluster->GetErrX(), mMuonClErr);
+      mucls.fErrY = TruncateFloatFraction(muCluster->GetErrY(), mMuonClErr);
+      mucls.fCharge = TruncateFloatFraction(muCluster->GetCharge(), mMuonCl);
+      mucls.fChi2 = TruncateFloatFraction(muCluster->GetChi2(), mMuonClErr);
       FillTree(kMuonCls);
       if (fTreeStatus[kMuonCls])
         nmucl_filled++;
@@ -1713,11 +1799,13 @@ void AliAnalysisTaskAO2Dconverter::FillEventInTF()
   fv0a.fIndexBCs = eventID;
   fv0c.fIndexBCs = eventID;
   for (Int_t ich = 0; ich < 32; ++ich)
-    fv0a.fAmplitude[ich] = AliMathBase::TruncateFloatFraction(vz->GetMultiplicityV0A(ich), mV0Amplitude);
+    fv0a.fAmplitude[ich] = vz->GetMultiplicityV0A(ich);
   for (Int_t ich = 0; ich < 32; ++ich)
-    fv0c.fAmplitude[ich] = AliMathBase::TruncateFloatFraction(vz->GetMultiplicityV0C(ich), mV0Amplitude);
-  fv0a.fTime = AliMathBase::TruncateFloatFraction(vz->GetV0ATime(), mV0Time);
-  fv0c.fTime = AliMathBase::TruncateFloatFraction(vz->GetV0CTime(), mV0Time);
+    fv0c.fAmplitude[ich] = vz->GetMultiplicityV0C(ich);
+  TruncateFloatFractions(fv0a.fAmplitude, 32, mV0Amplitude);
+  TruncateFloatFractions(fv0c.fAmplitude, 32, mV0Amplitude);
+  fv0a.fTime = TruncateFloatFraction(vz->GetV0ATime(), mV0Time);
+  fv0c.fTime = TruncateFloatFraction(vz->GetV0CTime(), mV0Time);
   fv0a.fTriggerMask = 0; // not filled for the moment
   FillTree(kFV0A);
   FillTree(kFV0C);
@@ -1730,11 +1818,13 @@ void AliAnalysisTaskAO2Dconverter::FillEventInTF()
   // FT0
   ft0.fIndexBCs = eventID;
   for (Int_t ich = 0; ich < 12; ++ich)
-    ft0.fAmplitudeA[ich] = AliMathBase::TruncateFloatFraction(fESD->GetT0amplitude()[ich + 12], mT0Amplitude);
+    ft0.fAmplitudeA[ich] = fESD->GetT0amplitude()[ich + 12];
   for (Int_t ich = 0; ich < 12; ++ich)
-    ft0.fAmplitudeC[ich] = AliMathBase::TruncateFloatFraction(fESD->GetT0amplitude()[ich], mT0Amplitude);
-  ft0.fTimeA = AliMathBase::TruncateFloatFraction(fESD->GetT0TOF(1) * 1e-3, mT0Time); // ps to ns
-  ft0.fTimeC = AliMathBase::TruncateFloatFraction(fESD->GetT0TOF(2) * 1e-3, mT0Time); // ps to ns
+    ft0.fAmplitudeC[ich] = fESD->GetT0amplitude()[ich];
+  TruncateFloatFractions(ft0.fAmplitudeA, 12, mT0Amplitude);
+  TruncateFloatFractions(ft0.fAmplitudeC, 12, mT0Amplitude);
+  ft0.fTimeA = TruncateFloatFraction(fESD->GetT0TOF(1) * 1e-3, mT0Time); // ps to ns
+  ft0.fTimeC = TruncateFloatFraction(fESD->GetT0TOF(2) * 1e-3, mT0Time); // ps to ns
   ft0.fTriggerMask = fESD->GetT0Trig();
   FillTree(kFT0);
   if (fTreeStatus[kFT0])
@@ -1748,8 +1838,8 @@ void AliAnalysisTaskAO2Dconverter::FillEventInTF()
     fdd.fAmplitudeA[ich] = 0; // not filled for the moment
   for (Int_t ich = 0; ich < 4; ++ich)
     fdd.fAmplitudeC[ich] = 0; // not filled for the moment
-  fdd.fTimeA = AliMathBase::TruncateFloatFraction(esdad->GetADATime(), mADTime);
-  fdd.fTimeC = AliMathBase::TruncateFloatFraction(esdad->GetADCTime(), mADTime);
+  fdd.fTimeA = TruncateFloatFraction(esdad->GetADATime(), mADTime);
+  fdd.fTimeC = TruncateFloatFraction(esdad->GetADCTime(), mADTime);
   fdd.fTriggerMask = 0; // not filled for the moment
   FillTree(kFDD);
   if (fTreeStatus[kFDD])
@@ -1844,13 +1934,13 @@ void AliAnalysisTaskAO2Dconverter::FillEventInTF()
 
     mccollision.fIndexBCs = eventID;
 
-    mccollision.fPosX = AliMathBase::TruncateFloatFraction(MCvtx->GetX(), mCollisionPosition);
-    mccollision.fPosY = AliMathBase::TruncateFloatFraction(MCvtx->GetY(), mCollisionPosition);
-    mccollision.fPosZ = AliMathBase::TruncateFloatFraction(MCvtx->GetZ(), mCollisionPosition);
+    mccollision.fPosX = TruncateFloatFraction(MCvtx->GetX(), mCollisionPosition);
+    mccollision.fPosY = TruncateFloatFraction(MCvtx->GetY(), mCollisionPosition);
+    mccollision.fPosZ = TruncateFloatFraction(MCvtx->GetZ(), mCollisionPosition);
 
     AliGenEventHeader *mcGenH = MCEvt->GenEventHeader();
-    mccollision.fT = AliMathBase::TruncateFloatFraction(mcGenH->InteractionTime(), mCollisionPosition);
-    mccollision.fWeight = AliMathBase::TruncateFloatFraction(mcGenH->EventWeight(), mCollisionPosition);
+    mccollision.fT = TruncateFloatFraction(mcGenH->InteractionTime(), mCollisionPosition);
+    mccollision.fWeight = TruncateFloatFraction(mcGenH->EventWeight(), mCollisionPosition);
 
     // Impact parameter
     AliCollisionGeometry *cGeo = dynamic_cast<AliCollisionGeometry *>(mcGenH);
@@ -1884,7 +1974,7 @@ void AliAnalysisTaskAO2Dconverter::FillEventInTF()
         }
       }
     }
-    mccollision.fImpactParameter = AliMathBase::TruncateFloatFraction(mccollision.fImpactParameter, mCollisionPosition);
+    mccollision.fImpactParameter = TruncateFloatFraction(mccollision.fImpactParameter, mCollisionPosition);
     eventextra.fNentries[kMcCollision] = 1;
   }
   else
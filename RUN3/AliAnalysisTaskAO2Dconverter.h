@@ -36,6 +36,7 @@ public:
   virtual void Init() {}
   virtual void UserCreateOutputObjects();
   virtual void UserExec(Option_t *option);
+  virtual Bool_t UserNotify();
   virtual void FinishTaskOutput();
   virtual void Terminate(Option_t *option);
 
@@ -44,6 +45,11 @@ public:
   virtual void SetTruncation(Bool_t trunc=kTRUE) {fTruncate = trunc;}
   virtual void SetCompression(UInt_t compress=101) {fCompress = compress; }
   virtual void SetMaxBytes(ULong_t nbytes = 100000000) {fMaxBytes = nbytes;}
+  /// Threads compressing the output, 0 = all cores, 1 = sequential.
+  /// Other than 1, ROOT implicit MT is enabled for the whole process, i.e. for all the tasks
+  /// of the train and their own trees, until the end of the event loop if this task enabled it.
+  /// The input tree of the train is kept sequential.
+  void SetNThreads(Int_t nthreads = 0) { fNThreads = nthreads; }
   void SetEMCALAmplitudeThreshold(Double_t threshold) { fEMCALAmplitudeThreshold = threshold; }
 
   static AliAnalysisTaskAO2Dconverter* AddTask(TString suffix = "");
@@ -142,6 +148,7 @@ private:
   void InitTF(ULong64_t tfId);           // Initialize output subdir and trees for TF tfId
   void FillEventInTF();
   void FinishTF();
+  void DisableInputImplicitMT();          // Keep the reading of the input tree sequential
 
   // Task configuration variables
   TString fPruneList = "";                // Names of the branches that will not be saved to output file
@@ -491,6 +498,7 @@ private:
   Bool_t fTruncate = kFALSE;
   /// Compression algotythm and level, see TFile.cxx and RZip.cxx
   UInt_t fCompress = 101; /// This is the default level in Root (zip level 1)
+  Int_t fNThreads = 1; /// Threads for the compression of the output trees (ROOT implicit MT), 0 = all cores, 1 = sequential
   Bool_t fSkipPileup = kFALSE;       /// Skip pileup events
   Bool_t fSkipTPCPileup = kFALSE;    /// Skip TPC pileup (SetRejectTPCPileupWithITSTPCnCluCorr)
   TString fCentralityMethod = "V0M"; /// Centrality method
@@ -506,8 +514,9 @@ private:
   /// Pointer to the output file
   TFile * fOutputFile = 0x0; ///! Pointer to the output file
   TDirectory * fOutputDir = 0x0; ///! Pointer to the output Root subdirectory
+  Bool_t fImplicitMTEnabled = kFALSE; ///! Implicit MT was enabled by this task
   
-  ClassDef(AliAnalysisTaskAO2Dconverter, 14);
+  ClassDef(AliAnalysisTaskAO2Dconverter, 17);
 };
 
 #endif